@@ -2,16 +2,16 @@
 
 #include <stdio.h>
 #include <cstdlib>
-#include <for.h>
 #include <cstring>
 #include <limits>
 #include <iostream>
+#include "int_codec.h"
 
 #define FOR_GROWTH_FACTOR 1.3
 #define FOR_ELE_SIZE sizeof(uint32_t)
-#define METADATA_OVERHEAD 5
 
-class array_base {
+template<class codec_t>
+class array_base_t {
 protected:
     uint8_t* in;
     uint32_t size_bytes = 0;    // allocated size
@@ -20,18 +20,16 @@ protected:
     uint32_t min = std::numeric_limits<uint32_t>::max();
     uint32_t max = std::numeric_limits<uint32_t>::min();
 
-    static inline uint32_t required_bits(const uint32_t v) {
-        return (uint32_t) (v == 0 ? 0 : 32 - __builtin_clz(v));
-    }
-
 public:
-    explicit array_base(const uint32_t n=2) {
+    typedef codec_t codec;
+
+    explicit array_base_t(const uint32_t n=2) {
         size_bytes = METADATA_OVERHEAD + (n * FOR_ELE_SIZE);
         in = (uint8_t *) malloc(size_bytes * sizeof *in);
         memset(in, 0, size_bytes);
     }
 
-    ~array_base() {
+    ~array_base_t() {
         free(in);
         in = nullptr;
     }
@@ -39,6 +37,9 @@ public:
     // len determines length of output buffer (default: length of input)
     uint32_t* uncompress(uint32_t len=0) const;
 
+    // decodes into a caller provided buffer that can hold atleast `getLength()` elements
+    void uncompress_into(uint32_t* out) const;
+
     uint32_t getSizeInBytes();
 
     uint32_t getLength() const;
@@ -46,4 +47,4 @@ public:
     uint32_t getMin() const;
 
     uint32_t getMax() const;
-};
\ No newline at end of file
+};
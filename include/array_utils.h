@@ -9,11 +9,37 @@
  */
 class ArrayUtils {
 public:
-  // Fast scalar scheme designed by N. Kurz. Returns the size of out (intersected set)
+  // when one list is these many times larger than the other, galloping beats a linear merge
+  static constexpr size_t GALLOPING_SIZE_RATIO = 32;
+
+  // Intersection of two sorted arrays, dispatched to `intersect()`. Returns the size of out (intersected set)
   static size_t and_scalar(const uint32_t *A, const size_t lenA, const uint32_t *B, const size_t lenB, uint32_t **out);
 
   static size_t or_scalar(const uint32_t *A, const size_t lenA, const uint32_t *B, const size_t lenB, uint32_t **out);
 
   static size_t exclude_scalar(const uint32_t *src, const size_t lenSrc, const uint32_t *filter, const size_t lenFilter,
                               uint32_t **out);
-};
\ No newline at end of file
+
+  // Intersects into a caller-owned `out` that can hold atleast min(lenA, lenB) elements.
+  // Uses galloping for lists of skewed lengths and the widest SIMD kernel supported by the CPU otherwise.
+  static size_t intersect(const uint32_t *A, const size_t lenA, const uint32_t *B, const size_t lenB, uint32_t *out);
+
+  // Fast scalar scheme designed by N. Kurz.
+  static size_t intersect_scalar(const uint32_t *A, const size_t lenA, const uint32_t *B, const size_t lenB,
+                                 uint32_t *out);
+
+  // Looks up each element of the smaller list in the larger one via exponential + binary search.
+  static size_t intersect_galloping(const uint32_t *small, const size_t len_small,
+                                    const uint32_t *large, const size_t len_large, uint32_t *out);
+
+  // 4x4 and 8x8 all-pairs comparison kernels. Must be called only when supported by the CPU.
+  static size_t intersect_sse(const uint32_t *A, const size_t lenA, const uint32_t *B, const size_t lenB,
+                              uint32_t *out);
+
+  static size_t intersect_avx2(const uint32_t *A, const size_t lenA, const uint32_t *B, const size_t lenB,
+                               uint32_t *out);
+
+  static bool has_sse_support();
+
+  static bool has_avx2_support();
+};
@@ -45,6 +45,8 @@ typedef struct {
     uint8_t num_children;
     uint8_t partial_len;
     unsigned char partial[MAX_PREFIX_LEN];
+    // upper bounds of the score and of the number of IDs of the leaves below, for best-first traversal
+    uint32_t max_frequency;
     int64_t max_score;
 } art_node;
 
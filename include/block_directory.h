@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+typedef uint32_t last_id_t;
+
+/*
+    Sorted directory of the blocks of a block chain, keyed on the *last* ID of each block.
+    Keys and block pointers are held in two contiguous arrays, so that a lookup is a binary search over a
+    compact array of integers instead of a walk over the nodes of a tree.
+*/
+template<class T>
+class block_directory_t {
+private:
+    std::vector<last_id_t> last_ids;
+    std::vector<T*> blocks;
+
+public:
+
+    [[nodiscard]] size_t size() const {
+        return last_ids.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return last_ids.empty();
+    }
+
+    [[nodiscard]] last_id_t last_id_at(size_t index) const {
+        return last_ids[index];
+    }
+
+    [[nodiscard]] T* block_at(size_t index) const {
+        return blocks[index];
+    }
+
+    // index of the first block whose last ID is >= `id`, or `size()` when there is no such block
+    [[nodiscard]] size_t lower_bound(last_id_t id) const {
+        size_t n = last_ids.size();
+        if(n == 0) {
+            return 0;
+        }
+
+        // branchless binary search: the loop trip count depends only on `n`
+        const last_id_t* base = last_ids.data();
+        while(n > 1) {
+            const size_t half = n / 2;
+            base = (base[half] < id) ? base + half : base;
+            n -= half;
+        }
+
+        return (base - last_ids.data()) + (*base < id);
+    }
+
+    // index of the block with the given last ID, or `size()` when absent
+    [[nodiscard]] size_t find(last_id_t last_id) const {
+        const size_t index = lower_bound(last_id);
+        return (index != size() && last_ids[index] == last_id) ? index : size();
+    }
+
+    // has no effect if the key already exists
+    void emplace(last_id_t last_id, T* block) {
+        const size_t index = lower_bound(last_id);
+        if(index != size() && last_ids[index] == last_id) {
+            return;
+        }
+
+        last_ids.insert(last_ids.begin() + index, last_id);
+        blocks.insert(blocks.begin() + index, block);
+    }
+
+    void erase(last_id_t last_id) {
+        const size_t index = find(last_id);
+        if(index == size()) {
+            return;
+        }
+
+        last_ids.erase(last_ids.begin() + index);
+        blocks.erase(blocks.begin() + index);
+    }
+
+    // Re-keys a block whose last ID has changed, or adds it when absent. The change must not affect the
+    // order of the blocks, which holds as long as IDs stay within the range of the block's neighbours.
+    void update(last_id_t before_last_id, last_id_t after_last_id, T* block) {
+        const size_t index = find(before_last_id);
+        if(index == size()) {
+            emplace(after_last_id, block);
+            return;
+        }
+
+        last_ids[index] = after_last_id;
+        blocks[index] = block;
+    }
+};
@@ -20,6 +20,7 @@
 #include <tsl/htrie_map.h>
 #include "tokenizer.h"
 #include "synonym_index.h"
+#include "search_plan_cache.h"
 
 struct doc_seq_id_t {
     uint32_t seq_id;
@@ -123,6 +124,13 @@ private:
 
     SynonymIndex* synonym_index;
 
+    // advanced whenever fields are added to or dropped from `search_schema`
+    uint64_t schema_version = 0;
+
+    mutable search_plan_cache_t<filter_node_t> filter_plan_cache{SEARCH_PLAN_CACHE_SIZE};
+
+    mutable search_plan_cache_t<sort_plan_t> sort_plan_cache{SEARCH_PLAN_CACHE_SIZE};
+
     // methods
 
     std::string get_doc_id_key(const std::string & doc_id) const;
@@ -194,6 +202,12 @@ private:
                                                       std::vector<sort_by>& sort_fields_std,
                                                       bool is_wildcard_query) const;
 
+    Option<bool> get_filter_tree(const std::string& filter_query, const std::string& doc_id_prefix,
+                                 std::shared_ptr<const filter_node_t>& filter_tree) const;
+
+    Option<bool> get_sort_plan(const std::vector<sort_by>& sort_fields, bool is_wildcard_query,
+                               std::shared_ptr<const sort_plan_t>& sort_plan) const;
+
     Option<bool> persist_collection_meta();
 
     Option<bool> batch_alter_data(const std::vector<field>& alter_fields,
@@ -258,6 +272,9 @@ public:
 
     enum {MAX_ARRAY_MATCHES = 5};
 
+    // bytes of parsed `filter_by` and of `sort_by` clauses that are held per collection
+    enum {SEARCH_PLAN_CACHE_SIZE = 1024 * 1024};
+
     const size_t PER_PAGE_MAX = 250;
 
     const size_t GROUP_LIMIT_MAX = 99;
@@ -337,6 +354,10 @@ public:
 
     Option<bool> get_document_from_store(const uint32_t& seq_id, nlohmann::json & document, bool raw_doc = false) const;
 
+    // `documents` and `document_ops` are in the order of `seq_ids`
+    void get_documents_from_store(const std::vector<uint32_t>& seq_ids, std::vector<nlohmann::json>& documents,
+                                  std::vector<Option<bool>>& document_ops) const;
+
     Option<uint32_t> index_in_memory(nlohmann::json & document, uint32_t seq_id,
                                      const index_operation_t op, const DIRTY_VALUES& dirty_values);
 
@@ -347,9 +368,6 @@ public:
 
     const Index* _get_index() const;
 
-    bool facet_value_to_string(const facet &a_facet, const facet_count_t &facet_count, const nlohmann::json &document,
-                               std::string &value) const;
-
     static void populate_result_kvs(Topster *topster, std::vector<std::vector<KV *>> &result_kvs);
 
     void batch_index(std::vector<index_record>& index_records, std::vector<std::string>& json_out, size_t &num_indexed,
@@ -423,7 +441,10 @@ public:
                                   const std::string& vector_query_str = "",
                                   const bool enable_highlight_v1 = true,
                                   const uint64_t search_time_start_us = 0,
-                                  const text_match_type_t match_type = max_score) const;
+                                  const text_match_type_t match_type = max_score,
+                                  const size_t facet_sample_percent = 100,
+                                  const size_t facet_sample_threshold = 0,
+                                  const bool facet_approximate_group_counts = false) const;
 
     Option<bool> get_filter_ids(const std::string & simple_filter_query,
                                 std::vector<std::pair<size_t, uint32_t*>>& index_ids);
@@ -436,6 +457,8 @@ public:
 
     size_t get_num_documents() const;
 
+    size_t get_filter_cache_size_bytes() const;
+
     DIRTY_VALUES parse_dirty_values_option(std::string& dirty_values) const;
 
     std::vector<char> get_symbols_to_index();
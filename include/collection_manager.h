@@ -163,6 +163,9 @@ public:
 
     nlohmann::json get_collection_summaries() const;
 
+    // across the filter result caches of all collections
+    size_t get_filter_cache_size_bytes() const;
+
     Option<nlohmann::json> drop_collection(const std::string& collection_name, const bool remove_from_store = true);
 
     uint32_t get_next_collection_id() const;
@@ -61,6 +61,12 @@ private:
 
     std::atomic<int> log_slow_searches_time_ms;
 
+    size_t document_cache_size;
+
+    size_t search_cache_size;
+
+    size_t filter_cache_size;
+
 protected:
 
     Config() {
@@ -83,6 +89,9 @@ protected:
         this->memory_used_max_percentage = 100;
         this->skip_writes = false;
         this->log_slow_searches_time_ms = 30 * 1000;
+        this->document_cache_size = 0;
+        this->search_cache_size = 64 * 1024 * 1024;
+        this->filter_cache_size = 32 * 1024 * 1024;
     }
 
     Config(Config const&) {
@@ -296,6 +305,18 @@ public:
         return skip_writes;
     }
 
+    size_t get_document_cache_size() const {
+        return this->document_cache_size;
+    }
+
+    size_t get_search_cache_size() const {
+        return this->search_cache_size;
+    }
+
+    size_t get_filter_cache_size() const {
+        return this->filter_cache_size;
+    }
+
     // loaders
 
     std::string get_env(const char *name) {
@@ -410,6 +431,18 @@ public:
         }
 
         this->skip_writes = ("TRUE" == get_env("TYPESENSE_SKIP_WRITES"));
+
+        if(!get_env("TYPESENSE_DOCUMENT_CACHE_SIZE").empty()) {
+            this->document_cache_size = std::stoull(get_env("TYPESENSE_DOCUMENT_CACHE_SIZE"));
+        }
+
+        if(!get_env("TYPESENSE_SEARCH_CACHE_SIZE").empty()) {
+            this->search_cache_size = std::stoull(get_env("TYPESENSE_SEARCH_CACHE_SIZE"));
+        }
+
+        if(!get_env("TYPESENSE_FILTER_CACHE_SIZE").empty()) {
+            this->filter_cache_size = std::stoull(get_env("TYPESENSE_FILTER_CACHE_SIZE"));
+        }
     }
 
     void load_config_file(cmdline::parser & options) {
@@ -565,6 +598,18 @@ public:
             auto skip_writes_str = reader.Get("server", "skip-writes", "false");
             this->skip_writes = (skip_writes_str == "true");
         }
+
+        if(reader.Exists("server", "document-cache-size")) {
+            this->document_cache_size = (size_t) reader.GetInteger("server", "document-cache-size", 0);
+        }
+
+        if(reader.Exists("server", "search-cache-size")) {
+            this->search_cache_size = (size_t) reader.GetInteger("server", "search-cache-size", 64 * 1024 * 1024);
+        }
+
+        if(reader.Exists("server", "filter-cache-size")) {
+            this->filter_cache_size = (size_t) reader.GetInteger("server", "filter-cache-size", 32 * 1024 * 1024);
+        }
     }
 
     void load_config_cmd_args(cmdline::parser & options) {
@@ -697,6 +742,18 @@ public:
         if(options.exist("skip-writes")) {
             this->skip_writes = options.get<bool>("skip-writes");
         }
+
+        if(options.exist("document-cache-size")) {
+            this->document_cache_size = options.get<size_t>("document-cache-size");
+        }
+
+        if(options.exist("search-cache-size")) {
+            this->search_cache_size = options.get<size_t>("search-cache-size");
+        }
+
+        if(options.exist("filter-cache-size")) {
+            this->filter_cache_size = options.get<size_t>("filter-cache-size");
+        }
     }
 
     void set_cors_domains(std::string& cors_domains_value) {
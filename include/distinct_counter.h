@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "sparsepp.h"
+
+/*
+    Counts the distinct IDs added to it. IDs are held in a sorted vector while they are few, and then in a hash set.
+    An approximate counter instead folds them into a HyperLogLog sketch once they would take more space than it:
+    the count is then an estimate (with a standard error of about 1.04 / sqrt(NUM_REGISTERS)), but the memory stays
+    fixed however many IDs are added. Merging an approximate counter makes the merged counter approximate too.
+*/
+class distinct_counter_t {
+public:
+    static constexpr size_t PRECISION = 11;
+    static constexpr size_t NUM_REGISTERS = 1 << PRECISION;
+
+    // beyond this many exact IDs, the sketch takes less space
+    static constexpr size_t MAX_EXACT_IDS = NUM_REGISTERS / sizeof(uint64_t);
+
+private:
+    bool approximate;
+
+    // sorted, while few
+    std::vector<uint64_t> ids;
+
+    // once there are more than `MAX_EXACT_IDS` IDs, unless approximate
+    spp::sparse_hash_set<uint64_t> id_set;
+
+    // empty while exact
+    std::vector<uint8_t> registers;
+
+    void add_to_sketch(uint64_t id);
+
+    void to_sketch();
+
+    void to_set();
+
+public:
+
+    explicit distinct_counter_t(bool approximate = false): approximate(approximate) {
+
+    }
+
+    void add(uint64_t id);
+
+    void merge(const distinct_counter_t& other);
+
+    [[nodiscard]] size_t count() const;
+
+    [[nodiscard]] bool is_exact() const {
+        return registers.empty();
+    }
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <atomic>
+#include "json.hpp"
+#include "versioned_lru_cache.h"
+
+/*
+    LRU cache of parsed documents, shared by all collections and bounded by the total size of the stored JSON of
+    the documents it holds. Search results are hydrated from it before falling back to the store. Writers invalidate
+    a document after persisting it; a reader that fetched a document from the store before such a write must not
+    cache its stale copy, so every invalidation advances an epoch, and documents read before it are not cached.
+*/
+class DocumentCache {
+private:
+    // stamped with the write epoch that the documents were read at
+    versioned_lru_cache_t<uint64_t, nlohmann::json, uint64_t> documents;
+
+    std::atomic<uint64_t> write_epoch{0};
+
+    DocumentCache() = default;
+
+public:
+
+    static DocumentCache& get_instance() {
+        static DocumentCache instance;
+        return instance;
+    }
+
+    DocumentCache(DocumentCache const&) = delete;
+    void operator=(DocumentCache const&) = delete;
+
+    static uint64_t get_key(uint32_t collection_id, uint32_t seq_id) {
+        return (uint64_t(collection_id) << 32) | seq_id;
+    }
+
+    // in bytes of stored JSON: 0 disables the cache
+    void set_capacity(size_t capacity_bytes) {
+        documents.set_capacity(capacity_bytes);
+    }
+
+    bool enabled() const {
+        return documents.enabled();
+    }
+
+    // to be read before the documents to be cached are fetched from the store
+    uint64_t get_write_epoch() const {
+        return write_epoch.load();
+    }
+
+    // copies the cached document into `document`
+    bool get(uint64_t key, nlohmann::json& document);
+
+    // `size` is that of the stored JSON; has no effect when any document was invalidated since `read_epoch`
+    void put(uint64_t key, const nlohmann::json& document, size_t size, uint64_t read_epoch);
+
+    void invalidate(uint64_t key);
+
+    void clear();
+
+    size_t size_bytes() const {
+        return documents.size_bytes();
+    }
+
+    size_t num_documents() const {
+        return documents.num_entries();
+    }
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <string>
+#include "sparsepp.h"
+#include "rank_bitmap.h"
+
+/*
+    Facet values of a field, dictionary encoded: every distinct value hash is given a dense 32-bit ordinal, and the
+    ordinals of each document's values are held in a column indexed by seq_id. Like `sort_column_t`, the column is
+    split into pages of consecutive IDs with a presence bitmap, and the values of the documents of a page are laid
+    out back to back (CSR), in ID order. Counting facets then needs neither a hash lookup per document nor one per
+    value: an ordinal directly indexes a counter array.
+
+    The display value of every ordinal is kept alongside its hash, so that facet counts are rendered without
+    fetching any document. Differently written values can share a hash, like "BUQU" and "bu-qu": each of them is
+    then kept as a variant of the ordinal, counted by the documents holding it, so that a value is rendered as one
+    of its documents has it and is forgotten along with the last of them. Ordinals of values that are no longer
+    held by any document are recycled, so `num_ordinals()` stays close to the number of distinct values.
+*/
+class facet_index_t {
+public:
+    static constexpr size_t PAGE_BITS = rank_bitmap_t::PAGE_BITS;
+    static constexpr size_t PAGE_SIZE = rank_bitmap_t::PAGE_SIZE;
+
+private:
+    struct page_t: public rank_bitmap_t {
+        // start of the ordinals of each document within `ordinals`, followed by the end of the last one
+        std::vector<uint32_t> offsets = {0};
+
+        std::vector<uint32_t> ordinals;
+    };
+
+    std::vector<page_t*> pages;
+    size_t num_docs = 0;
+
+    // value hash => ordinal
+    spp::sparse_hash_map<uint64_t, uint32_t> hash_ordinals;
+
+    // ordinal => value hash
+    std::vector<uint64_t> ordinal_hashes;
+
+    // ordinal => display value of its first variant
+    std::vector<std::string> ordinal_values;
+
+    // ordinal => number of values referring to it
+    std::vector<uint32_t> ordinal_refs;
+
+    std::vector<uint32_t> free_ordinals;
+
+    struct variant_t {
+        std::string value;
+        uint32_t refs;
+    };
+
+    // ordinal => every variant of the ordinal, for the few ordinals that have more than one: the slots of
+    // variants that are no longer held are reused, so that the variant indices of documents stay put
+    spp::sparse_hash_map<uint32_t, std::vector<variant_t>> ordinal_variants;
+
+    // (seq_id, position of the value in the document) => variant index, for values that are not the first variant
+    spp::sparse_hash_map<uint64_t, uint32_t> value_variants;
+
+    static uint64_t get_value_key(uint32_t seq_id, uint32_t pos) {
+        return (uint64_t(seq_id) << 32) | pos;
+    }
+
+    uint32_t acquire_ordinal(uint64_t hash, const std::string& value, uint32_t& variant);
+
+    void release_ordinal(uint32_t ordinal, uint32_t variant);
+
+public:
+
+    facet_index_t() = default;
+
+    facet_index_t(const facet_index_t&) = delete;
+
+    facet_index_t& operator=(const facet_index_t&) = delete;
+
+    ~facet_index_t();
+
+    // points `ordinals` to the value ordinals of the document, in array order, and returns their count
+    uint32_t get(uint32_t seq_id, const uint32_t*& ordinals) const {
+        const size_t page_index = seq_id >> PAGE_BITS;
+        const uint32_t offset = seq_id & (PAGE_SIZE - 1);
+
+        if(page_index >= pages.size() || pages[page_index] == nullptr || !pages[page_index]->contains(offset)) {
+            return 0;
+        }
+
+        const page_t* page = pages[page_index];
+        const size_t rank = page->rank(offset);
+
+        ordinals = page->ordinals.data() + page->offsets[rank];
+        return page->offsets[rank + 1] - page->offsets[rank];
+    }
+
+    [[nodiscard]] uint64_t get_hash(uint32_t ordinal) const {
+        return ordinal_hashes[ordinal];
+    }
+
+    // the value as written in the document holding the ordinal at the given position of its values: when it does
+    // not, the variant held by the most documents
+    [[nodiscard]] const std::string& get_value(uint32_t ordinal, uint32_t seq_id, uint32_t pos) const;
+
+    // returns false when no document has the value
+    bool get_ordinal(uint64_t hash, uint32_t& ordinal) const {
+        const auto it = hash_ordinals.find(hash);
+        if(it == hash_ordinals.end()) {
+            return false;
+        }
+
+        ordinal = it->second;
+        return true;
+    }
+
+    // ordinals are below this bound, which sizes the counter arrays indexed by ordinal
+    [[nodiscard]] size_t num_ordinals() const {
+        return ordinal_hashes.size();
+    }
+
+    [[nodiscard]] size_t num_values() const {
+        return hash_ordinals.size();
+    }
+
+    [[nodiscard]] bool contains(uint32_t seq_id) const {
+        const size_t page_index = seq_id >> PAGE_BITS;
+        return page_index < pages.size() && pages[page_index] != nullptr &&
+               pages[page_index]->contains(seq_id & (PAGE_SIZE - 1));
+    }
+
+    // `values` holds the display value of each hash; has no effect when the document is already present
+    void insert(uint32_t seq_id, const std::vector<uint64_t>& hashes, const std::vector<std::string>& values);
+
+    void erase(uint32_t seq_id);
+
+    [[nodiscard]] size_t size() const {
+        return num_docs;
+    }
+};
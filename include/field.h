@@ -9,6 +9,7 @@
 #include <sparsepp.h>
 #include <tsl/htrie_map.h>
 #include "json.hpp"
+#include "distinct_counter.h"
 
 namespace field_types {
     // first field value indexed will determine the type
@@ -563,7 +564,7 @@ struct sort_by {
     };
 
     struct eval_t {
-        filter_node_t* filter_tree_root;
+        filter_node_t* filter_tree_root = nullptr;
         uint32_t* ids = nullptr;
         uint32_t  size = 0;
     };
@@ -659,10 +660,22 @@ struct facet {
     spp::sparse_hash_map<uint64_t, std::vector<std::string>> hash_tokens;
 
     // used for faceting grouped results
-    spp::sparse_hash_map<uint64_t, spp::sparse_hash_set<uint64_t>> hash_groups;
+    spp::sparse_hash_map<uint64_t, distinct_counter_t> hash_groups;
 
     facet_stats_t stats;
 
+    // number of distinct values counted, of which `result_map` holds only the top ones
+    size_t total_values = 0;
+
+    // counts were estimated from a sample of the results
+    bool sampled = false;
+
+    // the groups of values with many of them may be counted approximately, in bounded memory
+    bool approximate_group_counts = false;
+
+    // some of the group counts are estimates
+    bool group_counts_estimated = false;
+
     explicit facet(const std::string& field_name): field_name(field_name) {
 
     }
@@ -686,48 +699,3 @@ struct facet_value_t {
     std::string highlighted;
     uint32_t count;
 };
-
-struct facet_hash_values_t {
-    uint32_t length = 0;
-    uint64_t* hashes = nullptr;
-
-    facet_hash_values_t() {
-        length = 0;
-        hashes = nullptr;
-    }
-
-    facet_hash_values_t(facet_hash_values_t&& hash_values) noexcept {
-        length = hash_values.length;
-        hashes = hash_values.hashes;
-
-        hash_values.length = 0;
-        hash_values.hashes = nullptr;
-    }
-
-    facet_hash_values_t& operator=(facet_hash_values_t&& other) noexcept {
-        if (this != &other) {
-            delete[] hashes;
-
-            hashes = other.hashes;
-            length = other.length;
-
-            other.hashes = nullptr;
-            other.length = 0;
-        }
-
-        return *this;
-    }
-
-    ~facet_hash_values_t() {
-        delete [] hashes;
-        hashes = nullptr;
-    }
-
-    uint64_t size() const {
-        return length;
-    }
-
-    uint64_t back() const {
-        return hashes[length - 1];
-    }
-};
\ No newline at end of file
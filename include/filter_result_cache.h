@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "id_bitmap.h"
+#include "versioned_lru_cache.h"
+
+/*
+    LRU cache of the IDs that the filter subtrees of an index match, keyed by the canonical form of a subtree. Every
+    entry is stamped with the generations of the fields that its subtree filters on, as they were when its IDs were
+    found: the index advances the generation of a field whenever documents are written to it or removed from it, so
+    an entry is dropped once any of its fields changes, while writes to other fields leave it be. The cache is
+    bounded by the bytes held by its entries.
+*/
+class filter_result_cache_t: public versioned_lru_cache_t<std::string, id_bitmap_t, std::vector<uint64_t>> {
+public:
+
+    using versioned_lru_cache_t::versioned_lru_cache_t;
+
+    void put(const std::string& key, const std::vector<uint64_t>& generations, std::shared_ptr<const id_bitmap_t> ids) {
+        const size_t entry_size = ENTRY_OVERHEAD + key.size() + generations.size() * sizeof(uint64_t) +
+                                  sizeof(id_bitmap_t) + ids->size_bytes();
+        versioned_lru_cache_t::put(key, generations, std::move(ids), entry_size);
+    }
+};
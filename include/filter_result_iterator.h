@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "posting.h"
+#include "ids_t.h"
+
+/*
+    Pull-based evaluation of a filter expression: leaves walk the posting lists of the ART index and the ID lists of
+    the numerical index directly, so that a text query matching only a few documents can probe a broad filter
+    instead of materializing it upfront. Leaves that can't be walked lazily hold a materialized array of IDs.
+*/
+class filter_result_iterator_t {
+public:
+    enum node_type_t {
+        IDS_LEAF,
+        POSTING_LEAF,
+        ID_LIST_LEAF,
+        AND_NODE,
+        OR_NODE
+    };
+
+private:
+    node_type_t type = IDS_LEAF;
+
+    std::vector<uint32_t> ids;
+    size_t ids_index = 0;
+
+    posting_list_t* posting_list = nullptr;
+    std::unique_ptr<posting_list_t::iterator_t> posting_it;
+
+    id_list_t* id_list = nullptr;
+    std::unique_ptr<id_list_t::iterator_t> id_list_it;
+
+    std::vector<filter_result_iterator_t> children;
+
+    bool is_valid = false;
+    uint32_t seq_id = 0;
+
+    // the iterator is always positioned on the first match >= this ID, so smaller probes are looked up instead
+    uint32_t last_probed_id = 0;
+
+    void load_leaf();
+
+    // point lookup that leaves the iterator where it is
+    [[nodiscard]] bool lookup(uint32_t id) const;
+
+    void advance_and();
+
+    void advance_or();
+
+public:
+
+    // empty leaf
+    filter_result_iterator_t() = default;
+
+    // sorted, de-duplicated IDs
+    static filter_result_iterator_t ids_leaf(std::vector<uint32_t>&& ids);
+
+    // leaf over a raw `posting_t` object
+    static filter_result_iterator_t posting_leaf(void* obj);
+
+    // leaf over a raw `ids_t` object
+    static filter_result_iterator_t id_list_leaf(void* obj);
+
+    static filter_result_iterator_t and_node(std::vector<filter_result_iterator_t>&& children);
+
+    static filter_result_iterator_t or_node(std::vector<filter_result_iterator_t>&& children);
+
+    [[nodiscard]] bool valid() const {
+        return is_valid;
+    }
+
+    [[nodiscard]] uint32_t id() const {
+        return seq_id;
+    }
+
+    [[nodiscard]] node_type_t get_type() const {
+        return type;
+    }
+
+    void next();
+
+    // moves to the first match >= `id`: has no effect when already there
+    void skip_to(uint32_t id);
+
+    void reset();
+
+    // ascending probes advance the iterator, while smaller ones are looked up without rewinding it
+    bool contains(uint32_t id);
+
+    // whether any of the documents of the raw `posting_t` object matches
+    bool contains_atleast_one(const void* obj);
+
+    // upper bound of the number of matches, without walking the tree
+    [[nodiscard]] size_t approx_cardinality() const;
+};
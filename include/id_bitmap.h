@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/*
+    Compressed set of document IDs, used for holding filter results.
+    IDs are partitioned into chunks of 2^16 by their upper 16 bits. Each chunk is stored either as a sorted array
+    of the lower 16 bits (sparse chunks) or as a 2^16 bit bitmap (dense chunks), based on the chunk's cardinality.
+*/
+class id_bitmap_t {
+public:
+    // a chunk with more IDs than this is stored as a bitmap (at 4096 both forms need 8 KB)
+    static constexpr size_t ARRAY_CONTAINER_MAX = 4096;
+    static constexpr size_t BITMAP_WORDS = (1 << 16) / 64;
+
+    struct container_t {
+        uint16_t key = 0;
+        uint32_t cardinality = 0;
+
+        // only one of these is populated at any time
+        std::vector<uint16_t> array;
+        std::vector<uint64_t> bitmap;
+
+        [[nodiscard]] bool is_bitmap() const {
+            return !bitmap.empty();
+        }
+
+        [[nodiscard]] bool contains(uint16_t low) const;
+
+        // returns true if the value was not already present
+        bool add(uint16_t low);
+
+        void to_bitmap();
+
+        void to_array();
+
+        // converts to the form appropriate for the current cardinality
+        void optimize();
+    };
+
+    class iterator_t {
+    private:
+        const id_bitmap_t* bitmap;
+        size_t container_index = 0;
+
+        // position within an array container or bit index within a bitmap container
+        uint32_t pos = 0;
+
+        void seek_valid();
+
+    public:
+        explicit iterator_t(const id_bitmap_t* bitmap);
+        [[nodiscard]] bool valid() const;
+        void next();
+        void skip_to(uint32_t id);
+        [[nodiscard]] uint32_t id() const;
+    };
+
+private:
+    std::vector<container_t> containers;
+    size_t num_ids = 0;
+
+    [[nodiscard]] size_t find_container(uint16_t key) const;
+
+public:
+
+    id_bitmap_t() = default;
+
+    // builds from a sorted, de-duplicated array of IDs
+    id_bitmap_t(const uint32_t* sorted_ids, size_t length);
+
+    // IDs are expected to be added mostly in ascending order
+    void add(uint32_t id);
+
+    [[nodiscard]] bool contains(uint32_t id) const;
+
+    [[nodiscard]] size_t cardinality() const {
+        return num_ids;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return num_ids == 0;
+    }
+
+    [[nodiscard]] size_t num_containers() const {
+        return containers.size();
+    }
+
+    // bytes held by the containers
+    [[nodiscard]] size_t size_bytes() const;
+
+    [[nodiscard]] const std::vector<container_t>& get_containers() const {
+        return containers;
+    }
+
+    // returns the ID at the given position in sorted order (rank must be < cardinality)
+    [[nodiscard]] uint32_t select(size_t rank) const;
+
+    // writes all IDs in ascending order to `out` which must hold atleast `cardinality()` elements
+    void uncompress(uint32_t* out) const;
+
+    [[nodiscard]] uint32_t* uncompress() const;
+
+    [[nodiscard]] iterator_t new_iterator() const;
+
+    void clear();
+
+    static void intersect(const id_bitmap_t& a, const id_bitmap_t& b, id_bitmap_t& out);
+
+    static void merge(const id_bitmap_t& a, const id_bitmap_t& b, id_bitmap_t& out);
+
+    // IDs in `src` that are not present in `filter`
+    static void exclude(const id_bitmap_t& src, const id_bitmap_t& filter, id_bitmap_t& out);
+};
@@ -3,8 +3,7 @@
 #include <map>
 #include <unordered_map>
 #include "sorted_array.h"
-
-typedef uint32_t last_id_t;
+#include "block_directory.h"
 
 /*
     Compressed chain of blocks that store the document IDs and offsets of a given token.
@@ -37,7 +36,7 @@ public:
         int64_t curr_index;
 
         block_t* end_block;
-        std::map<last_id_t, block_t*>* id_block_map;
+        block_directory_t<block_t>* id_block_map;
 
         bool reverse;
 
@@ -45,7 +44,7 @@ public:
         // uncompressed data structure for performance
         uint32_t* ids = nullptr;
 
-        explicit iterator_t(block_t* start, block_t* end, std::map<last_id_t, block_t*>* id_block_map, bool reverse);
+        explicit iterator_t(block_t* start, block_t* end, block_directory_t<block_t>* id_block_map, bool reverse);
         iterator_t(iterator_t&& rhs) noexcept;
         ~iterator_t();
         [[nodiscard]] bool valid() const;
@@ -86,8 +85,7 @@ private:
 
     // keeps track of the *last* ID in each block and is used for partial random access
     // e.g. 0..[9], 10..[19], 20..[29]
-    // MUST be ordered
-    std::map<last_id_t, block_t*> id_block_map;
+    block_directory_t<block_t> id_block_map;
 
     static bool at_end(const std::vector<id_list_t::iterator_t>& its);
     static bool at_end2(const std::vector<id_list_t::iterator_t>& its);
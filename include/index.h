@@ -4,8 +4,11 @@
 #include <unordered_map>
 #include <vector>
 #include <mutex>
+#include <atomic>
 #include <shared_mutex>
 #include <condition_variable>
+#include <thread>
+#include <memory>
 #include <art.h>
 #include <number.h>
 #include <sparsepp.h>
@@ -25,14 +28,36 @@
 #include "tsl/htrie_set.h"
 #include <tsl/htrie_map.h>
 #include "id_list.h"
+#include "id_bitmap.h"
+#include "sort_column.h"
+#include "facet_index.h"
+#include "typo_candidate_cache.h"
+#include "filter_result_cache.h"
+#include "filter_result_iterator.h"
 #include "synonym_index.h"
 #include "override.h"
 #include "vector_query_ops.h"
 #include "hnswlib/hnswlib.h"
 
-static constexpr size_t ARRAY_FACET_DIM = 4;
-using facet_map_t = spp::sparse_hash_map<uint32_t, facet_hash_values_t>;
-using array_mapped_facet_t = std::array<facet_map_t*, ARRAY_FACET_DIM>;
+// facet counting uses an array indexed by value ordinal, unless the field has this many times more distinct
+// values than there are results to count
+static constexpr size_t FACET_DENSE_COUNT_RATIO = 4;
+
+// the merge of facet counts across result batches is split into ranges of value ordinals, one per this many values
+// counted by the batches
+static constexpr size_t FACET_MERGE_PARTITION_MIN_ORDINALS = 16384;
+
+// number of distinct sets of group_by fields whose group keys are held in a column
+static constexpr size_t MAX_GROUP_KEY_COLUMNS = 4;
+
+// a group key column that no search has read for this long is dropped on the next write, which would update it
+static constexpr int64_t GROUP_KEY_COLUMN_IDLE_S = 600;
+
+// counts of the facet values of a batch of results, in ascending order of value ordinal
+using facet_ordinal_counts_t = std::vector<std::pair<uint32_t, facet_count_t>>;
+
+// filter subtree => canonical form of the subtree and the generations of its fields, used as its filter cache entry
+using filter_cache_keys_t = spp::sparse_hash_map<const filter_node_t*, std::pair<std::string, std::vector<uint64_t>>>;
 
 static constexpr size_t ARRAY_INFIX_DIM = 4;
 using array_mapped_infix_t = std::vector<tsl::htrie_set<char>*>;
@@ -127,6 +152,8 @@ struct search_args {
     const size_t max_extra_prefix;
     const size_t max_extra_suffix;
     const size_t facet_query_num_typos;
+    const size_t facet_sample_percent;
+    const size_t facet_sample_threshold;
     const bool filter_curated_hits;
     const enable_t split_join_tokens;
     tsl::htrie_map<char, token_leaf> qtoken_set;
@@ -142,7 +169,7 @@ struct search_args {
 
     search_args(std::vector<query_tokens_t> field_query_tokens, std::vector<search_field_t> search_fields,
                 const text_match_type_t match_type,
-                filter_node_t* filter_tree_root, std::vector<facet>& facets,
+                const filter_node_t* filter_tree_root, std::vector<facet>& facets,
                 std::vector<std::pair<uint32_t, uint32_t>>& included_ids, std::vector<uint32_t> excluded_ids,
                 std::vector<sort_by>& sort_fields_std, facet_query_t facet_query, const std::vector<uint32_t>& num_typos,
                 size_t max_facet_values, size_t max_hits, size_t per_page, size_t page, token_ordering token_order,
@@ -153,6 +180,7 @@ struct search_args {
                 size_t concurrency, size_t search_cutoff_ms,
                 size_t min_len_1typo, size_t min_len_2typo, size_t max_candidates, const std::vector<enable_t>& infixes,
                 const size_t max_extra_prefix, const size_t max_extra_suffix, const size_t facet_query_num_typos,
+                const size_t facet_sample_percent, const size_t facet_sample_threshold,
                 const bool filter_curated_hits, const enable_t split_join_tokens, vector_query_t& vector_query) :
             field_query_tokens(field_query_tokens),
             search_fields(search_fields), match_type(match_type), filter_tree_root(filter_tree_root), facets(facets),
@@ -166,7 +194,8 @@ struct search_args {
             search_cutoff_ms(search_cutoff_ms),
             min_len_1typo(min_len_1typo), min_len_2typo(min_len_2typo), max_candidates(max_candidates),
             infixes(infixes), max_extra_prefix(max_extra_prefix), max_extra_suffix(max_extra_suffix),
-            facet_query_num_typos(facet_query_num_typos), filter_curated_hits(filter_curated_hits),
+            facet_query_num_typos(facet_query_num_typos), facet_sample_percent(facet_sample_percent),
+            facet_sample_threshold(facet_sample_threshold), filter_curated_hits(filter_curated_hits),
             split_join_tokens(split_join_tokens), vector_query(vector_query) {
 
         const size_t topster_size = std::max((size_t)1, max_hits);  // needs to be atleast 1 since scoring is mandatory
@@ -198,6 +227,9 @@ enum class DIRTY_VALUES {
 struct offsets_facet_hashes_t {
     std::unordered_map<std::string, std::vector<uint32_t>> offsets;
     std::vector<uint64_t> facet_hashes;
+
+    // value of each facet hash, as displayed in facet counts
+    std::vector<std::string> facet_values;
 };
 
 struct index_record {
@@ -241,19 +273,17 @@ struct index_record {
 };
 
 class VectorFilterFunctor: public hnswlib::FilterFunctor {
-    const uint32_t* filter_ids = nullptr;
-    const uint32_t filter_ids_length = 0;
+    const id_bitmap_t* filter_bitmap = nullptr;
 
 public:
-    explicit VectorFilterFunctor(const uint32_t* filter_ids, const uint32_t filter_ids_length) :
-            filter_ids(filter_ids), filter_ids_length(filter_ids_length) {}
+    explicit VectorFilterFunctor(const id_bitmap_t* filter_bitmap) : filter_bitmap(filter_bitmap) {}
 
     bool operator()(unsigned int id) {
-        if(filter_ids_length == 0) {
+        if(filter_bitmap == nullptr) {
             return true;
         }
 
-        return std::binary_search(filter_ids, filter_ids + filter_ids_length, id);
+        return filter_bitmap->contains(id);
     }
 };
 
@@ -308,6 +338,26 @@ private:
 
     spp::sparse_hash_map<std::string, art_tree*> search_index;
 
+    // string field => generation of its tree, advanced whenever the tree or its postings change
+    spp::sparse_hash_map<std::string, uint64_t> search_index_generations;
+
+    // leaves found by fuzzy searches of the trees in `search_index`, valid while the generation of the tree holds
+    mutable typo_candidate_cache_t typo_candidate_cache{TYPO_CANDIDATE_CACHE_SIZE};
+
+    // filterable field => generation of its filter index, advanced whenever documents are written to or removed from it
+    spp::sparse_hash_map<std::string, uint64_t> filter_generations;
+
+    // advanced whenever documents are added or removed, which changes what `!=` filters match
+    uint64_t seq_ids_generation = 0;
+
+    // bytes held by the filter result cache of each index created from here on
+    static std::atomic<size_t> filter_result_cache_size;
+
+    static std::atomic<uint64_t> filter_result_cache_min_cost_us;
+
+    // IDs matched by filter subtrees, valid while the generations of their fields hold
+    mutable filter_result_cache_t filter_result_cache{filter_result_cache_size.load()};
+
     spp::sparse_hash_map<std::string, num_tree_t*> numerical_index;
 
     spp::sparse_hash_map<std::string, spp::sparse_hash_map<std::string, std::vector<uint32_t>>*> geopoint_index;
@@ -315,11 +365,11 @@ private:
     // geo_array_field => (seq_id => values) used for exact filtering of geo array records
     spp::sparse_hash_map<std::string, spp::sparse_hash_map<uint32_t, int64_t*>*> geo_array_index;
 
-    // facet_field => (seq_id => values)
-    spp::sparse_hash_map<std::string, array_mapped_facet_t> facet_index_v3;
+    // facet_field => (seq_id => value ordinals)
+    spp::sparse_hash_map<std::string, facet_index_t*> facet_index_v4;
 
     // sort_field => (seq_id => value)
-    spp::sparse_hash_map<std::string, spp::sparse_hash_map<uint32_t, int64_t>*> sort_index;
+    spp::sparse_hash_map<std::string, sort_column_t*> sort_index;
 
     // str_sort_field => adi_tree_t
     spp::sparse_hash_map<std::string, adi_tree_t*> str_sort_index;
@@ -327,12 +377,41 @@ private:
     // infix field => value
     spp::sparse_hash_map<std::string, array_mapped_infix_t> infix_index;
 
+    struct group_key_column_t {
+        std::vector<std::string> group_by_fields;
+
+        // seq_id => distinct ID
+        sort_column_t distinct_ids;
+
+        // steady clock seconds of the last search grouped by the fields
+        int64_t last_used_s = 0;
+    };
+
+    // built in the background on the first search grouped by a set of fields, and kept up to date on indexing
+    // thereafter: searches hold on to the column they read, so a column can be replaced while they run
+    mutable std::array<std::shared_ptr<group_key_column_t>, MAX_GROUP_KEY_COLUMNS> group_key_columns;
+
+    // guards the slots above, the builder and the last used times of the columns
+    mutable std::mutex group_key_columns_mutex;
+
+    // slots in use, so that writes to a collection that is not grouped on need not take the locks
+    mutable std::atomic<size_t> num_group_key_columns{0};
+
+    // builds one column at a time, under a shared lock
+    mutable std::thread group_key_column_builder;
+    mutable std::atomic<bool> group_key_column_building{false};
+
     // vector field => vector index
     spp::sparse_hash_map<std::string, hnsw_index_t*> vector_index;
 
     // this is used for wildcard queries
     id_list_t* seq_ids;
 
+    // Posting list blocks hold the max default sorting field value of their documents as of when the tokens were
+    // indexed. An update that changes only that value does not touch the postings of unchanged fields, so such
+    // updated values are tracked per document here, and the bounds of the blocks holding them are raised to these.
+    spp::sparse_hash_map<uint32_t, int64_t> updated_points;
+
     std::vector<char> symbols_to_index;
 
     std::vector<char> token_separators;
@@ -341,11 +420,11 @@ private:
 
     // used as sentinels
 
-    static spp::sparse_hash_map<uint32_t, int64_t> text_match_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t> seq_id_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t> eval_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t> geo_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t> str_sentinel_value;
+    static sort_column_t text_match_sentinel_value;
+    static sort_column_t seq_id_sentinel_value;
+    static sort_column_t eval_sentinel_value;
+    static sort_column_t geo_sentinel_value;
+    static sort_column_t str_sentinel_value;
 
     // Internal utility functions
 
@@ -364,10 +443,21 @@ private:
 
     void log_leaves(int cost, const std::string &token, const std::vector<art_leaf *> &leaves) const;
 
+    // counts the facets of `results_size` results: the IDs of `result_ids`, or when `result_bitmap` is given, its IDs
+    // from `result_bitmap_start_id` on
     void do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
                    const std::vector<facet_info_t>& facet_infos,
-                   size_t group_limit, const std::vector<std::string>& group_by_fields,
-                   const uint32_t* result_ids, size_t results_size) const;
+                   size_t group_limit, const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
+                   const uint32_t* result_ids, size_t results_size,
+                   std::vector<facet_ordinal_counts_t>& ordinal_counts,
+                   size_t sample_percent = 100,
+                   const id_bitmap_t* result_bitmap = nullptr, uint32_t result_bitmap_start_id = 0) const;
+
+    // sums the facet counts of the batches into `facets`, keeping only the top `max_facet_values` of every field
+    void merge_facets(std::vector<facet>& facets, const std::vector<std::vector<facet>>& facet_batches,
+                      const std::vector<std::vector<facet_ordinal_counts_t>>& batch_ordinal_counts,
+                      const std::vector<const std::vector<facet_info_t>*>& batch_facet_infos,
+                      size_t group_limit, size_t max_facet_values, size_t concurrency) const;
 
     bool static_filter_query_eval(const override_t* override, std::vector<std::string>& tokens,
                                   filter_node_t*& filter_tree_root) const;
@@ -400,7 +490,7 @@ private:
                       uint32_t** all_result_ids, size_t & all_result_ids_len,
                       size_t& field_num_results,
                       size_t group_limit,
-                      const std::vector<std::string>& group_by_fields,
+                      const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
                       bool prioritize_exact_match,
                       size_t concurrency,
                       std::set<uint64>& query_hashes,
@@ -417,6 +507,8 @@ private:
                                const text_match_type_t match_type,
                                const std::vector<search_field_t>& the_fields,
                                const uint32_t* filter_ids, size_t filter_ids_length,
+                               const id_bitmap_t* filter_bitmap,
+                               filter_result_iterator_t* filter_iterator,
                                const uint32_t* exclude_token_ids, size_t exclude_token_ids_size,
                                const std::vector<sort_by>& sort_fields,
                                std::vector<tok_candidates>& token_candidates_vec,
@@ -427,7 +519,7 @@ private:
                                uint32_t*& all_result_ids, size_t& all_result_ids_len,
                                const size_t typo_tokens_threshold,
                                const size_t group_limit,
-                               const std::vector<std::string>& group_by_fields,
+                               const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
                                const std::vector<token_t>& query_tokens,
                                const std::vector<uint32_t>& num_typos,
                                const std::vector<bool>& prefixes,
@@ -437,8 +529,9 @@ private:
                                const size_t max_candidates,
                                int syn_orig_num_tokens,
                                const int* sort_order,
-                               std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                               std::array<sort_column_t*, 3>& field_values,
                                const std::vector<size_t>& geopoint_indices,
+                               const std::string& default_sorting_field,
                                std::set<uint64>& query_hashes,
                                std::vector<uint32_t>& id_buff) const;
 
@@ -454,7 +547,7 @@ private:
                            size_t & all_result_ids_len,
                            size_t& field_num_results,
                            const size_t typo_tokens_threshold,
-                           const size_t group_limit, const std::vector<std::string>& group_by_fields,
+                           const size_t group_limit, const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
                            const std::vector<token_t>& query_tokens,
                            bool prioritize_exact_match,
                            bool exhaustive_search,
@@ -478,6 +571,33 @@ private:
                           filter_node_t const* const root,
                           const bool enable_short_circuit) const;
 
+    void recursive_filter(id_bitmap_t& filter_bitmap,
+                          filter_node_t const* const root,
+                          const bool enable_short_circuit) const;
+
+    // subtrees with an entry in `cache_keys` are looked up in the filter result cache, and their results are cached
+    // when they took long to find
+    void evaluate_filter_tree(id_bitmap_t& filter_bitmap,
+                              filter_node_t const* const root,
+                              const bool enable_short_circuit,
+                              const filter_cache_keys_t* cache_keys) const;
+
+    // the keys of the subtrees of `root` whose results can be cached are added to `cache_keys`, and false is returned
+    // when those of `root` itself can't be
+    bool get_filter_cache_key(const filter_node_t* root, std::string& key, std::vector<uint64_t>& generations,
+                              filter_cache_keys_t& cache_keys) const;
+
+    // returns false when the filter has a leaf that can't be evaluated lazily
+    bool new_lazy_filter_iterator(const filter_node_t* root, filter_result_iterator_t& filter_iterator) const;
+
+    // returns true when the filter is broad enough, relative to the text query, to be probed lazily
+    bool plan_lazy_filter(filter_node_t const* const filter_tree_root,
+                          const std::vector<search_field_t>& the_fields, const size_t num_search_fields,
+                          const std::vector<token_t>& query_tokens, const std::vector<uint32_t>& num_typos,
+                          const std::vector<bool>& prefixes, const token_ordering token_order,
+                          const size_t min_len_1typo, const size_t min_len_2typo,
+                          filter_result_iterator_t& filter_iterator) const;
+
     void insert_doc(const int64_t score, art_tree *t, uint32_t seq_id,
                     const std::unordered_map<std::string, std::vector<uint32_t>> &token_to_offsets) const;
 
@@ -553,6 +673,35 @@ public:
     enum {NUM_CANDIDATES_DEFAULT_MIN = 4};
     enum {NUM_CANDIDATES_DEFAULT_MAX = 10};
 
+    // filters matching atleast 1/N of all documents are treated as dense during candidate generation
+    enum {DENSE_FILTER_RATIO = 8};
+
+    // filters matching atleast N times as many documents as the text query are probed instead of materialized
+    enum {LAZY_FILTER_RATIO = 64};
+
+    // query tokens expanding to more than these many candidates of a typo cost are too costly to estimate
+    enum {LAZY_FILTER_MAX_EXPANSION = 64};
+
+    // a wildcard query sorted on a numerical field walks its values in order when that is expected to visit
+    // atmost 1/N of the filtered documents
+    enum {ORDERED_WILDCARD_SCAN_RATIO = 8};
+
+    // intersections whose shortest posting list has atleast these many IDs are split across the thread pool
+    enum {PARALLEL_INTERSECTION_MIN_IDS = 65536};
+
+    // leaves of the typo candidates of a query token that are looked at, across the nodes that match it
+    enum {MAX_TYPO_CANDIDATE_LEAVES = 100000};
+
+    // bytes held by the typo candidate cache of an index
+    enum {TYPO_CANDIDATE_CACHE_SIZE = 4 * 1024 * 1024};
+
+    // bytes held by the filter result cache of an index, unless configured otherwise
+    enum {FILTER_RESULT_CACHE_SIZE = 32 * 1024 * 1024};
+
+    // microseconds that a filter subtree must take to evaluate for its results to be cached, unless configured
+    // otherwise: cheaper ones are recomputed rather than holding on to the cache
+    enum {FILTER_RESULT_CACHE_MIN_COST_US = 100};
+
     // If the number of results found is less than this threshold, Typesense will attempt to drop the tokens
     // in the query that have the least individual hits one by one until enough results are found.
     static const int DROP_TOKENS_THRESHOLD = 1;
@@ -588,10 +737,10 @@ public:
                        Topster *topster, const std::vector<art_leaf *> &query_suggestion,
                        spp::sparse_hash_set<uint64_t> &groups_processed,
                        const uint32_t seq_id, const int sort_order[3],
-                       std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values,
+                       std::array<sort_column_t*, 3> field_values,
                        const std::vector<size_t>& geopoint_indices,
                        const size_t group_limit,
-                       const std::vector<std::string> &group_by_fields, uint32_t token_bits,
+                       const std::vector<std::string> &group_by_fields, const group_key_column_t* group_key_column, uint32_t token_bits,
                        bool prioritize_exact_match,
                        bool single_exact_query_token,
                        int syn_orig_num_tokens,
@@ -614,7 +763,31 @@ public:
 
     static float int64_t_to_float(int64_t n);
 
-    uint64_t get_distinct_id(const std::vector<std::string>& group_by_fields, const uint32_t seq_id) const;
+    uint64_t get_distinct_id(const group_key_column_t* group_key_column,
+                             const std::vector<std::string>& group_by_fields, const uint32_t seq_id) const;
+
+    uint64_t compute_distinct_id(const std::vector<std::string>& group_by_fields, const uint32_t seq_id) const;
+
+    std::shared_ptr<const group_key_column_t> get_group_key_column(const std::vector<std::string>& group_by_fields) const;
+
+    void build_group_key_column(const std::vector<std::string>& group_by_fields) const;
+
+    void update_group_key_columns(const std::vector<index_record>& iter_batch);
+
+    void erase_group_key_columns(const std::vector<field>& fields);
+
+    void clear_group_key_columns();
+
+    void advance_search_index_generation(const std::string& field_name);
+
+    void advance_filter_generation(const std::string& field_name);
+
+    // finds atmost `num_leaves` leaves of the token, in the order of `art_fuzzy_search()`
+    void find_typo_candidates(const std::string& field_name, const std::string& token, uint32_t cost,
+                              bool prefix_search, token_ordering token_order, size_t num_leaves,
+                              const uint32_t* filter_ids, size_t filter_ids_length,
+                              filter_result_iterator_t* filter_iterator,
+                              const std::set<std::string>& exclude_leaves, std::vector<art_leaf*>& leaves) const;
 
     static void compute_token_offsets_facets(index_record& record,
                                              const tsl::htrie_map<char, field>& search_schema,
@@ -654,6 +827,8 @@ public:
                 size_t concurrency, size_t search_cutoff_ms, size_t min_len_1typo, size_t min_len_2typo,
                 size_t max_candidates, const std::vector<enable_t>& infixes, const size_t max_extra_prefix,
                 const size_t max_extra_suffix, const size_t facet_query_num_typos,
+                const size_t max_facet_values, const size_t facet_sample_percent,
+                const size_t facet_sample_threshold,
                 const bool filter_curated_hits, enable_t split_join_tokens,
                 const vector_query_t& vector_query) const;
 
@@ -700,6 +875,12 @@ public:
 
     void refresh_schemas(const std::vector<field>& new_fields, const std::vector<field>& del_fields);
 
+    static void set_filter_result_cache_size(size_t size_bytes);
+
+    static void set_filter_result_cache_min_cost_us(uint64_t min_cost_us);
+
+    size_t get_filter_result_cache_size_bytes() const;
+
     // the following methods are not synchronized because their parent calls are synchronized or they are const/static
 
     static Option<uint32_t> validate_index_in_memory(nlohmann::json &document, uint32_t seq_id,
@@ -714,25 +895,25 @@ public:
                          const std::vector<sort_by>& sort_fields, Topster* topster, Topster* curated_topster,
                          spp::sparse_hash_set<uint64_t>& groups_processed,
                          std::vector<std::vector<art_leaf*>>& searched_queries, const size_t group_limit,
-                         const std::vector<std::string>& group_by_fields, const std::set<uint32_t>& curated_ids,
+                         const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column, const std::set<uint32_t>& curated_ids,
                          const std::vector<uint32_t>& curated_ids_sorted, const uint32_t* exclude_token_ids,
-                         size_t exclude_token_ids_size,
-                         uint32_t*& all_result_ids, size_t& all_result_ids_len, const uint32_t* filter_ids,
-                         uint32_t filter_ids_length, const size_t concurrency,
+                         size_t exclude_token_ids_size, const id_bitmap_t& filter_bitmap, const size_t concurrency,
                          const int* sort_order,
-                         std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                         std::array<sort_column_t*, 3>& field_values,
                          const std::vector<size_t>& geopoint_indices) const;
 
+    // returns false, without adding any result, when the sort does not allow the walk or it would cost too much
+    bool search_wildcard_ordered(const std::vector<sort_by>& sort_fields, const int* sort_order,
+                                 const std::array<sort_column_t*, 3>& field_values, Topster* topster,
+                                 std::vector<std::vector<art_leaf*>>& searched_queries, const size_t group_limit,
+                                 const id_bitmap_t& filter_bitmap) const;
+
     void search_infix(const std::string& query, const std::string& field_name, std::vector<uint32_t>& ids,
                       size_t max_extra_prefix, size_t max_extra_suffix) const;
 
-    void curate_filtered_ids(filter_node_t const* const& filter_tree_root, const std::set<uint32_t>& curated_ids,
-                             const uint32_t* exclude_token_ids, size_t exclude_token_ids_size, uint32_t*& filter_ids,
-                             uint32_t& filter_ids_length, const std::vector<uint32_t>& curated_ids_sorted) const;
-
     void populate_sort_mapping(int* sort_order, std::vector<size_t>& geopoint_indices,
                                std::vector<sort_by>& sort_fields_std,
-                               std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values) const;
+                               std::array<sort_column_t*, 3>& field_values) const;
 
     static void remove_matched_tokens(std::vector<std::string>& tokens, const std::set<std::string>& rule_token_set) ;
 
@@ -748,6 +929,12 @@ public:
 
     size_t num_seq_ids() const;
 
+    // resolves the first `num_values` facet counts to their values, as written in their representative documents:
+    // `found` is false for hashes that no document holds
+    void get_facet_values(const std::string& field_name,
+                          const std::vector<std::pair<uint64_t, facet_count_t>>& facet_hash_counts,
+                          size_t num_values, std::vector<std::string>& values, std::vector<bool>& found) const;
+
     void handle_exclusion(const size_t num_search_fields, std::vector<query_tokens_t>& field_query_tokens,
                           const std::vector<search_field_t>& search_fields, uint32_t*& exclude_token_ids,
                           size_t& exclude_token_ids_size) const;
@@ -756,11 +943,11 @@ public:
                          const std::vector<enable_t>& infixes,
                          const std::vector<sort_by>& sort_fields,
                          std::vector<std::vector<art_leaf*>>& searched_queries, const size_t group_limit,
-                         const std::vector<std::string>& group_by_fields, const size_t max_extra_prefix,
+                         const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column, const size_t max_extra_prefix,
                          const size_t max_extra_suffix, const std::vector<token_t>& query_tokens, Topster* actual_topster,
                          const uint32_t *filter_ids, size_t filter_ids_length,
                          const int sort_order[3],
-                         std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values,
+                         std::array<sort_column_t*, 3> field_values,
                          const std::vector<size_t>& geopoint_indices,
                          const std::vector<uint32_t>& curated_ids_sorted,
                          uint32_t*& all_result_ids, size_t& all_result_ids_len,
@@ -773,7 +960,7 @@ public:
                            const std::vector<sort_by>& sort_fields_std, Topster* curated_topster,
                            const token_ordering& token_order,
                            const size_t typo_tokens_threshold, const size_t group_limit,
-                           const std::vector<std::string>& group_by_fields, bool prioritize_exact_match,
+                           const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column, bool prioritize_exact_match,
                            const bool prioritize_token_position,
                            const bool exhaustive_search, const size_t concurrency,
                            const std::vector<bool>& prefixes,
@@ -787,11 +974,14 @@ public:
                            spp::sparse_hash_set<uint64_t>& groups_processed,
                            std::vector<std::vector<art_leaf*>>& searched_queries,
                            uint32_t*& all_result_ids, size_t& all_result_ids_len,
-                           const uint32_t* filter_ids, uint32_t filter_ids_length, 
+                           const uint32_t* filter_ids, uint32_t filter_ids_length,
+                           const id_bitmap_t* filter_bitmap,
+                           filter_result_iterator_t* filter_iterator,
                            std::set<uint64>& query_hashes,
                            const int* sort_order,
-                           std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                           std::array<sort_column_t*, 3>& field_values,
                            const std::vector<size_t>& geopoint_indices,
+                           const std::string& default_sorting_field,
                            tsl::htrie_map<char, token_leaf>& qtoken_set) const;
 
     void do_phrase_search(const size_t num_search_fields, const std::vector<search_field_t>& search_fields,
@@ -805,6 +995,8 @@ public:
                              const uint32_t* exclude_token_ids,
                              size_t exclude_token_ids_size,
                              const uint32_t* filter_ids, size_t filter_ids_length,
+                             const id_bitmap_t* filter_bitmap,
+                             filter_result_iterator_t* filter_iterator,
                              const std::vector<uint32_t>& curated_ids,
                              const std::vector<sort_by>& sort_fields,
                              const std::vector<uint32_t>& num_typos,
@@ -812,7 +1004,7 @@ public:
                              tsl::htrie_map<char, token_leaf>& qtoken_set,
                              Topster* topster, spp::sparse_hash_set<uint64_t>& groups_processed,
                              uint32_t*& all_result_ids, size_t& all_result_ids_len,
-                             const size_t group_limit, const std::vector<std::string>& group_by_fields,
+                             const size_t group_limit, const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
                              bool prioritize_exact_match,
                              const bool prioritize_token_position,
                              std::set<uint64>& query_hashes,
@@ -825,14 +1017,17 @@ public:
                              size_t min_len_2typo,
                              int syn_orig_num_tokens,
                              const int* sort_order,
-                             std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
-                             const std::vector<size_t>& geopoint_indices) const;
+                             std::array<sort_column_t*, 3>& field_values,
+                             const std::vector<size_t>& geopoint_indices,
+                             const std::string& default_sorting_field) const;
 
     void find_across_fields(const token_t& previous_token,
                             const std::string& previous_token_str,
                             const std::vector<search_field_t>& the_fields,
                             const size_t num_search_fields,
                             const uint32_t* filter_ids, uint32_t filter_ids_length,
+                            const id_bitmap_t* filter_bitmap,
+                            filter_result_iterator_t* filter_iterator,
                             const uint32_t* exclude_token_ids,
                             size_t exclude_token_ids_size,
                             std::vector<uint32_t>& prev_token_doc_ids,
@@ -850,17 +1045,20 @@ public:
                               std::vector<std::vector<art_leaf*>>& searched_queries,
                               tsl::htrie_map<char, token_leaf>& qtoken_set,
                               const size_t group_limit,
-                              const std::vector<std::string>& group_by_fields,
+                              const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
                               bool prioritize_exact_match,
                               const bool search_all_candidates,
                               const uint32_t* filter_ids, uint32_t filter_ids_length,
+                              const id_bitmap_t* filter_bitmap,
+                              filter_result_iterator_t* filter_iterator,
                               const uint32_t total_cost,
                               const int syn_orig_num_tokens,
                               const uint32_t* exclude_token_ids,
                               size_t exclude_token_ids_size,
                               const int* sort_order,
-                              std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                              std::array<sort_column_t*, 3>& field_values,
                               const std::vector<size_t>& geopoint_indices,
+                              const std::string& default_sorting_field,
                               std::vector<uint32_t>& id_buff,
                               uint32_t*& all_result_ids,
                               size_t& all_result_ids_len) const;
@@ -894,7 +1092,7 @@ public:
                                   std::vector<const override_t*>& matched_dynamic_overrides) const;
 
     void compute_sort_scores(const std::vector<sort_by>& sort_fields, const int* sort_order,
-                             std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values,
+                             std::array<sort_column_t*, 3> field_values,
                              const std::vector<size_t>& geopoint_indices, uint32_t seq_id,
                              size_t filter_index,
                              int64_t max_field_match_score,
@@ -904,8 +1102,8 @@ public:
     void
     process_curated_ids(const std::vector<std::pair<uint32_t, uint32_t>>& included_ids,
                         const std::vector<uint32_t>& excluded_ids,
-                        const size_t group_limit, const bool filter_curated_hits, const uint32_t* filter_ids,
-                        uint32_t filter_ids_length, std::set<uint32_t>& curated_ids,
+                        const size_t group_limit, const bool filter_curated_hits, const id_bitmap_t* filter_bitmap,
+                        std::set<uint32_t>& curated_ids,
                         std::map<size_t, std::map<size_t, uint32_t>>& included_ids_map,
                         std::vector<uint32_t>& included_ids_vec) const;
 };
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <for.h>
+
+/*
+    Integer codecs behind `sorted_array` and `array`, selected at compile time.
+
+    By default, both use libfor's frame-of-reference encoding, which supports cheap random access. Building with
+    `POSTING_SIMD_CODEC` switches sorted arrays to BP128 (deltas bit-packed in blocks of 128 values) and unsorted
+    arrays to StreamVByte: both are more compact and decode faster in bulk, but trade away O(1) random access.
+
+    All codecs share the same static interface. Buffers handed to the `compress_*` and `append_*` methods must be
+    atleast as large as reported by the matching `size_*` and `append_size_*` methods.
+*/
+
+#define METADATA_OVERHEAD 5
+
+static inline uint32_t codec_required_bits(const uint32_t v) {
+    return (uint32_t) (v == 0 ? 0 : 32 - __builtin_clz(v));
+}
+
+struct for_codec_t {
+    static uint32_t size_sorted(const uint32_t* values, uint32_t length) {
+        uint32_t m = length != 0 ? values[0] : 0;
+        uint32_t M = length > 1 ? values[length-1] : m;
+        return METADATA_OVERHEAD + 4 + for_compressed_size_bits(length, codec_required_bits(M - m));
+    }
+
+    static uint32_t size_unsorted(const uint32_t* values, uint32_t length, uint32_t min, uint32_t max) {
+        return METADATA_OVERHEAD + 4 + for_compressed_size_bits(length, codec_required_bits(max - min));
+    }
+
+    static uint32_t append_size_sorted(const uint8_t* in, uint32_t length, uint32_t min, uint32_t max,
+                                       uint32_t value) {
+        uint32_t m = std::min(min, value), M = std::max(max, value);
+        return METADATA_OVERHEAD + 4 + for_compressed_size_bits(length + 1, codec_required_bits(M - m));
+    }
+
+    static uint32_t append_size_unsorted(const uint8_t* in, uint32_t length, uint32_t min, uint32_t max,
+                                         uint32_t value) {
+        return append_size_sorted(in, length, min, max, value);
+    }
+
+    static uint32_t compress_sorted(const uint32_t* values, uint8_t* out, uint32_t length) {
+        return for_compress_sorted(values, out, length);
+    }
+
+    static uint32_t compress_unsorted(const uint32_t* values, uint8_t* out, uint32_t length) {
+        return for_compress_unsorted(values, out, length);
+    }
+
+    static void uncompress(const uint8_t* in, uint32_t* out, uint32_t length) {
+        for_uncompress(in, out, length);
+    }
+
+    static uint32_t select(const uint8_t* in, uint32_t length, uint32_t index) {
+        return for_select(in, index);
+    }
+
+    static uint32_t lower_bound(const uint8_t* in, uint32_t length, uint32_t value, uint32_t* actual) {
+        return for_lower_bound_search(in, length, value, actual);
+    }
+
+    static uint32_t linear_search(const uint8_t* in, uint32_t length, uint32_t value) {
+        return for_linear_search(in, length, value);
+    }
+
+    // `max` is the largest value already held, and `value` must not be smaller than it
+    static uint32_t append_sorted(uint8_t* in, uint32_t length, uint32_t max, uint32_t value) {
+        return for_append_sorted(in, length, value);
+    }
+
+    static uint32_t append_unsorted(uint8_t* in, uint32_t length, uint32_t value) {
+        return for_append_unsorted(in, length, value);
+    }
+};
+
+/*
+    Sorted values, split into blocks of 128. Each block holds its first value and bit width, followed by the deltas
+    between consecutive values, bit-packed in 4 interleaved lanes: value `j` of a block lives in lane `j % 4` at
+    slot `j / 4`, so that 4 consecutive values are unpacked and prefix-summed together in one 128-bit register.
+*/
+struct bp128_codec_t {
+    static constexpr uint32_t BLOCK_SIZE = 128;
+    static constexpr uint32_t BLOCK_HEADER_SIZE = 5;
+
+    static uint32_t size_sorted(const uint32_t* values, uint32_t length);
+
+    static uint32_t append_size_sorted(const uint8_t* in, uint32_t length, uint32_t min, uint32_t max,
+                                       uint32_t value);
+
+    static uint32_t compress_sorted(const uint32_t* values, uint8_t* out, uint32_t length);
+
+    static void uncompress(const uint8_t* in, uint32_t* out, uint32_t length);
+
+    static uint32_t select(const uint8_t* in, uint32_t length, uint32_t index);
+
+    // index of the first value >= `value`, or `length` when there is no such value
+    static uint32_t lower_bound(const uint8_t* in, uint32_t length, uint32_t value, uint32_t* actual);
+
+    static uint32_t append_sorted(uint8_t* in, uint32_t length, uint32_t max, uint32_t value);
+
+    static uint32_t packed_size(uint32_t count, uint32_t bits) {
+        const uint32_t slots = (count + 3) / 4;
+        return 16 * ((slots * bits + 31) / 32);
+    }
+};
+
+/*
+    Unsorted values, in groups of 4: a control byte holding the byte length of each value, followed by the
+    value bytes. A whole group is decoded with a single byte shuffle.
+*/
+struct stream_vbyte_codec_t {
+    static uint32_t size_unsorted(const uint32_t* values, uint32_t length, uint32_t min, uint32_t max);
+
+    static uint32_t append_size_unsorted(const uint8_t* in, uint32_t length, uint32_t min, uint32_t max,
+                                         uint32_t value);
+
+    static uint32_t compress_unsorted(const uint32_t* values, uint8_t* out, uint32_t length);
+
+    static void uncompress(const uint8_t* in, uint32_t* out, uint32_t length);
+
+    static uint32_t select(const uint8_t* in, uint32_t length, uint32_t index);
+
+    // index of the first occurrence of `value`, or `length` when absent
+    static uint32_t linear_search(const uint8_t* in, uint32_t length, uint32_t value);
+
+    static uint32_t append_unsorted(uint8_t* in, uint32_t length, uint32_t value);
+
+    static uint32_t value_size(uint32_t value) {
+        return value < (1U << 8) ? 1 : value < (1U << 16) ? 2 : value < (1U << 24) ? 3 : 4;
+    }
+};
+
+#ifdef POSTING_SIMD_CODEC
+typedef bp128_codec_t sorted_codec_t;
+typedef stream_vbyte_codec_t unsorted_codec_t;
+#else
+typedef for_codec_t sorted_codec_t;
+typedef for_codec_t unsorted_codec_t;
+#endif
@@ -1,15 +1,44 @@
 #pragma once
 
 #include <map>
+#include <functional>
 #include "sparsepp.h"
 #include "sorted_array.h"
 #include "array_utils.h"
 #include "art.h"
 #include "ids_t.h"
 
+/*
+    Numerical index of a field, laid out as a sorted column of the distinct values, each with the `ids_t` list of
+    the documents having it. The column is split into buckets of consecutive values, and every bucket also holds
+    the union of its ID lists: a range query reads that union for the buckets it fully covers, and the individual
+    lists only for the (atmost two) buckets at its edges.
+*/
 class num_tree_t {
+public:
+    static constexpr size_t BUCKET_MAX_VALUES = 256;
+
 private:
-    std::map<int64_t, void*> int64map;
+    struct bucket_t {
+        std::vector<int64_t> values;
+        std::vector<void*> id_lists;
+
+        // union of `id_lists`
+        void* ids = nullptr;
+    };
+
+    std::vector<bucket_t*> buckets;
+    size_t num_values = 0;
+
+    // index of the first bucket whose last value is >= `value`, or `buckets.size()` when there is no such bucket
+    [[nodiscard]] size_t bucket_lower_bound(int64_t value) const;
+
+    static void build_bucket_ids(bucket_t* bucket);
+
+    void split_bucket(size_t bucket_index);
+
+    // ORs the IDs of the values within [start, end] into `ids`
+    void search_range(int64_t start, int64_t end, uint32_t** ids, size_t& ids_len) const;
 
 public:
 
@@ -21,9 +50,16 @@ public:
 
     size_t get(int64_t value, std::vector<uint32_t>& geo_result_ids);
 
+    // raw `ids_t` object of the documents having the given value, or nullptr
+    void* get_ids(int64_t value) const;
+
     void search(NUM_COMPARATOR comparator, int64_t value, uint32_t** ids, size_t& ids_len);
 
+    // visits the values in ascending (or descending) order, each with the raw `ids_t` object of the documents
+    // having it, until `visit` returns false
+    void walk(bool descending, const std::function<bool(int64_t value, void* ids)>& visit) const;
+
     void remove(uint64_t value, uint32_t id);
 
     size_t size();
-};
\ No newline at end of file
+};
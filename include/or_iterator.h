@@ -79,7 +79,7 @@ bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state
                     func(id, its);
                 }
 
-                if(istate.filter_ids_length != 0 && !is_excluded) {
+                if(istate.filter_ids_length != 0 && istate.filter_bitmap == nullptr && !is_excluded) {
                     if(istate.filter_ids_index < istate.filter_ids_length) {
                         // skip iterator till next id available in filter
                         its[0].skip_to(istate.filter_ids[istate.filter_ids_index]);
@@ -111,7 +111,7 @@ bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state
                         func(id, its);
                     }
 
-                    if(istate.filter_ids_length != 0 && !is_excluded) {
+                    if(istate.filter_ids_length != 0 && istate.filter_bitmap == nullptr && !is_excluded) {
                         if(istate.filter_ids_index < istate.filter_ids_length) {
                             // skip iterator till next id available in filter
                             its[0].skip_to(istate.filter_ids[istate.filter_ids_index]);
@@ -148,7 +148,7 @@ bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state
                         func(id, its);
                     }
 
-                    if(istate.filter_ids_length != 0 && !is_excluded) {
+                    if(istate.filter_ids_length != 0 && istate.filter_bitmap == nullptr && !is_excluded) {
                         if(istate.filter_ids_index < istate.filter_ids_length) {
                             // skip iterator till next id available in filter
                             for(auto& it: its) {
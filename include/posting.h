@@ -48,10 +48,15 @@ public:
         std::vector<posting_list_t*> plists;
         std::vector<posting_list_t*> expanded_plists;
         result_iter_state_t& iter_state;
+        ThreadPool* thread_pool;
+        size_t parallelize_min_ids;
 
         block_intersector_t(const std::vector<void*>& raw_posting_lists,
-                            result_iter_state_t& iter_state):
-                            iter_state(iter_state) {
+                            result_iter_state_t& iter_state,
+                            ThreadPool* thread_pool = nullptr,
+                            size_t parallelize_min_ids = 1):
+                            iter_state(iter_state), thread_pool(thread_pool),
+                            parallelize_min_ids(parallelize_min_ids) {
 
             to_expanded_plists(raw_posting_lists, plists, expanded_plists);
 
@@ -70,12 +75,21 @@ public:
 
         template<class T>
         bool intersect(T func);
+
+        // Intersects disjoint ID ranges of the lists in parallel: `func` also receives the index of the range
+        // (< `concurrency`), so that each range can accumulate results of its own.
+        template<class T>
+        bool intersect(T func, size_t concurrency);
+
+        void split_lists(size_t concurrency, std::vector<std::vector<posting_list_t::iterator_t>>& partial_its_vec);
     };
 
     static void to_expanded_plists(const std::vector<void*>& raw_posting_lists, std::vector<posting_list_t*>& plists,
                                    std::vector<posting_list_t*>& expanded_plists);
 
-    static void upsert(void*& obj, uint32_t id, const std::vector<uint32_t>& offsets);
+    // `score` feeds the block-level upper bounds (see `posting_list_t::block_t::max_score`)
+    static void upsert(void*& obj, uint32_t id, const std::vector<uint32_t>& offsets,
+                       int64_t score = posting_list_t::UNKNOWN_SCORE);
 
     static void erase(void*& obj, uint32_t id);
 
@@ -127,3 +141,70 @@ bool posting_t::block_intersector_t::intersect(T func) {
     posting_list_t::block_intersect<T>(its, iter_state, func);
     return true;
 }
+
+template<class T>
+bool posting_t::block_intersector_t::intersect(T func, size_t concurrency) {
+    // Split posting lists into N chunks and intersect them in-parallel
+    // 1. Sort posting lists by number of blocks
+    // 2. Iterate on the posting list with least number of blocks on N-block windows
+    // 3. On each window, find the blocks of the other lists that overlap the ID range of the window
+    // 4. Construct N groups of iterators this way: as the windows are disjoint, so are their results
+
+    if(plists.empty()) {
+        return true;
+    }
+
+    // a lazy filter is stateful, so it can't be probed from multiple threads
+    if(thread_pool == nullptr || concurrency <= 1 || iter_state.filter_iterator != nullptr ||
+       plists[0]->num_ids() < parallelize_min_ids) {
+        return intersect([&func](uint32_t id, std::vector<posting_list_t::iterator_t>& its) {
+            func(id, its, 0);
+        });
+    }
+
+    std::vector<std::vector<posting_list_t::iterator_t>> partial_its_vec(concurrency);
+    split_lists(concurrency, partial_its_vec);
+
+    size_t num_processed = 0;
+    std::mutex m_process;
+    std::condition_variable cv_process;
+    size_t num_non_empty = 0;
+
+    const auto parent_search_begin = search_begin_us;
+    const auto parent_search_stop_us = search_stop_us;
+    auto parent_search_cutoff = search_cutoff;
+
+    for(size_t i = 0; i < partial_its_vec.size(); i++) {
+        auto& partial_its = partial_its_vec[i];
+
+        if(partial_its.empty()) {
+            continue;
+        }
+
+        num_non_empty++;
+
+        thread_pool->enqueue([this, i, &func, &partial_its, &parent_search_begin, &parent_search_stop_us,
+                              &parent_search_cutoff, &num_processed, &m_process, &cv_process]() {
+            search_begin_us = parent_search_begin;
+            search_stop_us = parent_search_stop_us;
+            search_cutoff = false;
+
+            auto iter_state_copy = iter_state;
+            posting_list_t::block_intersect(partial_its, iter_state_copy,
+                                            [&func, i](uint32_t id, std::vector<posting_list_t::iterator_t>& its) {
+                func(id, its, i);
+            });
+
+            std::unique_lock<std::mutex> lock(m_process);
+            num_processed++;
+            parent_search_cutoff = parent_search_cutoff || search_cutoff;
+            cv_process.notify_one();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock_process(m_process);
+    cv_process.wait(lock_process, [&](){ return num_processed == num_non_empty; });
+    search_cutoff = parent_search_cutoff;
+
+    return true;
+}
@@ -6,8 +6,10 @@
 #include "array.h"
 #include "match_score.h"
 #include "thread_local_vars.h"
+#include "id_bitmap.h"
+#include "block_directory.h"
 
-typedef uint32_t last_id_t;
+class filter_result_iterator_t;
 
 struct result_iter_state_t {
     const uint32_t* excluded_result_ids = nullptr;
@@ -16,15 +18,26 @@ struct result_iter_state_t {
     const uint32_t* filter_ids = nullptr;
     const size_t filter_ids_length = 0;
 
+    // same IDs as `filter_ids`: when set, filter matches are probed against it instead of leap-frogging
+    // through `filter_ids`, which is cheaper for dense filters
+    const id_bitmap_t* filter_bitmap = nullptr;
+
+    // lazily evaluated filter, used in place of `filter_ids` when set
+    filter_result_iterator_t* filter_iterator = nullptr;
+
     size_t excluded_result_ids_index = 0;
     size_t filter_ids_index = 0;
 
     result_iter_state_t() = default;
 
     result_iter_state_t(const uint32_t* excluded_result_ids, size_t excluded_result_ids_size,
-                        const uint32_t* filter_ids, const size_t filter_ids_length) : excluded_result_ids(excluded_result_ids),
-                                                                                      excluded_result_ids_size(excluded_result_ids_size),
-                                                                                      filter_ids(filter_ids), filter_ids_length(filter_ids_length) {}
+                        const uint32_t* filter_ids, const size_t filter_ids_length,
+                        const id_bitmap_t* filter_bitmap = nullptr,
+                        filter_result_iterator_t* filter_iterator = nullptr) : excluded_result_ids(excluded_result_ids),
+                                                                               excluded_result_ids_size(excluded_result_ids_size),
+                                                                               filter_ids(filter_ids), filter_ids_length(filter_ids_length),
+                                                                               filter_bitmap(filter_bitmap),
+                                                                               filter_iterator(filter_iterator) {}
 };
 
 /*
@@ -42,6 +55,11 @@ public:
         sorted_array offset_index;
         array offsets;
 
+        // Upper bounds over the documents in this block, used for skipping documents that cannot make it into
+        // the top-K results. They are not lowered when documents are erased, so they are only conservative.
+        int64_t max_score = INT64_MIN;
+        bool has_verbatim_match = false;
+
         // link to next block
         block_t* next = nullptr;
 
@@ -51,32 +69,50 @@ public:
 
         void insert_and_shift_offset_index(const uint32_t index, const uint32_t num_offsets);
 
-        uint32_t upsert(uint32_t id, const std::vector<uint32_t>& offsets);
+        uint32_t upsert(uint32_t id, const std::vector<uint32_t>& offsets, int64_t score);
 
         uint32_t erase(uint32_t id);
 
+        // widens the bounds of this block to also cover the documents of `other`
+        void merge_bounds(const block_t& other);
+
         uint32_t size() {
             return ids.getLength();
         }
     };
 
+    // Growable buffers that an iterator decodes its current block into. They are recycled through a per-thread
+    // pool, so that neither block transitions nor the creation of iterators allocate in the steady state.
+    struct decode_buffer_t {
+        std::vector<uint32_t> ids;
+        std::vector<uint32_t> offset_index;
+        std::vector<uint32_t> offsets;
+
+        static decode_buffer_t* acquire();
+        static void release(decode_buffer_t* buffer);
+    };
+
     class iterator_t {
     private:
-        const std::map<last_id_t, block_t*>* id_block_map;
+        const block_directory_t<block_t>* id_block_map;
         block_t* curr_block;
         uint32_t curr_index;
         block_t* end_block;
 
+        // owned only when `auto_destroy` is set: clones share the buffer of the iterator they are cloned from
+        decode_buffer_t* buffer = nullptr;
         bool auto_destroy;
         uint32_t field_id;
 
+        void load_block();
+
     public:
         // uncompressed data structures for performance
         uint32_t* ids = nullptr;
         uint32_t* offset_index = nullptr;
         uint32_t* offsets = nullptr;
 
-        explicit iterator_t(const std::map<last_id_t, block_t*>* id_block_map,
+        explicit iterator_t(const block_directory_t<block_t>* id_block_map,
                             block_t* start, block_t* end, bool auto_destroy = true, uint32_t field_id = 0);
         ~iterator_t();
 
@@ -86,19 +122,29 @@ public:
         void reset_cache();
         [[nodiscard]] bool valid() const;
         void next();
+        void next_block();
         void skip_to(uint32_t id);
         void set_index(uint32_t index);
         [[nodiscard]] uint32_t id() const;
         [[nodiscard]] uint32_t last_block_id() const;
-        [[nodiscard]] inline uint32_t index() const;
-        [[nodiscard]] inline block_t* block() const;
         [[nodiscard]] uint32_t get_field_id() const;
 
+        [[nodiscard]] inline uint32_t index() const {
+            return curr_index;
+        }
+
+        [[nodiscard]] inline block_t* block() const {
+            return curr_block;
+        }
+
         posting_list_t::iterator_t clone() const;
     };
 
 public:
 
+    // score of documents upserted without one: such blocks must never be skipped
+    static constexpr int64_t UNKNOWN_SCORE = INT64_MAX;
+
     // maximum number of IDs (and associated offsets) to store in each block before another block is created
     const uint16_t BLOCK_MAX_ELEMENTS;
     uint32_t ids_length = 0;
@@ -107,8 +153,7 @@ public:
 
     // keeps track of the *last* ID in each block and is used for partial random access
     // e.g. 0..[9], 10..[19], 20..[29]
-    // MUST be ordered
-    std::map<last_id_t, block_t*> id_block_map;
+    block_directory_t<block_t> id_block_map;
 
     static bool at_end(const std::vector<posting_list_t::iterator_t>& its);
     static bool at_end2(const std::vector<posting_list_t::iterator_t>& its);
@@ -128,6 +173,13 @@ public:
     static uint32_t advance_smallest(std::vector<posting_list_t::iterator_t>& its);
     static uint32_t advance_smallest2(std::vector<posting_list_t::iterator_t>& its);
 
+    // Block-at-a-time intersection: all iterators are first aligned to the largest current ID, and the window
+    // then spans till the smallest last ID of the current blocks, so that every ID in it is already decompressed.
+    static uint32_t align_block_window(std::vector<posting_list_t::iterator_t>& its);
+    static size_t intersect_block_window(const std::vector<posting_list_t::iterator_t>& its, uint32_t window_end,
+                                         std::vector<uint32_t>& window_ids, std::vector<uint32_t>& scratch);
+    static void advance_past_window(std::vector<posting_list_t::iterator_t>& its, uint32_t window_end);
+
     posting_list_t() = delete;
 
     explicit posting_list_t(uint16_t max_block_elements);
@@ -138,7 +190,7 @@ public:
 
     static void merge_adjacent_blocks(block_t* block1, block_t* block2, size_t num_block2_ids_to_move);
 
-    void upsert(uint32_t id, const std::vector<uint32_t>& offsets);
+    void upsert(uint32_t id, const std::vector<uint32_t>& offsets, int64_t score = UNKNOWN_SCORE);
 
     void erase(uint32_t id);
 
@@ -180,6 +232,9 @@ public:
 
     static bool is_single_token_verbatim_match(const posting_list_t::iterator_t& it, bool field_is_array);
 
+    // whether the offsets of a document denote that the token is the only token of the field (or array element)
+    static bool is_verbatim_match(const uint32_t* offsets, uint32_t num_offsets, bool field_is_array);
+
     static void get_exact_matches(std::vector<iterator_t>& its, bool field_is_array,
                                   const uint32_t* ids, const uint32_t num_ids,
                                   uint32_t*& exact_ids, size_t& num_exact_ids);
@@ -224,46 +279,43 @@ bool posting_list_t::block_intersect(std::vector<posting_list_t::iterator_t>& it
                 its[0].next();
             }
             break;
-        case 2:
-            while(!at_end2(its)) {
-                num_processed++;
-                if (num_processed % 65536 == 0 && (std::chrono::duration_cast<std::chrono::microseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) {
-                    search_cutoff = true;
+        default: {
+            std::vector<uint32_t> window_ids;
+            std::vector<uint32_t> scratch;
+            size_t next_cutoff_check = 65536;
+
+            while(!at_end(its)) {
+                const uint32_t window_end = align_block_window(its);
+                if(at_end(its)) {
                     break;
                 }
 
-                if(equals2(its)) {
-                    if(posting_list_t::take_id(istate, its[0].id())) {
-                        func(its[0].id(), its);
+                const size_t num_window_ids = intersect_block_window(its, window_end, window_ids, scratch);
+
+                for(size_t i = 0; i < num_window_ids; i++) {
+                    const uint32_t id = window_ids[i];
+                    for(auto& it: its) {
+                        it.skip_to(id);
                     }
 
-                    advance_all2(its);
-                } else {
-                    advance_non_largest2(its);
-                }
-            }
-            break;
-        default:
-            while(!at_end(its)) {
-                num_processed++;
-                if (num_processed % 65536 == 0 && (std::chrono::duration_cast<std::chrono::microseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) {
-                    search_cutoff = true;
-                    break;
+                    if(posting_list_t::take_id(istate, id)) {
+                        func(id, its);
+                    }
                 }
 
-                if(equals(its)) {
-                    //LOG(INFO) << its[0].id();
-                    if(posting_list_t::take_id(istate, its[0].id())) {
-                        func(its[0].id(), its);
+                num_processed += its[0].block()->size();
+                if(num_processed >= next_cutoff_check) {
+                    next_cutoff_check = num_processed + 65536;
+                    if((std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) {
+                        search_cutoff = true;
+                        break;
                     }
-
-                    advance_all(its);
-                } else {
-                    advance_non_largest(its);
                 }
+
+                advance_past_window(its, window_end);
             }
+        }
     }
 
     return false;
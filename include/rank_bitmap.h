@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/*
+    Presence bitmap of a page of consecutive IDs, along with the number of set bits before each of its words, so that
+    the rank of an ID, i.e. the position of its entry among those of the page, takes a couple of loads and a popcount.
+    Columns indexed by seq_id split their IDs into such pages, and lay out the entries of a page in ID order.
+*/
+struct rank_bitmap_t {
+    static constexpr size_t PAGE_BITS = 12;
+    static constexpr size_t PAGE_SIZE = 1 << PAGE_BITS;
+    static constexpr size_t PAGE_WORDS = PAGE_SIZE / 64;
+
+    uint64_t present[PAGE_WORDS] = {0};
+
+    // number of set bits before each word of `present`
+    uint16_t ranks[PAGE_WORDS] = {0};
+
+    [[nodiscard]] bool contains(uint32_t offset) const {
+        return (present[offset >> 6] >> (offset & 63)) & 1;
+    }
+
+    [[nodiscard]] size_t rank(uint32_t offset) const {
+        const uint64_t below = present[offset >> 6] & ((uint64_t(1) << (offset & 63)) - 1);
+        return ranks[offset >> 6] + __builtin_popcountll(below);
+    }
+
+    // the offset must not be set
+    void set(uint32_t offset) {
+        present[offset >> 6] |= (uint64_t(1) << (offset & 63));
+
+        for(size_t w = (offset >> 6) + 1; w < PAGE_WORDS; w++) {
+            ranks[w]++;
+        }
+    }
+
+    // the offset must be set
+    void unset(uint32_t offset) {
+        present[offset >> 6] &= ~(uint64_t(1) << (offset & 63));
+
+        for(size_t w = (offset >> 6) + 1; w < PAGE_WORDS; w++) {
+            ranks[w]--;
+        }
+    }
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "store.h"
+#include "field.h"
+#include "versioned_lru_cache.h"
+
+// sort fields of a `sort_by` clause, validated and standardized: owns the filter trees of their eval expressions
+struct sort_plan_t {
+    std::vector<sort_by> sort_fields_std;
+
+    sort_plan_t() = default;
+
+    sort_plan_t(const sort_plan_t&) = delete;
+
+    sort_plan_t& operator=(const sort_plan_t&) = delete;
+
+    ~sort_plan_t() {
+        for(auto& sort_field: sort_fields_std) {
+            delete sort_field.eval.filter_tree_root;
+        }
+    }
+};
+
+/*
+    LRU cache of the plans that a collection makes out of the raw `filter_by` and `sort_by` strings of its searches,
+    so that the frequently repeated ones are parsed and validated against the schema only once. Plans are shared
+    with the searches that use them and must not be modified. Every entry is stamped with the version of the schema
+    that it was made against, and entries of an older version are dropped rather than returned. The cache is bounded
+    by an estimate of the bytes held by its plans.
+*/
+template <typename plan_t>
+class search_plan_cache_t: public versioned_lru_cache_t<std::string, plan_t, uint64_t> {
+private:
+    typedef versioned_lru_cache_t<std::string, plan_t, uint64_t> lru_cache_t;
+
+    // a plan holds the values of the clause it was made from, spread over nodes that outweigh them
+    static constexpr size_t PLAN_BYTES_PER_CLAUSE_BYTE = 8;
+
+public:
+
+    using lru_cache_t::lru_cache_t;
+
+    void put(const std::string& key, uint64_t schema_version, std::shared_ptr<const plan_t> plan) {
+        const size_t entry_size = lru_cache_t::ENTRY_OVERHEAD + sizeof(plan_t) +
+                                  key.size() * (1 + PLAN_BYTES_PER_CLAUSE_BYTE);
+        lru_cache_t::put(key, schema_version, std::move(plan), entry_size);
+    }
+};
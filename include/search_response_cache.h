@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <atomic>
+#include <deque>
+#include <string>
+#include <vector>
+#include "http_data.h"
+#include "sparsepp.h"
+#include "versioned_lru_cache.h"
+
+/*
+    LRU cache of the responses of searches made with `use_cache`, bounded by the total size of the bodies it holds.
+    Entries are spread over shards by the hash of their request, so that concurrent searches rarely contend for the
+    same lock. Each shard holds an equal part of the capacity, which bounds the size of a single response that is
+    cached. Every collection has a version that is advanced whenever its documents, synonyms, overrides or schema
+    change; an entry is stamped with the versions of the collections that its searches read, as they were before the
+    searches began, and is dropped rather than returned once any of them has changed or its TTL has lapsed.
+*/
+class SearchResponseCache {
+public:
+    struct collection_version_t {
+        std::string collection_name;
+        uint64_t version;
+    };
+
+private:
+    static constexpr const size_t NUM_SHARDS = 16;
+
+    // entries are stamped with the versions of the collections that their searches read
+    typedef versioned_lru_cache_t<uint64_t, cached_res_t, std::vector<collection_version_t>> shard_t;
+
+    shard_t shards[NUM_SHARDS];
+
+    // a dropped collection keeps a version of its own for this long, for the searches that read it before the drop
+    static constexpr const int64_t TOMBSTONE_TTL_S = 600;
+
+    struct tombstone_t {
+        std::string collection_name;
+        uint64_t version;
+        int64_t dropped_at_s;
+    };
+
+    mutable std::shared_mutex versions_mutex;
+
+    // versions are drawn from one sequence, so that a collection that is created again never repeats a version
+    uint64_t last_version = 0;
+    spp::sparse_hash_map<std::string, uint64_t> collection_versions;
+
+    // oldest first
+    std::deque<tombstone_t> tombstones;
+
+    std::atomic<uint64_t> num_hits{0};
+    std::atomic<uint64_t> num_misses{0};
+
+    // of stale entries that were dropped on lookup
+    std::atomic<uint64_t> num_stale_drops{0};
+
+    SearchResponseCache() = default;
+
+    shard_t& get_shard(uint64_t key) {
+        return shards[key % NUM_SHARDS];
+    }
+
+    bool is_stale(const std::vector<collection_version_t>& read_versions, const cached_res_t& res) const;
+
+    // to be called under a unique lock of `versions_mutex`
+    void purge_tombstones();
+
+public:
+
+    static SearchResponseCache& get_instance() {
+        static SearchResponseCache instance;
+        return instance;
+    }
+
+    SearchResponseCache(SearchResponseCache const&) = delete;
+    void operator=(SearchResponseCache const&) = delete;
+
+    // in bytes of response bodies, shared equally by the shards: responses larger than a shard's part are not
+    // cached, and 0 disables the cache
+    void set_capacity(size_t capacity_bytes);
+
+    bool enabled() const {
+        return shards[0].enabled();
+    }
+
+    // to be read before the collection is searched
+    uint64_t get_collection_version(const std::string& collection_name) const;
+
+    // to be called once the collection is known, and after a change to it has been applied
+    void invalidate(const std::string& collection_name);
+
+    // to be called after the collection has been dropped
+    void erase(const std::string& collection_name);
+
+    // returns nullptr on a miss
+    std::shared_ptr<const cached_res_t> get(uint64_t key);
+
+    // has no effect when any of the collections changed since its version in `read_versions` was read
+    void put(uint64_t key, const cached_res_t& res, std::vector<collection_version_t> read_versions);
+
+    void clear();
+
+    uint64_t get_num_hits() const {
+        return num_hits.load();
+    }
+
+    uint64_t get_num_misses() const {
+        return num_misses.load();
+    }
+
+    // of entries dropped to make room for others
+    uint64_t get_num_evictions() const;
+
+    // of entries dropped on lookup, for their collections having changed or their TTL having lapsed
+    uint64_t get_num_stale_drops() const {
+        return num_stale_drops.load();
+    }
+
+    // of collections, including those dropped recently
+    size_t num_collection_versions() const;
+
+    size_t size_bytes();
+
+    size_t num_entries();
+};
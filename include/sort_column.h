@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "rank_bitmap.h"
+
+/*
+    Sort values of a field, in a column indexed by seq_id. The column is split into pages of consecutive IDs, each
+    with a `rank_bitmap_t` of the documents that have a value: values are stored in ID order, so the position of a
+    value is its rank in the bitmap. Documents without a value take no space beyond their bit, and a lookup never
+    probes a hash table.
+*/
+class sort_column_t {
+public:
+    static constexpr size_t PAGE_BITS = rank_bitmap_t::PAGE_BITS;
+    static constexpr size_t PAGE_SIZE = rank_bitmap_t::PAGE_SIZE;
+
+private:
+    struct page_t: public rank_bitmap_t {
+        std::vector<int64_t> values;
+    };
+
+    std::vector<page_t*> pages;
+    size_t num_values = 0;
+
+    [[nodiscard]] const page_t* page_of(uint32_t seq_id) const {
+        const size_t page_index = seq_id >> PAGE_BITS;
+        return page_index < pages.size() ? pages[page_index] : nullptr;
+    }
+
+public:
+
+    sort_column_t() = default;
+
+    sort_column_t(const sort_column_t&) = delete;
+
+    sort_column_t& operator=(const sort_column_t&) = delete;
+
+    ~sort_column_t();
+
+    // returns false when the document has no value
+    bool get(uint32_t seq_id, int64_t& value) const {
+        const page_t* page = page_of(seq_id);
+        const uint32_t offset = seq_id & (PAGE_SIZE - 1);
+
+        if(page == nullptr || !page->contains(offset)) {
+            return false;
+        }
+
+        value = page->values[page->rank(offset)];
+        return true;
+    }
+
+    // the document must have a value
+    [[nodiscard]] int64_t at(uint32_t seq_id) const {
+        const page_t* page = pages[seq_id >> PAGE_BITS];
+        return page->values[page->rank(seq_id & (PAGE_SIZE - 1))];
+    }
+
+    [[nodiscard]] bool contains(uint32_t seq_id) const {
+        const page_t* page = page_of(seq_id);
+        return page != nullptr && page->contains(seq_id & (PAGE_SIZE - 1));
+    }
+
+    // has no effect when the document already has a value
+    void emplace(uint32_t seq_id, int64_t value);
+
+    void erase(uint32_t seq_id);
+
+    [[nodiscard]] size_t size() const {
+        return num_values;
+    }
+};
@@ -2,7 +2,6 @@
 
 #include <stdio.h>
 #include <cstdlib>
-#include <for.h>
 #include <cstring>
 #include <vector>
 #include <limits>
@@ -10,40 +9,19 @@
 #include "array_base.h"
 #include "logger.h"
 
-class sorted_array: public array_base {
+class sorted_array: public array_base_t<sorted_codec_t> {
 private:
 
-    uint32_t inline sorted_append_size_required(uint32_t value, uint32_t new_length) {
-        uint32_t m = std::min(min, value);
-        uint32_t M = std::max(max, value);
-        uint32_t bnew = required_bits(M - m);
-        uint32_t size_bits = for_compressed_size_bits(new_length, bnew);
-
-
-        /*if(new_length == 15) {
-            LOG(INFO) << "value: " << value << ", m: " << m << ", M: " << M << ", bnew: "
-                      << bnew << ", size_bits: " << size_bits;
-        }*/
-
-        return METADATA_OVERHEAD + 4 + size_bits;
-    }
-
-    uint32_t lower_bound_search_bits(const uint8_t *in, uint32_t imin, uint32_t imax, uint32_t base,
-                                     uint32_t bits, uint32_t value, uint32_t *actual);
+    uint32_t lower_bound_search_compressed(uint32_t imin, uint32_t imax, uint32_t value, uint32_t *actual);
 
     uint32_t lower_bound_search(const uint32_t *in, uint32_t imin, uint32_t imax,
                                 uint32_t value, uint32_t *actual);
 
-    void binary_search_indices(const uint32_t *values, int low_vindex, int high_vindex,
-                               int low_index, int high_index, uint32_t base, uint32_t bits,
-                               uint32_t *indices);
-
     void binary_search_indices(const uint32_t *values, int low_vindex, int high_vindex,
                                int low_index, int high_index, uint32_t *indices);
 
     void binary_count_indices(const uint32_t *values, int low_vindex, int high_vindex,
-                              int low_index, int high_index, uint32_t base, uint32_t bits,
-                              size_t& num_found);
+                              int low_index, int high_index, size_t& num_found);
 
     void binary_count_indices(const uint32_t *values, int low_vindex, int high_vindex,
                               const uint32_t* src, int low_index, int high_index, size_t& num_found);
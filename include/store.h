@@ -165,6 +165,36 @@ public:
         return StoreStatus::ERROR;
     }
 
+    // fetches the values of all the keys in one batch; `values` and `statuses` are in the order of `keys`
+    void multi_get(const std::vector<std::string>& keys, std::vector<std::string>& values,
+                   std::vector<StoreStatus>& statuses) const {
+        std::vector<rocksdb::Slice> key_slices(keys.begin(), keys.end());
+        std::vector<rocksdb::PinnableSlice> pinned_values(keys.size());
+        std::vector<rocksdb::Status> key_statuses(keys.size());
+
+        values.resize(keys.size());
+        statuses.resize(keys.size());
+
+        std::shared_lock lock(mutex);
+        db->MultiGet(rocksdb::ReadOptions(), db->DefaultColumnFamily(), keys.size(),
+                     key_slices.data(), pinned_values.data(), key_statuses.data());
+
+        for(size_t i = 0; i < keys.size(); i++) {
+            if(key_statuses[i].ok()) {
+                values[i] = pinned_values[i].ToString();
+                statuses[i] = StoreStatus::FOUND;
+            } else if(key_statuses[i].IsNotFound()) {
+                statuses[i] = StoreStatus::NOT_FOUND;
+            } else {
+                LOG(ERROR) << "Error while fetching the key: " << keys[i] << " - status is: "
+                           << key_statuses[i].ToString();
+                statuses[i] = StoreStatus::ERROR;
+            }
+
+            pinned_values[i].Reset();
+        }
+    }
+
     bool remove(const std::string& key) {
         std::shared_lock lock(mutex);
         rocksdb::Status status = db->Delete(write_options, key);
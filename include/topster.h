@@ -4,6 +4,8 @@
 #include <climits>
 #include <cstdio>
 #include <algorithm>
+#include <memory>
+#include <vector>
 #include <unordered_map>
 
 struct KV {
@@ -87,6 +89,71 @@ struct KV {
     }
 };
 
+/*
+    The groups of a grouping Topster. The KVs of each group are held in descending order in a fixed-size slot of one
+    array, and a flat open addressing table maps the distinct key of a group to its index. Arenas are recycled
+    across the searches that run on a thread, so that a new group costs no allocation once they have grown large
+    enough.
+*/
+struct group_arena_t {
+    // arenas larger than this are freed after use instead of being recycled
+    static constexpr size_t MAX_POOLED_KVS = 1 << 16;
+    static constexpr size_t MAX_POOLED_ARENAS = 1;
+    static constexpr size_t MIN_SLOTS = 64;
+
+    // group => KVs, in the slot [group * group_limit, (group + 1) * group_limit)
+    std::vector<KV> kvs;
+
+    // group => number of KVs
+    std::vector<uint32_t> sizes;
+
+    // group => distinct key
+    std::vector<uint64_t> distinct_keys;
+
+    // distinct key hash => group + 1, or 0 when free
+    std::vector<uint32_t> slots;
+
+    static std::vector<std::unique_ptr<group_arena_t>>& pool() {
+        static thread_local std::vector<std::unique_ptr<group_arena_t>> arenas;
+        return arenas;
+    }
+
+    static group_arena_t* acquire() {
+        auto& arenas = pool();
+        if(arenas.empty()) {
+            return new group_arena_t();
+        }
+
+        group_arena_t* arena = arenas.back().release();
+        arenas.pop_back();
+        return arena;
+    }
+
+    static void release(group_arena_t* arena) {
+        auto& arenas = pool();
+        if(arenas.size() >= MAX_POOLED_ARENAS || arena->kvs.capacity() > MAX_POOLED_KVS ||
+           arena->slots.size() > MAX_POOLED_KVS) {
+            delete arena;
+            return;
+        }
+
+        arena->kvs.clear();
+        arena->sizes.clear();
+        arena->distinct_keys.clear();
+        std::fill(arena->slots.begin(), arena->slots.end(), 0);
+
+        arenas.emplace_back(arena);
+    }
+
+    static size_t slot_of(uint64_t distinct_key, size_t mask) {
+        // murmur3 finalizer: distinct keys can be small integers
+        distinct_key ^= distinct_key >> 33;
+        distinct_key *= 0xff51afd7ed558ccdULL;
+        distinct_key ^= distinct_key >> 33;
+        return distinct_key & mask;
+    }
+};
+
 /*
 * Remembers the max-K elements seen so far using a min-heap
 */
@@ -99,7 +166,9 @@ struct Topster {
 
     std::unordered_map<uint64_t, KV*> kv_map;
 
-    spp::sparse_hash_map<uint64_t, Topster*> group_kv_map;
+    // when grouping, the top `distinct` KVs of every group
+    group_arena_t* groups = nullptr;
+    uint32_t num_groups = 0;
     size_t distinct;
 
     explicit Topster(size_t capacity): Topster(capacity, 0) {
@@ -119,19 +188,23 @@ struct Topster {
             data[i].distinct_key = 0;
             kvs[i] = &data[i];
         }
+
+        if(distinct) {
+            groups = group_arena_t::acquire();
+        }
     }
 
     ~Topster() {
         delete[] data;
         delete[] kvs;
-        for(auto& kv: group_kv_map) {
-            delete kv.second;
-        }
 
         data = nullptr;
         kvs = nullptr;
 
-        group_kv_map.clear();
+        if(groups != nullptr) {
+            group_arena_t::release(groups);
+            groups = nullptr;
+        }
     }
 
     static inline void swapMe(KV** a, KV** b) {
@@ -162,17 +235,7 @@ struct Topster {
 
         if(distinct) {
             // Grouping cannot be a streaming operation, so aggregate the KVs associated with every group.
-            auto kvs_it = group_kv_map.find(kv->distinct_key);
-            if(kvs_it != group_kv_map.end()) {
-                kvs_it->second->add(kv);
-            } else {
-                Topster* g_topster = new Topster(distinct, 0);
-                g_topster->add(kv);
-                group_kv_map.insert({kv->distinct_key, g_topster});
-            }
-            
-            return true;
-
+            return add_to_group(kv);
         } else { // not distinct
             //LOG(INFO) << "Searching for key: " << kv->key;
 
@@ -259,6 +322,123 @@ struct Topster {
         return true;
     }
 
+    bool add_to_group(KV* kv) {
+        const uint32_t group = get_or_create_group(kv->distinct_key);
+        KV* group_kvs = &groups->kvs[group * distinct];
+        uint32_t& group_size = groups->sizes[group];
+
+        // the same document can be added again, e.g. when it matches another query
+        size_t pos = group_size;
+        for(size_t i = 0; i < group_size; i++) {
+            if(group_kvs[i].key == kv->key) {
+                if(is_smaller(kv, &group_kvs[i])) {
+                    return false;
+                }
+
+                pos = i;
+                break;
+            }
+        }
+
+        if(pos == group_size) {
+            if(group_size == distinct) {
+                if(is_smaller(kv, &group_kvs[group_size - 1])) {
+                    return false;
+                }
+
+                // the smallest KV of the group is evicted
+                pos = group_size - 1;
+            } else {
+                group_size++;
+            }
+        }
+
+        // `kv` is never smaller than the KV it replaces, so it can only move towards the front
+        while(pos > 0 && is_greater(kv, &group_kvs[pos - 1])) {
+            group_kvs[pos] = std::move(group_kvs[pos - 1]);
+            pos--;
+        }
+
+        kv->array_index = pos;
+        group_kvs[pos] = *kv;
+        return true;
+    }
+
+    uint32_t get_or_create_group(uint64_t distinct_key) {
+        if((num_groups + 1) * 2 > groups->slots.size()) {
+            grow_group_slots();
+        }
+
+        const size_t mask = groups->slots.size() - 1;
+        size_t slot = group_arena_t::slot_of(distinct_key, mask);
+
+        while(groups->slots[slot] != 0) {
+            const uint32_t group = groups->slots[slot] - 1;
+            if(groups->distinct_keys[group] == distinct_key) {
+                return group;
+            }
+
+            slot = (slot + 1) & mask;
+        }
+
+        const uint32_t group = num_groups++;
+        groups->slots[slot] = group + 1;
+        groups->distinct_keys.push_back(distinct_key);
+        groups->sizes.push_back(0);
+
+        if(groups->kvs.size() < num_groups * distinct) {
+            groups->kvs.resize(num_groups * distinct);
+        }
+
+        return group;
+    }
+
+    void grow_group_slots() {
+        const size_t num_slots = std::max(group_arena_t::MIN_SLOTS, groups->slots.size() * 2);
+        const size_t mask = num_slots - 1;
+
+        groups->slots.assign(num_slots, 0);
+
+        for(uint32_t group = 0; group < num_groups; group++) {
+            size_t slot = group_arena_t::slot_of(groups->distinct_keys[group], mask);
+            while(groups->slots[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+
+            groups->slots[slot] = group + 1;
+        }
+    }
+
+    // returns false when no KV has the distinct key
+    bool find_group(uint64_t distinct_key, uint32_t& group) const {
+        if(groups == nullptr || groups->slots.empty()) {
+            return false;
+        }
+
+        const size_t mask = groups->slots.size() - 1;
+        size_t slot = group_arena_t::slot_of(distinct_key, mask);
+
+        while(groups->slots[slot] != 0) {
+            if(groups->distinct_keys[groups->slots[slot] - 1] == distinct_key) {
+                group = groups->slots[slot] - 1;
+                return true;
+            }
+
+            slot = (slot + 1) & mask;
+        }
+
+        return false;
+    }
+
+    uint32_t getGroupSize(uint32_t group) const {
+        return groups->sizes[group];
+    }
+
+    // KVs of a group are in descending order
+    KV* getGroupKV(uint32_t group, uint32_t index) {
+        return &groups->kvs[group * distinct + index];
+    }
+
     static bool is_greater(const struct KV* i, const struct KV* j) {
         return std::tie(i->scores[0], i->scores[1], i->scores[2], i->key) >
                std::tie(j->scores[0], j->scores[1], j->scores[2], j->key);
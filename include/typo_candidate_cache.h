@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "art.h"
+#include "versioned_lru_cache.h"
+
+struct typo_candidates_t {
+    // in the order `art_fuzzy_search()` returns them
+    std::vector<art_leaf*> leaves;
+
+    // only the best of the matching leaves were taken
+    bool truncated = false;
+};
+
+/*
+    LRU cache of the leaves that `art_fuzzy_search()` finds for a token of a field, at a typo cost and prefix
+    setting, before they are filtered. Every entry is stamped with the generation of the field's tree when its leaves
+    were found: the index advances the generation of a field whenever its tree or the postings in it change, and
+    entries of an older generation, whose leaves may since have been freed, are dropped rather than returned. The
+    cache is bounded by the bytes held by its entries.
+*/
+class typo_candidate_cache_t: public versioned_lru_cache_t<std::string, typo_candidates_t, uint64_t> {
+public:
+
+    using versioned_lru_cache_t::versioned_lru_cache_t;
+
+    static std::string get_key(const std::string& field_name, const std::string& token, uint32_t cost,
+                               bool prefix, token_ordering token_order);
+
+    void put(const std::string& key, uint64_t generation, std::shared_ptr<const typo_candidates_t> candidates) {
+        const size_t entry_size = ENTRY_OVERHEAD + key.size() + sizeof(typo_candidates_t) +
+                                  candidates->leaves.size() * sizeof(art_leaf*);
+        versioned_lru_cache_t::put(key, generation, std::move(candidates), entry_size);
+    }
+};
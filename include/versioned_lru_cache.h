@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "sparsepp.h"
+
+/*
+    LRU cache of values that are shared with the readers they are handed out to, bounded by the bytes that its
+    entries are charged. Every entry is stamped with the version of the state that its value was derived from, and
+    an entry that its reader finds to be of another version is dropped rather than returned. Values outlive the
+    entries they are evicted from, and must not be modified once they are cached.
+*/
+template <typename key_t, typename value_t, typename version_t>
+class versioned_lru_cache_t {
+private:
+    struct entry_t {
+        key_t key;
+        version_t version;
+        std::shared_ptr<const value_t> value;
+        size_t size;
+    };
+
+    typedef typename std::list<entry_t>::iterator entry_iterator_t;
+    typedef typename spp::sparse_hash_map<key_t, entry_iterator_t>::iterator entry_map_iterator_t;
+
+    mutable std::mutex mutex;
+
+    // most recently used first
+    std::list<entry_t> entries;
+    spp::sparse_hash_map<key_t, entry_iterator_t> entry_map;
+
+    std::atomic<size_t> capacity;
+    size_t size = 0;
+
+    // entries dropped to make room for others, as opposed to those dropped for being of another version
+    std::atomic<uint64_t> num_evictions{0};
+
+    void erase_entry(entry_map_iterator_t it) {
+        size -= it->second->size;
+        entries.erase(it->second);
+        entry_map.erase(it);
+    }
+
+    void evict(size_t max_size) {
+        while(size > max_size && !entries.empty()) {
+            const entry_t& entry = entries.back();
+            size -= entry.size;
+            entry_map.erase(entry.key);
+            entries.pop_back();
+            num_evictions++;
+        }
+    }
+
+public:
+
+    // bookkeeping of an entry, for the callers that charge it along with the value
+    static constexpr size_t ENTRY_OVERHEAD = sizeof(entry_t) + sizeof(key_t) + sizeof(entry_iterator_t);
+
+    explicit versioned_lru_cache_t(size_t capacity_bytes = 0): capacity(capacity_bytes) {
+
+    }
+
+    versioned_lru_cache_t(const versioned_lru_cache_t&) = delete;
+
+    versioned_lru_cache_t& operator=(const versioned_lru_cache_t&) = delete;
+
+    // 0 disables the cache
+    void set_capacity(size_t capacity_bytes) {
+        std::unique_lock lock(mutex);
+        capacity = capacity_bytes;
+        evict(capacity);
+    }
+
+    size_t get_capacity() const {
+        return capacity.load();
+    }
+
+    bool enabled() const {
+        return capacity.load() != 0;
+    }
+
+    // returns nullptr when there is no entry, or when `is_valid(version, value)` rejects it, which drops the entry
+    template <typename is_valid_t>
+    std::shared_ptr<const value_t> get_if(const key_t& key, is_valid_t is_valid) {
+        std::unique_lock lock(mutex);
+
+        const auto it = entry_map.find(key);
+        if(it == entry_map.end()) {
+            return nullptr;
+        }
+
+        if(!is_valid(it->second->version, *it->second->value)) {
+            erase_entry(it);
+            return nullptr;
+        }
+
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->value;
+    }
+
+    // returns nullptr when there is no entry of the given version
+    std::shared_ptr<const value_t> get(const key_t& key, const version_t& version) {
+        return get_if(key, [&version](const version_t& entry_version, const value_t&) {
+            return entry_version == version;
+        });
+    }
+
+    // `entry_size` is what the entry is charged against the capacity: an entry larger than it is not held
+    void put(const key_t& key, version_t version, std::shared_ptr<const value_t> value, size_t entry_size) {
+        std::unique_lock lock(mutex);
+
+        if(entry_size > capacity) {
+            return;
+        }
+
+        const auto it = entry_map.find(key);
+        if(it != entry_map.end()) {
+            erase_entry(it);
+        }
+
+        evict(capacity - entry_size);
+
+        entries.push_front(entry_t{key, std::move(version), std::move(value), entry_size});
+        entry_map.emplace(key, entries.begin());
+        size += entry_size;
+    }
+
+    void erase(const key_t& key) {
+        std::unique_lock lock(mutex);
+
+        const auto it = entry_map.find(key);
+        if(it != entry_map.end()) {
+            erase_entry(it);
+        }
+    }
+
+    void clear() {
+        std::unique_lock lock(mutex);
+        entries.clear();
+        entry_map.clear();
+        size = 0;
+    }
+
+    size_t size_bytes() const {
+        std::unique_lock lock(mutex);
+        return size;
+    }
+
+    size_t num_entries() const {
+        std::unique_lock lock(mutex);
+        return entries.size();
+    }
+
+    uint64_t get_num_evictions() const {
+        return num_evictions.load();
+    }
+};
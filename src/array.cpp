@@ -1,20 +1,20 @@
 #include "array.h"
 
 uint32_t array::at(uint32_t index) {
-    return for_select(in, index);
+    return codec::select(in, length, index);
 }
 
 bool array::contains(uint32_t value) {
-    uint32_t index = for_linear_search(in, length, value);
+    uint32_t index = codec::linear_search(in, length, value);
     return index != length;
 }
 
 uint32_t array::indexOf(uint32_t value) {
-    return for_linear_search(in, length, value);
+    return codec::linear_search(in, length, value);
 }
 
 bool array::append(uint32_t value) {
-    uint32_t size_required = unsorted_append_size_required(value, length+1);
+    uint32_t size_required = codec::append_size_unsorted(in, length, min, max, value);
 
     if(size_required+FOR_ELE_SIZE > size_bytes) {
         // grow the array first
@@ -27,7 +27,7 @@ bool array::append(uint32_t value) {
         size_bytes = (uint32_t) new_size;
     }
 
-    uint32_t new_length_bytes = for_append_unsorted(in, length, value);
+    uint32_t new_length_bytes = codec::append_unsorted(in, length, value);
     if(new_length_bytes == 0) {
         abort();
     }
@@ -45,10 +45,10 @@ void array::load(const uint32_t *sorted_array, const uint32_t array_length, cons
     min = m;
     max = M;
 
-    uint32_t size_required = (uint32_t) (unsorted_append_size_required(max, array_length) * FOR_GROWTH_FACTOR);
+    uint32_t size_required = (uint32_t) (codec::size_unsorted(sorted_array, array_length, min, max) * FOR_GROWTH_FACTOR);
     uint8_t *out = (uint8_t *) malloc(size_required * sizeof *out);
     memset(out, 0, size_required);
-    uint32_t actual_size = for_compress_unsorted(sorted_array, out, array_length);
+    uint32_t actual_size = codec::compress_unsorted(sorted_array, out, array_length);
 
     free(in);
     in = nullptr;
@@ -102,10 +102,10 @@ void array::remove_index(uint32_t start_index, uint32_t end_index) {
         curr_index++;
     }
 
-    uint32_t size_required = (uint32_t) (unsorted_append_size_required(max, new_index) * FOR_GROWTH_FACTOR);
+    uint32_t size_required = (uint32_t) (codec::size_unsorted(new_array, new_index, min, max) * FOR_GROWTH_FACTOR);
     uint8_t *out = (uint8_t *) malloc(size_required * sizeof *out);
     memset(out, 0, size_required);
-    uint32_t actual_size = for_compress_unsorted(new_array, out, new_index);
+    uint32_t actual_size = codec::compress_unsorted(new_array, out, new_index);
 
     delete[] curr_array;
     delete[] new_array;
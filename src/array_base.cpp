@@ -1,24 +1,38 @@
 #include "array_base.h"
 
-uint32_t* array_base::uncompress(uint32_t len) const {
+template<class codec_t>
+uint32_t* array_base_t<codec_t>::uncompress(uint32_t len) const {
     uint32_t actual_len = std::max(len, length);
     uint32_t *out = new uint32_t[actual_len];
-    for_uncompress(in, out, length);
+    codec_t::uncompress(in, out, length);
     return out;
 }
 
-uint32_t array_base::getSizeInBytes() {
+template<class codec_t>
+void array_base_t<codec_t>::uncompress_into(uint32_t* out) const {
+    codec_t::uncompress(in, out, length);
+}
+
+template<class codec_t>
+uint32_t array_base_t<codec_t>::getSizeInBytes() {
     return size_bytes;
 }
 
-uint32_t array_base::getLength() const {
+template<class codec_t>
+uint32_t array_base_t<codec_t>::getLength() const {
     return length;
 }
 
-uint32_t array_base::getMin() const {
+template<class codec_t>
+uint32_t array_base_t<codec_t>::getMin() const {
     return min;
 }
 
-uint32_t array_base::getMax() const {
+template<class codec_t>
+uint32_t array_base_t<codec_t>::getMax() const {
     return max;
 }
+
+template class array_base_t<for_codec_t>;
+template class array_base_t<bp128_codec_t>;
+template class array_base_t<stream_vbyte_codec_t>;
@@ -1,5 +1,97 @@
 #include "array_utils.h"
 #include <memory.h>
+#include <algorithm>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SIMD_TARGET_SSE __attribute__((target("sse4.1")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#define HAS_SIMD_INTERSECT 1
+#elif defined(__aarch64__)
+#include <sse2neon.h>
+#define SIMD_TARGET_SSE
+#define HAS_SIMD_INTERSECT 1
+#endif
+
+namespace {
+    enum class simd_level_t {
+        scalar,
+        sse,
+        avx2
+    };
+
+    simd_level_t detect_simd_level() {
+#if defined(__x86_64__)
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) {
+            return simd_level_t::avx2;
+        }
+
+        if(__builtin_cpu_supports("sse4.1")) {
+            return simd_level_t::sse;
+        }
+
+        return simd_level_t::scalar;
+#elif defined(__aarch64__)
+        return simd_level_t::sse;
+#else
+        return simd_level_t::scalar;
+#endif
+    }
+
+    const simd_level_t simd_level = detect_simd_level();
+
+#ifdef HAS_SIMD_INTERSECT
+    // byte shuffles that pack the lanes set in a 4-bit match mask to the front of a 128-bit register
+    struct sse_shuffle_masks_t {
+        alignas(16) uint8_t masks[16][16];
+
+        sse_shuffle_masks_t() {
+            for(size_t mask = 0; mask < 16; mask++) {
+                size_t pos = 0;
+                for(size_t lane = 0; lane < 4; lane++) {
+                    if(mask & (1 << lane)) {
+                        for(size_t b = 0; b < 4; b++) {
+                            masks[mask][pos*4 + b] = lane*4 + b;
+                        }
+                        pos++;
+                    }
+                }
+
+                for(size_t b = pos*4; b < 16; b++) {
+                    masks[mask][b] = 0x80;
+                }
+            }
+        }
+    };
+
+    const sse_shuffle_masks_t sse_shuffle_masks;
+#endif
+
+#if defined(__x86_64__)
+    // lane permutations that pack the lanes set in an 8-bit match mask to the front of a 256-bit register
+    struct avx2_permutations_t {
+        alignas(32) uint32_t perms[256][8];
+
+        avx2_permutations_t() {
+            for(size_t mask = 0; mask < 256; mask++) {
+                size_t pos = 0;
+                for(size_t lane = 0; lane < 8; lane++) {
+                    if(mask & (1 << lane)) {
+                        perms[mask][pos++] = lane;
+                    }
+                }
+
+                while(pos < 8) {
+                    perms[mask][pos++] = 0;
+                }
+            }
+        }
+    };
+
+    const avx2_permutations_t avx2_permutations;
+#endif
+}
 
 size_t ArrayUtils::and_scalar(const uint32_t *A, const size_t lenA,
                               const uint32_t *B, const size_t lenB, uint32_t **results) {
@@ -8,7 +100,211 @@ size_t ArrayUtils::and_scalar(const uint32_t *A, const size_t lenA,
   }
 
   *results = new uint32_t[std::min(lenA, lenB)];
-  uint32_t *out = *results;
+  return intersect(A, lenA, B, lenB, *results);
+}
+
+bool ArrayUtils::has_sse_support() {
+    return simd_level != simd_level_t::scalar;
+}
+
+bool ArrayUtils::has_avx2_support() {
+    return simd_level == simd_level_t::avx2;
+}
+
+size_t ArrayUtils::intersect(const uint32_t *A, const size_t lenA,
+                             const uint32_t *B, const size_t lenB, uint32_t *out) {
+    if (lenA == 0 || lenB == 0) {
+        return 0;
+    }
+
+    if(lenA * GALLOPING_SIZE_RATIO < lenB) {
+        return intersect_galloping(A, lenA, B, lenB, out);
+    }
+
+    if(lenB * GALLOPING_SIZE_RATIO < lenA) {
+        return intersect_galloping(B, lenB, A, lenA, out);
+    }
+
+    switch (simd_level) {
+        case simd_level_t::avx2:
+            return intersect_avx2(A, lenA, B, lenB, out);
+        case simd_level_t::sse:
+            return intersect_sse(A, lenA, B, lenB, out);
+        default:
+            return intersect_scalar(A, lenA, B, lenB, out);
+    }
+}
+
+size_t ArrayUtils::intersect_galloping(const uint32_t *small, const size_t len_small,
+                                       const uint32_t *large, const size_t len_large, uint32_t *out) {
+    size_t num_found = 0;
+    size_t low = 0;
+
+    for(size_t i = 0; i < len_small && low < len_large; i++) {
+        const uint32_t target = small[i];
+
+        if(large[low] < target) {
+            // gallop ahead until we overshoot the target and then binary search within the last step
+            size_t step = 1;
+            size_t high = low + step;
+            while(high < len_large && large[high] < target) {
+                low = high;
+                step <<= 1;
+                high = low + step;
+            }
+
+            high = std::min(high + 1, len_large);
+            low = std::lower_bound(large + low + 1, large + high, target) - large;
+
+            if(low == len_large) {
+                break;
+            }
+        }
+
+        if(large[low] == target) {
+            out[num_found++] = target;
+            low++;
+        }
+    }
+
+    return num_found;
+}
+
+#ifdef HAS_SIMD_INTERSECT
+SIMD_TARGET_SSE
+static size_t intersect_sse_kernel(const uint32_t *A, const size_t lenA,
+                                   const uint32_t *B, const size_t lenB,
+                                   uint32_t *out, const size_t out_capacity) {
+    // full-width stores are done only when `out` has room for all lanes
+    const size_t vec_lenA = (lenA / 4) * 4;
+    const size_t vec_lenB = (lenB / 4) * 4;
+    size_t i = 0, j = 0, num_found = 0;
+
+    while(i < vec_lenA && j < vec_lenB) {
+        const __m128i va = _mm_loadu_si128((const __m128i*)(A + i));
+        const __m128i vb = _mm_loadu_si128((const __m128i*)(B + j));
+
+        // compare every lane of `va` against all 4 rotations of `vb`
+        const __m128i cmp0 = _mm_cmpeq_epi32(va, vb);
+        const __m128i cmp1 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)));
+        const __m128i cmp2 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2)));
+        const __m128i cmp3 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)));
+        const __m128i cmp = _mm_or_si128(_mm_or_si128(cmp0, cmp1), _mm_or_si128(cmp2, cmp3));
+
+        const int mask = _mm_movemask_ps(_mm_castsi128_ps(cmp));
+
+        if(mask != 0) {
+            const __m128i shuffle = _mm_load_si128((const __m128i*) sse_shuffle_masks.masks[mask]);
+            const __m128i packed = _mm_shuffle_epi8(va, shuffle);
+            const size_t num_matched = __builtin_popcount(mask);
+
+            if(num_found + 4 <= out_capacity) {
+                _mm_storeu_si128((__m128i*)(out + num_found), packed);
+            } else {
+                alignas(16) uint32_t packed_vals[4];
+                _mm_store_si128((__m128i*) packed_vals, packed);
+                memcpy(out + num_found, packed_vals, num_matched * sizeof(uint32_t));
+            }
+
+            num_found += num_matched;
+        }
+
+        const uint32_t a_max = A[i + 3];
+        const uint32_t b_max = B[j + 3];
+
+        if(a_max <= b_max) {
+            i += 4;
+        }
+
+        if(b_max <= a_max) {
+            j += 4;
+        }
+    }
+
+    return num_found + ArrayUtils::intersect_scalar(A + i, lenA - i, B + j, lenB - j, out + num_found);
+}
+#endif
+
+#if defined(__x86_64__)
+SIMD_TARGET_AVX2
+static size_t intersect_avx2_kernel(const uint32_t *A, const size_t lenA,
+                                    const uint32_t *B, const size_t lenB,
+                                    uint32_t *out, const size_t out_capacity) {
+    const size_t vec_lenA = (lenA / 8) * 8;
+    const size_t vec_lenB = (lenB / 8) * 8;
+    size_t i = 0, j = 0, num_found = 0;
+
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+
+    while(i < vec_lenA && j < vec_lenB) {
+        const __m256i va = _mm256_loadu_si256((const __m256i*)(A + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(B + j));
+
+        // compare every lane of `va` against all 8 rotations of `vb`
+        __m256i cmp = _mm256_cmpeq_epi32(va, vb);
+        for(size_t r = 1; r < 8; r++) {
+            vb = _mm256_permutevar8x32_epi32(vb, rotate);
+            cmp = _mm256_or_si256(cmp, _mm256_cmpeq_epi32(va, vb));
+        }
+
+        const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+
+        if(mask != 0) {
+            const __m256i perm = _mm256_load_si256((const __m256i*) avx2_permutations.perms[mask]);
+            const __m256i packed = _mm256_permutevar8x32_epi32(va, perm);
+            const size_t num_matched = __builtin_popcount(mask);
+
+            if(num_found + 8 <= out_capacity) {
+                _mm256_storeu_si256((__m256i*)(out + num_found), packed);
+            } else {
+                alignas(32) uint32_t packed_vals[8];
+                _mm256_store_si256((__m256i*) packed_vals, packed);
+                memcpy(out + num_found, packed_vals, num_matched * sizeof(uint32_t));
+            }
+
+            num_found += num_matched;
+        }
+
+        const uint32_t a_max = A[i + 7];
+        const uint32_t b_max = B[j + 7];
+
+        if(a_max <= b_max) {
+            i += 8;
+        }
+
+        if(b_max <= a_max) {
+            j += 8;
+        }
+    }
+
+    return num_found + intersect_sse_kernel(A + i, lenA - i, B + j, lenB - j,
+                                            out + num_found, out_capacity - num_found);
+}
+#endif
+
+size_t ArrayUtils::intersect_sse(const uint32_t *A, const size_t lenA,
+                                 const uint32_t *B, const size_t lenB, uint32_t *out) {
+#ifdef HAS_SIMD_INTERSECT
+    return intersect_sse_kernel(A, lenA, B, lenB, out, std::min(lenA, lenB));
+#else
+    return intersect_scalar(A, lenA, B, lenB, out);
+#endif
+}
+
+size_t ArrayUtils::intersect_avx2(const uint32_t *A, const size_t lenA,
+                                  const uint32_t *B, const size_t lenB, uint32_t *out) {
+#if defined(__x86_64__)
+    return intersect_avx2_kernel(A, lenA, B, lenB, out, std::min(lenA, lenB));
+#else
+    return intersect_sse(A, lenA, B, lenB, out);
+#endif
+}
+
+size_t ArrayUtils::intersect_scalar(const uint32_t *A, const size_t lenA,
+                                    const uint32_t *B, const size_t lenB, uint32_t *out) {
+  if (lenA == 0 || lenB == 0) {
+    return 0;
+  }
 
   const uint32_t *const initout(out);
   const uint32_t *endA = A + lenA;
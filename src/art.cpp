@@ -41,9 +41,10 @@
 
 enum recurse_progress { RECURSE, ABORT, ITERATE };
 
+template<class row_t>
 static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *n, int depth, const unsigned char *term,
-                              const int term_len, const int* irow, const int* jrow, const int min_cost,
-                              const int max_cost, const bool prefix, std::vector<const art_node *> &results);
+                              const int term_len, row_t row, const int min_cost, const int max_cost,
+                              const bool prefix, std::vector<const art_node *> &results);
 
 void art_int_fuzzy_recurse(art_node *n, int depth, const unsigned char* int_str, int int_str_len,
                            NUM_COMPARATOR comparator, std::vector<const art_leaf *> &results);
@@ -62,11 +63,15 @@ bool compare_art_node_frequency(const art_node *a, const art_node *b) {
     if(IS_LEAF(a)) {
         art_leaf* al = (art_leaf *) LEAF_RAW(a);
         a_value = posting_t::num_ids(al->values);
+    } else {
+        a_value = a->max_frequency;
     }
 
     if(IS_LEAF(b)) {
         art_leaf* bl = (art_leaf *) LEAF_RAW(b);
         b_value = posting_t::num_ids(bl->values);
+    } else {
+        b_value = b->max_frequency;
     }
 
     return a_value > b_value;
@@ -422,7 +427,7 @@ art_leaf* art_maximum(art_tree *t) {
 
 static void add_document_to_leaf(art_document *document, art_leaf *leaf) {
     leaf->max_score = MAX(leaf->max_score, document->score);
-    posting_t::upsert(leaf->values, document->id, document->offsets);
+    posting_t::upsert(leaf->values, document->id, document->offsets, document->score);
 
     if(document->score == USE_FREQUENCY_SCORE) {
         leaf->max_score = posting_t::num_ids(leaf->values);
@@ -443,7 +448,7 @@ static art_leaf* make_leaf(const unsigned char *key, uint32_t key_len, art_docum
         l->values = SET_COMPACT_POSTING(list);
     } else {
         posting_list_t* pl = new posting_list_t(posting_t::MAX_BLOCK_ELEMENTS);
-        pl->upsert(document->id, document->offsets);
+        pl->upsert(document->id, document->offsets, document->score);
         l->values = pl;
     }
 
@@ -465,15 +470,33 @@ static uint32_t longest_common_prefix(art_leaf *l1, art_leaf *l2, int depth) {
 static void copy_header(art_node *dest, art_node *src) {
     dest->num_children = src->num_children;
     dest->partial_len = src->partial_len;
+    dest->max_frequency = src->max_frequency;
     dest->max_score = src->max_score;
     memcpy(dest->partial, src->partial, min(MAX_PREFIX_LEN, src->partial_len));
 }
 
+static inline uint32_t child_max_frequency(const void *child) {
+    if(IS_LEAF(child)) {
+        return posting_t::num_ids(((art_leaf *) LEAF_RAW(child))->values);
+    }
+
+    return ((const art_node *) child)->max_frequency;
+}
+
+// raises the bounds of `n` to cover those of a child, which can be a leaf or a node
+static inline void add_child_bounds(art_node *n, const void *child) {
+    const int64_t child_max_score = IS_LEAF(child) ? ((art_leaf *) LEAF_RAW(child))->max_score :
+                                    ((const art_node *) child)->max_score;
+
+    n->max_score = MAX(n->max_score, child_max_score);
+    n->max_frequency = MAX(n->max_frequency, child_max_frequency(child));
+}
+
 static void add_child256(art_node256 *n, art_node **ref, unsigned char c, void *child) {
     (void)ref;
     n->n.num_children++;
     n->children[c] = (art_node *) child;
-    n->n.max_score = MAX(n->n.max_score, ((art_leaf *) LEAF_RAW(child))->max_score);
+    add_child_bounds(&n->n, child);
 }
 
 static void add_child48(art_node48 *n, art_node **ref, unsigned char c, void *child) {
@@ -483,7 +506,7 @@ static void add_child48(art_node48 *n, art_node **ref, unsigned char c, void *ch
         n->children[pos] = (art_node *) child;
         n->keys[c] = pos + 1;
         n->n.num_children++;
-        n->n.max_score = MAX(n->n.max_score, ((art_leaf *) LEAF_RAW(child))->max_score);
+        add_child_bounds(&n->n, child);
     } else {
         art_node256 *new_n = (art_node256*)alloc_node(NODE256);
         for (int i=0;i<256;i++) {
@@ -524,7 +547,7 @@ static void add_child16(art_node16 *n, art_node **ref, unsigned char c, void *ch
         n->keys[idx] = c;
         n->children[idx] = (art_node *) child;
         n->n.num_children++;
-        n->n.max_score = MAX(n->n.max_score, ((art_leaf *) LEAF_RAW(child))->max_score);
+        add_child_bounds(&n->n, child);
 
     } else {
         art_node48 *new_n = (art_node48*)alloc_node(NODE48);
@@ -557,7 +580,7 @@ static void add_child4(art_node4 *n, art_node **ref, unsigned char c, void *chil
         n->keys[idx] = c;
         n->children[idx] = (art_node *) child;
         n->n.num_children++;
-        n->n.max_score = MAX(n->n.max_score, ((art_leaf *) LEAF_RAW(child))->max_score);
+        add_child_bounds(&n->n, child);
 
     } else {
         art_node16 *new_n = (art_node16*)alloc_node(NODE16);
@@ -710,7 +733,12 @@ static void* recursive_insert(art_node* n, art_node** ref, const unsigned char*
     // Find a child to recurse to
     art_node **child = find_child(n, key[depth]);
     if (child) {
-        return recursive_insert(*child, child, key, key_len, docs_max_score, documents, depth + 1, path, old);
+        void* old_values = recursive_insert(*child, child, key, key_len, docs_max_score, documents, depth + 1,
+                                            path, old);
+
+        // the leaf below could have gained IDs
+        n->max_frequency = MAX(n->max_frequency, child_max_frequency(*child));
+        return old_values;
     }
 
     // No child, node goes within us
@@ -940,12 +968,17 @@ void* art_delete(art_tree *t, const unsigned char *key, int key_len) {
     return child->max_token_count;
 }*/
 
-int art_topk_iter(const art_node *root, token_ordering token_order, size_t max_results,
+/*
+    Best-first walk of the subtrees under `roots`: nodes are expanded in decreasing order of the bound they hold on
+    the scores (or number of IDs, for FREQUENCY) of their leaves, so that leaves are reached in decreasing order and
+    the walk stops once `max_results` of them are taken, without enumerating the rest of the subtrees.
+*/
+int art_topk_iter(const std::vector<const art_node*>& roots, token_ordering token_order, size_t max_results,
                   const uint32_t* filter_ids, size_t filter_ids_length,
                   const std::set<std::string>& exclude_leaves, const art_leaf* exact_leaf,
                   std::vector<art_leaf *>& results) {
 
-    printf("INSIDE art_topk_iter: root->type: %d\n", root->type);
+    printf("INSIDE art_topk_iter: roots: %zu\n", roots.size());
 
     std::priority_queue<const art_node *, std::vector<const art_node *>,
             decltype(&compare_art_node_score_pq)> q(compare_art_node_score_pq);
@@ -955,9 +988,11 @@ int art_topk_iter(const art_node *root, token_ordering token_order, size_t max_r
                 decltype(&compare_art_node_frequency_pq)>(compare_art_node_frequency_pq);
     }
 
-    q.push(root);
+    for(const art_node* root: roots) {
+        q.push(root);
+    }
 
-    while(!q.empty() && results.size() < max_results*4) {
+    while(!q.empty() && results.size() < max_results) {
         art_node *n = (art_node *) q.top();
         q.pop();
 
@@ -1209,12 +1244,6 @@ void print_row(const int* row, const int row_len) {
     printf("\n");
 }
 
-static inline void copyIntArray2(const int *src, int *dest, const int len) {
-    for(int t=0; t<len; t++) {
-        dest[t] = src[t];
-    }
-}
-
 static inline void levenshtein_dist(const int depth, const unsigned char p, const unsigned char c,
                                     const unsigned char* term, const int term_len,
                                     const int* irow, const int* jrow, int* krow) {
@@ -1238,8 +1267,103 @@ static inline void levenshtein_dist(const int depth, const unsigned char p, cons
     }
 }
 
-static inline void art_fuzzy_children(unsigned char p, const art_node *n, int depth, const unsigned char *term, const int term_len,
-                                      const int* irow, const int* jrow, const int min_cost, const int max_cost,
+/*
+    Levenshtein row of the term against the key characters walked so far, one cell per term prefix, computed by
+    `levenshtein_dist()`. Used for terms that are too long for `fuzzy_bit_row_t`.
+
+    The rows of every depth are held back to back in one buffer, which is shared by the copies of the row that are
+    handed down the recursion: a copy is only a position in the buffer, and it writes only the rows past its own,
+    which belong to the subtree that it walks. So no row is allocated or copied per node.
+*/
+struct fuzzy_dp_row_t {
+    const unsigned char* term;
+    int term_len;
+
+    std::vector<int>& rows;
+
+    // index of the current row: the one before it is needed for transpositions
+    size_t row_index = 1;
+
+    fuzzy_dp_row_t(const unsigned char* term, const int term_len, std::vector<int>& rows):
+                   term(term), term_len(term_len), rows(rows) {
+        rows.resize(2 * (term_len + 1));
+        for (int i = 0; i <= term_len; i++){
+            rows[i] = rows[term_len + 1 + i] = i;
+        }
+    }
+
+    void advance(const int depth, const unsigned char p, const unsigned char c) {
+        const size_t row_len = term_len + 1;
+        if(rows.size() < (row_index + 2) * row_len) {
+            rows.resize((row_index + 2) * row_len);
+        }
+
+        int* irow = rows.data() + (row_index - 1) * row_len;
+        levenshtein_dist(depth, p, c, term, term_len, irow, irow + row_len, irow + 2 * row_len);
+        row_index++;
+    }
+
+    [[nodiscard]] int cost(const int column) const {
+        return rows[row_index * (term_len + 1) + column];
+    }
+};
+
+/*
+    The same row, for terms of up to 64 characters, held as the differences between adjacent cells in two bit
+    vectors (Myers' algorithm, with Hyyrö's extension for transpositions). Advancing the row by a key character
+    takes a lookup of the character's match mask and a few word operations, however long the term is, and a cell
+    is read back with two popcounts.
+*/
+struct fuzzy_bit_row_t {
+    static constexpr int MAX_TERM_LEN = 64;
+
+    // bit `j` of `match_masks[ch]` is set when `term[j] == ch`
+    const uint64_t* match_masks;
+
+    // bit `j` set: cell `j+1` is one more / one less than cell `j`
+    uint64_t pos_deltas = ~uint64_t(0);
+    uint64_t neg_deltas = 0;
+
+    // bit `j` set: cell `j+1` is equal to cell `j` of the previous row
+    uint64_t zero_diagonals = 0;
+
+    // cell 0: the number of key characters walked
+    int base = 0;
+
+    explicit fuzzy_bit_row_t(const uint64_t* match_masks): match_masks(match_masks) {
+
+    }
+
+    void advance(const int depth, const unsigned char p, const unsigned char c) {
+        uint64_t matches = match_masks[c];
+
+        // transposition of `p` and `c`, under the same condition as `levenshtein_dist()`
+        if(depth > 1) {
+            matches |= (((~zero_diagonals) & matches) << 1) & match_masks[p];
+        }
+
+        const uint64_t diagonals = (((matches & pos_deltas) + pos_deltas) ^ pos_deltas) | matches | neg_deltas;
+        const uint64_t pos_vertical = neg_deltas | ~(diagonals | pos_deltas);
+        const uint64_t neg_vertical = pos_deltas & diagonals;
+
+        // cell 0 grows by one with every key character
+        const uint64_t shifted_pos_vertical = (pos_vertical << 1) | 1;
+
+        neg_deltas = shifted_pos_vertical & diagonals;
+        pos_deltas = (neg_vertical << 1) | ~(diagonals | shifted_pos_vertical);
+        zero_diagonals = diagonals;
+        base++;
+    }
+
+    [[nodiscard]] int cost(const int column) const {
+        const uint64_t mask = (column == MAX_TERM_LEN) ? ~uint64_t(0) : ((uint64_t(1) << column) - 1);
+        return base + __builtin_popcountll(pos_deltas & mask) - __builtin_popcountll(neg_deltas & mask);
+    }
+};
+
+template<class row_t>
+static inline void art_fuzzy_children(unsigned char p, const art_node *n, int depth, const unsigned char *term,
+                                      const int term_len, const row_t& row, const int min_cost, const int max_cost,
                                       const bool prefix, std::vector<const art_node *> &results) {
     char child_char;
     art_node* child;
@@ -1251,7 +1375,7 @@ static inline void art_fuzzy_children(unsigned char p, const art_node *n, int de
                 child_char = ((art_node4*)n)->keys[i];
                 printf("4!child_char: %c, %d, depth: %d\n", child_char, child_char, depth);
                 child = ((art_node4*)n)->children[i];
-                art_fuzzy_recurse(p, child_char, child, depth, term, term_len, irow, jrow, min_cost, max_cost, prefix, results);
+                art_fuzzy_recurse(p, child_char, child, depth, term, term_len, row, min_cost, max_cost, prefix, results);
             }
             break;
         case NODE16:
@@ -1260,7 +1384,7 @@ static inline void art_fuzzy_children(unsigned char p, const art_node *n, int de
                 child_char = ((art_node16*)n)->keys[i];
                 printf("16!child_char: %c, depth: %d\n", child_char, depth);
                 child = ((art_node16*)n)->children[i];
-                art_fuzzy_recurse(p, child_char, child, depth, term, term_len, irow, jrow, min_cost, max_cost, prefix, results);
+                art_fuzzy_recurse(p, child_char, child, depth, term, term_len, row, min_cost, max_cost, prefix, results);
             }
             break;
         case NODE48:
@@ -1271,7 +1395,7 @@ static inline void art_fuzzy_children(unsigned char p, const art_node *n, int de
                 child = ((art_node48*)n)->children[ix - 1];
                 child_char = (char)i;
                 printf("48!child_char: %c, depth: %d, ix: %d\n", child_char, depth, ix);
-                art_fuzzy_recurse(p, child_char, child, depth, term, term_len, irow, jrow, min_cost, max_cost, prefix, results);
+                art_fuzzy_recurse(p, child_char, child, depth, term, term_len, row, min_cost, max_cost, prefix, results);
             }
             break;
         case NODE256:
@@ -1281,7 +1405,7 @@ static inline void art_fuzzy_children(unsigned char p, const art_node *n, int de
                 child_char = (char) i;
                 printf("256!child_char: %c, depth: %d\n", child_char, depth);
                 child = ((art_node256*)n)->children[i];
-                art_fuzzy_recurse(p, child_char, child, depth, term, term_len, irow, jrow, min_cost, max_cost, prefix, results);
+                art_fuzzy_recurse(p, child_char, child, depth, term, term_len, row, min_cost, max_cost, prefix, results);
             }
             break;
         default:
@@ -1289,16 +1413,10 @@ static inline void art_fuzzy_children(unsigned char p, const art_node *n, int de
     }
 }
 
-static inline void rotate(int &i, int &j, int &k) {
-    int old_i = i;
-    i = j;
-    j = k;
-    k = old_i;
-}
-
 // -1: return without adding, 0 : continue iteration, 1: return after adding
+template<class row_t>
 static inline int fuzzy_search_state(const bool prefix, int key_index, bool last_key_char,
-                                     int term_len, const int* cost_row, int min_cost, int max_cost) {
+                                     int term_len, const row_t& cost_row, int min_cost, int max_cost) {
 
     // a) iter_len < term_len: "pltninum" (term) on "pst" (key)
     // b) term_len < iter_len: "pst" (term) on "pltninum" (key)
@@ -1308,13 +1426,13 @@ static inline int fuzzy_search_state(const bool prefix, int key_index, bool last
     // a) because key's null character will appear first
     if(last_key_char) {
         int key_len = key_index;
-        cost = cost_row[term_len];
+        cost = cost_row.cost(term_len);
 
         if(cost >= min_cost && cost <= max_cost) {
             return 1;
         }
 
-        cost = cost_row[key_len];
+        cost = cost_row.cost(key_len);
 
         // used to match q=strawberries on key=strawberry, but limit to larger keys to prevent eager matches
         if(key_len > 5 && term_len > key_len && (term_len - key_len) <= max_cost &&
@@ -1329,35 +1447,26 @@ static inline int fuzzy_search_state(const bool prefix, int key_index, bool last
 
     // b) we might iterate past term_len to catch trailing typos
     if(key_len >= term_len && prefix) {
-        cost = cost_row[term_len];
+        cost = cost_row.cost(term_len);
         if(cost >= min_cost && cost <= max_cost) {
             return 1;
         }
     } else {
         // `key_len` can't exceed `term_len` since length of `cost_row` is `term_len + 1`
-        cost = cost_row[std::min(key_len, term_len)];
+        cost = cost_row.cost(std::min(key_len, term_len));
     }
 
     int bounded_cost = (max_cost == 0) ? max_cost : (max_cost + 1);
     return (cost > bounded_cost) ? -1 : 0;
 }
 
+template<class row_t>
 static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *n, int depth, const unsigned char *term,
-                              const int term_len, const int* irow, const int* jrow, const int min_cost,
-                              const int max_cost, const bool prefix, std::vector<const art_node *> &results) {
+                              const int term_len, row_t row, const int min_cost, const int max_cost,
+                              const bool prefix, std::vector<const art_node *> &results) {
 
     if (!n) return ;
 
-    const int columns = term_len+1;
-    int i=0, j=1, k=2;
-    int row0[columns];
-    int row1[columns];
-    int row2[columns];
-    int* rows[3] = {row0, row1, row2};
-
-    copyIntArray2(irow, rows[i], columns);
-    copyIntArray2(jrow, rows[j], columns);
-
     if(depth == -1) {
         // root node
         depth = 0;
@@ -1366,12 +1475,11 @@ static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *
         bool last_key_char = (c == '\0');
 
         if(!prefix || !last_key_char) {
-            levenshtein_dist(depth, p, c, term, term_len, rows[i], rows[j], rows[k]);
-            rotate(i, j, k);
+            row.advance(depth, p, c);
             p = c;
         }
 
-        int action = fuzzy_search_state(prefix, depth, last_key_char, term_len, rows[j], min_cost, max_cost);
+        int action = fuzzy_search_state(prefix, depth, last_key_char, term_len, row, min_cost, max_cost);
         if(1 == action) {
             results.push_back(n);
             return;
@@ -1399,7 +1507,7 @@ static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *
 
         if(depth >= iter_len) {
             // when a preceding partial node completely contains the whole leaf (e.g. "[raspberr]y" on "raspberries")
-            int action = fuzzy_search_state(prefix, depth, true, term_len, rows[j], min_cost, max_cost);
+            int action = fuzzy_search_state(prefix, depth, true, term_len, row, min_cost, max_cost);
             if(action == 1) {
                 results.push_back(n);
             }
@@ -1413,16 +1521,15 @@ static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *
             bool last_key_char = (c == '\0');
 
             if(!prefix || !last_key_char) {
-                levenshtein_dist(depth, p, c, term, term_len, rows[i], rows[j], rows[k]);
+                row.advance(depth, p, c);
 
                 printf("leaf char: %c\n", l->key[depth]);
                 printf("cost: %d, depth: %d, term_len: %d\n", temp_cost, depth, term_len);
 
-                rotate(i, j, k);
                 p = c;
             }
 
-            int action = fuzzy_search_state(prefix, depth, last_key_char, term_len, rows[j], min_cost, max_cost);
+            int action = fuzzy_search_state(prefix, depth, last_key_char, term_len, row, min_cost, max_cost);
             if(action == 1) {
                 results.push_back(n);
                 return;
@@ -1446,11 +1553,10 @@ static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *
     for (int idx = 0; idx < partial_len; idx++) {
         c = n->partial[idx];
 
-        levenshtein_dist(depth, p, c, term, term_len, rows[i], rows[j], rows[k]);
-        rotate(i, j, k);
+        row.advance(depth, p, c);
         p = c;
 
-        int action = fuzzy_search_state(prefix, depth, false, term_len, rows[j], min_cost, max_cost);
+        int action = fuzzy_search_state(prefix, depth, false, term_len, row, min_cost, max_cost);
         if(action == 1) {
             results.push_back(n);
             return;
@@ -1466,11 +1572,10 @@ static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *
     // Some intermediate path may have been left out if partial_len is truncated: progress the levenshtein matrix
     while(partial_len < n->partial_len && depth < term_len) {
         c = term[depth];
-        levenshtein_dist(depth, p, c, term, term_len, rows[i], rows[j], rows[k]);
-        rotate(i, j, k);
+        row.advance(depth, p, c);
         p = c;
 
-        int action = fuzzy_search_state(prefix, depth, false, term_len, rows[j], min_cost, max_cost);
+        int action = fuzzy_search_state(prefix, depth, false, term_len, row, min_cost, max_cost);
         if(action == 1) {
             results.push_back(n);
             return;
@@ -1484,7 +1589,20 @@ static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *
         partial_len++;
     }
 
-    art_fuzzy_children(c, n, depth, term, term_len, rows[i], rows[j], min_cost, max_cost, prefix, results);
+    art_fuzzy_children(c, n, depth, term, term_len, row, min_cost, max_cost, prefix, results);
+}
+
+template<class row_t>
+static void art_fuzzy_root(const art_tree *t, const unsigned char *term, const int term_len, const row_t& row,
+                           const int min_cost, const int max_cost, const bool prefix,
+                           std::vector<const art_node *> &results) {
+    if(IS_LEAF(t->root)) {
+        art_leaf *l = (art_leaf *) LEAF_RAW(t->root);
+        art_fuzzy_recurse(0, l->key[0], t->root, 0, term, term_len, row, min_cost, max_cost, prefix, results);
+    } else {
+        // send depth as -1 to indicate that this is a root node
+        art_fuzzy_recurse(0, 0, t->root, -1, term, term_len, row, min_cost, max_cost, prefix, results);
+    }
 }
 
 /**
@@ -1496,24 +1614,25 @@ int art_fuzzy_search(art_tree *t, const unsigned char *term, const int term_len,
                      std::vector<art_leaf *> &results, const std::set<std::string>& exclude_leaves) {
 
     std::vector<const art_node*> nodes;
-    int irow[term_len + 1];
-    int jrow[term_len + 1];
-    for (int i = 0; i <= term_len; i++){
-        irow[i] = jrow[i] = i;
-    }
 
     //auto begin = std::chrono::high_resolution_clock::now();
 
-    if(IS_LEAF(t->root)) {
-        art_leaf *l = (art_leaf *) LEAF_RAW(t->root);
-        art_fuzzy_recurse(0, l->key[0], t->root, 0, term, term_len, irow, jrow, min_cost, max_cost, prefix, nodes);
-    } else {
-        if(t->root == nullptr) {
-            return 0;
+    if(t->root == nullptr) {
+        return 0;
+    }
+
+    if(term_len <= fuzzy_bit_row_t::MAX_TERM_LEN) {
+        uint64_t match_masks[256] = {0};
+        for(int i = 0; i < term_len; i++) {
+            match_masks[term[i]] |= (uint64_t(1) << i);
         }
 
-        // send depth as -1 to indicate that this is a root node
-        art_fuzzy_recurse(0, 0, t->root, -1, term, term_len, irow, jrow, min_cost, max_cost, prefix, nodes);
+        art_fuzzy_root(t, term, term_len, fuzzy_bit_row_t(match_masks), min_cost, max_cost, prefix, nodes);
+    } else {
+        // rows of the depths that a match can reach, past which the buffer rarely grows
+        std::vector<int> dp_rows;
+        dp_rows.reserve(size_t(term_len + max_cost + 2) * (term_len + 1));
+        art_fuzzy_root(t, term, term_len, fuzzy_dp_row_t(term, term_len, dp_rows), min_cost, max_cost, prefix, nodes);
     }
 
     //long long int time_micro = microseconds(std::chrono::high_resolution_clock::now() - begin).count();
@@ -1525,9 +1644,7 @@ int art_fuzzy_search(art_tree *t, const unsigned char *term, const int term_len,
     art_leaf* exact_leaf = (art_leaf *) art_search(t, term, key_len);
     //LOG(INFO) << "exact_leaf: " << exact_leaf << ", term: " << term << ", term_len: " << term_len;
 
-    for(auto node: nodes) {
-        art_topk_iter(node, token_order, max_words, filter_ids, filter_ids_length, exclude_leaves, exact_leaf, results);
-    }
+    art_topk_iter(nodes, token_order, max_words, filter_ids, filter_ids_length, exclude_leaves, exact_leaf, results);
 
     if(token_order == FREQUENCY) {
         std::sort(results.begin(), results.end(), compare_art_leaf_frequency);
@@ -16,6 +16,8 @@
 #include "logger.h"
 #include "thread_local_vars.h"
 #include "vector_query_ops.h"
+#include "document_cache.h"
+#include "search_response_cache.h"
 
 const std::string override_t::MATCH_EXACT = "exact";
 const std::string override_t::MATCH_CONTAINS = "contains";
@@ -34,6 +36,32 @@ struct sort_fields_guard_t {
     }
 };
 
+// deep copy of a filter tree, which the caller owns
+static filter_node_t* copy_filter_tree(const filter_node_t* root) {
+    if(root == nullptr) {
+        return nullptr;
+    }
+
+    if(!root->isOperator) {
+        return new filter_node_t(root->filter_exp);
+    }
+
+    return new filter_node_t(root->filter_operator, copy_filter_tree(root->left), copy_filter_tree(root->right));
+}
+
+// `id` filters are parsed into the sequence IDs of the documents, which change with writes to the collection
+static bool filters_on_doc_ids(const filter_node_t* root) {
+    if(root == nullptr) {
+        return false;
+    }
+
+    if(root->isOperator) {
+        return filters_on_doc_ids(root->left) || filters_on_doc_ids(root->right);
+    }
+
+    return root->filter_exp.field_name == "id";
+}
+
 Collection::Collection(const std::string& name, const uint32_t collection_id, const uint64_t created_at,
                        const uint32_t next_seq_id, Store *store, const std::vector<field> &fields,
                        const std::string& default_sorting_field,
@@ -285,6 +313,7 @@ nlohmann::json Collection::add_many(std::vector<std::string>& json_lines, nlohma
                             record.index_failure(persist_op.code(), persist_op.error());
                         } else {
                             index->refresh_schemas(new_fields, {});
+                            schema_version++;
                         }
                     }
                 }
@@ -389,6 +418,11 @@ void Collection::batch_index(std::vector<index_record>& index_records, std::vect
             res["code"] = index_record.indexed.code();
         }
 
+        if(index_record.is_update) {
+            // after the store is written, so that the previous version is not cached again
+            DocumentCache::get_instance().invalidate(DocumentCache::get_key(collection_id, index_record.seq_id));
+        }
+
         json_out[index_record.position] = res.dump(-1, ' ', false,
                                                    nlohmann::detail::error_handler_t::ignore);
     }
@@ -414,6 +448,7 @@ Option<uint32_t> Collection::index_in_memory(nlohmann::json &document, uint32_t
                               fallback_field_type, token_separators, symbols_to_index, true);
 
     num_documents += 1;
+    SearchResponseCache::get_instance().invalidate(name);
     return Option<>(200);
 }
 
@@ -423,6 +458,7 @@ size_t Collection::batch_index_in_memory(std::vector<index_record>& index_record
                                                    search_schema, fallback_field_type,
                                                    token_separators, symbols_to_index, true);
     num_documents += num_indexed;
+    SearchResponseCache::get_instance().invalidate(name);
     return num_indexed;
 }
 
@@ -780,6 +816,64 @@ Option<bool> Collection::validate_and_standardize_sort_fields(const std::vector<
     return Option<bool>(true);
 }
 
+Option<bool> Collection::get_filter_tree(const std::string& filter_query, const std::string& doc_id_prefix,
+                                         std::shared_ptr<const filter_node_t>& filter_tree) const {
+    filter_tree = filter_plan_cache.get(filter_query, schema_version);
+    if(filter_tree != nullptr) {
+        return Option<bool>(true);
+    }
+
+    filter_node_t* filter_tree_root = nullptr;
+    Option<bool> parse_filter_op = filter::parse_filter_query(filter_query, search_schema,
+                                                              store, doc_id_prefix, filter_tree_root);
+    if(!parse_filter_op.ok()) {
+        return parse_filter_op;
+    }
+
+    filter_tree.reset(filter_tree_root);
+
+    if(filter_tree_root != nullptr && !filters_on_doc_ids(filter_tree_root)) {
+        filter_plan_cache.put(filter_query, schema_version, filter_tree);
+    }
+
+    return Option<bool>(true);
+}
+
+Option<bool> Collection::get_sort_plan(const std::vector<sort_by>& sort_fields, bool is_wildcard_query,
+                                       std::shared_ptr<const sort_plan_t>& sort_plan) const {
+    // the default sort fields depend on whether the query is a wildcard one
+    std::string key(1, is_wildcard_query ? '*' : ' ');
+    for(const sort_by& sort_field: sort_fields) {
+        key += sort_field.name;
+        key += '\0';
+        key += sort_field.order;
+        key += '\0';
+    }
+
+    sort_plan = sort_plan_cache.get(key, schema_version);
+    if(sort_plan != nullptr) {
+        return Option<bool>(true);
+    }
+
+    auto new_sort_plan = std::make_shared<sort_plan_t>();
+    auto sort_validation_op = validate_and_standardize_sort_fields(sort_fields, new_sort_plan->sort_fields_std,
+                                                                   is_wildcard_query);
+    if(!sort_validation_op.ok()) {
+        return sort_validation_op;
+    }
+
+    sort_plan = new_sort_plan;
+
+    for(const sort_by& sort_field: new_sort_plan->sort_fields_std) {
+        if(filters_on_doc_ids(sort_field.eval.filter_tree_root)) {
+            return Option<bool>(true);
+        }
+    }
+
+    sort_plan_cache.put(key, schema_version, sort_plan);
+    return Option<bool>(true);
+}
+
 Option<bool> Collection::extract_field_name(const std::string& field_name,
                                             const tsl::htrie_map<char, field>& search_schema,
                                             std::vector<std::string>& processed_search_fields,
@@ -864,7 +958,10 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
                                   const std::string& vector_query_str,
                                   const bool enable_highlight_v1,
                                   const uint64_t search_time_start_us,
-                                  const text_match_type_t match_type) const {
+                                  const text_match_type_t match_type,
+                                  const size_t facet_sample_percent,
+                                  const size_t facet_sample_threshold,
+                                  const bool facet_approximate_group_counts) const {
 
     std::shared_lock lock(mutex);
 
@@ -890,6 +987,10 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
                                       std::to_string(GROUP_LIMIT_MAX) + ".");
     }
 
+    if(facet_sample_percent == 0 || facet_sample_percent > 100) {
+        return Option<nlohmann::json>(400, "Value of `facet_sample_percent` must be between 1 and 100.");
+    }
+
     if(!raw_search_fields.empty() && raw_search_fields.size() != num_typos.size()) {
         if(num_typos.size() != 1) {
             return Option<nlohmann::json>(400, "Number of values in `num_typos` does not match "
@@ -1027,13 +1128,14 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
     std::vector<facet> facets;
 
     const std::string doc_id_prefix = std::to_string(collection_id) + "_" + DOC_ID_PREFIX + "_";
-    filter_node_t* filter_tree_root = nullptr;
-    Option<bool> parse_filter_op = filter::parse_filter_query(filter_query, search_schema,
-                                                              store, doc_id_prefix, filter_tree_root);
+    std::shared_ptr<const filter_node_t> filter_tree;
+    Option<bool> parse_filter_op = get_filter_tree(filter_query, doc_id_prefix, filter_tree);
     if(!parse_filter_op.ok()) {
         return Option<nlohmann::json>(parse_filter_op.code(), parse_filter_op.error());
     }
 
+    const filter_node_t* filter_tree_root = filter_tree.get();
+
     // validate facet fields
     for(const std::string & field_name: facet_fields) {
         if(search_schema.count(field_name) == 0 || !search_schema.at(field_name).facet) {
@@ -1041,6 +1143,7 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
             return Option<nlohmann::json>(404, error);
         }
         facets.emplace_back(field_name);
+        facets.back().approximate_group_counts = facet_approximate_group_counts;
     }
 
     // parse facet query
@@ -1179,8 +1282,11 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
 
     bool is_wildcard_query = (query == "*");
 
+    // holds the filter trees of eval expressions through the search
+    std::shared_ptr<const sort_plan_t> sort_plan;
+
     if(curated_sort_by.empty()) {
-        auto sort_validation_op = validate_and_standardize_sort_fields(sort_fields, sort_fields_std, is_wildcard_query);
+        auto sort_validation_op = get_sort_plan(sort_fields, is_wildcard_query, sort_plan);
         if(!sort_validation_op.ok()) {
             return Option<nlohmann::json>(sort_validation_op.code(), sort_validation_op.error());
         }
@@ -1191,13 +1297,14 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
             return Option<nlohmann::json>(400, "Parameter `sort_by` is malformed.");
         }
 
-        auto sort_validation_op = validate_and_standardize_sort_fields(curated_sort_fields, sort_fields_std,
-                                                                       is_wildcard_query);
+        auto sort_validation_op = get_sort_plan(curated_sort_fields, is_wildcard_query, sort_plan);
         if(!sort_validation_op.ok()) {
             return Option<nlohmann::json>(sort_validation_op.code(), sort_validation_op.error());
         }
     }
 
+    sort_fields_std = sort_plan->sort_fields_std;
+
     // apply bucketing on text match score
     int match_score_index = -1;
     for(size_t i = 0; i < sort_fields_std.size(); i++) {
@@ -1234,9 +1341,18 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
         // process filter overrides first, before synonyms (order is important)
 
         // included_ids, excluded_ids
-        process_filter_overrides(filter_overrides, q_include_tokens, token_order, filter_tree_root,
+
+        // overrides add to the filter tree, which is shared with other searches once it is cached
+        filter_node_t* overridden_filter_tree_root = filter_overrides.empty() ? nullptr :
+                                                     copy_filter_tree(filter_tree_root);
+        process_filter_overrides(filter_overrides, q_include_tokens, token_order, overridden_filter_tree_root,
                                  included_ids, excluded_ids);
 
+        if(overridden_filter_tree_root != nullptr) {
+            filter_tree.reset(overridden_filter_tree_root);
+            filter_tree_root = overridden_filter_tree_root;
+        }
+
         for(size_t i = 0; i < q_include_tokens.size(); i++) {
             auto& q_include_token = q_include_tokens[i];
             q_tokens.push_back(q_include_token);
@@ -1271,6 +1387,7 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
                                                  search_stop_millis,
                                                  min_len_1typo, min_len_2typo, max_candidates, infixes,
                                                  max_extra_prefix, max_extra_suffix, facet_query_num_typos,
+                                                 facet_sample_percent, facet_sample_threshold,
                                                  filter_curated_hits, split_join_tokens, vector_query);
 
     index->run_search(search_params);
@@ -1290,7 +1407,9 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
     if(group_limit) {
         for(auto& acc_facet: facets) {
             for(auto& facet_kv: acc_facet.result_map) {
-                facet_kv.second.count = acc_facet.hash_groups[facet_kv.first].size();
+                const distinct_counter_t& groups = acc_facet.hash_groups[facet_kv.first];
+                facet_kv.second.count = groups.count();
+                acc_facet.group_counts_estimated = acc_facet.group_counts_estimated || !groups.is_exact();
             }
         }
 
@@ -1442,6 +1561,19 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
         index_symbols[uint8_t(c)] = 1;
     }
 
+    // documents of all the hits of the page are fetched together
+    std::vector<uint32_t> hit_seq_ids;
+    for(long result_kvs_index = start_result_index; result_kvs_index <= end_result_index; result_kvs_index++) {
+        for(const KV* kv: result_group_kvs[result_kvs_index]) {
+            hit_seq_ids.push_back((uint32_t) kv->key);
+        }
+    }
+
+    std::vector<nlohmann::json> hit_documents;
+    std::vector<Option<bool>> hit_document_ops;
+    get_documents_from_store(hit_seq_ids, hit_documents, hit_document_ops);
+    size_t hit_index = 0;
+
     // construct results array
     for(long result_kvs_index = start_result_index; result_kvs_index <= end_result_index; result_kvs_index++) {
         const std::vector<KV*> & kv_group = result_group_kvs[result_kvs_index];
@@ -1455,10 +1587,9 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
         nlohmann::json group_key = nlohmann::json::array();
 
         for(const KV* field_order_kv: kv_group) {
-            const std::string& seq_id_key = get_seq_id_key((uint32_t) field_order_kv->key);
-
-            nlohmann::json document;
-            const Option<bool> & document_op = get_document_from_store(seq_id_key, document);
+            nlohmann::json& document = hit_documents[hit_index];
+            const Option<bool> & document_op = hit_document_ops[hit_index];
+            hit_index++;
 
             if(!document_op.ok()) {
                 LOG(ERROR) << "Document fetch error. " << document_op.error();
@@ -1662,25 +1793,20 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
 
         std::vector<facet_value_t> facet_values;
 
+        // remap facet value hashes with actual strings
+        std::vector<std::string> hash_values;
+        std::vector<bool> hash_values_found;
+        index->get_facet_values(a_facet.field_name, facet_hash_counts, max_facets, hash_values, hash_values_found);
+
         for(size_t fi = 0; fi < max_facets; fi++) {
-            // remap facet value hash with actual string
             auto & kv = facet_hash_counts[fi];
             auto & facet_count = kv.second;
 
-            // fetch actual facet value from representative doc id
-            const std::string& seq_id_key = get_seq_id_key((uint32_t) facet_count.doc_id);
-            nlohmann::json document;
-            const Option<bool> & document_op = get_document_from_store(seq_id_key, document);
-
-            if(!document_op.ok()) {
-                LOG(ERROR) << "Facet fetch error. " << document_op.error();
-                continue;
-            }
-
-            std::string value;
-            bool facet_found = facet_value_to_string(a_facet, facet_count, document, value);
+            std::string value = std::move(hash_values[fi]);
 
-            if(!facet_found) {
+            if(!hash_values_found[fi]) {
+                LOG(ERROR) << "Could not find value of facet hash " << kv.first << " for facet field "
+                           << a_facet.field_name;
                 continue;
             }
 
@@ -1795,15 +1921,22 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
             facet_result["stats"]["avg"] = (a_facet.stats.fvsum / a_facet.stats.fvcount);
         }
 
-        facet_result["stats"]["total_values"] = facet_hash_counts.size();
+        facet_result["stats"]["total_values"] = a_facet.total_values;
+
+        if(a_facet.sampled) {
+            facet_result["sampled"] = true;
+        }
+
+        if(a_facet.group_counts_estimated) {
+            facet_result["group_counts_approximate"] = true;
+        }
+
         result["facet_counts"].push_back(facet_result);
     }
 
     // free search params
     delete search_params;
 
-    delete filter_tree_root;
-
     result["search_cutoff"] = search_cutoff;
 
     result["request_params"] = nlohmann::json::object();
@@ -2214,10 +2347,9 @@ void Collection::populate_result_kvs(Topster *topster, std::vector<std::vector<K
         // we have to pick top-K groups
         Topster gtopster(topster->MAX_SIZE);
 
-        for(auto& group_topster: topster->group_kv_map) {
-            group_topster.second->sort();
-            if(group_topster.second->size != 0) {
-                KV* kv_head = group_topster.second->getKV(0);
+        for(uint32_t group = 0; group < topster->num_groups; group++) {
+            if(topster->getGroupSize(group) != 0) {
+                KV* kv_head = topster->getGroupKV(group, 0);
                 gtopster.add(kv_head);
             }
         }
@@ -2226,10 +2358,14 @@ void Collection::populate_result_kvs(Topster *topster, std::vector<std::vector<K
 
         for(size_t i = 0; i < gtopster.size; i++) {
             KV* kv = gtopster.getKV(i);
-            const std::vector<KV*> group_kvs(
-                topster->group_kv_map[kv->distinct_key]->kvs,
-                topster->group_kv_map[kv->distinct_key]->kvs+topster->group_kv_map[kv->distinct_key]->size
-            );
+            uint32_t group;
+            topster->find_group(kv->distinct_key, group);
+
+            std::vector<KV*> group_kvs(topster->getGroupSize(group));
+            for(uint32_t j = 0; j < group_kvs.size(); j++) {
+                group_kvs[j] = topster->getGroupKV(group, j);
+            }
+
             result_kvs.emplace_back(group_kvs);
         }
     } else {
@@ -2245,9 +2381,8 @@ Option<bool> Collection::get_filter_ids(const std::string & simple_filter_query,
     std::shared_lock lock(mutex);
 
     const std::string doc_id_prefix = std::to_string(collection_id) + "_" + DOC_ID_PREFIX + "_";
-    filter_node_t* filter_tree_root = nullptr;
-    Option<bool> filter_op = filter::parse_filter_query(simple_filter_query, search_schema,
-                                                        store, doc_id_prefix, filter_tree_root);
+    std::shared_ptr<const filter_node_t> filter_tree;
+    Option<bool> filter_op = get_filter_tree(simple_filter_query, doc_id_prefix, filter_tree);
 
     if(!filter_op.ok()) {
         return filter_op;
@@ -2255,76 +2390,12 @@ Option<bool> Collection::get_filter_ids(const std::string & simple_filter_query,
 
     uint32_t* filter_ids = nullptr;
     uint32_t filter_ids_len = 0;
-    index->do_filtering_with_lock(filter_ids, filter_ids_len, filter_tree_root);
+    index->do_filtering_with_lock(filter_ids, filter_ids_len, filter_tree.get());
     index_ids.emplace_back(filter_ids_len, filter_ids);
 
-    delete filter_tree_root;
     return Option<bool>(true);
 }
 
-bool Collection::facet_value_to_string(const facet &a_facet, const facet_count_t &facet_count,
-                                       const nlohmann::json &document, std::string &value) const {
-
-    if(document.count(a_facet.field_name) == 0) {
-        // check for field exists
-        if(search_schema.at(a_facet.field_name).optional) {
-            return false;
-        }
-
-        LOG(ERROR) << "Could not find field " << a_facet.field_name << " in document during faceting.";
-        LOG(ERROR) << "Facet field type: " << search_schema.at(a_facet.field_name).type;
-        LOG(ERROR) << "Actual document: " << document;
-        return false;
-    }
-
-    if(search_schema.at(a_facet.field_name).is_array()) {
-        size_t array_sz = document[a_facet.field_name].size();
-        if(facet_count.array_pos >= array_sz) {
-            LOG(ERROR) << "Facet field array size " << array_sz << " lesser than array pos " <<  facet_count.array_pos
-                       << " for facet field " << a_facet.field_name;
-            LOG(ERROR) << "Facet field type: " << search_schema.at(a_facet.field_name).type;
-            LOG(ERROR) << "Actual document: " << document;
-            return false;
-        }
-    }
-
-    if(search_schema.at(a_facet.field_name).type == field_types::STRING) {
-        value =  document[a_facet.field_name];
-    } else if(search_schema.at(a_facet.field_name).type == field_types::STRING_ARRAY) {
-        value = document[a_facet.field_name][facet_count.array_pos];
-    } else if(search_schema.at(a_facet.field_name).type == field_types::INT32) {
-        int32_t raw_val = document[a_facet.field_name].get<int32_t>();
-        value = std::to_string(raw_val);
-    } else if(search_schema.at(a_facet.field_name).type == field_types::INT32_ARRAY) {
-        int32_t raw_val = document[a_facet.field_name][facet_count.array_pos].get<int32_t>();
-        value = std::to_string(raw_val);
-    } else if(search_schema.at(a_facet.field_name).type == field_types::INT64) {
-        int64_t raw_val = document[a_facet.field_name].get<int64_t>();
-        value = std::to_string(raw_val);
-    } else if(search_schema.at(a_facet.field_name).type == field_types::INT64_ARRAY) {
-        int64_t raw_val = document[a_facet.field_name][facet_count.array_pos].get<int64_t>();
-        value = std::to_string(raw_val);
-    } else if(search_schema.at(a_facet.field_name).type == field_types::FLOAT) {
-        float raw_val = document[a_facet.field_name].get<float>();
-        value = StringUtils::float_to_str(raw_val);
-        if(value != "0") {
-            value.erase ( value.find_last_not_of('0') + 1, std::string::npos ); // remove trailing zeros
-        }
-    } else if(search_schema.at(a_facet.field_name).type == field_types::FLOAT_ARRAY) {
-        float raw_val = document[a_facet.field_name][facet_count.array_pos].get<float>();
-        value = StringUtils::float_to_str(raw_val);
-        value.erase ( value.find_last_not_of('0') + 1, std::string::npos );  // remove trailing zeros
-    } else if(search_schema.at(a_facet.field_name).type == field_types::BOOL) {
-        value = std::to_string(document[a_facet.field_name].get<bool>());
-        value = (value == "1") ? "true" : "false";
-    } else if(search_schema.at(a_facet.field_name).type == field_types::BOOL_ARRAY) {
-        value = std::to_string(document[a_facet.field_name][facet_count.array_pos].get<bool>());
-        value = (value == "1") ? "true" : "false";
-    }
-
-    return true;
-}
-
 bool Collection::is_nested_array(const nlohmann::json& obj, std::vector<std::string> path_parts, size_t part_i) const {
     auto child_it = obj.find(path_parts[part_i]);
     if(child_it == obj.end()) {
@@ -2932,12 +3003,15 @@ void Collection::remove_document(const nlohmann::json & document, const uint32_t
 
         index->remove(seq_id, document, {}, false);
         num_documents -= 1;
+        SearchResponseCache::get_instance().invalidate(name);
     }
 
     if(remove_from_store) {
         store->remove(get_doc_id_key(id));
         store->remove(get_seq_id_key(seq_id));
     }
+
+    DocumentCache::get_instance().invalidate(DocumentCache::get_key(collection_id, seq_id));
 }
 
 Option<std::string> Collection::remove(const std::string & id, const bool remove_from_store) {
@@ -3009,6 +3083,7 @@ Option<uint32_t> Collection::add_override(const override_t & override) {
 
     std::unique_lock lock(mutex);
     overrides[override.id] = override;
+    SearchResponseCache::get_instance().invalidate(name);
     return Option<uint32_t>(200);
 }
 
@@ -3021,6 +3096,7 @@ Option<uint32_t> Collection::remove_override(const std::string & id) {
 
         std::unique_lock lock(mutex);
         overrides.erase(id);
+        SearchResponseCache::get_instance().invalidate(name);
         return Option<uint32_t>(200);
     }
 
@@ -3061,6 +3137,11 @@ size_t Collection::get_num_documents() const {
     return num_documents.load();
 }
 
+size_t Collection::get_filter_cache_size_bytes() const {
+    std::shared_lock lock(mutex);
+    return index->get_filter_result_cache_size_bytes();
+}
+
 uint32_t Collection::get_collection_id() const {
     return collection_id.load();
 }
@@ -3172,6 +3253,68 @@ Option<bool> Collection::get_document_from_store(const std::string &seq_id_key,
     return Option<bool>(true);
 }
 
+void Collection::get_documents_from_store(const std::vector<uint32_t>& seq_ids, std::vector<nlohmann::json>& documents,
+                                          std::vector<Option<bool>>& document_ops) const {
+    DocumentCache& document_cache = DocumentCache::get_instance();
+    const bool use_cache = document_cache.enabled();
+
+    // must be read before the store, so that documents written since are not cached
+    const uint64_t read_epoch = use_cache ? document_cache.get_write_epoch() : 0;
+
+    documents.clear();
+    documents.resize(seq_ids.size());
+    document_ops.assign(seq_ids.size(), Option<bool>(true));
+
+    std::vector<size_t> store_indices;
+    std::vector<std::string> store_keys;
+
+    for(size_t i = 0; i < seq_ids.size(); i++) {
+        if(!use_cache || !document_cache.get(DocumentCache::get_key(collection_id, seq_ids[i]), documents[i])) {
+            store_indices.push_back(i);
+            store_keys.push_back(get_seq_id_key(seq_ids[i]));
+        }
+    }
+
+    std::vector<std::string> json_docs;
+    std::vector<StoreStatus> json_doc_statuses;
+
+    if(!store_keys.empty()) {
+        store->multi_get(store_keys, json_docs, json_doc_statuses);
+    }
+
+    for(size_t j = 0; j < store_indices.size(); j++) {
+        const size_t i = store_indices[j];
+
+        if(json_doc_statuses[j] != StoreStatus::FOUND) {
+            document_ops[i] = Option<bool>(500, "Could not locate the JSON document for sequence ID: " +
+                                                std::to_string(seq_ids[i]));
+            continue;
+        }
+
+        try {
+            documents[i] = nlohmann::json::parse(json_docs[j]);
+        } catch(...) {
+            document_ops[i] = Option<bool>(500, "Error while parsing stored document with sequence ID: " +
+                                                store_keys[j]);
+            continue;
+        }
+
+        if(use_cache) {
+            document_cache.put(DocumentCache::get_key(collection_id, seq_ids[i]), documents[i],
+                               json_docs[j].size(), read_epoch);
+        }
+    }
+
+    if(enable_nested_fields) {
+        for(size_t i = 0; i < seq_ids.size(); i++) {
+            if(document_ops[i].ok()) {
+                std::vector<field> flattened_fields;
+                field::flatten_doc(documents[i], nested_fields, true, flattened_fields);
+            }
+        }
+    }
+}
+
 const Index* Collection::_get_index() const {
     return index;
 }
@@ -3221,7 +3364,9 @@ Option<bool> Collection::add_synonym(const nlohmann::json& syn_json) {
         return syn_op;
     }
 
-    return synonym_index->add_synonym(name, synonym);
+    Option<bool> add_op = synonym_index->add_synonym(name, synonym);
+    SearchResponseCache::get_instance().invalidate(name);
+    return add_op;
 }
 
 bool Collection::get_synonym(const std::string& id, synonym_t& synonym) {
@@ -3231,7 +3376,9 @@ bool Collection::get_synonym(const std::string& id, synonym_t& synonym) {
 
 Option<bool> Collection::remove_synonym(const std::string &id) {
     std::shared_lock lock(mutex);
-    return synonym_index->remove_synonym(name, id);
+    Option<bool> remove_op = synonym_index->remove_synonym(name, id);
+    SearchResponseCache::get_instance().invalidate(name);
+    return remove_op;
 }
 
 void Collection::synonym_reduction(const std::vector<std::string>& tokens,
@@ -3319,6 +3466,7 @@ Option<bool> Collection::batch_alter_data(const std::vector<field>& alter_fields
     }
 
     index->refresh_schemas(new_fields, {});
+    schema_version++;
 
     field::compact_nested_fields(nested_fields);
 
@@ -3416,6 +3564,7 @@ Option<bool> Collection::batch_alter_data(const std::vector<field>& alter_fields
     }
 
     index->refresh_schemas({}, del_fields);
+    schema_version++;
 
     auto persist_op = persist_collection_meta();
     if(!persist_op.ok()) {
@@ -3450,6 +3599,9 @@ Option<bool> Collection::alter(nlohmann::json& alter_payload) {
     }
 
     LOG(INFO) << "Alter payload validation is successful...";
+
+    // searches wait on the lock held here, so none can read the version before the change is applied
+    SearchResponseCache::get_instance().invalidate(name);
     if(!reindex_fields.empty()) {
         LOG(INFO) << "Processing field additions and deletions first...";
     }
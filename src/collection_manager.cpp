@@ -6,6 +6,7 @@
 #include "batched_indexer.h"
 #include "logger.h"
 #include "magic_enum.hpp"
+#include "search_response_cache.h"
 
 constexpr const size_t CollectionManager::DEFAULT_NUM_MEMORY_SHARDS;
 
@@ -130,6 +131,9 @@ void CollectionManager::add_to_collections(Collection* collection) {
     std::unique_lock lock(mutex);
     collections.emplace(collection_name, collection);
     collection_id_names.emplace(collection_id, collection_name);
+
+    // multi searches cache the errors of searches on collections that did not exist, which read no version
+    SearchResponseCache::get_instance().invalidate(collection_name);
 }
 
 void CollectionManager::init(Store *store, ThreadPool* thread_pool,
@@ -247,6 +251,7 @@ Option<bool> CollectionManager::load(const size_t collection_batch_size, const s
         std::vector<std::string> parts;
         StringUtils::split(iter->key().ToString(), parts, symlink_prefix_key);
         collection_symlinks[parts[0]] = iter->value().ToString();
+        SearchResponseCache::get_instance().invalidate(parts[0]);
         iter->Next();
     }
 
@@ -494,6 +499,8 @@ Option<nlohmann::json> CollectionManager::drop_collection(const std::string& col
     collection_id_names.erase(collection->get_collection_id());
     u_lock.unlock();
 
+    SearchResponseCache::get_instance().erase(actual_coll_name);
+
     // don't hold any collection manager locks here, since this can take some time
     delete collection;
 
@@ -536,6 +543,7 @@ Option<bool> CollectionManager::upsert_symlink(const std::string & symlink_name,
     }
 
     collection_symlinks[symlink_name] = collection_name;
+    SearchResponseCache::get_instance().invalidate(symlink_name);
     return Option<bool>(true);
 }
 
@@ -548,6 +556,7 @@ Option<bool> CollectionManager::delete_symlink(const std::string & symlink_name)
     }
 
     collection_symlinks.erase(symlink_name);
+    SearchResponseCache::get_instance().erase(symlink_name);
     return Option<bool>(true);
 }
 
@@ -654,6 +663,9 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
     const char *FACET_QUERY = "facet_query";
     const char *FACET_QUERY_NUM_TYPOS = "facet_query_num_typos";
     const char *MAX_FACET_VALUES = "max_facet_values";
+    const char *FACET_SAMPLE_PERCENT = "facet_sample_percent";
+    const char *FACET_SAMPLE_THRESHOLD = "facet_sample_threshold";
+    const char *FACET_APPROXIMATE_GROUP_COUNTS = "facet_approximate_group_counts";
 
     const char *VECTOR_QUERY = "vector_query";
 
@@ -755,6 +767,9 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
     size_t max_facet_values = 10;
     std::string simple_facet_query;
     size_t facet_query_num_typos = 2;
+    size_t facet_sample_percent = 100;
+    size_t facet_sample_threshold = 0;
+    bool facet_approximate_group_counts = false;
     size_t snippet_threshold = 30;
     size_t highlight_affix_num_tokens = 4;
     std::string highlight_full_fields;
@@ -799,6 +814,8 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
         {MAX_EXTRA_SUFFIX, &max_extra_suffix},
         {MAX_CANDIDATES, &max_candidates},
         {FACET_QUERY_NUM_TYPOS, &facet_query_num_typos},
+        {FACET_SAMPLE_PERCENT, &facet_sample_percent},
+        {FACET_SAMPLE_THRESHOLD, &facet_sample_threshold},
         {FILTER_CURATED_HITS, &filter_curated_hits_option},
     };
 
@@ -821,6 +838,7 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
         {EXHAUSTIVE_SEARCH, &exhaustive_search},
         {ENABLE_OVERRIDES, &enable_overrides},
         {ENABLE_HIGHLIGHT_V1, &enable_highlight_v1},
+        {FACET_APPROXIMATE_GROUP_COUNTS, &facet_approximate_group_counts},
     };
 
     std::unordered_map<std::string, std::vector<std::string>*> str_list_values = {
@@ -997,7 +1015,10 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
                                                           vector_query,
                                                           enable_highlight_v1,
                                                           start_ts,
-                                                          match_type
+                                                          match_type,
+                                                          facet_sample_percent,
+                                                          facet_sample_threshold,
+                                                          facet_approximate_group_counts
                                                         );
 
     uint64_t timeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -1042,6 +1063,17 @@ nlohmann::json CollectionManager::get_collection_summaries() const {
     return json_summaries;
 }
 
+size_t CollectionManager::get_filter_cache_size_bytes() const {
+    std::shared_lock lock(mutex);
+
+    size_t size_bytes = 0;
+    for(const auto& kv: collections) {
+        size_bytes += kv.second->get_filter_cache_size_bytes();
+    }
+
+    return size_bytes;
+}
+
 Option<Collection*> CollectionManager::create_collection(nlohmann::json& req_json) {
     const char* NUM_MEMORY_SHARDS = "num_memory_shards";
     const char* SYMBOLS_TO_INDEX = "symbols_to_index";
@@ -10,14 +10,11 @@
 #include "system_metrics.h"
 #include "logger.h"
 #include "core_api_utils.h"
-#include "lru/lru.hpp"
 #include "ratelimit_manager.h"
+#include "search_response_cache.h"
 
 using namespace std::chrono_literals;
 
-std::shared_mutex mutex;
-LRU::Cache<uint64_t, cached_res_t> res_cache;
-
 bool handle_authentication(std::map<std::string, std::string>& req_params,
                            std::vector<nlohmann::json>& embedded_params_vec,
                            const std::string& body,
@@ -303,6 +300,14 @@ bool get_stats_json(const std::shared_ptr<http_req>& req, const std::shared_ptr<
     AppMetrics::get_instance().get("requests_per_second", "latency_ms", result);
     result["pending_write_batches"] = server->get_num_queued_writes();
 
+    SearchResponseCache& search_cache = SearchResponseCache::get_instance();
+    result["search_cache_hits"] = search_cache.get_num_hits();
+    result["search_cache_misses"] = search_cache.get_num_misses();
+    result["search_cache_evictions"] = search_cache.get_num_evictions();
+    result["search_cache_stale_drops"] = search_cache.get_num_stale_drops();
+    result["search_cache_size_bytes"] = search_cache.size_bytes();
+    result["filter_cache_size_bytes"] = CollectionManager::get_instance().get_filter_cache_size_bytes();
+
     res->set_body(200, result.dump(2));
     return true;
 }
@@ -327,6 +332,37 @@ uint64_t hash_request(const std::shared_ptr<http_req>& req) {
     return StringUtils::hash_wy(req_str.c_str(), req_str.size());
 }
 
+// a search reads the collection that it names and, when that name is an alias, the collection it resolves to
+void add_read_versions(const std::map<std::string, std::string>& req_params,
+                       std::vector<SearchResponseCache::collection_version_t>& read_versions) {
+    const auto collection_it = req_params.find("collection");
+    if(collection_it == req_params.end()) {
+        return;
+    }
+
+    std::vector<std::string> collection_names = {collection_it->second};
+    const auto& symlink_op = CollectionManager::get_instance().resolve_symlink(collection_it->second);
+    if(symlink_op.ok()) {
+        collection_names.push_back(symlink_op.get());
+    }
+
+    SearchResponseCache& search_cache = SearchResponseCache::get_instance();
+
+    for(const auto& collection_name: collection_names) {
+        bool found = false;
+        for(const auto& read_version: read_versions) {
+            if(read_version.collection_name == collection_name) {
+                found = true;
+                break;
+            }
+        }
+
+        if(!found) {
+            read_versions.push_back({collection_name, search_cache.get_collection_version(collection_name)});
+        }
+    }
+}
+
 bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
     const auto use_cache_it = req->params.find("use_cache");
     bool use_cache = (use_cache_it != req->params.end()) && (use_cache_it->second == "1" || use_cache_it->second == "true");
@@ -338,23 +374,12 @@ bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http
 
         //LOG(INFO) << "req_hash = " << req_hash;
 
-        std::shared_lock lock(mutex);
-        auto hit_it = res_cache.find(req_hash);
-        if(hit_it != res_cache.end()) {
+        // entries whose TTL has lapsed or whose collections have changed since are not returned
+        auto cached_value = SearchResponseCache::get_instance().get(req_hash);
+        if(cached_value != nullptr) {
             //LOG(INFO) << "Result found in cache.";
-            const auto& cached_value = hit_it.value();
-
-            // we still need to check that TTL has not expired
-            uint32_t ttl = cached_value.ttl;
-            uint64_t seconds_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                    std::chrono::high_resolution_clock::now() - cached_value.created_at).count();
-
-            if(seconds_elapsed < cached_value.ttl) {
-                res->set_content(cached_value.status_code, cached_value.content_type_header, cached_value.body, true);
-                return true;
-            }
-
-            //LOG(INFO) << "Result found in cache but ttl lapsed.";
+            res->set_content(cached_value->status_code, cached_value->content_type_header, cached_value->body, true);
+            return true;
         }
     }
 
@@ -386,6 +411,12 @@ bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http
         return false;
     }
 
+    // read before searching, so that changes made during the search keep its response from being cached
+    std::vector<SearchResponseCache::collection_version_t> read_versions;
+    if(use_cache) {
+        add_read_versions(req->params, read_versions);
+    }
+
     std::string results_json_str;
     Option<bool> search_op = CollectionManager::do_search(req->params, req->embedded_params_vec[0],
                                                           results_json_str, req->conn_ts);
@@ -413,8 +444,7 @@ bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http
         cached_res_t cached_res;
         cached_res.load(res->status_code, res->content_type_header, res->body, now, cache_ttl, req_hash);
 
-        std::unique_lock lock(mutex);
-        res_cache.insert(req_hash, cached_res);
+        SearchResponseCache::get_instance().put(req_hash, cached_res, std::move(read_versions));
     }
 
     return true;
@@ -431,21 +461,12 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
 
         //LOG(INFO) << "req_hash = " << req_hash;
 
-        std::shared_lock lock(mutex);
-        auto hit_it = res_cache.find(req_hash);
-        if(hit_it != res_cache.end()) {
+        // entries whose TTL has lapsed or whose collections have changed since are not returned
+        auto cached_value = SearchResponseCache::get_instance().get(req_hash);
+        if(cached_value != nullptr) {
             //LOG(INFO) << "Result found in cache.";
-            const auto& cached_value = hit_it.value();
-
-            // we still need to check that TTL has not expired
-            uint32_t ttl = cached_value.ttl;
-            uint64_t seconds_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                    std::chrono::high_resolution_clock::now() - cached_value.created_at).count();
-
-            if(seconds_elapsed < cached_value.ttl) {
-                res->set_content(cached_value.status_code, cached_value.content_type_header, cached_value.body, true);
-                return true;
-            }
+            res->set_content(cached_value->status_code, cached_value->content_type_header, cached_value->body, true);
+            return true;
         }
     }
 
@@ -513,6 +534,8 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
 
     //LOG(INFO) << "REQ: " << req_json.dump(-1);
 
+    std::vector<SearchResponseCache::collection_version_t> read_versions;
+
     for(size_t i = 0; i < searches.size(); i++) {
         auto& search_params = searches[i];
 
@@ -558,6 +581,10 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
             }
         }
 
+        if(use_cache) {
+            add_read_versions(req->params, read_versions);
+        }
+
         std::string results_json_str;
         Option<bool> search_op = CollectionManager::do_search(req->params, req->embedded_params_vec[i],
                                                               results_json_str, req->conn_ts);
@@ -592,8 +619,7 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
         cached_res_t cached_res;
         cached_res.load(res->status_code, res->content_type_header, res->body, now, cache_ttl, req_hash);
 
-        std::unique_lock lock(mutex);
-        res_cache.insert(req_hash, cached_res);
+        SearchResponseCache::get_instance().put(req_hash, cached_res, std::move(read_versions));
     }
 
     return true;
@@ -1511,10 +1537,7 @@ bool post_config(const std::shared_ptr<http_req>& req, const std::shared_ptr<htt
 }
 
 bool post_clear_cache(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
-    {
-        std::unique_lock lock(mutex);
-        res_cache.clear();
-    }
+    SearchResponseCache::get_instance().clear();
 
     nlohmann::json response;
     response["success"] = true;
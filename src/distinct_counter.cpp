@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cmath>
+#include "distinct_counter.h"
+
+namespace {
+    // murmur3 finalizer: the sketch needs uniformly distributed bits, which IDs need not have
+    uint64_t mix(uint64_t id) {
+        id ^= id >> 33;
+        id *= 0xff51afd7ed558ccdULL;
+        id ^= id >> 33;
+        id *= 0xc4ceb9fe1a85ec53ULL;
+        id ^= id >> 33;
+        return id;
+    }
+}
+
+void distinct_counter_t::add_to_sketch(uint64_t id) {
+    const uint64_t hash = mix(id);
+    const size_t register_index = hash >> (64 - PRECISION);
+
+    // position of the first set bit among the remaining bits, which are capped with a set bit
+    const uint64_t rest = (hash << PRECISION) | (uint64_t(1) << (PRECISION - 1));
+    const uint8_t rank = __builtin_clzll(rest) + 1;
+
+    if(rank > registers[register_index]) {
+        registers[register_index] = rank;
+    }
+}
+
+void distinct_counter_t::to_sketch() {
+    registers.assign(NUM_REGISTERS, 0);
+
+    for(uint64_t id: ids) {
+        add_to_sketch(id);
+    }
+
+    for(uint64_t id: id_set) {
+        add_to_sketch(id);
+    }
+
+    std::vector<uint64_t>().swap(ids);
+    spp::sparse_hash_set<uint64_t>().swap(id_set);
+}
+
+void distinct_counter_t::to_set() {
+    id_set.insert(ids.begin(), ids.end());
+    std::vector<uint64_t>().swap(ids);
+}
+
+void distinct_counter_t::add(uint64_t id) {
+    if(!is_exact()) {
+        add_to_sketch(id);
+        return;
+    }
+
+    if(!id_set.empty()) {
+        id_set.insert(id);
+        return;
+    }
+
+    // IDs are mostly added in increasing order of their documents, but not of their values
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if(it != ids.end() && *it == id) {
+        return;
+    }
+
+    ids.insert(it, id);
+
+    if(ids.size() > MAX_EXACT_IDS) {
+        approximate ? to_sketch() : to_set();
+    }
+}
+
+void distinct_counter_t::merge(const distinct_counter_t& other) {
+    approximate = approximate || other.approximate;
+
+    if(!other.is_exact()) {
+        if(is_exact()) {
+            to_sketch();
+        }
+
+        for(size_t i = 0; i < NUM_REGISTERS; i++) {
+            registers[i] = std::max(registers[i], other.registers[i]);
+        }
+
+        return;
+    }
+
+    if(!is_exact()) {
+        for(uint64_t id: other.ids) {
+            add_to_sketch(id);
+        }
+
+        for(uint64_t id: other.id_set) {
+            add_to_sketch(id);
+        }
+
+        return;
+    }
+
+    if(id_set.empty() && other.id_set.empty()) {
+        std::vector<uint64_t> merged(ids.size() + other.ids.size());
+        auto end = std::set_union(ids.begin(), ids.end(), other.ids.begin(), other.ids.end(), merged.begin());
+        merged.resize(end - merged.begin());
+        ids = std::move(merged);
+
+        if(ids.size() > MAX_EXACT_IDS) {
+            approximate ? to_sketch() : to_set();
+        }
+
+        return;
+    }
+
+    to_set();
+    id_set.insert(other.ids.begin(), other.ids.end());
+    id_set.insert(other.id_set.begin(), other.id_set.end());
+
+    if(approximate && id_set.size() > MAX_EXACT_IDS) {
+        to_sketch();
+    }
+}
+
+size_t distinct_counter_t::count() const {
+    if(is_exact()) {
+        return id_set.empty() ? ids.size() : id_set.size();
+    }
+
+    const double m = NUM_REGISTERS;
+    const double alpha = 0.7213 / (1 + 1.079 / m);
+
+    double sum = 0;
+    size_t num_zeros = 0;
+
+    for(uint8_t reg: registers) {
+        sum += std::ldexp(1.0, -int(reg));
+        num_zeros += (reg == 0);
+    }
+
+    const double estimate = alpha * m * m / sum;
+
+    // linear counting is more accurate for small cardinalities
+    if(estimate <= 2.5 * m && num_zeros != 0) {
+        return std::llround(m * std::log(m / num_zeros));
+    }
+
+    return std::llround(estimate);
+}
@@ -0,0 +1,42 @@
+#include "document_cache.h"
+
+bool DocumentCache::get(uint64_t key, nlohmann::json& document) {
+    // documents are only cached as of the epoch they were read at, so any entry is current
+    auto cached_document = documents.get_if(key, [](uint64_t, const nlohmann::json&) { return true; });
+    if(cached_document == nullptr) {
+        return false;
+    }
+
+    // copied outside the lock, since documents can be large
+    document = *cached_document;
+    return true;
+}
+
+void DocumentCache::put(uint64_t key, const nlohmann::json& document, size_t doc_size, uint64_t read_epoch) {
+    if(doc_size > documents.get_capacity() || write_epoch.load() != read_epoch) {
+        return;
+    }
+
+    documents.put(key, read_epoch, std::make_shared<const nlohmann::json>(document), doc_size);
+
+    // checked again, as a write could have invalidated the document while it was copied: writes advance the epoch
+    // before they erase the document, so whichever of the two comes last erases the stale copy
+    if(write_epoch.load() != read_epoch) {
+        documents.erase(key);
+    }
+}
+
+void DocumentCache::invalidate(uint64_t key) {
+    if(!enabled()) {
+        return;
+    }
+
+    // advanced even when the document is not cached, since a reader could be about to cache it
+    write_epoch++;
+    documents.erase(key);
+}
+
+void DocumentCache::clear() {
+    write_epoch++;
+    documents.clear();
+}
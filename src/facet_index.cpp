@@ -0,0 +1,204 @@
+#include "facet_index.h"
+
+facet_index_t::~facet_index_t() {
+    for(page_t* page: pages) {
+        delete page;
+    }
+}
+
+uint32_t facet_index_t::acquire_ordinal(uint64_t hash, const std::string& value, uint32_t& variant) {
+    variant = 0;
+
+    const auto it = hash_ordinals.find(hash);
+    if(it != hash_ordinals.end()) {
+        const uint32_t ordinal = it->second;
+        ordinal_refs[ordinal]++;
+
+        const auto variants_it = ordinal_variants.find(ordinal);
+        if(variants_it == ordinal_variants.end()) {
+            if(ordinal_values[ordinal] == value) {
+                return ordinal;
+            }
+
+            // a differently written value of the hash: every variant is counted from now on
+            auto& variants = ordinal_variants[ordinal];
+            variants.push_back(variant_t{ordinal_values[ordinal], ordinal_refs[ordinal] - 1});
+            variants.push_back(variant_t{value, 1});
+            variant = 1;
+            return ordinal;
+        }
+
+        auto& variants = variants_it->second;
+        size_t free_variant = variants.size();
+
+        for(size_t i = 0; i < variants.size(); i++) {
+            if(variants[i].refs != 0 && variants[i].value == value) {
+                variants[i].refs++;
+                variant = i;
+                return ordinal;
+            }
+
+            if(variants[i].refs == 0 && free_variant == variants.size()) {
+                free_variant = i;
+            }
+        }
+
+        if(free_variant == variants.size()) {
+            variants.push_back(variant_t{value, 1});
+        } else {
+            variants[free_variant] = variant_t{value, 1};
+        }
+
+        variant = free_variant;
+        return ordinal;
+    }
+
+    uint32_t ordinal;
+
+    if(!free_ordinals.empty()) {
+        ordinal = free_ordinals.back();
+        free_ordinals.pop_back();
+        ordinal_hashes[ordinal] = hash;
+        ordinal_values[ordinal] = value;
+        ordinal_refs[ordinal] = 1;
+    } else {
+        ordinal = ordinal_hashes.size();
+        ordinal_hashes.push_back(hash);
+        ordinal_values.push_back(value);
+        ordinal_refs.push_back(1);
+    }
+
+    hash_ordinals.emplace(hash, ordinal);
+    return ordinal;
+}
+
+void facet_index_t::release_ordinal(uint32_t ordinal, uint32_t variant) {
+    if(--ordinal_refs[ordinal] == 0) {
+        hash_ordinals.erase(ordinal_hashes[ordinal]);
+        std::string().swap(ordinal_values[ordinal]);
+        ordinal_variants.erase(ordinal);
+        free_ordinals.push_back(ordinal);
+        return;
+    }
+
+    const auto variants_it = ordinal_variants.find(ordinal);
+    if(variants_it == ordinal_variants.end()) {
+        return;
+    }
+
+    auto& variant_ref = variants_it->second[variant];
+    if(--variant_ref.refs == 0) {
+        std::string().swap(variant_ref.value);
+    }
+}
+
+const std::string& facet_index_t::get_value(uint32_t ordinal, uint32_t seq_id, uint32_t pos) const {
+    const auto variants_it = ordinal_variants.find(ordinal);
+    if(variants_it == ordinal_variants.end()) {
+        return ordinal_values[ordinal];
+    }
+
+    const auto& variants = variants_it->second;
+
+    const uint32_t* doc_ordinals = nullptr;
+    if(pos < get(seq_id, doc_ordinals) && doc_ordinals[pos] == ordinal) {
+        const auto variant_it = value_variants.find(get_value_key(seq_id, pos));
+        return variants[(variant_it == value_variants.end()) ? 0 : variant_it->second].value;
+    }
+
+    size_t common_variant = 0;
+    for(size_t i = 1; i < variants.size(); i++) {
+        if(variants[i].refs > variants[common_variant].refs) {
+            common_variant = i;
+        }
+    }
+
+    return variants[common_variant].value;
+}
+
+void facet_index_t::insert(uint32_t seq_id, const std::vector<uint64_t>& hashes,
+                           const std::vector<std::string>& values) {
+    const size_t page_index = seq_id >> PAGE_BITS;
+    const uint32_t offset = seq_id & (PAGE_SIZE - 1);
+
+    if(page_index >= pages.size()) {
+        pages.resize(page_index + 1, nullptr);
+    }
+
+    if(pages[page_index] == nullptr) {
+        pages[page_index] = new page_t;
+    }
+
+    page_t* page = pages[page_index];
+    if(page->contains(offset)) {
+        return;
+    }
+
+    const size_t rank = page->rank(offset);
+    const uint32_t start = page->offsets[rank];
+    const uint32_t num_hashes = hashes.size();
+
+    // documents are mostly indexed in ID order, which makes these appends
+    page->ordinals.insert(page->ordinals.begin() + start, num_hashes, 0);
+    for(size_t i = 0; i < num_hashes; i++) {
+        uint32_t variant;
+        page->ordinals[start + i] = acquire_ordinal(hashes[i], values[i], variant);
+
+        if(variant != 0) {
+            value_variants.emplace(get_value_key(seq_id, i), variant);
+        }
+    }
+
+    page->offsets.insert(page->offsets.begin() + rank + 1, start + num_hashes);
+    for(size_t r = rank + 2; r < page->offsets.size(); r++) {
+        page->offsets[r] += num_hashes;
+    }
+
+    page->set(offset);
+
+    num_docs++;
+}
+
+void facet_index_t::erase(uint32_t seq_id) {
+    const size_t page_index = seq_id >> PAGE_BITS;
+    const uint32_t offset = seq_id & (PAGE_SIZE - 1);
+
+    if(page_index >= pages.size() || pages[page_index] == nullptr || !pages[page_index]->contains(offset)) {
+        return;
+    }
+
+    page_t* page = pages[page_index];
+    const size_t rank = page->rank(offset);
+    const uint32_t start = page->offsets[rank];
+    const uint32_t num_hashes = page->offsets[rank + 1] - start;
+
+    for(size_t i = 0; i < num_hashes; i++) {
+        uint32_t variant = 0;
+
+        if(!value_variants.empty()) {
+            const auto variant_it = value_variants.find(get_value_key(seq_id, i));
+            if(variant_it != value_variants.end()) {
+                variant = variant_it->second;
+                value_variants.erase(variant_it);
+            }
+        }
+
+        release_ordinal(page->ordinals[start + i], variant);
+    }
+
+    page->ordinals.erase(page->ordinals.begin() + start, page->ordinals.begin() + start + num_hashes);
+
+    page->offsets.erase(page->offsets.begin() + rank + 1);
+    for(size_t r = rank + 1; r < page->offsets.size(); r++) {
+        page->offsets[r] -= num_hashes;
+    }
+
+    page->unset(offset);
+
+    num_docs--;
+
+    if(page->offsets.size() == 1) {
+        delete page;
+        pages[page_index] = nullptr;
+    }
+}
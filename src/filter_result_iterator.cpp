@@ -0,0 +1,340 @@
+#include "filter_result_iterator.h"
+#include <algorithm>
+
+filter_result_iterator_t filter_result_iterator_t::ids_leaf(std::vector<uint32_t>&& ids) {
+    filter_result_iterator_t leaf;
+    leaf.type = IDS_LEAF;
+    leaf.ids = std::move(ids);
+    leaf.load_leaf();
+    return leaf;
+}
+
+filter_result_iterator_t filter_result_iterator_t::posting_leaf(void* obj) {
+    if(IS_COMPACT_POSTING(obj)) {
+        // compact lists are tiny: cheaper to hold as an array
+        std::vector<uint32_t> compact_ids;
+        posting_t::merge({obj}, compact_ids);
+        return ids_leaf(std::move(compact_ids));
+    }
+
+    filter_result_iterator_t leaf;
+    leaf.type = POSTING_LEAF;
+    leaf.posting_list = (posting_list_t*) obj;
+    leaf.posting_it.reset(new posting_list_t::iterator_t(leaf.posting_list->new_iterator()));
+    leaf.load_leaf();
+    return leaf;
+}
+
+filter_result_iterator_t filter_result_iterator_t::id_list_leaf(void* obj) {
+    if(IS_COMPACT_IDS(obj)) {
+        std::vector<uint32_t> compact_ids;
+        ids_t::uncompress(obj, compact_ids);
+        return ids_leaf(std::move(compact_ids));
+    }
+
+    filter_result_iterator_t leaf;
+    leaf.type = ID_LIST_LEAF;
+    leaf.id_list = (id_list_t*) obj;
+    leaf.id_list_it.reset(new id_list_t::iterator_t(leaf.id_list->new_iterator()));
+    leaf.load_leaf();
+    return leaf;
+}
+
+filter_result_iterator_t filter_result_iterator_t::and_node(std::vector<filter_result_iterator_t>&& children) {
+    if(children.empty()) {
+        return filter_result_iterator_t();
+    }
+
+    if(children.size() == 1) {
+        return std::move(children[0]);
+    }
+
+    filter_result_iterator_t node;
+    node.type = AND_NODE;
+    node.children = std::move(children);
+    node.advance_and();
+    return node;
+}
+
+filter_result_iterator_t filter_result_iterator_t::or_node(std::vector<filter_result_iterator_t>&& children) {
+    if(children.empty()) {
+        return filter_result_iterator_t();
+    }
+
+    if(children.size() == 1) {
+        return std::move(children[0]);
+    }
+
+    filter_result_iterator_t node;
+    node.type = OR_NODE;
+    node.children = std::move(children);
+    node.advance_or();
+    return node;
+}
+
+void filter_result_iterator_t::load_leaf() {
+    switch(type) {
+        case IDS_LEAF:
+            is_valid = ids_index < ids.size();
+            if(is_valid) {
+                seq_id = ids[ids_index];
+            }
+            break;
+        case POSTING_LEAF:
+            is_valid = posting_it->valid();
+            if(is_valid) {
+                seq_id = posting_it->id();
+            }
+            break;
+        case ID_LIST_LEAF:
+            is_valid = id_list_it->valid();
+            if(is_valid) {
+                seq_id = id_list_it->id();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void filter_result_iterator_t::advance_and() {
+    // leap-frog the children till they all agree on an ID
+    while(true) {
+        uint32_t target = 0;
+        for(const auto& child: children) {
+            if(!child.is_valid) {
+                is_valid = false;
+                return;
+            }
+
+            target = std::max(target, child.seq_id);
+        }
+
+        bool aligned = true;
+        for(auto& child: children) {
+            child.skip_to(target);
+            if(!child.is_valid) {
+                is_valid = false;
+                return;
+            }
+
+            if(child.seq_id != target) {
+                aligned = false;
+            }
+        }
+
+        if(aligned) {
+            is_valid = true;
+            seq_id = target;
+            return;
+        }
+    }
+}
+
+void filter_result_iterator_t::advance_or() {
+    is_valid = false;
+
+    for(const auto& child: children) {
+        if(child.is_valid && (!is_valid || child.seq_id < seq_id)) {
+            is_valid = true;
+            seq_id = child.seq_id;
+        }
+    }
+}
+
+void filter_result_iterator_t::next() {
+    if(!is_valid) {
+        return;
+    }
+
+    switch(type) {
+        case IDS_LEAF:
+            ids_index++;
+            load_leaf();
+            break;
+        case POSTING_LEAF:
+            posting_it->next();
+            load_leaf();
+            break;
+        case ID_LIST_LEAF:
+            id_list_it->next();
+            load_leaf();
+            break;
+        case AND_NODE:
+            children[0].next();
+            advance_and();
+            break;
+        case OR_NODE:
+            for(auto& child: children) {
+                if(child.is_valid && child.seq_id == seq_id) {
+                    child.next();
+                }
+            }
+            advance_or();
+            break;
+    }
+}
+
+void filter_result_iterator_t::skip_to(uint32_t id) {
+    if(!is_valid || seq_id >= id) {
+        return;
+    }
+
+    switch(type) {
+        case IDS_LEAF:
+            ids_index = std::lower_bound(ids.begin() + ids_index, ids.end(), id) - ids.begin();
+            load_leaf();
+            break;
+        case POSTING_LEAF:
+            posting_it->skip_to(id);
+            load_leaf();
+            break;
+        case ID_LIST_LEAF:
+            id_list_it->skip_to(id);
+            load_leaf();
+            break;
+        case AND_NODE:
+            children[0].skip_to(id);
+            advance_and();
+            break;
+        case OR_NODE:
+            for(auto& child: children) {
+                child.skip_to(id);
+            }
+            advance_or();
+            break;
+    }
+}
+
+void filter_result_iterator_t::reset() {
+    last_probed_id = 0;
+
+    switch(type) {
+        case IDS_LEAF:
+            ids_index = 0;
+            load_leaf();
+            break;
+        case POSTING_LEAF:
+            posting_it.reset(new posting_list_t::iterator_t(posting_list->new_iterator()));
+            load_leaf();
+            break;
+        case ID_LIST_LEAF:
+            id_list_it.reset(new id_list_t::iterator_t(id_list->new_iterator()));
+            load_leaf();
+            break;
+        case AND_NODE:
+            for(auto& child: children) {
+                child.reset();
+            }
+            advance_and();
+            break;
+        case OR_NODE:
+            for(auto& child: children) {
+                child.reset();
+            }
+            advance_or();
+            break;
+    }
+}
+
+bool filter_result_iterator_t::lookup(uint32_t id) const {
+    switch(type) {
+        case IDS_LEAF:
+            return std::binary_search(ids.begin(), ids.end(), id);
+        case POSTING_LEAF:
+            return posting_list->contains(id);
+        case ID_LIST_LEAF:
+            return id_list->contains(id);
+        case AND_NODE:
+            return std::all_of(children.begin(), children.end(), [id](const filter_result_iterator_t& child) {
+                return child.lookup(id);
+            });
+        case OR_NODE:
+            return std::any_of(children.begin(), children.end(), [id](const filter_result_iterator_t& child) {
+                return child.lookup(id);
+            });
+    }
+
+    return false;
+}
+
+bool filter_result_iterator_t::contains(uint32_t id) {
+    if(id < last_probed_id) {
+        return lookup(id);
+    }
+
+    last_probed_id = id;
+    skip_to(id);
+
+    return is_valid && seq_id == id;
+}
+
+bool filter_result_iterator_t::contains_atleast_one(const void* obj) {
+    if(IS_COMPACT_POSTING(obj)) {
+        std::vector<uint32_t> compact_ids;
+        posting_t::merge({const_cast<void*>(obj)}, compact_ids);
+
+        for(uint32_t compact_id: compact_ids) {
+            if(contains(compact_id)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    auto it = ((posting_list_t*) obj)->new_iterator();
+
+    // documents before the position of the iterator are looked up one by one, and the rest are leap-frogged
+    while(it.valid() && it.id() < last_probed_id) {
+        if(lookup(it.id())) {
+            return true;
+        }
+
+        it.next();
+    }
+
+    while(it.valid()) {
+        last_probed_id = it.id();
+        skip_to(it.id());
+
+        if(!is_valid) {
+            return false;
+        }
+
+        if(seq_id == it.id()) {
+            return true;
+        }
+
+        it.skip_to(seq_id);
+    }
+
+    return false;
+}
+
+size_t filter_result_iterator_t::approx_cardinality() const {
+    switch(type) {
+        case IDS_LEAF:
+            return ids.size();
+        case POSTING_LEAF:
+            return posting_list->num_ids();
+        case ID_LIST_LEAF:
+            return id_list->num_ids();
+        case AND_NODE: {
+            size_t cardinality = children[0].approx_cardinality();
+            for(size_t i = 1; i < children.size(); i++) {
+                cardinality = std::min(cardinality, children[i].approx_cardinality());
+            }
+            return cardinality;
+        }
+        case OR_NODE: {
+            size_t cardinality = 0;
+            for(const auto& child: children) {
+                cardinality += child.approx_cardinality();
+            }
+            return cardinality;
+        }
+    }
+
+    return 0;
+}
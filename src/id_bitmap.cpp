@@ -0,0 +1,515 @@
+#include "id_bitmap.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+    typedef id_bitmap_t::container_t container_t;
+
+    inline void set_bit(std::vector<uint64_t>& words, uint16_t low) {
+        words[low >> 6] |= (uint64_t(1) << (low & 63));
+    }
+
+    inline bool test_bit(const std::vector<uint64_t>& words, uint16_t low) {
+        return (words[low >> 6] >> (low & 63)) & 1;
+    }
+
+    inline uint32_t count_bits(const std::vector<uint64_t>& words) {
+        uint32_t count = 0;
+        for(uint64_t word: words) {
+            count += __builtin_popcountll(word);
+        }
+        return count;
+    }
+
+    void intersect_containers(const container_t& a, const container_t& b, container_t& out) {
+        if(a.is_bitmap() && b.is_bitmap()) {
+            out.bitmap.resize(id_bitmap_t::BITMAP_WORDS);
+            for(size_t i = 0; i < id_bitmap_t::BITMAP_WORDS; i++) {
+                out.bitmap[i] = a.bitmap[i] & b.bitmap[i];
+            }
+            out.cardinality = count_bits(out.bitmap);
+            out.optimize();
+            return ;
+        }
+
+        if(!a.is_bitmap() && !b.is_bitmap()) {
+            out.array.reserve(std::min(a.array.size(), b.array.size()));
+            std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                  std::back_inserter(out.array));
+            out.cardinality = out.array.size();
+            return ;
+        }
+
+        // probe the array side against the bitmap side
+        const container_t& arr = a.is_bitmap() ? b : a;
+        const container_t& bmp = a.is_bitmap() ? a : b;
+
+        out.array.reserve(arr.array.size());
+        for(uint16_t low: arr.array) {
+            if(test_bit(bmp.bitmap, low)) {
+                out.array.push_back(low);
+            }
+        }
+
+        out.cardinality = out.array.size();
+    }
+
+    void merge_containers(const container_t& a, const container_t& b, container_t& out) {
+        if(!a.is_bitmap() && !b.is_bitmap()) {
+            out.array.reserve(a.array.size() + b.array.size());
+            std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                           std::back_inserter(out.array));
+            out.cardinality = out.array.size();
+            out.optimize();
+            return ;
+        }
+
+        if(a.is_bitmap() && b.is_bitmap()) {
+            out.bitmap.resize(id_bitmap_t::BITMAP_WORDS);
+            for(size_t i = 0; i < id_bitmap_t::BITMAP_WORDS; i++) {
+                out.bitmap[i] = a.bitmap[i] | b.bitmap[i];
+            }
+            out.cardinality = count_bits(out.bitmap);
+            return ;
+        }
+
+        const container_t& arr = a.is_bitmap() ? b : a;
+        const container_t& bmp = a.is_bitmap() ? a : b;
+
+        out.bitmap = bmp.bitmap;
+        out.cardinality = bmp.cardinality;
+
+        for(uint16_t low: arr.array) {
+            if(!test_bit(out.bitmap, low)) {
+                set_bit(out.bitmap, low);
+                out.cardinality++;
+            }
+        }
+    }
+
+    void exclude_containers(const container_t& src, const container_t& filter, container_t& out) {
+        if(!src.is_bitmap()) {
+            out.array.reserve(src.array.size());
+
+            if(filter.is_bitmap()) {
+                for(uint16_t low: src.array) {
+                    if(!test_bit(filter.bitmap, low)) {
+                        out.array.push_back(low);
+                    }
+                }
+            } else {
+                std::set_difference(src.array.begin(), src.array.end(), filter.array.begin(), filter.array.end(),
+                                    std::back_inserter(out.array));
+            }
+
+            out.cardinality = out.array.size();
+            return ;
+        }
+
+        out.bitmap = src.bitmap;
+
+        if(filter.is_bitmap()) {
+            for(size_t i = 0; i < id_bitmap_t::BITMAP_WORDS; i++) {
+                out.bitmap[i] &= ~filter.bitmap[i];
+            }
+        } else {
+            for(uint16_t low: filter.array) {
+                out.bitmap[low >> 6] &= ~(uint64_t(1) << (low & 63));
+            }
+        }
+
+        out.cardinality = count_bits(out.bitmap);
+        out.optimize();
+    }
+}
+
+/* container_t operations */
+
+bool id_bitmap_t::container_t::contains(uint16_t low) const {
+    if(is_bitmap()) {
+        return test_bit(bitmap, low);
+    }
+
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+bool id_bitmap_t::container_t::add(uint16_t low) {
+    if(is_bitmap()) {
+        if(test_bit(bitmap, low)) {
+            return false;
+        }
+
+        set_bit(bitmap, low);
+        cardinality++;
+        return true;
+    }
+
+    if(array.empty() || array.back() < low) {
+        array.push_back(low);
+    } else {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if(*it == low) {
+            return false;
+        }
+        array.insert(it, low);
+    }
+
+    cardinality++;
+
+    if(cardinality > ARRAY_CONTAINER_MAX) {
+        to_bitmap();
+    }
+
+    return true;
+}
+
+void id_bitmap_t::container_t::to_bitmap() {
+    if(is_bitmap()) {
+        return ;
+    }
+
+    bitmap.resize(BITMAP_WORDS, 0);
+    for(uint16_t low: array) {
+        set_bit(bitmap, low);
+    }
+
+    std::vector<uint16_t>().swap(array);
+}
+
+void id_bitmap_t::container_t::to_array() {
+    if(!is_bitmap()) {
+        return ;
+    }
+
+    array.reserve(cardinality);
+    for(size_t i = 0; i < BITMAP_WORDS; i++) {
+        uint64_t word = bitmap[i];
+        while(word != 0) {
+            array.push_back(uint16_t(i * 64 + __builtin_ctzll(word)));
+            word &= (word - 1);
+        }
+    }
+
+    std::vector<uint64_t>().swap(bitmap);
+}
+
+void id_bitmap_t::container_t::optimize() {
+    if(cardinality > ARRAY_CONTAINER_MAX) {
+        to_bitmap();
+    } else {
+        to_array();
+    }
+}
+
+/* iterator_t operations */
+
+id_bitmap_t::iterator_t::iterator_t(const id_bitmap_t* bitmap): bitmap(bitmap) {
+    seek_valid();
+}
+
+void id_bitmap_t::iterator_t::seek_valid() {
+    // moves `pos` to the next present value, starting from the current position
+    const auto& containers = bitmap->containers;
+
+    while(container_index < containers.size()) {
+        const container_t& container = containers[container_index];
+
+        if(!container.is_bitmap()) {
+            if(pos < container.array.size()) {
+                return ;
+            }
+        } else if(pos < (1 << 16)) {
+            size_t word_index = pos >> 6;
+            uint64_t word = container.bitmap[word_index] & (~uint64_t(0) << (pos & 63));
+
+            while(word == 0 && ++word_index < BITMAP_WORDS) {
+                word = container.bitmap[word_index];
+            }
+
+            if(word != 0) {
+                pos = word_index * 64 + __builtin_ctzll(word);
+                return ;
+            }
+        }
+
+        container_index++;
+        pos = 0;
+    }
+}
+
+bool id_bitmap_t::iterator_t::valid() const {
+    return container_index < bitmap->containers.size();
+}
+
+void id_bitmap_t::iterator_t::next() {
+    pos++;
+    seek_valid();
+}
+
+uint32_t id_bitmap_t::iterator_t::id() const {
+    const container_t& container = bitmap->containers[container_index];
+    uint32_t low = container.is_bitmap() ? pos : container.array[pos];
+    return (uint32_t(container.key) << 16) | low;
+}
+
+void id_bitmap_t::iterator_t::skip_to(uint32_t id) {
+    const auto& containers = bitmap->containers;
+    const uint16_t key = id >> 16;
+    const uint16_t low = id & 0xFFFF;
+
+    while(container_index < containers.size() && containers[container_index].key < key) {
+        container_index++;
+        pos = 0;
+    }
+
+    if(container_index == containers.size()) {
+        return ;
+    }
+
+    const container_t& container = containers[container_index];
+
+    if(container.key == key) {
+        if(container.is_bitmap()) {
+            pos = std::max<uint32_t>(pos, low);
+        } else {
+            auto begin = container.array.begin() + pos;
+            pos = std::lower_bound(begin, container.array.end(), low) - container.array.begin();
+        }
+    }
+
+    seek_valid();
+}
+
+/* id_bitmap_t operations */
+
+id_bitmap_t::id_bitmap_t(const uint32_t* sorted_ids, size_t length) {
+    size_t i = 0;
+
+    while(i < length) {
+        const uint16_t key = sorted_ids[i] >> 16;
+        size_t j = i;
+
+        while(j < length && (sorted_ids[j] >> 16) == key) {
+            j++;
+        }
+
+        container_t container;
+        container.key = key;
+        container.cardinality = j - i;
+
+        if(container.cardinality > ARRAY_CONTAINER_MAX) {
+            container.bitmap.resize(BITMAP_WORDS, 0);
+            for(size_t k = i; k < j; k++) {
+                set_bit(container.bitmap, sorted_ids[k] & 0xFFFF);
+            }
+        } else {
+            container.array.resize(container.cardinality);
+            for(size_t k = i; k < j; k++) {
+                container.array[k - i] = sorted_ids[k] & 0xFFFF;
+            }
+        }
+
+        containers.push_back(std::move(container));
+        i = j;
+    }
+
+    num_ids = length;
+}
+
+size_t id_bitmap_t::find_container(uint16_t key) const {
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const container_t& c, uint16_t k) { return c.key < k; });
+    return it - containers.begin();
+}
+
+void id_bitmap_t::add(uint32_t id) {
+    const uint16_t key = id >> 16;
+    const uint16_t low = id & 0xFFFF;
+
+    size_t index;
+
+    if(containers.empty() || containers.back().key < key) {
+        index = containers.size();
+    } else if(containers.back().key == key) {
+        index = containers.size() - 1;
+    } else {
+        index = find_container(key);
+    }
+
+    if(index == containers.size() || containers[index].key != key) {
+        container_t container;
+        container.key = key;
+        containers.insert(containers.begin() + index, std::move(container));
+    }
+
+    if(containers[index].add(low)) {
+        num_ids++;
+    }
+}
+
+bool id_bitmap_t::contains(uint32_t id) const {
+    const uint16_t key = id >> 16;
+    size_t index = find_container(key);
+
+    if(index == containers.size() || containers[index].key != key) {
+        return false;
+    }
+
+    return containers[index].contains(id & 0xFFFF);
+}
+
+uint32_t id_bitmap_t::select(size_t rank) const {
+    for(const auto& container: containers) {
+        if(rank >= container.cardinality) {
+            rank -= container.cardinality;
+            continue;
+        }
+
+        const uint32_t high = uint32_t(container.key) << 16;
+
+        if(!container.is_bitmap()) {
+            return high | container.array[rank];
+        }
+
+        for(size_t i = 0; i < BITMAP_WORDS; i++) {
+            uint64_t word = container.bitmap[i];
+            const size_t word_count = __builtin_popcountll(word);
+
+            if(rank >= word_count) {
+                rank -= word_count;
+                continue;
+            }
+
+            while(rank-- != 0) {
+                word &= (word - 1);
+            }
+
+            return high | uint32_t(i * 64 + __builtin_ctzll(word));
+        }
+    }
+
+    return UINT32_MAX;
+}
+
+void id_bitmap_t::uncompress(uint32_t* out) const {
+    size_t k = 0;
+
+    for(const auto& container: containers) {
+        const uint32_t high = uint32_t(container.key) << 16;
+
+        if(!container.is_bitmap()) {
+            for(uint16_t low: container.array) {
+                out[k++] = high | low;
+            }
+            continue;
+        }
+
+        for(size_t i = 0; i < BITMAP_WORDS; i++) {
+            uint64_t word = container.bitmap[i];
+            while(word != 0) {
+                out[k++] = high | uint32_t(i * 64 + __builtin_ctzll(word));
+                word &= (word - 1);
+            }
+        }
+    }
+}
+
+uint32_t* id_bitmap_t::uncompress() const {
+    uint32_t* out = new uint32_t[num_ids];
+    uncompress(out);
+    return out;
+}
+
+id_bitmap_t::iterator_t id_bitmap_t::new_iterator() const {
+    return iterator_t(this);
+}
+
+size_t id_bitmap_t::size_bytes() const {
+    size_t size = containers.capacity() * sizeof(container_t);
+    for(const container_t& container: containers) {
+        size += container.array.capacity() * sizeof(uint16_t) + container.bitmap.capacity() * sizeof(uint64_t);
+    }
+
+    return size;
+}
+
+void id_bitmap_t::clear() {
+    containers.clear();
+    num_ids = 0;
+}
+
+void id_bitmap_t::intersect(const id_bitmap_t& a, const id_bitmap_t& b, id_bitmap_t& out) {
+    out.clear();
+
+    size_t i = 0, j = 0;
+    while(i < a.containers.size() && j < b.containers.size()) {
+        const container_t& ca = a.containers[i];
+        const container_t& cb = b.containers[j];
+
+        if(ca.key < cb.key) {
+            i++;
+        } else if(ca.key > cb.key) {
+            j++;
+        } else {
+            container_t container;
+            container.key = ca.key;
+            intersect_containers(ca, cb, container);
+
+            if(container.cardinality != 0) {
+                out.num_ids += container.cardinality;
+                out.containers.push_back(std::move(container));
+            }
+
+            i++;
+            j++;
+        }
+    }
+}
+
+void id_bitmap_t::merge(const id_bitmap_t& a, const id_bitmap_t& b, id_bitmap_t& out) {
+    out.clear();
+
+    size_t i = 0, j = 0;
+    while(i < a.containers.size() || j < b.containers.size()) {
+        if(j == b.containers.size() || (i < a.containers.size() && a.containers[i].key < b.containers[j].key)) {
+            out.containers.push_back(a.containers[i++]);
+        } else if(i == a.containers.size() || b.containers[j].key < a.containers[i].key) {
+            out.containers.push_back(b.containers[j++]);
+        } else {
+            container_t container;
+            container.key = a.containers[i].key;
+            merge_containers(a.containers[i], b.containers[j], container);
+            out.containers.push_back(std::move(container));
+            i++;
+            j++;
+        }
+
+        out.num_ids += out.containers.back().cardinality;
+    }
+}
+
+void id_bitmap_t::exclude(const id_bitmap_t& src, const id_bitmap_t& filter, id_bitmap_t& out) {
+    out.clear();
+
+    size_t j = 0;
+    for(const auto& container: src.containers) {
+        while(j < filter.containers.size() && filter.containers[j].key < container.key) {
+            j++;
+        }
+
+        if(j == filter.containers.size() || filter.containers[j].key != container.key) {
+            out.num_ids += container.cardinality;
+            out.containers.push_back(container);
+            continue;
+        }
+
+        container_t result;
+        result.key = container.key;
+        exclude_containers(container, filter.containers[j], result);
+
+        if(result.cardinality != 0) {
+            out.num_ids += result.cardinality;
+            out.containers.push_back(std::move(result));
+        }
+    }
+}
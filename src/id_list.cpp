@@ -31,7 +31,7 @@ uint32_t id_list_t::block_t::erase(const uint32_t id) {
 /* iterator_t operations */
 
 id_list_t::iterator_t::iterator_t(id_list_t::block_t* start, id_list_t::block_t* end,
-                                  std::map<last_id_t, block_t*>* id_block_map, bool reverse):
+                                  block_directory_t<block_t>* id_block_map, bool reverse):
         curr_block(start), curr_index(0), end_block(end), id_block_map(id_block_map), reverse(reverse) {
 
     if(curr_block != end_block) {
@@ -71,10 +71,9 @@ void id_list_t::iterator_t::previous() {
     if(curr_index < 0) {
         // since block stores only the next pointer, we have to use `id_block_map` for reverse iteration
         auto last_ele = ids[curr_block->size()-1];
-        auto it = id_block_map->find(last_ele);
-        if(it != id_block_map->end() && it != id_block_map->begin()) {
-            it--;
-            curr_block = it->second;
+        const size_t index = id_block_map->find(last_ele);
+        if(index != id_block_map->size() && index != 0) {
+            curr_block = id_block_map->block_at(index - 1);
             curr_index = curr_block->size()-1;
 
             delete [] ids;
@@ -202,8 +201,8 @@ void id_list_t::upsert(const uint32_t id) {
         upsert_block = &root_block;
         before_upsert_last_id = UINT32_MAX;
     } else {
-        const auto it = id_block_map.lower_bound(id);
-        upsert_block = (it == id_block_map.end()) ? id_block_map.rbegin()->second : it->second;
+        const size_t index = std::min(id_block_map.lower_bound(id), id_block_map.size() - 1);
+        upsert_block = id_block_map.block_at(index);
         before_upsert_last_id = upsert_block->ids.last();
     }
 
@@ -214,8 +213,7 @@ void id_list_t::upsert(const uint32_t id) {
 
         last_id_t after_upsert_last_id = upsert_block->ids.last();
         if(before_upsert_last_id != after_upsert_last_id) {
-            id_block_map.erase(before_upsert_last_id);
-            id_block_map.emplace(after_upsert_last_id, upsert_block);
+            id_block_map.update(before_upsert_last_id, after_upsert_last_id, upsert_block);
         }
     } else {
         block_t* new_block = new block_t;
@@ -233,8 +231,7 @@ void id_list_t::upsert(const uint32_t id) {
             split_block(upsert_block, new_block);
 
             last_id_t after_upsert_last_id = upsert_block->ids.last();
-            id_block_map.erase(before_upsert_last_id);
-            id_block_map.emplace(after_upsert_last_id, upsert_block);
+            id_block_map.update(before_upsert_last_id, after_upsert_last_id, upsert_block);
         }
 
         last_id_t after_new_block_id = new_block->ids.last();
@@ -246,14 +243,14 @@ void id_list_t::upsert(const uint32_t id) {
 }
 
 void id_list_t::erase(const uint32_t id) {
-    const auto it = id_block_map.lower_bound(id);
+    const size_t index = id_block_map.lower_bound(id);
 
-    if(it == id_block_map.end()) {
+    if(index == id_block_map.size()) {
         return ;
     }
 
-    block_t* erase_block = it->second;
-    last_id_t before_last_id = it->first;
+    block_t* erase_block = id_block_map.block_at(index);
+    last_id_t before_last_id = id_block_map.last_id_at(index);
     uint32_t num_erased = erase_block->erase(id);
     ids_length -= num_erased;
 
@@ -264,7 +261,7 @@ void id_list_t::erase(const uint32_t id) {
 
         if(erase_block != &root_block) {
             // since we will be deleting the empty node, set the previous node's next pointer to null
-            std::prev(it)->second->next = nullptr;
+            id_block_map.block_at(index - 1)->next = nullptr;
             delete erase_block;
         } else {
             // The root block cannot be empty if there are other blocks so we will pull some contents from next block
@@ -287,8 +284,7 @@ void id_list_t::erase(const uint32_t id) {
     if(new_ids_length >= BLOCK_MAX_ELEMENTS/2 || erase_block->next == nullptr) {
         last_id_t after_last_id = erase_block->ids.last();
         if(before_last_id != after_last_id) {
-            id_block_map.erase(before_last_id);
-            id_block_map.emplace(after_last_id, erase_block);
+            id_block_map.update(before_last_id, after_last_id, erase_block);
         }
 
         return ;
@@ -317,8 +313,7 @@ void id_list_t::erase(const uint32_t id) {
 
     last_id_t after_last_id = erase_block->ids.last();
     if(before_last_id != after_last_id) {
-        id_block_map.erase(before_last_id);
-        id_block_map.emplace(after_last_id, erase_block);
+        id_block_map.update(before_last_id, after_last_id, erase_block);
     }
 }
 
@@ -339,12 +334,12 @@ uint32_t id_list_t::first_id() {
 }
 
 id_list_t::block_t* id_list_t::block_of(uint32_t id) {
-    const auto it = id_block_map.lower_bound(id);
-    if(it == id_block_map.end()) {
+    const size_t index = id_block_map.lower_bound(id);
+    if(index == id_block_map.size()) {
         return nullptr;
     }
 
-    return it->second;
+    return id_block_map.block_at(index);
 }
 
 void id_list_t::merge(const std::vector<id_list_t*>& id_lists, std::vector<uint32_t>& result_ids) {
@@ -494,7 +489,7 @@ id_list_t::iterator_t id_list_t::new_iterator(block_t* start_block, block_t* end
 id_list_t::iterator_t id_list_t::new_rev_iterator() {
     block_t* start_block = nullptr;
     if(!id_block_map.empty()) {
-        start_block = id_block_map.rbegin()->second;
+        start_block = id_block_map.block_at(id_block_map.size() - 1);
     }
 
     auto rev_it = id_list_t::iterator_t(start_block, nullptr, &id_block_map, true);
@@ -575,13 +570,13 @@ size_t id_list_t::num_ids() const {
 }
 
 bool id_list_t::contains(uint32_t id) {
-    const auto it = id_block_map.lower_bound(id);
+    const size_t index = id_block_map.lower_bound(id);
 
-    if(it == id_block_map.end()) {
+    if(index == id_block_map.size()) {
         return false;
     }
 
-    block_t* potential_block = it->second;
+    block_t* potential_block = id_block_map.block_at(index);
     return potential_block->contains(id);
 }
 
@@ -3,6 +3,8 @@
 #include <numeric>
 #include <chrono>
 #include <set>
+#include <deque>
+#include <optional>
 #include <unordered_map>
 #include <array_utils.h>
 #include <match_score.h>
@@ -35,11 +37,14 @@
                     break;\
                 }
 
-spp::sparse_hash_map<uint32_t, int64_t> Index::text_match_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t> Index::seq_id_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t> Index::eval_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t> Index::geo_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t> Index::str_sentinel_value;
+sort_column_t Index::text_match_sentinel_value;
+sort_column_t Index::seq_id_sentinel_value;
+sort_column_t Index::eval_sentinel_value;
+sort_column_t Index::geo_sentinel_value;
+sort_column_t Index::str_sentinel_value;
+
+std::atomic<size_t> Index::filter_result_cache_size{FILTER_RESULT_CACHE_SIZE};
+std::atomic<uint64_t> Index::filter_result_cache_min_cost_us{FILTER_RESULT_CACHE_MIN_COST_US};
 
 struct token_posting_t {
     uint32_t token_id;
@@ -70,10 +75,13 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
             continue;
         }
 
+        filter_generations.emplace(a_field.name, 0);
+
         if(a_field.is_string()) {
             art_tree *t = new art_tree;
             art_tree_init(t);
             search_index.emplace(a_field.name, t);
+            search_index_generations.emplace(a_field.name, 0);
         } else if(a_field.is_geopoint()) {
             auto field_geo_index = new spp::sparse_hash_map<std::string, std::vector<uint32_t>>();
             geopoint_index.emplace(a_field.name, field_geo_index);
@@ -92,18 +100,13 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
                 adi_tree_t* tree = new adi_tree_t();
                 str_sort_index.emplace(a_field.name, tree);
             } else if(a_field.type != field_types::GEOPOINT_ARRAY) {
-                spp::sparse_hash_map<uint32_t, int64_t> * doc_to_score = new spp::sparse_hash_map<uint32_t, int64_t>();
+                sort_column_t* doc_to_score = new sort_column_t();
                 sort_index.emplace(a_field.name, doc_to_score);
             }
         }
 
         if(a_field.facet) {
-            array_mapped_facet_t facet_array;
-            for(size_t i = 0; i < ARRAY_FACET_DIM; i++) {
-                facet_array[i] = new facet_map_t();
-            }
-
-            facet_index_v3.emplace(a_field.name, facet_array);
+            facet_index_v4.emplace(a_field.name, new facet_index_t());
         }
 
         // initialize for non-string facet fields
@@ -128,6 +131,11 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
 }
 
 Index::~Index() {
+    // a build in progress needs the shared lock
+    if(group_key_column_builder.joinable()) {
+        group_key_column_builder.join();
+    }
+
     std::unique_lock lock(mutex);
 
     for(auto & name_tree: search_index) {
@@ -186,14 +194,14 @@ Index::~Index() {
 
     str_sort_index.clear();
 
-    for(auto& field_name_facet_map_array: facet_index_v3) {
-        for(auto& facet_map: field_name_facet_map_array.second) {
-            delete facet_map;
-            facet_map = nullptr;
-        }
+    for(auto& name_facet_index: facet_index_v4) {
+        delete name_facet_index.second;
+        name_facet_index.second = nullptr;
     }
 
-    facet_index_v3.clear();
+    facet_index_v4.clear();
+
+    clear_group_key_columns();
 
     delete seq_ids;
 
@@ -243,6 +251,23 @@ float Index::int64_t_to_float(int64_t n) {
     return f;
 }
 
+// facet value as displayed in facet counts, from the text that is tokenized for the facet hash
+static std::string facet_display_value(const field& a_field, const std::string& text) {
+    if(a_field.type == field_types::FLOAT || a_field.type == field_types::FLOAT_ARRAY) {
+        std::string value = text;
+        if(value != "0") {
+            value.erase(value.find_last_not_of('0') + 1, std::string::npos);  // remove trailing zeros
+        }
+        return value;
+    }
+
+    if(a_field.type == field_types::BOOL || a_field.type == field_types::BOOL_ARRAY) {
+        return (text == "1") ? "true" : "false";
+    }
+
+    return text;
+}
+
 void Index::compute_token_offsets_facets(index_record& record,
                                          const tsl::htrie_map<char, field>& search_schema,
                                          const std::vector<char>& local_token_separators,
@@ -286,6 +311,10 @@ void Index::compute_token_offsets_facets(index_record& record,
                 tokenize_string_array_with_facets(strings, is_facet, the_field,
                                                   local_symbols_to_index, local_token_separators,
                                                   offset_facet_hashes.offsets, offset_facet_hashes.facet_hashes);
+
+                for(const auto& str: strings) {
+                    offset_facet_hashes.facet_values.push_back(facet_display_value(the_field, str));
+                }
             } else {
                 std::string text;
 
@@ -302,6 +331,8 @@ void Index::compute_token_offsets_facets(index_record& record,
                 tokenize_string_with_facets(text, is_facet, the_field,
                                             local_symbols_to_index, local_token_separators,
                                             offset_facet_hashes.offsets, offset_facet_hashes.facet_hashes);
+
+                offset_facet_hashes.facet_values.push_back(facet_display_value(the_field, text));
             }
         }
 
@@ -311,10 +342,20 @@ void Index::compute_token_offsets_facets(index_record& record,
                 tokenize_string_with_facets(document[field_name], is_facet, the_field,
                                             local_symbols_to_index, local_token_separators,
                                             offset_facet_hashes.offsets, offset_facet_hashes.facet_hashes);
+
+                if(is_facet) {
+                    offset_facet_hashes.facet_values.push_back(document[field_name].get<std::string>());
+                }
             } else {
                 tokenize_string_array_with_facets(document[field_name], is_facet, the_field,
                                                   local_symbols_to_index, local_token_separators,
                                                   offset_facet_hashes.offsets, offset_facet_hashes.facet_hashes);
+
+                if(is_facet) {
+                    for(const auto& str: document[field_name]) {
+                        offset_facet_hashes.facet_values.push_back(str.get<std::string>());
+                    }
+                }
             }
         }
 
@@ -601,10 +642,7 @@ void Index::validate_and_preprocess(Index *index, std::vector<index_record>& ite
             if(index_rec.doc.count(default_sorting_field) == 0) {
                 auto default_sorting_field_it = index->sort_index.find(default_sorting_field);
                 if(default_sorting_field_it != index->sort_index.end()) {
-                    auto seq_id_it = default_sorting_field_it->second->find(index_rec.seq_id);
-                    if(seq_id_it != default_sorting_field_it->second->end()) {
-                        points = seq_id_it->second;
-                    } else {
+                    if(!default_sorting_field_it->second->get(index_rec.seq_id, points)) {
                         points = INT64_MIN;
                     }
                 } else {
@@ -686,6 +724,11 @@ size_t Index::batch_memory_index(Index *index, std::vector<index_record>& iter_b
 
         if(index_rec.is_update) {
             index->remove(index_rec.seq_id, index_rec.del_doc, {}, index_rec.is_update);
+
+            if(index_rec.doc.count(default_sorting_field) != 0) {
+                // value has changed (unchanged fields are scrubbed during validation)
+                index->updated_points[index_rec.seq_id] = index_rec.points;
+            }
         } else if(index_rec.indexed.ok()) {
             num_indexed++;
         }
@@ -730,6 +773,8 @@ size_t Index::batch_memory_index(Index *index, std::vector<index_record>& iter_b
         cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
     }
 
+    index->update_group_key_columns(iter_batch);
+
     return num_indexed;
 }
 
@@ -745,6 +790,7 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
             if(!record.is_update && record.indexed.ok()) {
                 // for updates, the seq_id will already exist
                 seq_ids->upsert(record.seq_id);
+                seq_ids_generation++;
             }
         }
 
@@ -755,6 +801,14 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
         return;
     }
 
+    const bool field_written = std::any_of(iter_batch.begin(), iter_batch.end(), [&afield](const index_record& record) {
+        return record.indexed.ok() && record.doc.count(afield.name) != 0;
+    });
+
+    if(field_written) {
+        advance_filter_generation(afield.name);
+    }
+
     // We have to handle both these edge cases:
     // a) `afield` might not exist in the document (optional field)
     // b) `afield` value could be empty
@@ -785,19 +839,12 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
             }
 
             if(afield.facet) {
-                facet_hash_values_t fhashvalues;
-                fhashvalues.length = field_index_it->second.facet_hashes.size();
-                fhashvalues.hashes = new uint64_t[field_index_it->second.facet_hashes.size()];
-
-                for(size_t i  = 0; i < field_index_it->second.facet_hashes.size(); i++) {
-                    fhashvalues.hashes[i] = field_index_it->second.facet_hashes[i];
-                }
-
-                auto& facet_dim_index = facet_index_v3[afield.name][seq_id % ARRAY_FACET_DIM];
-                if(facet_dim_index == nullptr) {
+                auto facet_index_it = facet_index_v4.find(afield.name);
+                if(facet_index_it == facet_index_v4.end()) {
                     LOG(ERROR) << "Error, facet index not initialized for field " << afield.name;
                 } else {
-                    facet_dim_index->emplace(seq_id, std::move(fhashvalues));
+                    facet_index_it->second->insert(seq_id, field_index_it->second.facet_hashes,
+                                                   field_index_it->second.facet_values);
                 }
             }
 
@@ -833,6 +880,10 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
             //LOG(INFO) << "key: " << key << ", art_doc.id: " << art_doc.id;
             art_inserts(t, key, key_len, max_score, documents);
         }
+
+        if(!token_to_doc_offsets.empty()) {
+            advance_search_index_generation(afield.faceted_name());
+        }
     }
 
     if(!afield.is_string()) {
@@ -1019,7 +1070,7 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
 
         // add numerical values automatically into sort index if sorting is enabled
         if(afield.is_num_sortable() && afield.type != field_types::GEOPOINT_ARRAY) {
-            spp::sparse_hash_map<uint32_t, int64_t> *doc_to_score = sort_index.at(afield.name);
+            sort_column_t* doc_to_score = sort_index.at(afield.name);
 
             bool is_integer = afield.is_integer();
             bool is_float = afield.is_float();
@@ -1226,10 +1277,26 @@ void Index::compute_facet_stats(facet &a_facet, uint64_t raw_value, const std::s
     }
 }
 
+// percentile of a document in facet sampling: uniform over the IDs, but stable across queries
+static inline uint32_t facet_sample_percentile(uint32_t seq_id) {
+    // murmur3 finalizer
+    seq_id ^= seq_id >> 16;
+    seq_id *= 0x85ebca6b;
+    seq_id ^= seq_id >> 13;
+    seq_id *= 0xc2b2ae35;
+    seq_id ^= seq_id >> 16;
+    return seq_id % 100;
+}
+
 void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
                       const std::vector<facet_info_t>& facet_infos,
-                      const size_t group_limit, const std::vector<std::string>& group_by_fields,
-                      const uint32_t* result_ids, size_t results_size) const {
+                      const size_t group_limit, const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
+                      const uint32_t* result_ids, size_t results_size,
+                      std::vector<facet_ordinal_counts_t>& ordinal_counts,
+                      const size_t sample_percent,
+                      const id_bitmap_t* result_bitmap, const uint32_t result_bitmap_start_id) const {
+
+    const bool sampled = (sample_percent < 100);
 
     // assumed that facet fields have already been validated upstream
     for(size_t findex=0; findex < facets.size(); findex++) {
@@ -1239,52 +1306,321 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
         const auto& fquery_hashes = facet_infos[findex].hashes;
         const bool should_compute_stats = facet_infos[findex].should_compute_stats;
 
-        const auto& field_facet_mapping_it = facet_index_v3.find(a_facet.field_name);
-        if(field_facet_mapping_it == facet_index_v3.end()) {
+        const auto& facet_index_it = facet_index_v4.find(a_facet.field_name);
+        if(facet_index_it == facet_index_v4.end()) {
             continue;
         }
 
-        const auto& field_facet_mapping = field_facet_mapping_it->second;
+        const facet_index_t* facet_index = facet_index_it->second;
+        const size_t num_ordinals = facet_index->num_ordinals();
+
+        // ordinals of the values matched by the facet query
+        std::vector<bool> query_ordinals;
+        if(use_facet_query) {
+            query_ordinals.resize(num_ordinals, false);
+            for(const auto& fquery_hash: fquery_hashes) {
+                uint32_t ordinal;
+                if(facet_index->get_ordinal(fquery_hash.first, ordinal)) {
+                    query_ordinals[ordinal] = true;
+                }
+            }
+        }
+
+        // a high cardinality field is counted into a hash map when the results are few
+        const size_t num_counted = sampled ? (results_size * sample_percent / 100) : results_size;
+        const bool dense_counts = (num_ordinals <= num_counted * FACET_DENSE_COUNT_RATIO);
+        std::vector<facet_count_t> dense_ordinal_counts(dense_counts ? num_ordinals : 0);
+        spp::sparse_hash_map<uint32_t, facet_count_t> sparse_ordinal_counts;
+
+        std::optional<id_bitmap_t::iterator_t> result_it;
+        if(result_bitmap != nullptr) {
+            result_it.emplace(result_bitmap->new_iterator());
+            result_it->skip_to(result_bitmap_start_id);
+        }
 
         for(size_t i = 0; i < results_size; i++) {
-            uint32_t doc_seq_id = result_ids[i];
-            const auto& facet_hashes_it = field_facet_mapping[doc_seq_id % ARRAY_FACET_DIM]->find(doc_seq_id);
+            uint32_t doc_seq_id;
+
+            if(result_it) {
+                if(!result_it->valid()) {
+                    break;
+                }
 
-            if(facet_hashes_it == field_facet_mapping[doc_seq_id % ARRAY_FACET_DIM]->end()) {
+                doc_seq_id = result_it->id();
+                result_it->next();
+            } else {
+                doc_seq_id = result_ids[i];
+            }
+
+            if(sampled && facet_sample_percentile(doc_seq_id) >= sample_percent) {
                 continue;
             }
 
-            const auto& facet_hashes = facet_hashes_it->second;
-            const uint64_t distinct_id = group_limit ? get_distinct_id(group_by_fields, doc_seq_id) : 0;
+            const uint32_t* doc_ordinals = nullptr;
+            const uint32_t num_doc_ordinals = facet_index->get(doc_seq_id, doc_ordinals);
+
+            if(num_doc_ordinals == 0) {
+                continue;
+            }
+
+            const uint64_t distinct_id = group_limit ? get_distinct_id(group_key_column, group_by_fields, doc_seq_id) : 0;
 
             if(((i + 1) % 16384) == 0) {
                 RETURN_CIRCUIT_BREAKER
             }
 
-            for(size_t j = 0; j < facet_hashes.size(); j++) {
-                auto fhash = facet_hashes.hashes[j];
+            for(size_t j = 0; j < num_doc_ordinals; j++) {
+                const uint32_t ordinal = doc_ordinals[j];
 
                 if(should_compute_stats) {
-                    compute_facet_stats(a_facet, fhash, facet_field.type);
+                    compute_facet_stats(a_facet, facet_index->get_hash(ordinal), facet_field.type);
                 }
 
-                if(!use_facet_query || fquery_hashes.find(fhash) != fquery_hashes.end()) {
-                    facet_count_t& facet_count = a_facet.result_map[fhash];
+                if(use_facet_query && !query_ordinals[ordinal]) {
+                    continue;
+                }
 
-                    //LOG(INFO) << "field: " << a_facet.field_name << ", doc id: " << doc_seq_id << ", hash: " <<  fhash;
+                facet_count_t& facet_count = dense_counts ? dense_ordinal_counts[ordinal] :
+                                             sparse_ordinal_counts[ordinal];
 
-                    facet_count.doc_id = doc_seq_id;
-                    facet_count.array_pos = j;
+                facet_count.doc_id = doc_seq_id;
+                facet_count.array_pos = j;
 
-                    if(group_limit) {
-                        a_facet.hash_groups[fhash].emplace(distinct_id);
-                    } else {
-                        facet_count.count += 1;
-                    }
+                // grouped counts are taken from `hash_groups` on merge: the count only marks the value as seen
+                facet_count.count += 1;
 
-                    if(use_facet_query) {
-                        a_facet.hash_tokens[fhash] = fquery_hashes.at(fhash);
+                if(group_limit) {
+                    const uint64_t hash = facet_index->get_hash(ordinal);
+                    auto groups_it = a_facet.hash_groups.find(hash);
+                    if(groups_it == a_facet.hash_groups.end()) {
+                        groups_it = a_facet.hash_groups.emplace(hash,
+                                        distinct_counter_t(a_facet.approximate_group_counts)).first;
                     }
+
+                    groups_it->second.add(distinct_id);
+                }
+            }
+        }
+
+        auto& facet_ordinal_counts = ordinal_counts[findex];
+
+        if(dense_counts) {
+            for(size_t ordinal = 0; ordinal < dense_ordinal_counts.size(); ordinal++) {
+                if(dense_ordinal_counts[ordinal].count != 0) {
+                    facet_ordinal_counts.emplace_back(ordinal, dense_ordinal_counts[ordinal]);
+                }
+            }
+        } else {
+            facet_ordinal_counts.assign(sparse_ordinal_counts.begin(), sparse_ordinal_counts.end());
+            std::sort(facet_ordinal_counts.begin(), facet_ordinal_counts.end(),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+        }
+
+        if(sampled) {
+            // scale up to estimates over all the results
+            for(auto& ordinal_count: facet_ordinal_counts) {
+                uint32_t& count = ordinal_count.second.count;
+                count = (uint64_t(count) * 100 + sample_percent / 2) / sample_percent;
+            }
+
+            a_facet.stats.fvcount = a_facet.stats.fvcount * 100 / sample_percent;
+            a_facet.stats.fvsum = a_facet.stats.fvsum * 100 / sample_percent;
+        }
+    }
+}
+
+void Index::merge_facets(std::vector<facet>& facets, const std::vector<std::vector<facet>>& facet_batches,
+                         const std::vector<std::vector<facet_ordinal_counts_t>>& batch_ordinal_counts,
+                         const std::vector<const std::vector<facet_info_t>*>& batch_facet_infos,
+                         const size_t group_limit, const size_t max_facet_values, const size_t concurrency) const {
+
+    // the values of a facet that survive the top-N selection over a range of its ordinals
+    struct partition_t {
+        size_t findex;
+        uint32_t ordinal_begin;
+        uint32_t ordinal_end;
+        size_t num_values;
+        std::vector<std::pair<uint64_t, facet_count_t>> hash_counts;
+        std::vector<distinct_counter_t> hash_groups;
+    };
+
+    std::vector<partition_t> partitions;
+
+    for(size_t findex = 0; findex < facets.size(); findex++) {
+        auto& acc_facet = facets[findex];
+
+        for(const auto& facet_batch: facet_batches) {
+            const auto& this_facet = facet_batch[findex];
+            if(this_facet.stats.fvcount != 0) {
+                acc_facet.stats.fvcount += this_facet.stats.fvcount;
+                acc_facet.stats.fvsum += this_facet.stats.fvsum;
+                acc_facet.stats.fvmax = std::max(acc_facet.stats.fvmax, this_facet.stats.fvmax);
+                acc_facet.stats.fvmin = std::min(acc_facet.stats.fvmin, this_facet.stats.fvmin);
+            }
+        }
+
+        const auto facet_index_it = facet_index_v4.find(acc_facet.field_name);
+        if(facet_index_it == facet_index_v4.end() || max_facet_values == 0) {
+            continue;
+        }
+
+        // the work of a merge is in the counted values, not in the values of the field
+        size_t num_counted_ordinals = 0;
+        for(const auto& ordinal_counts: batch_ordinal_counts) {
+            num_counted_ordinals += ordinal_counts[findex].size();
+        }
+
+        if(num_counted_ordinals == 0) {
+            continue;
+        }
+
+        const size_t num_ordinals = facet_index_it->second->num_ordinals();
+        const size_t num_partitions = std::max<size_t>(1, std::min(concurrency,
+                                                       num_counted_ordinals / FACET_MERGE_PARTITION_MIN_ORDINALS));
+        const size_t partition_size = (num_ordinals + num_partitions - 1) / num_partitions;
+
+        for(size_t ordinal_begin = 0; ordinal_begin < num_ordinals; ordinal_begin += partition_size) {
+            partitions.push_back({findex, uint32_t(ordinal_begin),
+                                  uint32_t(std::min(num_ordinals, ordinal_begin + partition_size)), 0, {}, {}});
+        }
+    }
+
+    // every partition sums its disjoint range of ordinals across the batches and keeps its own top values, so the
+    // global top values are among the partition survivors
+    auto merge_partition = [&](partition_t& partition) {
+        const facet_index_t* facet_index = facet_index_v4.find(facets[partition.findex].field_name)->second;
+
+        // the batches count ordinals in ascending order, so their ranges of the partition are merged k-way
+        typedef facet_ordinal_counts_t::const_iterator ordinal_count_iterator_t;
+        std::vector<std::pair<ordinal_count_iterator_t, ordinal_count_iterator_t>> batch_ranges;
+
+        for(const auto& ordinal_counts: batch_ordinal_counts) {
+            const auto& facet_ordinal_counts = ordinal_counts[partition.findex];
+            auto is_before = [](const auto& a, uint32_t ordinal) { return a.first < ordinal; };
+            auto begin = std::lower_bound(facet_ordinal_counts.begin(), facet_ordinal_counts.end(),
+                                          partition.ordinal_begin, is_before);
+            auto end = std::lower_bound(begin, facet_ordinal_counts.end(), partition.ordinal_end, is_before);
+            batch_ranges.emplace_back(begin, end);
+        }
+
+        // min-heap on (ordinal, batch), so that the count of a later batch is the one whose document is kept
+        std::vector<std::pair<uint32_t, size_t>> batch_heap;
+        for(size_t batch = 0; batch < batch_ranges.size(); batch++) {
+            if(batch_ranges[batch].first != batch_ranges[batch].second) {
+                batch_heap.emplace_back(batch_ranges[batch].first->first, batch);
+            }
+        }
+
+        std::make_heap(batch_heap.begin(), batch_heap.end(), std::greater<>());
+
+        auto union_groups = [&](uint64_t hash, distinct_counter_t& groups) {
+            for(const auto& facet_batch: facet_batches) {
+                const auto& batch_groups = facet_batch[partition.findex].hash_groups;
+                const auto groups_it = batch_groups.find(hash);
+                if(groups_it != batch_groups.end()) {
+                    groups.merge(groups_it->second);
+                }
+            }
+        };
+
+        // min-heap on (count, hash), which is the order in which facet values are picked for display
+        auto is_better = [](const std::pair<uint64_t, facet_count_t>& a, const std::pair<uint64_t, facet_count_t>& b) {
+            return std::tie(a.second.count, a.first) > std::tie(b.second.count, b.first);
+        };
+
+        auto& heap = partition.hash_counts;
+
+        while(!batch_heap.empty()) {
+            const uint32_t ordinal = batch_heap.front().first;
+            facet_count_t count;
+
+            while(!batch_heap.empty() && batch_heap.front().first == ordinal) {
+                std::pop_heap(batch_heap.begin(), batch_heap.end(), std::greater<>());
+                auto& batch_range = batch_ranges[batch_heap.back().second];
+
+                count.count += batch_range.first->second.count;
+                count.doc_id = batch_range.first->second.doc_id;
+                count.array_pos = batch_range.first->second.array_pos;
+
+                if(++batch_range.first == batch_range.second) {
+                    batch_heap.pop_back();
+                } else {
+                    batch_heap.back().first = batch_range.first->first;
+                    std::push_heap(batch_heap.begin(), batch_heap.end(), std::greater<>());
+                }
+            }
+
+            if(count.count == 0) {
+                continue;
+            }
+
+            partition.num_values++;
+
+            std::pair<uint64_t, facet_count_t> hash_count(facet_index->get_hash(ordinal), count);
+
+            if(group_limit) {
+                distinct_counter_t groups;
+                union_groups(hash_count.first, groups);
+                hash_count.second.count = groups.count();
+            }
+
+            if(heap.size() < max_facet_values) {
+                heap.push_back(hash_count);
+                std::push_heap(heap.begin(), heap.end(), is_better);
+            } else if(is_better(hash_count, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), is_better);
+                heap.back() = hash_count;
+                std::push_heap(heap.begin(), heap.end(), is_better);
+            }
+        }
+
+        if(group_limit) {
+            partition.hash_groups.resize(heap.size());
+            for(size_t i = 0; i < heap.size(); i++) {
+                union_groups(heap[i].first, partition.hash_groups[i]);
+            }
+        }
+    };
+
+    if(partitions.size() == 1) {
+        merge_partition(partitions[0]);
+    } else if(partitions.size() > 1) {
+        size_t num_processed = 0;
+        std::mutex m_process;
+        std::condition_variable cv_process;
+
+        for(auto& partition: partitions) {
+            thread_pool->enqueue([&merge_partition, &partition, &num_processed, &m_process, &cv_process]() {
+                merge_partition(partition);
+                std::unique_lock<std::mutex> lock(m_process);
+                num_processed++;
+                cv_process.notify_one();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock_process(m_process);
+        cv_process.wait(lock_process, [&](){ return num_processed == partitions.size(); });
+    }
+
+    for(auto& partition: partitions) {
+        auto& acc_facet = facets[partition.findex];
+        acc_facet.total_values += partition.num_values;
+
+        for(size_t i = 0; i < partition.hash_counts.size(); i++) {
+            const uint64_t hash = partition.hash_counts[i].first;
+            acc_facet.result_map.emplace(hash, partition.hash_counts[i].second);
+
+            if(group_limit) {
+                acc_facet.hash_groups.emplace(hash, std::move(partition.hash_groups[i]));
+            }
+
+            // tokens matched by the facet query are carried only for the surviving values
+            for(auto infos_it = batch_facet_infos.rbegin(); infos_it != batch_facet_infos.rend(); infos_it++) {
+                const auto& fquery_hashes = (**infos_it)[partition.findex].hashes;
+                const auto tokens_it = fquery_hashes.find(hash);
+                if(tokens_it != fquery_hashes.end()) {
+                    acc_facet.hash_tokens.emplace(hash, tokens_it->second);
+                    break;
                 }
             }
         }
@@ -1293,10 +1629,9 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
 
 void Index::aggregate_topster(Topster* agg_topster, Topster* index_topster) {
     if(index_topster->distinct) {
-        for(auto &group_topster_entry: index_topster->group_kv_map) {
-            Topster* group_topster = group_topster_entry.second;
-            for(const auto& map_kv: group_topster->kv_map) {
-                agg_topster->add(map_kv.second);
+        for(uint32_t group = 0; group < index_topster->num_groups; group++) {
+            for(uint32_t i = 0; i < index_topster->getGroupSize(group); i++) {
+                agg_topster->add(index_topster->getGroupKV(group, i));
             }
         }
     } else {
@@ -1310,6 +1645,8 @@ void Index::search_all_candidates(const size_t num_search_fields,
                                   const text_match_type_t match_type,
                                   const std::vector<search_field_t>& the_fields,
                                   const uint32_t* filter_ids, size_t filter_ids_length,
+                                  const id_bitmap_t* filter_bitmap,
+                                  filter_result_iterator_t* filter_iterator,
                                   const uint32_t* exclude_token_ids, size_t exclude_token_ids_size,
                                   const std::vector<sort_by>& sort_fields,
                                   std::vector<tok_candidates>& token_candidates_vec,
@@ -1320,7 +1657,7 @@ void Index::search_all_candidates(const size_t num_search_fields,
                                   uint32_t*& all_result_ids, size_t& all_result_ids_len,
                                   const size_t typo_tokens_threshold,
                                   const size_t group_limit,
-                                  const std::vector<std::string>& group_by_fields,
+                                  const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
                                   const std::vector<token_t>& query_tokens,
                                   const std::vector<uint32_t>& num_typos,
                                   const std::vector<bool>& prefixes,
@@ -1330,8 +1667,9 @@ void Index::search_all_candidates(const size_t num_search_fields,
                                   const size_t max_candidates,
                                   int syn_orig_num_tokens,
                                   const int* sort_order,
-                                  std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                                  std::array<sort_column_t*, 3>& field_values,
                                   const std::vector<size_t>& geopoint_indices,
+                                  const std::string& default_sorting_field,
                                   std::set<uint64>& query_hashes,
                                   std::vector<uint32_t>& id_buff) const {
 
@@ -1374,11 +1712,12 @@ void Index::search_all_candidates(const size_t num_search_fields,
 
         search_across_fields(query_suggestion, num_typos, prefixes, the_fields, num_search_fields, match_type,
                              sort_fields, topster,groups_processed,
-                             searched_queries, qtoken_set, group_limit, group_by_fields,
+                             searched_queries, qtoken_set, group_limit, group_by_fields, group_key_column,
                              prioritize_exact_match, prioritize_token_position,
-                             filter_ids, filter_ids_length, total_cost, syn_orig_num_tokens,
+                             filter_ids, filter_ids_length, filter_bitmap, filter_iterator,
+                             total_cost, syn_orig_num_tokens,
                              exclude_token_ids, exclude_token_ids_size,
-                             sort_order, field_values, geopoint_indices,
+                             sort_order, field_values, geopoint_indices, default_sorting_field,
                              id_buff, all_result_ids, all_result_ids_len);
 
         query_hashes.insert(qhash);
@@ -1398,7 +1737,7 @@ void Index::search_candidates(const uint8_t & field_id, bool field_is_array,
                               size_t& field_num_results,
                               const size_t typo_tokens_threshold,
                               const size_t group_limit,
-                              const std::vector<std::string>& group_by_fields,
+                              const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
                               const std::vector<token_t>& query_tokens,
                               bool prioritize_exact_match,
                               const bool exhaustive_search,
@@ -1411,7 +1750,7 @@ void Index::search_candidates(const uint8_t & field_id, bool field_is_array,
     long long int N = std::accumulate(token_candidates_vec.begin(), token_candidates_vec.end(), 1LL, product);
 
     int sort_order[3]; // 1 or -1 based on DESC or ASC respectively
-    std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values;
+    std::array<sort_column_t*, 3> field_values;
     std::vector<size_t> geopoint_indices;
 
     populate_sort_mapping(sort_order, geopoint_indices, sort_fields, field_values);
@@ -1474,22 +1813,54 @@ void Index::search_candidates(const uint8_t & field_id, bool field_is_array,
             single_exact_query_token = true;
         }
 
-        if(topster == nullptr) {
-            posting_t::block_intersector_t(posting_lists, iter_state)
-            .intersect([&](uint32_t seq_id, std::vector<posting_list_t::iterator_t>& its) {
+        // Heavy intersections are split into disjoint ID ranges across the thread pool. The first range feeds
+        // the actual topster, while the others accumulate into their own state that is merged once done.
+        const size_t num_ranges = std::max<size_t>(concurrency, 1);
+        std::vector<std::unique_ptr<Topster>> range_topsters(num_ranges);
+        std::vector<std::unique_ptr<spp::sparse_hash_set<uint64_t>>> range_groups_processed(num_ranges);
+        std::vector<std::vector<uint32_t>> range_id_buffs(num_ranges);
+
+        posting_t::block_intersector_t(posting_lists, iter_state, thread_pool, PARALLEL_INTERSECTION_MIN_IDS)
+        .intersect([&](uint32_t seq_id, std::vector<posting_list_t::iterator_t>& its, size_t range_index) {
+            if(range_index == 0) {
+                if(topster != nullptr) {
+                    score_results(sort_fields, searched_queries.size(), field_id, field_is_array,
+                                  total_cost, topster, query_suggestion, groups_processed,
+                                  seq_id, sort_order, field_values, geopoint_indices,
+                                  group_limit, group_by_fields, group_key_column, token_bits,
+                                  prioritize_exact_match, single_exact_query_token, syn_orig_num_tokens, its);
+                }
+
                 id_buff.push_back(seq_id);
-            });
-        } else {
-            posting_t::block_intersector_t(posting_lists, iter_state)
-            .intersect([&](uint32_t seq_id, std::vector<posting_list_t::iterator_t>& its) {
+                return;
+            }
+
+            if(topster != nullptr) {
+                if(range_topsters[range_index] == nullptr) {
+                    range_topsters[range_index].reset(new Topster(topster->MAX_SIZE, topster->distinct));
+                    range_groups_processed[range_index].reset(new spp::sparse_hash_set<uint64_t>());
+                }
+
                 score_results(sort_fields, searched_queries.size(), field_id, field_is_array,
-                              total_cost, topster, query_suggestion, groups_processed,
+                              total_cost, range_topsters[range_index].get(), query_suggestion,
+                              *range_groups_processed[range_index],
                               seq_id, sort_order, field_values, geopoint_indices,
-                              group_limit, group_by_fields, token_bits,
+                              group_limit, group_by_fields, group_key_column, token_bits,
                               prioritize_exact_match, single_exact_query_token, syn_orig_num_tokens, its);
+            }
 
-                id_buff.push_back(seq_id);
-            });
+            range_id_buffs[range_index].push_back(seq_id);
+        }, num_ranges);
+
+        for(size_t range_index = 1; range_index < num_ranges; range_index++) {
+            if(range_topsters[range_index] != nullptr) {
+                aggregate_topster(topster, range_topsters[range_index].get());
+                groups_processed.insert(range_groups_processed[range_index]->begin(),
+                                        range_groups_processed[range_index]->end());
+            }
+
+            // ranges are in ascending order of IDs
+            id_buff.insert(id_buff.end(), range_id_buffs[range_index].begin(), range_id_buffs[range_index].end());
         }
 
         delete [] excluded_result_ids;
@@ -1701,7 +2072,7 @@ void Index::do_filtering(uint32_t*& filter_ids,
             std::vector<uint32_t> exact_geo_result_ids;
 
             if (f.is_single_geopoint()) {
-                spp::sparse_hash_map<uint32_t, int64_t>* sort_field_index = sort_index.at(f.name);
+                sort_column_t* sort_field_index = sort_index.at(f.name);
 
                 for (auto result_id : geo_result_ids) {
                     // no need to check for existence of `result_id` because of indexer based pre-filtering above
@@ -1889,43 +2260,354 @@ void Index::recursive_filter(uint32_t*& filter_ids,
         return;
     }
 
-    uint32_t* l_filter_ids = nullptr;
-    uint32_t l_filter_ids_length = 0;
-    if (root->left != nullptr) {
-        recursive_filter(l_filter_ids, l_filter_ids_length, root->left,
-                         enable_short_circuit);
+    id_bitmap_t filter_bitmap;
+    recursive_filter(filter_bitmap, root, enable_short_circuit);
+
+    filter_ids_length = filter_bitmap.cardinality();
+    filter_ids = filter_bitmap.uncompress();
+}
+
+bool Index::get_filter_cache_key(const filter_node_t* root, std::string& key,
+                                 std::vector<uint64_t>& generations, filter_cache_keys_t& cache_keys) const {
+    if (root->isOperator) {
+        if (root->left == nullptr || root->right == nullptr) {
+            return false;
+        }
+
+        std::string l_key, r_key;
+        std::vector<uint64_t> l_generations, r_generations;
+
+        // both operands are keyed, since either can be cached on its own
+        const bool l_cached = get_filter_cache_key(root->left, l_key, l_generations, cache_keys);
+        const bool r_cached = get_filter_cache_key(root->right, r_key, r_generations, cache_keys);
+
+        if (!l_cached || !r_cached) {
+            return false;
+        }
+
+        // operands are ordered, so that commuted trees share their entries
+        if (r_key < l_key) {
+            std::swap(l_key, r_key);
+            std::swap(l_generations, r_generations);
+        }
+
+        key = (root->filter_operator == AND) ? "&" : "|";
+        key += std::to_string(l_key.size()) + ":" + l_key + r_key;
+
+        generations = std::move(l_generations);
+        generations.insert(generations.end(), r_generations.begin(), r_generations.end());
+
+        cache_keys.emplace(root, std::make_pair(key, generations));
+        return true;
+    }
+
+    // `id` filters are cheap, and they are not held by a field of the index
+    const filter& a_filter = root->filter_exp;
+    const auto generation_it = filter_generations.find(a_filter.field_name);
+    if (generation_it == filter_generations.end()) {
+        return false;
+    }
+
+    key = "=" + std::to_string(a_filter.field_name.size()) + ":" + a_filter.field_name;
+
+    // string filters have one comparator for all of their values, numerical filters have one per value
+    key += std::to_string(a_filter.comparators.size()) + ":";
+    for (const auto& comparator: a_filter.comparators) {
+        key += char(comparator);
+    }
+
+    for (const auto& value: a_filter.values) {
+        key += std::to_string(value.size()) + ":" + value;
+    }
+
+    generations.push_back(generation_it->second);
+
+    if (std::find(a_filter.comparators.begin(), a_filter.comparators.end(), NOT_EQUALS) !=
+        a_filter.comparators.end()) {
+        generations.push_back(seq_ids_generation);
+    }
+
+    cache_keys.emplace(root, std::make_pair(key, generations));
+    return true;
+}
+
+void Index::recursive_filter(id_bitmap_t& filter_bitmap,
+                             const filter_node_t* root,
+                             const bool enable_short_circuit) const {
+    if (root == nullptr) {
+        return;
+    }
+
+    if (!filter_result_cache.enabled()) {
+        evaluate_filter_tree(filter_bitmap, root, enable_short_circuit, nullptr);
+        return;
     }
 
-    uint32_t* r_filter_ids = nullptr;
-    uint32_t r_filter_ids_length = 0;
-    if (root->right != nullptr) {
-        recursive_filter(r_filter_ids, r_filter_ids_length, root->right,
-                         enable_short_circuit);
+    // the keys of all subtrees are built in one pass over the tree
+    filter_cache_keys_t cache_keys;
+    std::string cache_key;
+    std::vector<uint64_t> generations;
+    get_filter_cache_key(root, cache_key, generations, cache_keys);
+
+    evaluate_filter_tree(filter_bitmap, root, enable_short_circuit, &cache_keys);
+}
+
+void Index::evaluate_filter_tree(id_bitmap_t& filter_bitmap,
+                                 const filter_node_t* root,
+                                 const bool enable_short_circuit,
+                                 const filter_cache_keys_t* cache_keys) const {
+    const std::pair<std::string, std::vector<uint64_t>>* cache_key = nullptr;
+
+    if (cache_keys != nullptr) {
+        const auto cache_key_it = cache_keys->find(root);
+        if (cache_key_it != cache_keys->end()) {
+            cache_key = &cache_key_it->second;
+
+            auto cached_bitmap = filter_result_cache.get(cache_key->first, cache_key->second);
+            if (cached_bitmap != nullptr) {
+                filter_bitmap = *cached_bitmap;
+                return;
+            }
+        }
     }
 
+    const auto begin = std::chrono::steady_clock::now();
+
     if (root->isOperator) {
-        uint32_t* filtered_results = nullptr;
-        if (root->filter_operator == AND) {
-            filter_ids_length = ArrayUtils::and_scalar(
-                l_filter_ids, l_filter_ids_length, r_filter_ids,
-                r_filter_ids_length, &filtered_results);
-        } else {
-            filter_ids_length = ArrayUtils::or_scalar(
-                l_filter_ids, l_filter_ids_length, r_filter_ids,
-                r_filter_ids_length, &filtered_results);
+        id_bitmap_t l_filter_bitmap;
+        if (root->left != nullptr) {
+            evaluate_filter_tree(l_filter_bitmap, root->left, enable_short_circuit, cache_keys);
         }
 
-        delete[] l_filter_ids;
-        delete[] r_filter_ids;
+        if (root->filter_operator == AND && enable_short_circuit && l_filter_bitmap.empty()) {
+            // no need to evaluate the right sub-tree
+            filter_bitmap.clear();
+        } else {
+            id_bitmap_t r_filter_bitmap;
+            if (root->right != nullptr) {
+                evaluate_filter_tree(r_filter_bitmap, root->right, enable_short_circuit, cache_keys);
+            }
 
-        filter_ids = filtered_results;
+            if (root->filter_operator == AND) {
+                id_bitmap_t::intersect(l_filter_bitmap, r_filter_bitmap, filter_bitmap);
+            } else {
+                id_bitmap_t::merge(l_filter_bitmap, r_filter_bitmap, filter_bitmap);
+            }
+        }
     } else if (root->left == nullptr && root->right == nullptr) {
+        uint32_t* filter_ids = nullptr;
+        uint32_t filter_ids_length = 0;
         do_filtering(filter_ids, filter_ids_length, root);
+
+        filter_bitmap = id_bitmap_t(filter_ids, filter_ids_length);
+        delete[] filter_ids;
     } else {
         // malformed
+        return;
+    }
+
+    if (cache_key == nullptr) {
+        return;
+    }
+
+    // only costly subtrees are cached: cheap leaves, and operators over cached operands, are recomputed
+    const uint64_t cost_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+
+    if (cost_us >= filter_result_cache_min_cost_us) {
+        filter_result_cache.put(cache_key->first, cache_key->second, std::make_shared<const id_bitmap_t>(filter_bitmap));
     }
 }
 
+bool Index::new_lazy_filter_iterator(const filter_node_t* root, filter_result_iterator_t& filter_iterator) const {
+    if (root == nullptr) {
+        filter_iterator = filter_result_iterator_t();
+        return true;
+    }
+
+    if (root->isOperator) {
+        std::vector<filter_result_iterator_t> children(2);
+        if (!new_lazy_filter_iterator(root->left, children[0]) ||
+            !new_lazy_filter_iterator(root->right, children[1])) {
+            return false;
+        }
+
+        filter_iterator = (root->filter_operator == AND) ?
+                          filter_result_iterator_t::and_node(std::move(children)) :
+                          filter_result_iterator_t::or_node(std::move(children));
+        return true;
+    }
+
+    const filter& a_filter = root->filter_exp;
+
+    if (a_filter.field_name == "id") {
+        std::vector<uint32_t> result_ids;
+        for (const auto& id_str : a_filter.values) {
+            result_ids.push_back(std::stoul(id_str));
+        }
+
+        std::sort(result_ids.begin(), result_ids.end());
+        result_ids.erase(std::unique(result_ids.begin(), result_ids.end()), result_ids.end());
+
+        filter_iterator = filter_result_iterator_t::ids_leaf(std::move(result_ids));
+        return true;
+    }
+
+    bool has_search_index = search_index.count(a_filter.field_name) != 0 ||
+                            numerical_index.count(a_filter.field_name) != 0 ||
+                            geopoint_index.count(a_filter.field_name) != 0;
+
+    if (!has_search_index) {
+        filter_iterator = filter_result_iterator_t();
+        return true;
+    }
+
+    const field& f = search_schema.at(a_filter.field_name);
+    std::vector<filter_result_iterator_t> value_its;
+
+    if (f.is_integer() || f.is_float() || f.is_bool()) {
+        // ranges span many ID lists, so only equality is evaluated lazily
+        for (const auto& comparator : a_filter.comparators) {
+            if (comparator != EQUALS) {
+                return false;
+            }
+        }
+
+        auto num_tree = numerical_index.at(a_filter.field_name);
+
+        for (const std::string& filter_value : a_filter.values) {
+            int64_t value;
+            if (f.is_integer()) {
+                value = (int64_t) std::stol(filter_value);
+            } else if (f.is_float()) {
+                value = float_to_int64_t((float) std::atof(filter_value.c_str()));
+            } else {
+                value = (filter_value == "1") ? 1 : 0;
+            }
+
+            void* ids = num_tree->get_ids(value);
+            if (ids != nullptr) {
+                value_its.push_back(filter_result_iterator_t::id_list_leaf(ids));
+            }
+        }
+    } else if (f.is_string()) {
+        // exact matches need the token offsets of every document
+        if (a_filter.comparators[0] == EQUALS || a_filter.comparators[0] == NOT_EQUALS) {
+            return false;
+        }
+
+        art_tree* t = search_index.at(a_filter.field_name);
+
+        for (const std::string& filter_value : a_filter.values) {
+            std::vector<filter_result_iterator_t> token_its;
+            Tokenizer tokenizer(filter_value, true, false, f.locale, symbols_to_index, token_separators);
+
+            std::string str_token;
+            size_t token_index = 0;
+            bool all_tokens_found = true;
+
+            while (tokenizer.next(str_token, token_index)) {
+                art_leaf* leaf = (art_leaf *) art_search(t, (const unsigned char*) str_token.c_str(),
+                                                         str_token.length()+1);
+                if (leaf == nullptr) {
+                    all_tokens_found = false;
+                    break;
+                }
+
+                token_its.push_back(filter_result_iterator_t::posting_leaf(leaf->values));
+            }
+
+            if (all_tokens_found && !token_its.empty()) {
+                value_its.push_back(filter_result_iterator_t::and_node(std::move(token_its)));
+            }
+        }
+    } else {
+        return false;
+    }
+
+    filter_iterator = filter_result_iterator_t::or_node(std::move(value_its));
+    return true;
+}
+
+bool Index::plan_lazy_filter(filter_node_t const* const filter_tree_root,
+                             const std::vector<search_field_t>& the_fields, const size_t num_search_fields,
+                             const std::vector<token_t>& query_tokens, const std::vector<uint32_t>& num_typos,
+                             const std::vector<bool>& prefixes, const token_ordering token_order,
+                             const size_t min_len_1typo, const size_t min_len_2typo,
+                             filter_result_iterator_t& filter_iterator) const {
+    // Materializing a filter takes time proportional to the number of documents matched by the filter, while
+    // probing it takes time proportional to the number of documents matched by the text query. The text matches
+    // are estimated from the candidates that the query tokens expand to, as the text search would find them: the
+    // rarest token bounds the matches of each field. Tokens that expand too widely, like a short prefix, are not
+    // estimated and leave the filter to be materialized.
+    size_t text_estimate = 0;
+    bool text_estimated = false;
+
+    for (size_t i = 0; i < num_search_fields; i++) {
+        const auto& the_field = the_fields[i];
+        auto search_index_it = search_index.find(the_field.name);
+        if (search_index_it == search_index.end()) {
+            continue;
+        }
+
+        const bool field_prefix = (the_field.orig_index < prefixes.size()) ? prefixes[the_field.orig_index] :
+                                                                            prefixes[0];
+        uint32_t field_num_typos = (the_field.orig_index < num_typos.size()) ? num_typos[the_field.orig_index] :
+                                                                              num_typos[0];
+
+        const auto& locale = search_schema.at(the_field.name).locale;
+        if (locale != "" && locale != "en" && locale != "th" && !Tokenizer::is_cyrillic(locale)) {
+            field_num_typos = 0;
+        }
+
+        size_t field_estimate = SIZE_MAX;
+
+        for (const auto& query_token : query_tokens) {
+            const bool prefix_search = field_prefix && query_token.is_prefix_searched;
+            const int bounded_cost = get_bounded_typo_cost(std::min<uint32_t>(field_num_typos, 2),
+                                                           query_token.value.length(), min_len_1typo, min_len_2typo);
+            size_t token_estimate = 0;
+
+            if (bounded_cost == 0 && !prefix_search) {
+                art_leaf* leaf = (art_leaf *) art_search(search_index_it->second,
+                                                         (const unsigned char*) query_token.value.c_str(),
+                                                         query_token.value.length()+1);
+                if (leaf != nullptr) {
+                    token_estimate = posting_t::num_ids(leaf->values);
+                }
+            } else {
+                // the candidates are cached, so the text search that follows finds them again for free
+                for (int cost = 0; cost <= bounded_cost; cost++) {
+                    std::vector<art_leaf*> leaves;
+                    find_typo_candidates(the_field.name, query_token.value, cost, prefix_search, token_order,
+                                         LAZY_FILTER_MAX_EXPANSION + 1, nullptr, 0, nullptr, {}, leaves);
+
+                    if (leaves.size() > LAZY_FILTER_MAX_EXPANSION) {
+                        return false;
+                    }
+
+                    for (art_leaf* leaf : leaves) {
+                        token_estimate += posting_t::num_ids(leaf->values);
+                    }
+                }
+            }
+
+            field_estimate = std::min(field_estimate, token_estimate);
+        }
+
+        if (field_estimate != SIZE_MAX) {
+            text_estimate += field_estimate;
+            text_estimated = true;
+        }
+    }
+
+    if (!text_estimated || !new_lazy_filter_iterator(filter_tree_root, filter_iterator)) {
+        return false;
+    }
+
+    return filter_iterator.approx_cardinality() >= std::max<size_t>(text_estimate, 1) * LAZY_FILTER_RATIO;
+}
+
 void Index::do_filtering_with_lock(uint32_t*& filter_ids,
                                    uint32_t& filter_ids_length,
                                    filter_node_t const* const& filter_tree_root) const {
@@ -1962,6 +2644,9 @@ void Index::run_search(search_args* search_params) {
            search_params->max_extra_prefix,
            search_params->max_extra_suffix,
            search_params->facet_query_num_typos,
+           search_params->max_facet_values,
+           search_params->facet_sample_percent,
+           search_params->facet_sample_threshold,
            search_params->filter_curated_hits,
            search_params->split_join_tokens,
            search_params->vector_query);
@@ -2001,10 +2686,10 @@ void Index::collate_included_ids(const std::vector<token_t>& q_included_tokens,
 
 void Index::concat_topster_ids(Topster* topster, spp::sparse_hash_map<uint64_t, std::vector<KV*>>& topster_ids) {
     if(topster->distinct) {
-        for(auto &group_topster_entry: topster->group_kv_map) {
-            Topster* group_topster = group_topster_entry.second;
-            for(const auto& map_kv: group_topster->kv_map) {
-                topster_ids[map_kv.first].push_back(map_kv.second);
+        for(uint32_t group = 0; group < topster->num_groups; group++) {
+            for(uint32_t i = 0; i < topster->getGroupSize(group); i++) {
+                KV* kv = topster->getGroupKV(group, i);
+                topster_ids[kv->key].push_back(kv);
             }
         }
     } else {
@@ -2261,7 +2946,7 @@ bool Index::check_for_overrides(const token_ordering& token_order, const string&
             std::vector<sort_by> sort_fields;
             search_field(0, window_tokens, nullptr, 0, num_toks_dropped, field_it.value(), field_name,
                          nullptr, 0, {}, sort_fields, -1, 0, searched_queries, topster, groups_processed,
-                         &result_ids, result_ids_len, field_num_results, 0, group_by_fields,
+                         &result_ids, result_ids_len, field_num_results, 0, group_by_fields, nullptr,
                          false, 4, query_hashes, token_order, false, 0, 0, false, -1, 3, 7, 4);
 
             if(result_ids_len != 0) {
@@ -2412,6 +3097,8 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                    size_t concurrency, size_t search_cutoff_ms, size_t min_len_1typo, size_t min_len_2typo,
                    size_t max_candidates, const std::vector<enable_t>& infixes, const size_t max_extra_prefix,
                    const size_t max_extra_suffix, const size_t facet_query_num_typos,
+                   const size_t max_facet_values, const size_t facet_sample_percent,
+                   const size_t facet_sample_threshold,
                    const bool filter_curated_hits, const enable_t split_join_tokens,
                    const vector_query_t& vector_query) const {
 
@@ -2419,21 +3106,61 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
 
     uint32_t* filter_ids = nullptr;
     uint32_t filter_ids_length = 0;
+    id_bitmap_t filter_id_bitmap;
 
     std::shared_lock lock(mutex);
 
-    recursive_filter(filter_ids, filter_ids_length, filter_tree_root, true);
+    // resolved once, so that the key of each candidate is a lookup into the column when it's built
+    const auto group_key_column_ref = (group_limit != 0) ? get_group_key_column(group_by_fields) : nullptr;
+    const group_key_column_t* group_key_column = group_key_column_ref.get();
 
-    if (filter_tree_root != nullptr && filter_ids_length == 0) {
-        delete [] filter_ids;
-        return;
+    // only the text match path can probe a lazy filter: phrase, infix and curated hit filtering need the IDs upfront
+    const bool lazy_filter_eligible = filter_tree_root != nullptr && !field_query_tokens.empty() &&
+                                      !field_query_tokens[0].q_include_tokens.empty() &&
+                                      field_query_tokens[0].q_include_tokens[0].value != "*" &&
+                                      field_query_tokens[0].q_phrases.empty() &&
+                                      (!filter_curated_hits || included_ids.empty()) &&
+                                      std::all_of(infixes.begin(), infixes.end(),
+                                                  [](enable_t infix) { return infix == off; });
+
+    auto is_wildcard_query = !field_query_tokens.empty() && !field_query_tokens[0].q_include_tokens.empty() &&
+                             field_query_tokens[0].q_include_tokens[0].value == "*";
+
+    filter_result_iterator_t lazy_filter_iterator;
+    filter_result_iterator_t* filter_iterator = nullptr;
+
+    if (lazy_filter_eligible &&
+        plan_lazy_filter(filter_tree_root, the_fields, std::min(the_fields.size(), (size_t) FIELD_LIMIT_NUM),
+                         field_query_tokens[0].q_include_tokens, num_typos, prefixes, token_order,
+                         min_len_1typo, min_len_2typo, lazy_filter_iterator)) {
+        if (!lazy_filter_iterator.valid()) {
+            return;
+        }
+
+        filter_iterator = &lazy_filter_iterator;
+    } else {
+        recursive_filter(filter_id_bitmap, filter_tree_root, true);
+
+        if (filter_tree_root != nullptr && filter_id_bitmap.empty()) {
+            return;
+        }
+
+        if (filter_tree_root != nullptr) {
+            filter_ids_length = filter_id_bitmap.cardinality();
+
+            // wildcard queries walk and probe the bitmap: only phrase and text matching intersect against the array
+            if (!is_wildcard_query || !field_query_tokens[0].q_phrases.empty()) {
+                filter_ids = filter_id_bitmap.uncompress();
+            }
+        }
     }
 
     std::set<uint32_t> curated_ids;
     std::map<size_t, std::map<size_t, uint32_t>> included_ids_map;  // outer pos => inner pos => list of IDs
     std::vector<uint32_t> included_ids_vec;
     process_curated_ids(included_ids, excluded_ids, group_limit, filter_curated_hits,
-                        filter_ids, filter_ids_length, curated_ids, included_ids_map, included_ids_vec);
+                        filter_ids_length != 0 ? &filter_id_bitmap : nullptr,
+                        curated_ids, included_ids_map, included_ids_vec);
 
     std::vector<uint32_t> curated_ids_sorted(curated_ids.begin(), curated_ids.end());
     std::sort(curated_ids_sorted.begin(), curated_ids_sorted.end());
@@ -2450,15 +3177,22 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
         if (filter_ids_length == 0) {
             return;
         }
+
+        filter_id_bitmap = id_bitmap_t(filter_ids, filter_ids_length);
     }
 
+    // dense filters are cheaper to probe via the bitmap than to leap-frog through during candidate generation
+    const id_bitmap_t* filter_bitmap = (filter_ids_length != 0 &&
+                                        size_t(filter_ids_length) * DENSE_FILTER_RATIO >= seq_ids->num_ids()) ?
+                                       &filter_id_bitmap : nullptr;
+
     // handle exclusion of tokens/phrases
     uint32_t* exclude_token_ids = nullptr;
     size_t exclude_token_ids_size = 0;
     handle_exclusion(num_search_fields, field_query_tokens, the_fields, exclude_token_ids, exclude_token_ids_size);
 
     int sort_order[3];  // 1 or -1 based on DESC or ASC respectively
-    std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values;
+    std::array<sort_column_t*, 3> field_values;
     std::vector<size_t> geopoint_indices;
     populate_sort_mapping(sort_order, geopoint_indices, sort_fields_std, field_values);
 
@@ -2468,8 +3202,8 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                                                             &curated_ids_sorted[0], curated_ids_sorted.size(),
                                                             &excluded_result_ids);
 
-    auto is_wildcard_query = !field_query_tokens.empty() && !field_query_tokens[0].q_include_tokens.empty() &&
-                             field_query_tokens[0].q_include_tokens[0].value == "*";
+    // results of the wildcard path that are held as a bitmap instead of in `all_result_ids`
+    const id_bitmap_t* all_result_bitmap = nullptr;
 
     // for phrase query, parser will set field_query_tokens to "*", need to handle that
     if (is_wildcard_query) {
@@ -2486,7 +3220,7 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                 uint32_t seq_id = it.id();
                 uint64_t distinct_id = seq_id;
                 if (group_limit != 0) {
-                    distinct_id = get_distinct_id(group_by_fields, seq_id);
+                    distinct_id = get_distinct_id(group_key_column, group_by_fields, seq_id);
                     groups_processed.emplace(distinct_id);
                 }
 
@@ -2509,15 +3243,30 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
             goto process_search_results;
         }
 
+        // from here on, the bitmap is the only form of the filtered IDs
+        delete [] filter_ids;
+        filter_ids = nullptr;
+
         // if filters were not provided, use the seq_ids index to generate the
         // list of all document ids
         if (no_filters_provided) {
-            filter_ids_length = seq_ids->num_ids();
-            filter_ids = seq_ids->uncompress();
+            auto seq_id_it = seq_ids->new_iterator();
+            while (seq_id_it.valid()) {
+                filter_id_bitmap.add(seq_id_it.id());
+                seq_id_it.next();
+            }
+        }
+
+        // curated hits and documents of excluded tokens are removed from the results
+        if (excluded_result_ids_size != 0) {
+            id_bitmap_t curated_filter_bitmap;
+            id_bitmap_t::exclude(filter_id_bitmap, id_bitmap_t(excluded_result_ids, excluded_result_ids_size),
+                                 curated_filter_bitmap);
+            filter_id_bitmap = std::move(curated_filter_bitmap);
         }
 
-        curate_filtered_ids(filter_tree_root, curated_ids, excluded_result_ids,
-                            excluded_result_ids_size, filter_ids, filter_ids_length, curated_ids_sorted);
+        filter_ids_length = filter_id_bitmap.cardinality();
+
         collate_included_ids({}, included_ids_map, curated_topster, searched_queries);
 
         if (!vector_query.field_name.empty()) {
@@ -2527,14 +3276,14 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                 k++;
             }
 
-            VectorFilterFunctor filterFunctor(filter_ids, filter_ids_length);
+            VectorFilterFunctor filterFunctor(filter_ids_length == 0 ? nullptr : &filter_id_bitmap);
             auto& field_vector_index = vector_index.at(vector_query.field_name);
 
             std::vector<std::pair<float, size_t>> dist_labels;
 
             if(!no_filters_provided && filter_ids_length < vector_query.flat_search_cutoff) {
-                for(size_t i = 0; i < filter_ids_length; i++) {
-                    auto seq_id = filter_ids[i];
+                for(auto filter_it = filter_id_bitmap.new_iterator(); filter_it.valid(); filter_it.next()) {
+                    auto seq_id = filter_it.id();
                     std::vector<float> values;
 
                     try {
@@ -2578,7 +3327,7 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
 
                 uint64_t distinct_id = seq_id;
                 if (group_limit != 0) {
-                    distinct_id = get_distinct_id(group_by_fields, seq_id);
+                    distinct_id = get_distinct_id(group_key_column, group_by_fields, seq_id);
                     groups_processed.emplace(distinct_id);
                 }
 
@@ -2603,12 +3352,18 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                 all_result_ids_len = nearest_ids.size();
             }
         } else {
-            search_wildcard(filter_tree_root, included_ids_map, sort_fields_std, topster,
-                            curated_topster, groups_processed, searched_queries, group_limit, group_by_fields,
-                            curated_ids, curated_ids_sorted,
-                            excluded_result_ids, excluded_result_ids_size,
-                            all_result_ids, all_result_ids_len, filter_ids, filter_ids_length, concurrency,
-                            sort_order, field_values, geopoint_indices);
+            if(!search_wildcard_ordered(sort_fields_std, sort_order, field_values, topster, searched_queries,
+                                        group_limit, filter_id_bitmap)) {
+                search_wildcard(filter_tree_root, included_ids_map, sort_fields_std, topster,
+                                curated_topster, groups_processed, searched_queries, group_limit, group_by_fields,
+                                group_key_column, curated_ids, curated_ids_sorted,
+                                excluded_result_ids, excluded_result_ids_size, filter_id_bitmap,
+                                concurrency, sort_order, field_values, geopoint_indices);
+            }
+
+            // every filtered document is a result
+            all_result_bitmap = &filter_id_bitmap;
+            all_result_ids_len = filter_id_bitmap.cardinality();
         }
     } else {
         // Non-wildcard
@@ -2649,13 +3404,14 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
         }
 
         fuzzy_search_fields(the_fields, field_query_tokens[0].q_include_tokens, match_type, false, excluded_result_ids,
-                            excluded_result_ids_size, filter_ids, filter_ids_length, curated_ids_sorted,
+                            excluded_result_ids_size, filter_ids, filter_ids_length,
+                            filter_bitmap, filter_iterator, curated_ids_sorted,
                             sort_fields_std, num_typos, searched_queries, qtoken_set, topster, groups_processed,
-                            all_result_ids, all_result_ids_len, group_limit, group_by_fields, prioritize_exact_match,
+                            all_result_ids, all_result_ids_len, group_limit, group_by_fields, group_key_column, prioritize_exact_match,
                             prioritize_token_position, query_hashes, token_order, prefixes,
                             typo_tokens_threshold, exhaustive_search,
                             max_candidates, min_len_1typo, min_len_2typo, syn_orig_num_tokens, sort_order,
-                            field_values, geopoint_indices);
+                            field_values, geopoint_indices, default_sorting_field);
 
         // try split/joining tokens if no results are found
         if(split_join_tokens == always || (all_result_ids_len == 0 && split_join_tokens == fallback)) {
@@ -2686,24 +3442,26 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                 }
 
                 fuzzy_search_fields(the_fields, resolved_tokens, match_type, false, excluded_result_ids,
-                                    excluded_result_ids_size, filter_ids, filter_ids_length, curated_ids_sorted,
+                                    excluded_result_ids_size, filter_ids, filter_ids_length,
+                                    filter_bitmap, filter_iterator, curated_ids_sorted,
                                     sort_fields_std, num_typos, searched_queries, qtoken_set, topster, groups_processed,
-                                    all_result_ids, all_result_ids_len, group_limit, group_by_fields, prioritize_exact_match,
+                                    all_result_ids, all_result_ids_len, group_limit, group_by_fields, group_key_column, prioritize_exact_match,
                                     prioritize_token_position, query_hashes, token_order, prefixes, typo_tokens_threshold, exhaustive_search,
-                                    max_candidates, min_len_1typo, min_len_2typo, syn_orig_num_tokens, sort_order, field_values, geopoint_indices);
+                                    max_candidates, min_len_1typo, min_len_2typo, syn_orig_num_tokens, sort_order, field_values,
+                                    geopoint_indices, default_sorting_field);
             }
         }
 
         // do synonym based searches
         do_synonym_search(the_fields, match_type, filter_tree_root, included_ids_map, sort_fields_std,
                           curated_topster, token_order,
-                          0, group_limit, group_by_fields, prioritize_exact_match, prioritize_token_position,
+                          0, group_limit, group_by_fields, group_key_column, prioritize_exact_match, prioritize_token_position,
                           exhaustive_search, concurrency, prefixes,
                           min_len_1typo, min_len_2typo, max_candidates, curated_ids, curated_ids_sorted,
                           excluded_result_ids, excluded_result_ids_size, topster, q_pos_synonyms, syn_orig_num_tokens,
                           groups_processed, searched_queries, all_result_ids, all_result_ids_len,
-                          filter_ids, filter_ids_length, query_hashes,
-                          sort_order, field_values, geopoint_indices,
+                          filter_ids, filter_ids_length, filter_bitmap, filter_iterator, query_hashes,
+                          sort_order, field_values, geopoint_indices, default_sorting_field,
                           qtoken_set);
 
         // gather up both original query and synonym queries and do drop tokens
@@ -2743,12 +3501,14 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                         }
 
                         fuzzy_search_fields(the_fields, truncated_tokens, match_type, true, excluded_result_ids,
-                                            excluded_result_ids_size, filter_ids, filter_ids_length, curated_ids_sorted,
+                                            excluded_result_ids_size, filter_ids, filter_ids_length,
+                                            filter_bitmap, filter_iterator, curated_ids_sorted,
                                             sort_fields_std, num_typos, searched_queries, qtoken_set, topster, groups_processed,
-                                            all_result_ids, all_result_ids_len, group_limit, group_by_fields, prioritize_exact_match,
+                                            all_result_ids, all_result_ids_len, group_limit, group_by_fields, group_key_column, prioritize_exact_match,
                                             prioritize_token_position, query_hashes, token_order, prefixes, typo_tokens_threshold,
                                             exhaustive_search, max_candidates, min_len_1typo,
-                                            min_len_2typo, -1, sort_order, field_values, geopoint_indices);
+                                            min_len_2typo, -1, sort_order, field_values, geopoint_indices,
+                                            default_sorting_field);
 
                     } else {
                         break;
@@ -2758,7 +3518,7 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
         }
 
         do_infix_search(num_search_fields, the_fields, infixes, sort_fields_std, searched_queries,
-                        group_limit, group_by_fields,
+                        group_limit, group_by_fields, group_key_column,
                         max_extra_prefix, max_extra_suffix,
                         field_query_tokens[0].q_include_tokens,
                         topster, filter_ids, filter_ids_length,
@@ -2785,15 +3545,42 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
         std::mutex m_process;
         std::condition_variable cv_process;
 
+        // a facet query searches the facet values of the results, which it takes as an array
+        uint32_t* facet_query_result_ids = (all_result_bitmap != nullptr && !facet_query.query.empty()) ?
+                                           all_result_bitmap->uncompress() : nullptr;
+
         std::vector<facet_info_t> facet_infos(facets.size());
-        compute_facet_infos(facets, facet_query, facet_query_num_typos, all_result_ids, all_result_ids_len,
-                            group_by_fields, max_candidates, facet_infos);
+        compute_facet_infos(facets, facet_query, facet_query_num_typos,
+                            facet_query_result_ids != nullptr ? facet_query_result_ids : all_result_ids,
+                            all_result_ids_len, group_by_fields, max_candidates, facet_infos);
+
+        delete [] facet_query_result_ids;
+
+        std::vector<facet_info_t> curated_facet_infos(facets.size());
+        compute_facet_infos(facets, facet_query, facet_query_num_typos,
+                            &included_ids_vec[0], included_ids_vec.size(), group_by_fields, max_candidates,
+                            curated_facet_infos);
+
+        // the curated hits are counted as one more batch
+        const size_t num_batches = num_threads + 1;
 
-        std::vector<std::vector<facet>> facet_batches(num_threads);
-        for(size_t i = 0; i < num_threads; i++) {
+        // facets of a large result set can be estimated from a sample of it, except for grouped counts, which are
+        // distinct counts that do not scale up
+        const size_t sample_percent = (group_limit == 0 && all_result_ids_len > facet_sample_threshold) ?
+                                      facet_sample_percent : 100;
+
+        std::vector<std::vector<facet>> facet_batches(num_batches);
+        std::vector<std::vector<facet_ordinal_counts_t>> batch_ordinal_counts(num_batches);
+        std::vector<const std::vector<facet_info_t>*> batch_facet_infos(num_batches, &facet_infos);
+        batch_facet_infos[num_threads] = &curated_facet_infos;
+
+        for(size_t i = 0; i < num_batches; i++) {
             for(const auto& this_facet: facets) {
                 facet_batches[i].emplace_back(facet(this_facet.field_name));
+                facet_batches[i].back().approximate_group_counts = this_facet.approximate_group_counts;
             }
+
+            batch_ordinal_counts[i].resize(facets.size());
         }
 
         size_t num_queued = 0;
@@ -2812,11 +3599,14 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                 batch_res_len = all_result_ids_len - result_index;
             }
 
-            uint32_t* batch_result_ids = all_result_ids + result_index;
+            // a batch of results held as a bitmap starts from the id at its window's offset
+            uint32_t* batch_result_ids = (all_result_bitmap == nullptr) ? all_result_ids + result_index : nullptr;
+            const uint32_t batch_start_id = (all_result_bitmap != nullptr) ? all_result_bitmap->select(result_index) : 0;
             num_queued++;
 
-            thread_pool->enqueue([this, thread_id, &facet_batches, &facet_query, group_limit, group_by_fields,
-                                         batch_result_ids, batch_res_len, &facet_infos,
+            thread_pool->enqueue([this, thread_id, &facet_batches, &batch_ordinal_counts, &facet_query,
+                                         group_limit, group_by_fields, group_key_column, batch_result_ids, batch_res_len, &facet_infos,
+                                         all_result_bitmap, batch_start_id, sample_percent,
                                          &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
                                          &num_processed, &m_process, &cv_process]() {
                 search_begin_us = parent_search_begin;
@@ -2824,8 +3614,9 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                 search_cutoff = parent_search_cutoff;
 
                 auto fq = facet_query;
-                do_facets(facet_batches[thread_id], fq, facet_infos, group_limit, group_by_fields,
-                          batch_result_ids, batch_res_len);
+                do_facets(facet_batches[thread_id], fq, facet_infos, group_limit, group_by_fields, group_key_column,
+                          batch_result_ids, batch_res_len, batch_ordinal_counts[thread_id], sample_percent,
+                          all_result_bitmap, batch_start_id);
                 std::unique_lock<std::mutex> lock(m_process);
                 num_processed++;
                 parent_search_cutoff = parent_search_cutoff || search_cutoff;
@@ -2835,44 +3626,20 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
             result_index += batch_res_len;
         }
 
+        do_facets(facet_batches[num_threads], facet_query, curated_facet_infos, group_limit, group_by_fields, group_key_column,
+                  &included_ids_vec[0], included_ids_vec.size(), batch_ordinal_counts[num_threads]);
+
         std::unique_lock<std::mutex> lock_process(m_process);
         cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
-        search_cutoff = parent_search_cutoff;
-
-        for(auto& facet_batch: facet_batches) {
-            for(size_t fi = 0; fi < facet_batch.size(); fi++) {
-                auto& this_facet = facet_batch[fi];
-                auto& acc_facet = facets[fi];
-
-                for(auto & facet_kv: this_facet.result_map) {
-                    if(group_limit) {
-                        // we have to add all group sets
-                        acc_facet.hash_groups[facet_kv.first].insert(
-                                this_facet.hash_groups[facet_kv.first].begin(),
-                                this_facet.hash_groups[facet_kv.first].end()
-                        );
-                    } else {
-                        size_t count = 0;
-                        if(acc_facet.result_map.count(facet_kv.first) == 0) {
-                            // not found, so set it
-                            count = facet_kv.second.count;
-                        } else {
-                            count = acc_facet.result_map[facet_kv.first].count + facet_kv.second.count;
-                        }
-                        acc_facet.result_map[facet_kv.first].count = count;
-                    }
+        search_cutoff = parent_search_cutoff || search_cutoff;
+        lock_process.unlock();
 
-                    acc_facet.result_map[facet_kv.first].doc_id = facet_kv.second.doc_id;
-                    acc_facet.result_map[facet_kv.first].array_pos = facet_kv.second.array_pos;
-                    acc_facet.hash_tokens[facet_kv.first] = this_facet.hash_tokens[facet_kv.first];
-                }
+        merge_facets(facets, facet_batches, batch_ordinal_counts, batch_facet_infos, group_limit, max_facet_values,
+                     concurrency);
 
-                if(this_facet.stats.fvcount != 0) {
-                    acc_facet.stats.fvcount += this_facet.stats.fvcount;
-                    acc_facet.stats.fvsum += this_facet.stats.fvsum;
-                    acc_facet.stats.fvmax = std::max(acc_facet.stats.fvmax, this_facet.stats.fvmax);
-                    acc_facet.stats.fvmin = std::min(acc_facet.stats.fvmin, this_facet.stats.fvmin);
-                }
+        if(sample_percent < 100) {
+            for(auto& a_facet: facets) {
+                a_facet.sampled = true;
             }
         }
 
@@ -2881,11 +3648,6 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
         LOG(INFO) << "Time for faceting: " << timeMillisF;*/
     }
 
-    std::vector<facet_info_t> facet_infos(facets.size());
-    compute_facet_infos(facets, facet_query, facet_query_num_typos,
-                        &included_ids_vec[0], included_ids_vec.size(), group_by_fields, max_candidates, facet_infos);
-    do_facets(facets, facet_query, facet_infos, group_limit, group_by_fields, &included_ids_vec[0], included_ids_vec.size());
-
     all_result_ids_len += curated_topster->size;
 
     delete [] filter_ids;
@@ -2898,7 +3660,7 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
 
 void Index::process_curated_ids(const std::vector<std::pair<uint32_t, uint32_t>>& included_ids,
                                 const std::vector<uint32_t>& excluded_ids, const size_t group_limit,
-                                const bool filter_curated_hits, const uint32_t* filter_ids, uint32_t filter_ids_length,
+                                const bool filter_curated_hits, const id_bitmap_t* filter_bitmap,
                                 std::set<uint32_t>& curated_ids,
                                 std::map<size_t, std::map<size_t, uint32_t>>& included_ids_map,
                                 std::vector<uint32_t>& included_ids_vec) const {
@@ -2911,19 +3673,16 @@ void Index::process_curated_ids(const std::vector<std::pair<uint32_t, uint32_t>>
     // if `filter_curated_hits` is enabled, we will remove curated hits that don't match filter condition
     std::set<uint32_t> included_ids_set;
 
-    if(filter_ids_length != 0 && filter_curated_hits) {
-        uint32_t* included_ids_arr = nullptr;
-        size_t included_ids_len = ArrayUtils::and_scalar(&included_ids_vec[0], included_ids_vec.size(), filter_ids,
-                                                         filter_ids_length, &included_ids_arr);
+    if(filter_bitmap != nullptr && filter_curated_hits) {
+        std::vector<uint32_t> filtered_included_ids;
 
-        included_ids_vec.clear();
-
-        for(size_t i = 0; i < included_ids_len; i++) {
-            included_ids_set.insert(included_ids_arr[i]);
-            included_ids_vec.push_back(included_ids_arr[i]);
+        for(const uint32_t included_id: included_ids_vec) {
+            if(filter_bitmap->contains(included_id) && included_ids_set.insert(included_id).second) {
+                filtered_included_ids.push_back(included_id);
+            }
         }
 
-        delete [] included_ids_arr;
+        included_ids_vec = std::move(filtered_included_ids);
     } else {
         included_ids_set.insert(included_ids_vec.begin(), included_ids_vec.end());
     }
@@ -2945,33 +3704,154 @@ void Index::process_curated_ids(const std::vector<std::pair<uint32_t, uint32_t>>
         size_t ids_per_pos = std::max(size_t(1), group_limit);
         auto num_inner_ids = std::min(ids_per_pos, pos_ids.second.size());
 
-        for(size_t inner_pos = 0; inner_pos < num_inner_ids; inner_pos++) {
-            auto seq_id = pos_ids.second[inner_pos];
-            included_ids_map[outer_pos][inner_pos] = seq_id;
-            curated_ids.insert(seq_id);
-        }
-    }
+        for(size_t inner_pos = 0; inner_pos < num_inner_ids; inner_pos++) {
+            auto seq_id = pos_ids.second[inner_pos];
+            included_ids_map[outer_pos][inner_pos] = seq_id;
+            curated_ids.insert(seq_id);
+        }
+    }
+
+    curated_ids.insert(excluded_ids.begin(), excluded_ids.end());
+
+    if(all_positions.size() > included_ids_map.size()) {
+        // Some curated IDs may have been removed via filtering or simply don't exist.
+        // We have to shift lower placed hits upwards to fill those positions.
+        std::sort(all_positions.begin(), all_positions.end());
+        all_positions.erase(unique(all_positions.begin(), all_positions.end()), all_positions.end());
+
+        size_t pos_count = 0;
+        std::map<size_t, std::map<size_t, uint32_t>> new_included_ids_map;
+        auto included_id_it = included_ids_map.begin();
+        auto all_pos_it = all_positions.begin();
+
+        while(included_id_it != included_ids_map.end()) {
+            new_included_ids_map[*all_pos_it] = included_id_it->second;
+            all_pos_it++;
+            included_id_it++;
+        }
+
+        included_ids_map = new_included_ids_map;
+    }
+}
+
+void Index::advance_filter_generation(const std::string& field_name) {
+    // fields are indexed in parallel, but each advances only its own generation
+    const auto it = filter_generations.find(field_name);
+    if(it != filter_generations.end()) {
+        it->second++;
+    }
+}
+
+void Index::advance_search_index_generation(const std::string& field_name) {
+    // fields are indexed in parallel, but each advances only its own generation
+    const auto it = search_index_generations.find(field_name);
+    if(it != search_index_generations.end()) {
+        it->second++;
+    }
+}
+
+void Index::find_typo_candidates(const std::string& field_name, const std::string& token, uint32_t cost,
+                                 bool prefix_search, token_ordering token_order, size_t num_leaves,
+                                 const uint32_t* filter_ids, size_t filter_ids_length,
+                                 filter_result_iterator_t* filter_iterator,
+                                 const std::set<std::string>& exclude_leaves, std::vector<art_leaf*>& leaves) const {
+    art_tree* tree = search_index.at(field_name);
+    const int token_len = prefix_search ? (int) token.length() : (int) token.length() + 1;
+
+    const auto direct_search = [&]() {
+        if(filter_iterator == nullptr) {
+            art_fuzzy_search(tree, (const unsigned char *) token.c_str(), token_len, cost, cost,
+                             num_leaves, token_order, prefix_search,
+                             filter_ids, filter_ids_length, leaves, exclude_leaves);
+            return;
+        }
+
+        // a lazy filter can't prune the trie traversal, so the leaves of a single, capped walk are filtered after
+        // it: `plan_lazy_filter()` only probes lazily for tokens that expand to a few leaves
+        art_fuzzy_search(tree, (const unsigned char *) token.c_str(), token_len, cost, cost,
+                         std::max<size_t>(num_leaves, MAX_TYPO_CANDIDATE_LEAVES), token_order, prefix_search,
+                         nullptr, 0, leaves, exclude_leaves);
+
+        // as in `art_fuzzy_search()`, an exact match leads and is not filtered
+        const bool exact_match = (!leaves.empty() && cost == 0 && leaves[0]->key_len == token.length() + 1 &&
+                                  memcmp(leaves[0]->key, token.c_str(), token.length()) == 0);
+
+        leaves.erase(std::remove_if(leaves.begin() + exact_match, leaves.end(), [filter_iterator](art_leaf* leaf) {
+            return !filter_iterator->contains_atleast_one(leaf->values);
+        }), leaves.end());
+
+        if(leaves.size() > num_leaves) {
+            leaves.resize(num_leaves);
+        }
+    };
+
+    const auto generation_it = search_index_generations.find(field_name);
+    if(generation_it == search_index_generations.end()) {
+        direct_search();
+        return;
+    }
+
+    // leaves are cached before they are filtered or excluded, so that they serve every query of the token: only the
+    // best of them are found, and more are looked for when filtering leaves fewer than needed
+    const std::string key = typo_candidate_cache_t::get_key(field_name, token, cost, prefix_search, token_order);
+    auto candidates = typo_candidate_cache.get(key, generation_it->second);
+    size_t num_candidates = std::min<size_t>(MAX_TYPO_CANDIDATE_LEAVES, num_leaves + exclude_leaves.size());
+
+    while(true) {
+        if(candidates == nullptr || (candidates->truncated && candidates->leaves.size() < num_candidates)) {
+            auto found = std::make_shared<typo_candidates_t>();
+            art_fuzzy_search(tree, (const unsigned char *) token.c_str(), token_len, cost, cost,
+                             num_candidates, token_order, prefix_search, nullptr, 0, found->leaves);
+
+            found->truncated = (found->leaves.size() >= num_candidates);
+            candidates = found;
+            typo_candidate_cache.put(key, generation_it->second, candidates);
+        }
+
+        leaves.clear();
+
+        for(size_t i = 0; i < candidates->leaves.size() && leaves.size() < num_leaves; i++) {
+            art_leaf* leaf = candidates->leaves[i];
+
+            // as in `art_fuzzy_search()`, an exact match leads and is neither filtered nor excluded
+            const bool exact_match = (i == 0 && cost == 0 && leaf->key_len == token.length() + 1 &&
+                                      memcmp(leaf->key, token.c_str(), token.length()) == 0);
+
+            if(!exact_match) {
+                if(filter_ids_length != 0 &&
+                   !posting_t::contains_atleast_one(leaf->values, filter_ids, filter_ids_length)) {
+                    continue;
+                }
+
+                if(filter_iterator != nullptr && !filter_iterator->contains_atleast_one(leaf->values)) {
+                    continue;
+                }
+
+                if(!exclude_leaves.empty() &&
+                   exclude_leaves.count(std::string((const char*) leaf->key, leaf->key_len - 1)) != 0) {
+                    continue;
+                }
+            }
 
-    curated_ids.insert(excluded_ids.begin(), excluded_ids.end());
+            leaves.push_back(leaf);
+        }
 
-    if(all_positions.size() > included_ids_map.size()) {
-        // Some curated IDs may have been removed via filtering or simply don't exist.
-        // We have to shift lower placed hits upwards to fill those positions.
-        std::sort(all_positions.begin(), all_positions.end());
-        all_positions.erase(unique(all_positions.begin(), all_positions.end()), all_positions.end());
+        if(leaves.size() >= num_leaves || !candidates->truncated) {
+            return;
+        }
 
-        size_t pos_count = 0;
-        std::map<size_t, std::map<size_t, uint32_t>> new_included_ids_map;
-        auto included_id_it = included_ids_map.begin();
-        auto all_pos_it = all_positions.begin();
+        if(num_candidates >= MAX_TYPO_CANDIDATE_LEAVES) {
+            // the filter is too selective for the candidates that are worth caching: only a filter of IDs can prune
+            // a walk beyond them, as a lazy filter would probe the same leaves again
+            if(filter_iterator == nullptr) {
+                leaves.clear();
+                direct_search();
+            }
 
-        while(included_id_it != included_ids_map.end()) {
-            new_included_ids_map[*all_pos_it] = included_id_it->second;
-            all_pos_it++;
-            included_id_it++;
+            return;
         }
 
-        included_ids_map = new_included_ids_map;
+        num_candidates = std::min<size_t>(MAX_TYPO_CANDIDATE_LEAVES, num_candidates * 2);
     }
 }
 
@@ -2982,6 +3862,8 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
                                 const uint32_t* exclude_token_ids,
                                 size_t exclude_token_ids_size,
                                 const uint32_t* filter_ids, size_t filter_ids_length,
+                                const id_bitmap_t* filter_bitmap,
+                                filter_result_iterator_t* filter_iterator,
                                 const std::vector<uint32_t>& curated_ids,
                                 const std::vector<sort_by> & sort_fields,
                                 const std::vector<uint32_t>& num_typos,
@@ -2989,7 +3871,7 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
                                 tsl::htrie_map<char, token_leaf>& qtoken_set,
                                 Topster* topster, spp::sparse_hash_set<uint64_t>& groups_processed,
                                 uint32_t*& all_result_ids, size_t & all_result_ids_len,
-                                const size_t group_limit, const std::vector<std::string>& group_by_fields,
+                                const size_t group_limit, const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
                                 bool prioritize_exact_match,
                                 const bool prioritize_token_position,
                                 std::set<uint64>& query_hashes,
@@ -3002,8 +3884,9 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
                                 size_t min_len_2typo,
                                 int syn_orig_num_tokens,
                                 const int* sort_order,
-                                std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
-                                const std::vector<size_t>& geopoint_indices) const {
+                                std::array<sort_column_t*, 3>& field_values,
+                                const std::vector<size_t>& geopoint_indices,
+                                const std::string& default_sorting_field) const {
 
     // NOTE: `query_tokens` preserve original tokens, while `search_tokens` could be a result of dropped tokens
 
@@ -3102,7 +3985,6 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
                     auto& the_field = the_fields[field_id];
                     const bool field_prefix = (the_field.orig_index < prefixes.size()) ? prefixes[the_field.orig_index] : prefixes[0];;
                     const bool prefix_search = field_prefix && query_tokens[token_index].is_prefix_searched;
-                    const size_t token_len = prefix_search ? (int) token.length() : (int) token.length() + 1;
 
                     /*LOG(INFO) << "Searching for field: " << the_field.name << ", token:"
                               << token << " - cost: " << costs[token_index] << ", prefix_search: " << prefix_search;*/
@@ -3121,11 +4003,16 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
 
                     //LOG(INFO) << "Searching for field: " << the_field.name << ", found token:" << token;
 
+                    // leaves that are already candidates are excluded, so the rest need only fill the candidates
+                    // up, unless some of them are to be dropped for not co-occurring with the previous token: the
+                    // walk is best-first, so these are the leaves that a walk of MAX_TYPO_CANDIDATE_LEAVES leads with
+                    const size_t num_leaves = last_token ? (size_t) MAX_TYPO_CANDIDATE_LEAVES :
+                                              max_candidates - std::min(max_candidates, leaf_tokens.size()) + 1;
+
                     std::vector<art_leaf*> field_leaves;
-                    int max_words = 100000;
-                    art_fuzzy_search(search_index.at(the_field.name), (const unsigned char *) token.c_str(), token_len,
-                                     costs[token_index], costs[token_index], max_words, token_order, prefix_search,
-                                     filter_ids, filter_ids_length, field_leaves, unique_tokens);
+                    find_typo_candidates(the_field.name, token, costs[token_index], prefix_search, token_order,
+                                         num_leaves, filter_ids, filter_ids_length, filter_iterator,
+                                         unique_tokens, field_leaves);
 
                     /*auto timeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
                                     std::chrono::high_resolution_clock::now() - begin).count();
@@ -3153,7 +4040,14 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
                         std::vector<uint32_t> prev_leaf_ids;
                         posting_t::merge({prev_leaf->values}, prev_leaf_ids);
 
-                        if(filter_ids_length != 0) {
+                        if(filter_iterator != nullptr) {
+                            prev_token_doc_ids = new uint32_t[prev_leaf_ids.size()];
+                            for(uint32_t prev_leaf_id: prev_leaf_ids) {
+                                if(filter_iterator->contains(prev_leaf_id)) {
+                                    prev_token_doc_ids[prev_token_doc_ids_len++] = prev_leaf_id;
+                                }
+                            }
+                        } else if(filter_ids_length != 0) {
                             prev_token_doc_ids_len = ArrayUtils::and_scalar(prev_leaf_ids.data(), prev_leaf_ids.size(),
                                                                             filter_ids, filter_ids_length,
                                                                             &prev_token_doc_ids);
@@ -3197,14 +4091,14 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
                     std::vector<uint32_t> prev_token_doc_ids;
                     find_across_fields(token_candidates_vec.back().token,
                                        token_candidates_vec.back().candidates[0],
-                                       the_fields, num_search_fields, filter_ids, filter_ids_length, exclude_token_ids,
+                                       the_fields, num_search_fields, filter_ids, filter_ids_length,
+                                       filter_bitmap, filter_iterator, exclude_token_ids,
                                        exclude_token_ids_size, prev_token_doc_ids, popular_field_ids);
 
                     for(size_t field_id: query_field_ids) {
                         auto& the_field = the_fields[field_id];
                         const bool field_prefix = (the_field.orig_index < prefixes.size()) ? prefixes[the_field.orig_index] : prefixes[0];;
                         const bool prefix_search = field_prefix && query_tokens[token_index].is_prefix_searched;
-                        const size_t token_len = prefix_search ? (int) token.length() : (int) token.length() + 1;
                         int64_t field_num_typos = (the_field.orig_index < num_typos.size()) ? num_typos[the_field.orig_index] : num_typos[0];
 
                         auto& locale = search_schema.at(the_field.name).locale;
@@ -3218,10 +4112,9 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
                         }
 
                         std::vector<art_leaf*> field_leaves;
-                        int max_words = 100000;
-                        art_fuzzy_search(search_index.at(the_field.name), (const unsigned char *) token.c_str(), token_len,
-                                         costs[token_index], costs[token_index], max_words, token_order, prefix_search,
-                                         filter_ids, filter_ids_length, field_leaves, unique_tokens);
+                        find_typo_candidates(the_field.name, token, costs[token_index], prefix_search, token_order,
+                                             MAX_TYPO_CANDIDATE_LEAVES, filter_ids, filter_ids_length,
+                                             filter_iterator, unique_tokens, field_leaves);
 
                         if(field_leaves.empty()) {
                             // look at the next field
@@ -3284,14 +4177,14 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
         if(token_candidates_vec.size() == query_tokens.size()) {
             std::vector<uint32_t> id_buff;
             search_all_candidates(num_search_fields, match_type, the_fields, filter_ids, filter_ids_length,
-                                  exclude_token_ids, exclude_token_ids_size,
+                                  filter_bitmap, filter_iterator, exclude_token_ids, exclude_token_ids_size,
                                   sort_fields, token_candidates_vec, searched_queries, qtoken_set, topster,
                                   groups_processed, all_result_ids, all_result_ids_len,
-                                  typo_tokens_threshold, group_limit, group_by_fields, query_tokens,
+                                  typo_tokens_threshold, group_limit, group_by_fields, group_key_column, query_tokens,
                                   num_typos, prefixes, prioritize_exact_match, prioritize_token_position,
                                   exhaustive_search, max_candidates,
                                   syn_orig_num_tokens, sort_order, field_values, geopoint_indices,
-                                  query_hashes, id_buff);
+                                  default_sorting_field, query_hashes, id_buff);
 
             if(id_buff.size() > 1) {
                 gfx::timsort(id_buff.begin(), id_buff.end());
@@ -3353,6 +4246,8 @@ void Index::find_across_fields(const token_t& previous_token,
                                const std::vector<search_field_t>& the_fields,
                                const size_t num_search_fields,
                                const uint32_t* filter_ids, uint32_t filter_ids_length,
+                               const id_bitmap_t* filter_bitmap,
+                               filter_result_iterator_t* filter_iterator,
                                const uint32_t* exclude_token_ids, size_t exclude_token_ids_size,
                                std::vector<uint32_t>& prev_token_doc_ids,
                                std::vector<size_t>& top_prefix_field_ids) const {
@@ -3363,7 +4258,8 @@ void Index::find_across_fields(const token_t& previous_token,
     // used to track plists that must be destructed once done
     std::vector<posting_list_t*> expanded_plists;
 
-    result_iter_state_t istate(exclude_token_ids, exclude_token_ids_size, filter_ids, filter_ids_length);
+    result_iter_state_t istate(exclude_token_ids, exclude_token_ids_size, filter_ids, filter_ids_length,
+                               filter_bitmap, filter_iterator);
 
     const bool prefix_search = previous_token.is_prefix_searched;
     const uint32_t token_num_typos = previous_token.num_typos;
@@ -3440,15 +4336,18 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
                                  std::vector<std::vector<art_leaf*>>& searched_queries,
                                  tsl::htrie_map<char, token_leaf>& qtoken_set,
                                  const size_t group_limit,
-                                 const std::vector<std::string>& group_by_fields,
+                                 const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
                                  const bool prioritize_exact_match,
                                  const bool prioritize_token_position,
                                  const uint32_t* filter_ids, uint32_t filter_ids_length,
+                                 const id_bitmap_t* filter_bitmap,
+                                 filter_result_iterator_t* filter_iterator,
                                  const uint32_t total_cost, const int syn_orig_num_tokens,
                                  const uint32_t* exclude_token_ids, size_t exclude_token_ids_size,
                                  const int* sort_order,
-                                 std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                                 std::array<sort_column_t*, 3>& field_values,
                                  const std::vector<size_t>& geopoint_indices,
+                                 const std::string& default_sorting_field,
                                  std::vector<uint32_t>& id_buff,
                                  uint32_t*& all_result_ids, size_t& all_result_ids_len) const {
 
@@ -3460,7 +4359,8 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
     // used to track plists that must be destructed once done
     std::vector<posting_list_t*> expanded_plists;
 
-    result_iter_state_t istate(exclude_token_ids, exclude_token_ids_size, filter_ids, filter_ids_length);
+    result_iter_state_t istate(exclude_token_ids, exclude_token_ids_size, filter_ids, filter_ids_length,
+                               filter_bitmap, filter_iterator);
 
     // for each token, find the posting lists across all query_by fields
     for(size_t ti = 0; ti < query_tokens.size(); ti++) {
@@ -3525,8 +4425,124 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
     std::vector<uint32_t> result_ids;
     size_t filter_index = 0;
 
+    size_t query_len = query_tokens.size();
+    if(syn_orig_num_tokens != -1) {
+        query_len = syn_orig_num_tokens;
+    }
+    query_len = std::min<size_t>(15, query_len);
+
+    // NOTE: `query_len` is total tokens matched across fields.
+    // Within a field, only a subset can match
+
+    // MAX_SCORE
+    // [ sign | tokens_matched | max_field_score | max_field_weight | num_matching_fields ]
+    // [   1  |        4       |        48       |       8          |         3           ]  (64 bits)
+
+    // MAX_WEIGHT
+    // [ sign | tokens_matched | max_field_weight | max_field_score  | num_matching_fields ]
+    // [   1  |        4       |        8         |      48          |         3           ]  (64 bits)
+
+    auto aggregate_score = [&](int64_t best_field_match_score, int64_t best_field_weight, uint32_t num_matching_fields) {
+        auto max_field_weight = std::min<size_t>(FIELD_MAX_WEIGHT, best_field_weight);
+        num_matching_fields = std::min<size_t>(7, num_matching_fields);
+
+        return match_type == max_score ?
+               ((int64_t(query_len) << 59) |
+               (int64_t(best_field_match_score) << 11) |
+               (int64_t(max_field_weight) << 3) |
+               (int64_t(num_matching_fields) << 0))
+
+               :
+
+               ((int64_t(query_len) << 59) |
+                (int64_t(max_field_weight) << 51) |
+                (int64_t(best_field_match_score) << 3) |
+                (int64_t(num_matching_fields) << 0))
+               ;
+    };
+
+    // For single token queries, the match score of a document varies only by whether it's a verbatim match and by
+    // the token's position, so an upper bound of the sort scores of a document can be derived from the bounds kept on
+    // the posting list blocks. Documents whose bound cannot beat the topster's minimum need not be scored at all.
+    const bool use_block_bounds = (query_tokens.size() == 1 && group_limit == 0 && !sort_fields.empty());
+    int64_t match_score_bound = 0, verbatim_match_score_bound = 0;
+    int points_sort_index = -1;
+
+    if(use_block_bounds) {
+        size_t words_present = (syn_orig_num_tokens != -1) ? syn_orig_num_tokens : 1;
+        size_t distance = (syn_orig_num_tokens != -1) ? syn_orig_num_tokens-1 : 0;
+        size_t min_offset = prioritize_token_position ? 0 : 255;
+        const uint8_t can_be_verbatim = uint8_t(prioritize_exact_match && total_cost == 0);
+        match_score_bound = Match(words_present, distance, min_offset, 0).get_match_score(total_cost, words_present);
+        verbatim_match_score_bound = Match(words_present, distance, min_offset, can_be_verbatim)
+                                     .get_match_score(total_cost, words_present);
+
+        // points are comparable with the sort index values only for integer fields
+        auto dsf_it = search_schema.find(default_sorting_field);
+        if(dsf_it != search_schema.end() && dsf_it.value().is_integer()) {
+            for(size_t i = 0; i < sort_fields.size(); i++) {
+                if(sort_fields[i].name == default_sorting_field && sort_order[i] == 1 &&
+                   sort_fields[i].missing_values != sort_by::missing_values_t::first) {
+                    points_sort_index = i;
+                    break;
+                }
+            }
+        }
+    }
+
+    auto below_topster_min = [&](uint32_t seq_id, const std::vector<or_iterator_t>& its) {
+        if(topster->size < topster->MAX_SIZE) {
+            return false;
+        }
+
+        int64_t best_match_score_bound = 0, best_field_weight = 0;
+        int64_t points_bound = INT64_MAX;
+        uint32_t num_matching_fields = 0;
+
+        for(const auto& field_iter: its[0].get_its()) {
+            if(field_iter.id() != seq_id) {
+                continue;
+            }
+
+            const posting_list_t::block_t* block = field_iter.block();
+            const int64_t field_match_score_bound = block->has_verbatim_match ? verbatim_match_score_bound :
+                                                    match_score_bound;
+
+            best_match_score_bound = std::max(best_match_score_bound, field_match_score_bound);
+            best_field_weight = std::max<int64_t>(best_field_weight, the_fields[field_iter.get_field_id()].weight);
+            points_bound = std::min(points_bound, block->max_score);
+            num_matching_fields++;
+        }
+
+        const auto updated_points_it = updated_points.find(seq_id);
+        if(updated_points_it != updated_points.end()) {
+            points_bound = std::max(points_bound, updated_points_it->second);
+        }
+
+        int64_t bound_scores[3] = {0};
+        for(size_t i = 0; i < sort_fields.size(); i++) {
+            if(field_values[i] == &text_match_sentinel_value && sort_order[i] == 1) {
+                bound_scores[i] = aggregate_score(best_match_score_bound, best_field_weight, num_matching_fields);
+            } else if(int(i) == points_sort_index) {
+                bound_scores[i] = points_bound;
+            } else {
+                bound_scores[i] = INT64_MAX;
+            }
+        }
+
+        const KV* min_kv = topster->kvs[0];
+        return std::tie(bound_scores[0], bound_scores[1], bound_scores[2], seq_id) <
+               std::tie(min_kv->scores[0], min_kv->scores[1], min_kv->scores[2], min_kv->key);
+    };
+
     or_iterator_t::intersect(token_its, istate, [&](uint32_t seq_id, const std::vector<or_iterator_t>& its) {
         //LOG(INFO) << "seq_id: " << seq_id;
+        if(use_block_bounds && below_topster_min(seq_id, its)) {
+            // still a match, so must be counted
+            result_ids.push_back(seq_id);
+            return;
+        }
+
         // Convert [token -> fields] orientation to [field -> tokens] orientation
         std::vector<std::vector<posting_list_t::iterator_t>> field_to_tokens(num_search_fields);
 
@@ -3584,7 +4600,7 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
 
         uint64_t distinct_id = seq_id;
         if(group_limit != 0) {
-            distinct_id = get_distinct_id(group_by_fields, seq_id);
+            distinct_id = get_distinct_id(group_key_column, group_by_fields, seq_id);
             groups_processed.emplace(distinct_id);
         }
 
@@ -3594,44 +4610,12 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
         compute_sort_scores(sort_fields, sort_order, field_values, geopoint_indices, seq_id, filter_index,
                             best_field_match_score, scores, match_score_index);
 
-        size_t query_len = query_tokens.size();
-        if(syn_orig_num_tokens != -1) {
-            query_len = syn_orig_num_tokens;
-        }
-        query_len = std::min<size_t>(15, query_len);
-
-        // NOTE: `query_len` is total tokens matched across fields.
-        // Within a field, only a subset can match
-
-        // MAX_SCORE
-        // [ sign | tokens_matched | max_field_score | max_field_weight | num_matching_fields ]
-        // [   1  |        4       |        48       |       8          |         3           ]  (64 bits)
-
-        // MAX_WEIGHT
-        // [ sign | tokens_matched | max_field_weight | max_field_score  | num_matching_fields ]
-        // [   1  |        4       |        8         |      48          |         3           ]  (64 bits)
-
-        auto max_field_weight = std::min<size_t>(FIELD_MAX_WEIGHT, best_field_weight);
-        num_matching_fields = std::min<size_t>(7, num_matching_fields);
-
-        uint64_t aggregated_score = match_type == max_score ?
-                                    ((int64_t(query_len) << 59) |
-                                    (int64_t(best_field_match_score) << 11) |
-                                    (int64_t(max_field_weight) << 3) |
-                                    (int64_t(num_matching_fields) << 0))
-
-                                    :
-
-                                    ((int64_t(query_len) << 59) |
-                                     (int64_t(max_field_weight) << 51) |
-                                     (int64_t(best_field_match_score) << 3) |
-                                     (int64_t(num_matching_fields) << 0))
-                                    ;
+        uint64_t aggregated_score = aggregate_score(best_field_match_score, best_field_weight, num_matching_fields);
 
         /*LOG(INFO) << "seq_id: " << seq_id << ", query_len: " << query_len
                   << ", syn_orig_num_tokens: " << syn_orig_num_tokens
                   << ", best_field_match_score: " << best_field_match_score
-                  << ", max_field_weight: " << max_field_weight
+                  << ", best_field_weight: " << best_field_weight
                   << ", num_matching_fields: " << num_matching_fields
                   << ", aggregated_score: " << aggregated_score;*/
 
@@ -3671,7 +4655,7 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
 }
 
 void Index::compute_sort_scores(const std::vector<sort_by>& sort_fields, const int* sort_order,
-                                std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values,
+                                std::array<sort_column_t*, 3> field_values,
                                 const std::vector<size_t>& geopoint_indices,
                                 uint32_t seq_id, size_t filter_index, int64_t max_field_match_score,
                                 int64_t* scores, int64_t& match_score_index) const {
@@ -3679,17 +4663,16 @@ void Index::compute_sort_scores(const std::vector<sort_by>& sort_fields, const i
     int64_t geopoint_distances[3];
 
     for(auto& i: geopoint_indices) {
-        spp::sparse_hash_map<uint32_t, int64_t>* geopoints = field_values[i];
+        sort_column_t* geopoints = field_values[i];
         int64_t dist = INT32_MAX;
 
         S2LatLng reference_lat_lng;
         GeoPoint::unpack_lat_lng(sort_fields[i].geopoint, reference_lat_lng);
 
         if(geopoints != nullptr) {
-            auto it = geopoints->find(seq_id);
+            int64_t packed_latlng;
 
-            if(it != geopoints->end()) {
-                int64_t packed_latlng = it->second;
+            if(geopoints->get(seq_id, packed_latlng)) {
                 S2LatLng s2_lat_lng;
                 GeoPoint::unpack_lat_lng(packed_latlng, s2_lat_lng);
                 dist = GeoPoint::distance(s2_lat_lng, reference_lat_lng);
@@ -3770,8 +4753,9 @@ void Index::compute_sort_scores(const std::vector<sort_by>& sort_fields, const i
 
             scores[0] = int64_t(found);
         } else {
-            auto it = field_values[0]->find(seq_id);
-            scores[0] = (it == field_values[0]->end()) ? default_score : it->second;
+            if(!field_values[0]->get(seq_id, scores[0])) {
+                scores[0] = default_score;
+            }
 
             if(scores[0] == INT64_MIN && sort_fields[0].missing_values == sort_by::missing_values_t::first) {
                 // By default, missing numerical value are always going to be sorted to be at the end
@@ -3826,8 +4810,9 @@ void Index::compute_sort_scores(const std::vector<sort_by>& sort_fields, const i
 
             scores[1] = int64_t(found);
         } else {
-            auto it = field_values[1]->find(seq_id);
-            scores[1] = (it == field_values[1]->end()) ? default_score : it->second;
+            if(!field_values[1]->get(seq_id, scores[1])) {
+                scores[1] = default_score;
+            }
             if(scores[1] == INT64_MIN && sort_fields[1].missing_values == sort_by::missing_values_t::first) {
                 bool is_asc = (sort_order[1] == -1);
                 scores[1] = is_asc ? (INT64_MIN + 1) : INT64_MAX;
@@ -3878,8 +4863,9 @@ void Index::compute_sort_scores(const std::vector<sort_by>& sort_fields, const i
 
             scores[2] = int64_t(found);
         } else {
-            auto it = field_values[2]->find(seq_id);
-            scores[2] = (it == field_values[2]->end()) ? default_score : it->second;
+            if(!field_values[2]->get(seq_id, scores[2])) {
+                scores[2] = default_score;
+            }
             if(scores[2] == INT64_MIN && sort_fields[2].missing_values == sort_by::missing_values_t::first) {
                 bool is_asc = (sort_order[2] == -1);
                 scores[2] = is_asc ? (INT64_MIN + 1) : INT64_MAX;
@@ -3999,7 +4985,7 @@ void Index::do_synonym_search(const std::vector<search_field_t>& the_fields,
                               const std::vector<sort_by>& sort_fields_std, Topster* curated_topster,
                               const token_ordering& token_order,
                               const size_t typo_tokens_threshold, const size_t group_limit,
-                              const std::vector<std::string>& group_by_fields, bool prioritize_exact_match,
+                              const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column, bool prioritize_exact_match,
                               const bool prioritize_token_position,
                               const bool exhaustive_search, const size_t concurrency,
                               const std::vector<bool>& prefixes,
@@ -4014,21 +5000,26 @@ void Index::do_synonym_search(const std::vector<search_field_t>& the_fields,
                               std::vector<std::vector<art_leaf*>>& searched_queries,
                               uint32_t*& all_result_ids, size_t& all_result_ids_len,
                               const uint32_t* filter_ids, const uint32_t filter_ids_length,
+                              const id_bitmap_t* filter_bitmap,
+                              filter_result_iterator_t* filter_iterator,
                               std::set<uint64>& query_hashes,
                               const int* sort_order,
-                              std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                              std::array<sort_column_t*, 3>& field_values,
                               const std::vector<size_t>& geopoint_indices,
+                              const std::string& default_sorting_field,
                               tsl::htrie_map<char, token_leaf>& qtoken_set) const {
 
     for (const auto& syn_tokens : q_pos_synonyms) {
         query_hashes.clear();
         fuzzy_search_fields(the_fields, syn_tokens, match_type, false, exclude_token_ids,
-                            exclude_token_ids_size, filter_ids, filter_ids_length, curated_ids_sorted,
+                            exclude_token_ids_size, filter_ids, filter_ids_length,
+                            filter_bitmap, filter_iterator, curated_ids_sorted,
                             sort_fields_std, {0}, searched_queries, qtoken_set, actual_topster, groups_processed,
-                            all_result_ids, all_result_ids_len, group_limit, group_by_fields, prioritize_exact_match,
+                            all_result_ids, all_result_ids_len, group_limit, group_by_fields, group_key_column, prioritize_exact_match,
                             prioritize_token_position, query_hashes, token_order, prefixes, typo_tokens_threshold,
                             exhaustive_search, max_candidates, min_len_1typo,
-                            min_len_2typo, syn_orig_num_tokens, sort_order, field_values, geopoint_indices);
+                            min_len_2typo, syn_orig_num_tokens, sort_order, field_values, geopoint_indices,
+                            default_sorting_field);
     }
 
     collate_included_ids({}, included_ids_map, curated_topster, searched_queries);
@@ -4038,12 +5029,12 @@ void Index::do_infix_search(const size_t num_search_fields, const std::vector<se
                             const std::vector<enable_t>& infixes,
                             const std::vector<sort_by>& sort_fields,
                             std::vector<std::vector<art_leaf*>>& searched_queries, const size_t group_limit,
-                            const std::vector<std::string>& group_by_fields, const size_t max_extra_prefix,
+                            const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column, const size_t max_extra_prefix,
                             const size_t max_extra_suffix,
                             const std::vector<token_t>& query_tokens, Topster* actual_topster,
                             const uint32_t *filter_ids, size_t filter_ids_length,
                             const int sort_order[3],
-                            std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values,
+                            std::array<sort_column_t*, 3> field_values,
                             const std::vector<size_t>& geopoint_indices,
                             const std::vector<uint32_t>& curated_ids_sorted,
                             uint32_t*& all_result_ids, size_t& all_result_ids_len,
@@ -4103,7 +5094,7 @@ void Index::do_infix_search(const size_t num_search_fields, const std::vector<se
 
                     uint64_t distinct_id = seq_id;
                     if(group_limit != 0) {
-                        distinct_id = get_distinct_id(group_by_fields, seq_id);
+                        distinct_id = get_distinct_id(group_key_column, group_by_fields, seq_id);
                         groups_processed.emplace(distinct_id);
                     }
 
@@ -4197,11 +5188,12 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
     for(size_t findex=0; findex < facets.size(); findex++) {
         const auto& a_facet = facets[findex];
 
-        const auto field_facet_mapping_it = facet_index_v3.find(a_facet.field_name);
-        if(field_facet_mapping_it == facet_index_v3.end()) {
+        const auto facet_index_it = facet_index_v4.find(a_facet.field_name);
+        if(facet_index_it == facet_index_v4.end()) {
             continue;
         }
 
+        const facet_index_t* facet_index = facet_index_it->second;
         facet_infos[findex].use_facet_query = false;
 
         const field &facet_field = search_schema.at(a_facet.field_name);
@@ -4250,7 +5242,7 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
             search_field(0, qtokens, nullptr, 0, num_toks_dropped,
                          facet_field, facet_field.faceted_name(),
                          all_result_ids, all_result_ids_len, {}, sort_fields, -1, facet_query_num_typos, searched_queries, topster,
-                         groups_processed, &field_result_ids, field_result_ids_len, field_num_results, 0, group_by_fields,
+                         groups_processed, &field_result_ids, field_result_ids_len, field_num_results, 0, group_by_fields, nullptr,
                          false, 4, query_hashes, MAX_SCORE, true, 0, 1, false, -1, 3, 1000, max_candidates);
 
             //LOG(INFO) << "searched_queries.size: " << searched_queries.size();
@@ -4274,8 +5266,9 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
                 for(size_t i = 0; i < field_result_ids_len; i++) {
                     uint32_t seq_id = field_result_ids[i];
 
-                    const auto doc_fvalues_it = field_facet_mapping_it->second[seq_id % ARRAY_FACET_DIM]->find(seq_id);
-                    if(doc_fvalues_it == field_facet_mapping_it->second[seq_id % ARRAY_FACET_DIM]->end()) {
+                    const uint32_t* doc_ordinals = nullptr;
+                    const uint32_t num_doc_ordinals = facet_index->get(seq_id, doc_ordinals);
+                    if(num_doc_ordinals == 0) {
                         continue;
                     }
 
@@ -4299,8 +5292,8 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
                         posting_t::get_matching_array_indices(posting_lists, seq_id, array_indices);
 
                         for(size_t array_index: array_indices) {
-                            if(array_index < doc_fvalues_it->second.length) {
-                                uint64_t hash = doc_fvalues_it->second.hashes[array_index];
+                            if(array_index < num_doc_ordinals) {
+                                uint64_t hash = facet_index->get_hash(doc_ordinals[array_index]);
 
                                 /*LOG(INFO) << "seq_id: " << seq_id << ", hash: " << hash << ", array index: "
                                           << array_index;*/
@@ -4311,7 +5304,7 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
                             }
                         }
                     } else {
-                        uint64_t hash = doc_fvalues_it->second.hashes[0];
+                        uint64_t hash = facet_index->get_hash(doc_ordinals[0]);
                         if(facet_infos[findex].hashes.count(hash) == 0) {
                             facet_infos[findex].hashes.emplace(hash, searched_tokens);
                         }
@@ -4324,43 +5317,20 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
     }
 }
 
-void Index::curate_filtered_ids(filter_node_t const* const& filter_tree_root, const std::set<uint32_t>& curated_ids,
-                                const uint32_t* exclude_token_ids, size_t exclude_token_ids_size,
-                                uint32_t*& filter_ids, uint32_t& filter_ids_length,
-                                const std::vector<uint32_t>& curated_ids_sorted) const {
-    if(!curated_ids.empty()) {
-        uint32_t *excluded_result_ids = nullptr;
-        filter_ids_length = ArrayUtils::exclude_scalar(filter_ids, filter_ids_length, &curated_ids_sorted[0],
-                                                       curated_ids_sorted.size(), &excluded_result_ids);
-        delete [] filter_ids;
-        filter_ids = excluded_result_ids;
-    }
-
-    // Exclude document IDs associated with excluded tokens from the result set
-    if(exclude_token_ids_size != 0) {
-        uint32_t *excluded_result_ids = nullptr;
-        filter_ids_length = ArrayUtils::exclude_scalar(filter_ids, filter_ids_length, exclude_token_ids,
-                                                       exclude_token_ids_size, &excluded_result_ids);
-        delete[] filter_ids;
-        filter_ids = excluded_result_ids;
-    }
-}
-
 void Index::search_wildcard(filter_node_t const* const& filter_tree_root,
                             const std::map<size_t, std::map<size_t, uint32_t>>& included_ids_map,
                             const std::vector<sort_by>& sort_fields, Topster* topster, Topster* curated_topster,
                             spp::sparse_hash_set<uint64_t>& groups_processed,
                             std::vector<std::vector<art_leaf*>>& searched_queries, const size_t group_limit,
-                            const std::vector<std::string>& group_by_fields, const std::set<uint32_t>& curated_ids,
+                            const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column, const std::set<uint32_t>& curated_ids,
                             const std::vector<uint32_t>& curated_ids_sorted, const uint32_t* exclude_token_ids,
-                            size_t exclude_token_ids_size,
-                            uint32_t*& all_result_ids, size_t& all_result_ids_len, const uint32_t* filter_ids,
-                            uint32_t filter_ids_length, const size_t concurrency,
+                            size_t exclude_token_ids_size, const id_bitmap_t& filter_bitmap, const size_t concurrency,
                             const int* sort_order,
-                            std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                            std::array<sort_column_t*, 3>& field_values,
                             const std::vector<size_t>& geopoint_indices) const {
 
     uint32_t token_bits = 0;
+    const size_t filter_ids_length = filter_bitmap.cardinality();
     const bool check_for_circuit_break = (filter_ids_length > 1000000);
 
     //auto beginF = std::chrono::high_resolution_clock::now();
@@ -4391,7 +5361,8 @@ void Index::search_wildcard(filter_node_t const* const& filter_tree_root,
             batch_res_len = filter_ids_length - filter_index;
         }
 
-        const uint32_t* batch_result_ids = filter_ids + filter_index;
+        // each batch walks the filter bitmap starting from the id at its window's offset
+        const uint32_t batch_start_id = filter_bitmap.select(filter_index);
         num_queued++;
 
         searched_queries.push_back({});
@@ -4400,10 +5371,10 @@ void Index::search_wildcard(filter_node_t const* const& filter_tree_root,
 
         thread_pool->enqueue([this, &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
                                      thread_id, &sort_fields, &searched_queries,
-                                     &group_limit, &group_by_fields, &topsters, &tgroups_processed,
+                                     &group_limit, &group_by_fields, group_key_column, &topsters, &tgroups_processed,
                                      &sort_order, field_values, &geopoint_indices, &plists,
-                                     check_for_circuit_break,
-                                     batch_result_ids, batch_res_len,
+                                     check_for_circuit_break, &filter_bitmap,
+                                     batch_start_id, batch_res_len,
                                      &num_processed, &m_process, &cv_process]() {
 
             search_begin_us = parent_search_begin;
@@ -4412,8 +5383,11 @@ void Index::search_wildcard(filter_node_t const* const& filter_tree_root,
 
             size_t filter_index = 0;
 
-            for(size_t i = 0; i < batch_res_len; i++) {
-                const uint32_t seq_id = batch_result_ids[i];
+            auto filter_it = filter_bitmap.new_iterator();
+            filter_it.skip_to(batch_start_id);
+
+            for(size_t i = 0; i < batch_res_len && filter_it.valid(); i++, filter_it.next()) {
+                const uint32_t seq_id = filter_it.id();
                 int64_t match_score = 0;
 
                 score_results2(sort_fields, (uint16_t) searched_queries.size(), 0, false, 0,
@@ -4427,7 +5401,7 @@ void Index::search_wildcard(filter_node_t const* const& filter_tree_root,
 
                 uint64_t distinct_id = seq_id;
                 if(group_limit != 0) {
-                    distinct_id = get_distinct_id(group_by_fields, seq_id);
+                    distinct_id = get_distinct_id(group_key_column, group_by_fields, seq_id);
                     tgroups_processed[thread_id].emplace(distinct_id);
                 }
 
@@ -4463,17 +5437,107 @@ void Index::search_wildcard(filter_node_t const* const& filter_tree_root,
     /*long long int timeMillisF = std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::high_resolution_clock::now() - beginF).count();
     LOG(INFO) << "Time for raw scoring: " << timeMillisF;*/
+}
 
-    uint32_t* new_all_result_ids = nullptr;
-    all_result_ids_len = ArrayUtils::or_scalar(all_result_ids, all_result_ids_len, filter_ids,
-                                               filter_ids_length, &new_all_result_ids);
-    delete [] all_result_ids;
-    all_result_ids = new_all_result_ids;
+bool Index::search_wildcard_ordered(const std::vector<sort_by>& sort_fields, const int* sort_order,
+                                    const std::array<sort_column_t*, 3>& field_values, Topster* topster,
+                                    std::vector<std::vector<art_leaf*>>& searched_queries, const size_t group_limit,
+                                    const id_bitmap_t& filter_bitmap) const {
+    const size_t filter_ids_length = filter_bitmap.cardinality();
+
+    // grouping needs every filtered document to count the groups
+    if(group_limit != 0 || sort_fields.size() != 1 || filter_ids_length == 0 ||
+       sort_fields[0].missing_values == sort_by::missing_values_t::first) {
+        return false;
+    }
+
+    const auto field_it = search_schema.find(sort_fields[0].name);
+    if(field_it == search_schema.end() || !field_it.value().is_num_sortable() || field_it.value().is_geopoint()) {
+        return false;
+    }
+
+    const auto num_tree_it = numerical_index.find(sort_fields[0].name);
+    if(num_tree_it == numerical_index.end()) {
+        return false;
+    }
+
+    // in a walk over the values, about 1 in (num_docs / filter_ids_length) documents is a result
+    const size_t num_hits = topster->MAX_SIZE;
+    const size_t num_docs = seq_ids->num_ids();
+
+    if(num_hits * num_docs * ORDERED_WILDCARD_SCAN_RATIO > size_t(filter_ids_length) * filter_ids_length) {
+        return false;
+    }
+
+    std::vector<std::pair<uint32_t, int64_t>> hits;
+    std::vector<uint32_t> value_ids;
+    size_t num_visited = 0;
+    bool walked_all = true;
+
+    num_tree_it->second->walk(sort_order[0] == 1, [&](int64_t value, void* ids) {
+        value_ids.clear();
+        ids_t::uncompress(ids, value_ids);
+
+        // documents of equal value are ordered by descending seq_id
+        for(auto id_it = value_ids.rbegin(); id_it != value_ids.rend(); ++id_it) {
+            if(filter_bitmap.contains(*id_it)) {
+                hits.emplace_back(*id_it, value);
+                if(hits.size() == num_hits) {
+                    walked_all = false;
+                    return false;
+                }
+            }
+        }
+
+        // give up when the values are skewed against the filter
+        num_visited += value_ids.size();
+        if(num_visited > filter_ids_length) {
+            walked_all = false;
+            return false;
+        }
+
+        return true;
+    });
+
+    if(hits.size() < num_hits && !walked_all) {
+        return false;
+    }
+
+    // documents without a value are sorted last, by descending seq_id: the bitmap is walked forward, keeping the
+    // last of them that fit
+    const size_t num_missing_hits = num_hits - hits.size();
+    std::deque<uint32_t> missing_ids;
+
+    for(auto filter_it = filter_bitmap.new_iterator(); num_missing_hits != 0 && filter_it.valid(); filter_it.next()) {
+        if(!field_values[0]->contains(filter_it.id())) {
+            missing_ids.push_back(filter_it.id());
+            if(missing_ids.size() > num_missing_hits) {
+                missing_ids.pop_front();
+            }
+        }
+    }
+
+    for(auto id_it = missing_ids.rbegin(); id_it != missing_ids.rend(); ++id_it) {
+        hits.emplace_back(*id_it, INT64_MIN);
+    }
+
+    searched_queries.push_back({});
+
+    for(const auto& hit: hits) {
+        int64_t scores[3] = {0};
+        scores[0] = (hit.second == INT64_MIN) ? INT64_MIN : hit.second * sort_order[0];
+        int64_t match_score_index = -1;
+
+        KV kv(searched_queries.size(), hit.first, hit.first, match_score_index, scores);
+        topster->add(&kv);
+    }
+
+    return true;
 }
 
 void Index::populate_sort_mapping(int* sort_order, std::vector<size_t>& geopoint_indices,
                                   std::vector<sort_by>& sort_fields_std,
-                                  std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values) const {
+                                  std::array<sort_column_t*, 3>& field_values) const {
     for (size_t i = 0; i < sort_fields_std.size(); i++) {
         sort_order[i] = 1;
         if (sort_fields_std[i].order == sort_field_const::asc) {
@@ -4518,7 +5582,7 @@ void Index::search_field(const uint8_t & field_id,
                          std::vector<std::vector<art_leaf*>> & searched_queries,
                          Topster* topster, spp::sparse_hash_set<uint64_t>& groups_processed,
                          uint32_t** all_result_ids, size_t & all_result_ids_len, size_t& field_num_results,
-                         const size_t group_limit, const std::vector<std::string>& group_by_fields,
+                         const size_t group_limit, const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
                          bool prioritize_exact_match,
                          const size_t concurrency,
                          std::set<uint64>& query_hashes,
@@ -4650,7 +5714,7 @@ void Index::search_field(const uint8_t & field_id,
                               exclude_token_ids, exclude_token_ids_size,
                               curated_ids, sort_fields, token_candidates_vec, searched_queries, topster,
                               groups_processed, all_result_ids, all_result_ids_len, field_num_results,
-                              typo_tokens_threshold, group_limit, group_by_fields, query_tokens,
+                              typo_tokens_threshold, group_limit, group_by_fields, group_key_column, query_tokens,
                               prioritize_exact_match, exhaustive_search, syn_orig_num_tokens,
                               concurrency, query_hashes, id_buff);
 
@@ -4818,9 +5882,9 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
                           const std::vector<art_leaf *> &query_suggestion,
                           spp::sparse_hash_set<uint64_t>& groups_processed,
                           const uint32_t seq_id, const int sort_order[3],
-                          std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values,
+                          std::array<sort_column_t*, 3> field_values,
                           const std::vector<size_t>& geopoint_indices,
-                          const size_t group_limit, const std::vector<std::string>& group_by_fields,
+                          const size_t group_limit, const std::vector<std::string>& group_by_fields, const group_key_column_t* group_key_column,
                           const uint32_t token_bits,
                           const bool prioritize_exact_match,
                           const bool single_exact_query_token,
@@ -4830,17 +5894,16 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
     int64_t geopoint_distances[3];
 
     for(auto& i: geopoint_indices) {
-        spp::sparse_hash_map<uint32_t, int64_t>* geopoints = field_values[i];
+        sort_column_t* geopoints = field_values[i];
         int64_t dist = INT32_MAX;
 
         S2LatLng reference_lat_lng;
         GeoPoint::unpack_lat_lng(sort_fields[i].geopoint, reference_lat_lng);
 
         if(geopoints != nullptr) {
-            auto it = geopoints->find(seq_id);
+            int64_t packed_latlng;
 
-            if(it != geopoints->end()) {
-                int64_t packed_latlng = it->second;
+            if(geopoints->get(seq_id, packed_latlng)) {
                 S2LatLng s2_lat_lng;
                 GeoPoint::unpack_lat_lng(packed_latlng, s2_lat_lng);
                 dist = GeoPoint::distance(s2_lat_lng, reference_lat_lng);
@@ -4961,8 +6024,9 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         } else if(field_values[0] == &str_sentinel_value) {
             scores[0] = str_sort_index.at(sort_fields[0].name)->rank(seq_id);
         } else {
-            auto it = field_values[0]->find(seq_id);
-            scores[0] = (it == field_values[0]->end()) ? default_score : it->second;
+            if(!field_values[0]->get(seq_id, scores[0])) {
+                scores[0] = default_score;
+            }
         }
 
         if (sort_order[0] == -1) {
@@ -4981,8 +6045,9 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         } else if(field_values[1] == &str_sentinel_value) {
             scores[1] = str_sort_index.at(sort_fields[1].name)->rank(seq_id);
         } else {
-            auto it = field_values[1]->find(seq_id);
-            scores[1] = (it == field_values[1]->end()) ? default_score : it->second;
+            if(!field_values[1]->get(seq_id, scores[1])) {
+                scores[1] = default_score;
+            }
         }
 
         if (sort_order[1] == -1) {
@@ -5001,8 +6066,9 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         } else if(field_values[2] == &str_sentinel_value) {
             scores[2] = str_sort_index.at(sort_fields[2].name)->rank(seq_id);
         } else {
-            auto it = field_values[2]->find(seq_id);
-            scores[2] = (it == field_values[2]->end()) ? default_score : it->second;
+            if(!field_values[2]->get(seq_id, scores[2])) {
+                scores[2] = default_score;
+            }
         }
 
         if (sort_order[2] == -1) {
@@ -5013,7 +6079,7 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
     uint64_t distinct_id = seq_id;
 
     if(group_limit != 0) {
-        distinct_id = get_distinct_id(group_by_fields, seq_id);
+        distinct_id = get_distinct_id(group_key_column, group_by_fields, seq_id);
         groups_processed.emplace(distinct_id);
     }
 
@@ -5025,29 +6091,183 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
     //LOG(INFO) << "Time taken for results iteration: " << timeNanos << "ms";
 }
 
-// pre-filter group_by_fields such that we can avoid the find() check
-uint64_t Index::get_distinct_id(const std::vector<std::string>& group_by_fields,
+uint64_t Index::get_distinct_id(const group_key_column_t* group_key_column,
+                                const std::vector<std::string>& group_by_fields,
                                 const uint32_t seq_id) const {
-    uint64_t distinct_id = 1; // some constant initial value
+    int64_t distinct_id;
+    if(group_key_column != nullptr && group_key_column->distinct_ids.get(seq_id, distinct_id)) {
+        return distinct_id;
+    }
 
-    // calculate hash from group_by_fields
-    for(const auto& field: group_by_fields) {
-        const auto& field_facet_mapping_it = facet_index_v3.find(field);
-        if(field_facet_mapping_it == facet_index_v3.end()) {
+    return compute_distinct_id(group_by_fields, seq_id);
+}
+
+static int64_t get_steady_clock_s() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::shared_ptr<const Index::group_key_column_t> Index::get_group_key_column(
+                                                     const std::vector<std::string>& group_by_fields) const {
+    std::unique_lock lock(group_key_columns_mutex);
+
+    for(const auto& group_key_column: group_key_columns) {
+        if(group_key_column != nullptr && group_key_column->group_by_fields == group_by_fields) {
+            group_key_column->last_used_s = get_steady_clock_s();
+            return group_key_column;
+        }
+    }
+
+    // keys are computed per document until the column is built, so that searches don't wait on the build
+    if(!group_key_column_building) {
+        if(group_key_column_builder.joinable()) {
+            // the previous build is done
+            group_key_column_builder.join();
+        }
+
+        group_key_column_building = true;
+        group_key_column_builder = std::thread(&Index::build_group_key_column, this, group_by_fields);
+    }
+
+    return nullptr;
+}
+
+void Index::build_group_key_column(const std::vector<std::string>& group_by_fields) const {
+    auto new_column = std::make_shared<group_key_column_t>();
+    new_column->group_by_fields = group_by_fields;
+
+    // writes, which keep the columns up to date, wait until the column is in place
+    std::shared_lock lock(mutex);
+
+    const uint32_t* all_ids = seq_ids->uncompress();
+    const size_t all_ids_len = seq_ids->num_ids();
+
+    for(size_t i = 0; i < all_ids_len; i++) {
+        new_column->distinct_ids.emplace(all_ids[i], compute_distinct_id(group_by_fields, all_ids[i]));
+    }
+
+    delete[] all_ids;
+
+    std::unique_lock columns_lock(group_key_columns_mutex);
+    new_column->last_used_s = get_steady_clock_s();
+
+    // takes a free slot, or else the place of the column that was read least recently
+    size_t slot_index = 0;
+
+    for(size_t i = 0; i < group_key_columns.size(); i++) {
+        if(group_key_columns[i] == nullptr) {
+            slot_index = i;
+            break;
+        }
+
+        if(group_key_columns[i]->last_used_s < group_key_columns[slot_index]->last_used_s) {
+            slot_index = i;
+        }
+    }
+
+    group_key_columns[slot_index] = new_column;
+    num_group_key_columns = MAX_GROUP_KEY_COLUMNS -
+                            std::count(group_key_columns.begin(), group_key_columns.end(), nullptr);
+    group_key_column_building = false;
+}
+
+void Index::update_group_key_columns(const std::vector<index_record>& iter_batch) {
+    // a build in progress is checked first, as a build puts its column in place before it is done
+    if(!group_key_column_building && num_group_key_columns == 0) {
+        return;
+    }
+
+    std::unique_lock lock(mutex);
+    std::unique_lock columns_lock(group_key_columns_mutex);
+
+    const int64_t now_s = get_steady_clock_s();
+
+    for(auto& group_key_column: group_key_columns) {
+        if(group_key_column == nullptr) {
+            continue;
+        }
+
+        // rather than keep updating a column that is no longer searched
+        if(now_s - group_key_column->last_used_s > GROUP_KEY_COLUMN_IDLE_S) {
+            group_key_column = nullptr;
+            continue;
+        }
+
+        const auto& group_by_fields = group_key_column->group_by_fields;
+
+        for(const auto& record: iter_batch) {
+            if(!record.indexed.ok()) {
+                continue;
+            }
+
+            // an update that leaves the group fields alone keeps its key
+            if(record.is_update && std::none_of(group_by_fields.begin(), group_by_fields.end(),
+                                                [&record](const std::string& field_name) {
+                                                    return record.doc.count(field_name) != 0 ||
+                                                           record.del_doc.count(field_name) != 0;
+                                                })) {
+                continue;
+            }
+
+            const uint64_t distinct_id = compute_distinct_id(group_by_fields, record.seq_id);
+            group_key_column->distinct_ids.erase(record.seq_id);
+            group_key_column->distinct_ids.emplace(record.seq_id, distinct_id);
+        }
+    }
+
+    num_group_key_columns = MAX_GROUP_KEY_COLUMNS -
+                            std::count(group_key_columns.begin(), group_key_columns.end(), nullptr);
+}
+
+void Index::erase_group_key_columns(const std::vector<field>& fields) {
+    std::unique_lock columns_lock(group_key_columns_mutex);
+
+    for(auto& group_key_column: group_key_columns) {
+        if(group_key_column == nullptr) {
             continue;
         }
 
-        const auto& field_facet_mapping = field_facet_mapping_it->second;
-        const auto& facet_hashes_it = field_facet_mapping[seq_id % ARRAY_FACET_DIM]->find(seq_id);
+        const auto& group_by_fields = group_key_column->group_by_fields;
+
+        for(const auto& a_field: fields) {
+            if(std::find(group_by_fields.begin(), group_by_fields.end(), a_field.name) != group_by_fields.end()) {
+                group_key_column = nullptr;
+                break;
+            }
+        }
+    }
+
+    num_group_key_columns = MAX_GROUP_KEY_COLUMNS -
+                            std::count(group_key_columns.begin(), group_key_columns.end(), nullptr);
+}
+
+void Index::clear_group_key_columns() {
+    std::unique_lock columns_lock(group_key_columns_mutex);
+
+    for(auto& group_key_column: group_key_columns) {
+        group_key_column = nullptr;
+    }
+
+    num_group_key_columns = 0;
+}
+
+uint64_t Index::compute_distinct_id(const std::vector<std::string>& group_by_fields,
+                                    const uint32_t seq_id) const {
+    uint64_t distinct_id = 1; // some constant initial value
 
-        if(facet_hashes_it == field_facet_mapping[seq_id % ARRAY_FACET_DIM]->end()) {
+    // calculate hash from group_by_fields
+    for(const auto& field: group_by_fields) {
+        const auto& facet_index_it = facet_index_v4.find(field);
+        if(facet_index_it == facet_index_v4.end()) {
             continue;
         }
 
-        const auto& facet_hashes = facet_hashes_it->second;
+        const facet_index_t* facet_index = facet_index_it->second;
+        const uint32_t* ordinals = nullptr;
+        const uint32_t num_ordinals = facet_index->get(seq_id, ordinals);
 
-        for(size_t i = 0; i < facet_hashes.size(); i++) {
-            distinct_id = StringUtils::hash_combine(distinct_id, facet_hashes.hashes[i]);
+        for(size_t i = 0; i < num_ordinals; i++) {
+            distinct_id = StringUtils::hash_combine(distinct_id, facet_index->get_hash(ordinals[i]));
         }
     }
 
@@ -5161,6 +6381,8 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
         return;
     }
 
+    advance_filter_generation(field_name);
+
     // Go through all the field names and find the keys+values so that they can be removed from in-memory index
     if(search_field.type == field_types::STRING_ARRAY || search_field.type == field_types::STRING) {
         std::vector<std::string> tokens;
@@ -5186,6 +6408,10 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
                 infix_sets[strhash % 4]->erase(token);
             }
         }
+
+        if(!tokens.empty()) {
+            advance_search_index_generation(field_name);
+        }
     } else if(search_field.is_int32()) {
         const std::vector<int32_t>& values = search_field.is_single_integer() ?
                                              std::vector<int32_t>{document[field_name].get<int32_t>()} :
@@ -5272,12 +6498,9 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
     }
 
     // remove facets
-    const auto& field_facets_it = facet_index_v3.find(field_name);
-    if(field_facets_it != facet_index_v3.end()) {
-        const auto& fvalues_it = field_facets_it->second[seq_id % ARRAY_FACET_DIM]->find(seq_id);
-        if(fvalues_it != field_facets_it->second[seq_id % ARRAY_FACET_DIM]->end()) {
-            field_facets_it->second[seq_id % ARRAY_FACET_DIM]->erase(fvalues_it);
-        }
+    const auto& field_facets_it = facet_index_v4.find(field_name);
+    if(field_facets_it != facet_index_v4.end()) {
+        field_facets_it->second->erase(seq_id);
     }
 
     // remove sort field
@@ -5327,6 +6550,16 @@ Option<uint32_t> Index::remove(const uint32_t seq_id, const nlohmann::json & doc
 
     if(!is_update) {
         seq_ids->erase(seq_id);
+        seq_ids_generation++;
+        updated_points.erase(seq_id);
+
+        std::unique_lock columns_lock(group_key_columns_mutex);
+
+        for(auto& group_key_column: group_key_columns) {
+            if(group_key_column != nullptr) {
+                group_key_column->distinct_ids.erase(seq_id);
+            }
+        }
     }
 
     return Option<uint32_t>(seq_id);
@@ -5371,9 +6604,29 @@ const spp::sparse_hash_map<std::string, hnsw_index_t*>& Index::_get_vector_index
     return vector_index;
 }
 
+void Index::set_filter_result_cache_size(size_t size_bytes) {
+    filter_result_cache_size = size_bytes;
+}
+
+void Index::set_filter_result_cache_min_cost_us(uint64_t min_cost_us) {
+    filter_result_cache_min_cost_us = min_cost_us;
+}
+
+size_t Index::get_filter_result_cache_size_bytes() const {
+    return filter_result_cache.size_bytes();
+}
+
 void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vector<field>& del_fields) {
     std::unique_lock lock(mutex);
 
+    // the keys of the groups over these fields are built again against the new schema
+    erase_group_key_columns(new_fields);
+    erase_group_key_columns(del_fields);
+
+    // the generations of a field that is dropped and added again start over
+    typo_candidate_cache.clear();
+    filter_result_cache.clear();
+
     for(const auto & new_field: new_fields) {
         if(!new_field.index || new_field.is_dynamic()) {
             continue;
@@ -5387,9 +6640,11 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
             continue;
         }
 
+        filter_generations.emplace(new_field.name, 0);
+
         if(new_field.is_sortable()) {
             if(new_field.is_num_sortable()) {
-                spp::sparse_hash_map<uint32_t, int64_t> * doc_to_score = new spp::sparse_hash_map<uint32_t, int64_t>();
+                sort_column_t* doc_to_score = new sort_column_t();
                 sort_index.emplace(new_field.name, doc_to_score);
             } else if(new_field.is_str_sortable()) {
                 str_sort_index.emplace(new_field.name, new adi_tree_t);
@@ -5401,6 +6656,7 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
                 art_tree *t = new art_tree;
                 art_tree_init(t);
                 search_index.emplace(new_field.name, t);
+                search_index_generations.emplace(new_field.name, 0);
             } else if(new_field.is_geopoint()) {
                 auto field_geo_index = new spp::sparse_hash_map<std::string, std::vector<uint32_t>>();
                 geopoint_index.emplace(new_field.name, field_geo_index);
@@ -5415,12 +6671,7 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
         }
 
         if(new_field.is_facet()) {
-            array_mapped_facet_t facet_array;
-            for(size_t i = 0; i < ARRAY_FACET_DIM; i++) {
-                facet_array[i] = new facet_map_t();
-            }
-
-            facet_index_v3.emplace(new_field.name, facet_array);
+            facet_index_v4.emplace(new_field.name, new facet_index_t());
 
             // initialize for non-string facet fields
             if(!new_field.is_string()) {
@@ -5452,10 +6703,13 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
             continue;
         }
 
+        filter_generations.erase(del_field.name);
+
         if(del_field.is_string() || field_types::is_string_or_array(del_field.type)) {
             art_tree_destroy(search_index[del_field.name]);
             delete search_index[del_field.name];
             search_index.erase(del_field.name);
+            search_index_generations.erase(del_field.name);
         } else if(del_field.is_geopoint()) {
             delete geopoint_index[del_field.name];
             geopoint_index.erase(del_field.name);
@@ -5484,12 +6738,8 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
         }
 
         if(del_field.is_facet()) {
-            auto& arr = facet_index_v3[del_field.name];
-            for(size_t i = 0; i < ARRAY_FACET_DIM; i++) {
-                delete arr[i];
-            }
-
-            facet_index_v3.erase(del_field.name);
+            delete facet_index_v4[del_field.name];
+            facet_index_v4.erase(del_field.name);
 
             if(!del_field.is_string()) {
                 art_tree_destroy(search_index[del_field.faceted_name()]);
@@ -5965,6 +7215,32 @@ size_t Index::num_seq_ids() const {
     return seq_ids->num_ids();
 }
 
+void Index::get_facet_values(const std::string& field_name,
+                             const std::vector<std::pair<uint64_t, facet_count_t>>& facet_hash_counts,
+                             size_t num_values, std::vector<std::string>& values, std::vector<bool>& found) const {
+    values.assign(num_values, "");
+    found.assign(num_values, false);
+
+    std::shared_lock lock(mutex);
+
+    const auto facet_index_it = facet_index_v4.find(field_name);
+    if(facet_index_it == facet_index_v4.end()) {
+        return;
+    }
+
+    const facet_index_t* facet_index = facet_index_it->second;
+
+    for(size_t i = 0; i < num_values; i++) {
+        const auto& facet_count = facet_hash_counts[i].second;
+
+        uint32_t ordinal;
+        if(facet_index->get_ordinal(facet_hash_counts[i].first, ordinal)) {
+            values[i] = facet_index->get_value(ordinal, facet_count.doc_id, facet_count.array_pos);
+            found[i] = true;
+        }
+    }
+}
+
 void Index::resolve_space_as_typos(std::vector<std::string>& qtokens, const string& field_name,
                                    std::vector<std::vector<std::string>>& resolved_queries) const {
 
@@ -0,0 +1,472 @@
+#include "int_codec.h"
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SIMD_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define HAS_SIMD_CODEC 1
+#elif defined(__aarch64__)
+#include <sse2neon.h>
+#define SIMD_TARGET_SSSE3
+#define HAS_SIMD_CODEC 1
+#endif
+
+namespace {
+    inline uint32_t load_u32(const uint8_t* p) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline void store_u32(uint8_t* p, uint32_t v) {
+        memcpy(p, &v, sizeof(v));
+    }
+
+    bool detect_ssse3() {
+#if defined(__x86_64__)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3");
+#elif defined(__aarch64__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    const bool has_ssse3 = detect_ssse3();
+
+    // -- BP128
+
+    uint32_t bp128_block_bits(const uint32_t* values, uint32_t count) {
+        uint32_t deltas = 0;
+        for(uint32_t i = 1; i < count; i++) {
+            deltas |= values[i] - values[i-1];
+        }
+
+        return codec_required_bits(deltas);
+    }
+
+    inline void bp128_pack(uint8_t* packed, uint32_t bits, uint32_t j, uint32_t delta) {
+        const uint32_t lane = j & 3;
+        const uint32_t bit = (j >> 2) * bits;
+        const uint32_t word = bit >> 5, shift = bit & 31;
+
+        uint8_t* p = packed + (word * 4 + lane) * 4;
+        store_u32(p, load_u32(p) | (delta << shift));
+
+        if(shift + bits > 32) {
+            uint8_t* q = packed + ((word + 1) * 4 + lane) * 4;
+            store_u32(q, load_u32(q) | (delta >> (32 - shift)));
+        }
+    }
+
+    uint32_t bp128_compress_block(const uint32_t* values, uint32_t count, uint8_t* out) {
+        const uint32_t bits = bp128_block_bits(values, count);
+        const uint32_t size = bp128_codec_t::packed_size(count, bits);
+
+        store_u32(out, values[0]);
+        out[4] = (uint8_t) bits;
+
+        uint8_t* packed = out + bp128_codec_t::BLOCK_HEADER_SIZE;
+        memset(packed, 0, size);
+
+        if(bits != 0) {
+            for(uint32_t j = 1; j < count; j++) {
+                bp128_pack(packed, bits, j, values[j] - values[j-1]);
+            }
+        }
+
+        return bp128_codec_t::BLOCK_HEADER_SIZE + size;
+    }
+
+    // `out` must have room for `count` rounded up to a multiple of 4
+    void bp128_unpack(const uint8_t* block, uint32_t count, uint32_t* out) {
+        const uint32_t first = load_u32(block);
+        const uint32_t bits = block[4];
+        const uint8_t* packed = block + bp128_codec_t::BLOCK_HEADER_SIZE;
+        const uint32_t slots = (count + 3) / 4;
+
+        if(bits == 0) {
+            std::fill(out, out + slots * 4, first);
+            return;
+        }
+
+#ifdef HAS_SIMD_CODEC
+        const __m128i mask = _mm_set1_epi32(bits == 32 ? -1 : int32_t((1U << bits) - 1));
+        __m128i carry = _mm_set1_epi32(int32_t(first));
+
+        for(uint32_t s = 0; s < slots; s++) {
+            const uint32_t bit = s * bits;
+            const uint32_t word = bit >> 5, shift = bit & 31;
+
+            __m128i v = _mm_loadu_si128((const __m128i*) (packed + word * 16));
+            v = _mm_srl_epi32(v, _mm_cvtsi32_si128(int(shift)));
+
+            if(shift + bits > 32) {
+                const __m128i next = _mm_loadu_si128((const __m128i*) (packed + (word + 1) * 16));
+                v = _mm_or_si128(v, _mm_sll_epi32(next, _mm_cvtsi32_si128(int(32 - shift))));
+            }
+
+            v = _mm_and_si128(v, mask);
+
+            // prefix sum of 4 consecutive deltas, on top of the last value of the previous slot
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi32(v, carry);
+
+            _mm_storeu_si128((__m128i*) (out + s * 4), v);
+            carry = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+#else
+        const uint32_t mask = bits == 32 ? UINT32_MAX : (1U << bits) - 1;
+        uint32_t value = first;
+
+        for(uint32_t j = 0; j < slots * 4; j++) {
+            const uint32_t lane = j & 3;
+            const uint32_t bit = (j >> 2) * bits;
+            const uint32_t word = bit >> 5, shift = bit & 31;
+
+            uint32_t delta = load_u32(packed + (word * 4 + lane) * 4) >> shift;
+            if(shift + bits > 32) {
+                delta |= load_u32(packed + ((word + 1) * 4 + lane) * 4) << (32 - shift);
+            }
+
+            value += delta & mask;
+            out[j] = value;
+        }
+#endif
+    }
+
+    // only full blocks precede the requested one, so their size follows from their bit width
+    inline const uint8_t* bp128_block_at(const uint8_t* in, uint32_t block_index) {
+        for(uint32_t b = 0; b < block_index; b++) {
+            in += bp128_codec_t::BLOCK_HEADER_SIZE + bp128_codec_t::packed_size(bp128_codec_t::BLOCK_SIZE, in[4]);
+        }
+
+        return in;
+    }
+
+    inline uint32_t bp128_block_size(const uint8_t* block, uint32_t count) {
+        return bp128_codec_t::BLOCK_HEADER_SIZE + bp128_codec_t::packed_size(count, block[4]);
+    }
+
+    // -- StreamVByte
+
+    struct svb_tables_t {
+        alignas(16) uint8_t shuffles[256][16];
+        uint8_t lengths[256];
+
+        svb_tables_t() {
+            for(size_t control = 0; control < 256; control++) {
+                uint8_t pos = 0;
+                for(size_t k = 0; k < 4; k++) {
+                    const uint8_t len = ((control >> (2 * k)) & 3) + 1;
+                    for(uint8_t b = 0; b < 4; b++) {
+                        shuffles[control][k * 4 + b] = (b < len) ? (pos + b) : 0x80;
+                    }
+                    pos += len;
+                }
+
+                lengths[control] = pos;
+            }
+        }
+    };
+
+    const svb_tables_t svb_tables;
+
+    inline uint32_t svb_value_length(uint8_t control, uint32_t k) {
+        return ((control >> (2 * k)) & 3) + 1;
+    }
+
+    // decodes the first `count` values of the group at `p`, returns the start of the next group
+    inline const uint8_t* svb_decode_group(const uint8_t* p, uint32_t* out, uint32_t count) {
+        const uint8_t control = *p++;
+        for(uint32_t k = 0; k < count; k++) {
+            const uint32_t len = svb_value_length(control, k);
+            uint32_t v = 0;
+            memcpy(&v, p, len);
+            out[k] = v;
+            p += len;
+        }
+
+        return p;
+    }
+
+    inline const uint8_t* svb_skip_groups(const uint8_t* p, uint32_t num_groups) {
+        for(uint32_t g = 0; g < num_groups; g++) {
+            p += 1 + svb_tables.lengths[*p];
+        }
+
+        return p;
+    }
+
+    // start of the last, partially filled group, along with the end of the encoded values
+    inline void svb_tail(const uint8_t* in, uint32_t length, const uint8_t*& last_group, const uint8_t*& end) {
+        last_group = svb_skip_groups(in, length / 4);
+        end = last_group;
+
+        const uint32_t tail_count = length % 4;
+        if(tail_count != 0) {
+            end++;
+            for(uint32_t k = 0; k < tail_count; k++) {
+                end += svb_value_length(*last_group, k);
+            }
+        }
+    }
+
+#ifdef HAS_SIMD_CODEC
+    SIMD_TARGET_SSSE3
+    const uint8_t* svb_decode_groups_sse(const uint8_t* p, uint32_t* out, uint32_t num_groups) {
+        for(uint32_t g = 0; g < num_groups; g++) {
+            const uint8_t control = *p++;
+            const __m128i data = _mm_loadu_si128((const __m128i*) p);
+            const __m128i shuffle = _mm_load_si128((const __m128i*) svb_tables.shuffles[control]);
+            _mm_storeu_si128((__m128i*) (out + g * 4), _mm_shuffle_epi8(data, shuffle));
+            p += svb_tables.lengths[control];
+        }
+
+        return p;
+    }
+#endif
+}
+
+// -- bp128_codec_t
+
+uint32_t bp128_codec_t::size_sorted(const uint32_t* values, uint32_t length) {
+    if(length == 0) {
+        return BLOCK_HEADER_SIZE;
+    }
+
+    uint32_t size = 0;
+    for(uint32_t i = 0; i < length; i += BLOCK_SIZE) {
+        const uint32_t count = std::min(BLOCK_SIZE, length - i);
+        size += BLOCK_HEADER_SIZE + packed_size(count, bp128_block_bits(values + i, count));
+    }
+
+    return size;
+}
+
+uint32_t bp128_codec_t::append_size_sorted(const uint8_t* in, uint32_t length, uint32_t min, uint32_t max,
+                                           uint32_t value) {
+    const uint8_t* block = bp128_block_at(in, length / BLOCK_SIZE);
+    const uint32_t count = length % BLOCK_SIZE;
+    const uint32_t offset = block - in;
+
+    if(count == 0) {
+        return offset + BLOCK_HEADER_SIZE;
+    }
+
+    const uint32_t bits = std::max<uint32_t>(block[4], codec_required_bits(value - max));
+    return offset + BLOCK_HEADER_SIZE + packed_size(count + 1, bits);
+}
+
+uint32_t bp128_codec_t::compress_sorted(const uint32_t* values, uint8_t* out, uint32_t length) {
+    uint32_t size = 0;
+    for(uint32_t i = 0; i < length; i += BLOCK_SIZE) {
+        const uint32_t count = std::min(BLOCK_SIZE, length - i);
+        size += bp128_compress_block(values + i, count, out + size);
+    }
+
+    return size;
+}
+
+void bp128_codec_t::uncompress(const uint8_t* in, uint32_t* out, uint32_t length) {
+    alignas(16) uint32_t tail[BLOCK_SIZE];
+
+    for(uint32_t i = 0; i < length; i += BLOCK_SIZE) {
+        const uint32_t count = std::min(BLOCK_SIZE, length - i);
+        if(count % 4 == 0) {
+            bp128_unpack(in, count, out + i);
+        } else {
+            bp128_unpack(in, count, tail);
+            memcpy(out + i, tail, count * sizeof(uint32_t));
+        }
+
+        in += bp128_block_size(in, count);
+    }
+}
+
+uint32_t bp128_codec_t::select(const uint8_t* in, uint32_t length, uint32_t index) {
+    alignas(16) uint32_t values[BLOCK_SIZE];
+    const uint8_t* block = bp128_block_at(in, index / BLOCK_SIZE);
+    bp128_unpack(block, (index % BLOCK_SIZE) + 1, values);
+    return values[index % BLOCK_SIZE];
+}
+
+uint32_t bp128_codec_t::lower_bound(const uint8_t* in, uint32_t length, uint32_t value, uint32_t* actual) {
+    if(length == 0) {
+        *actual = 0;
+        return 0;
+    }
+
+    // skip the blocks whose successor starts at or before `value`
+    uint32_t start = 0;
+    const uint8_t* block = in;
+
+    while(start + BLOCK_SIZE < length) {
+        const uint8_t* next = block + bp128_block_size(block, BLOCK_SIZE);
+        if(load_u32(next) > value) {
+            break;
+        }
+
+        block = next;
+        start += BLOCK_SIZE;
+    }
+
+    const uint32_t count = std::min(BLOCK_SIZE, length - start);
+    alignas(16) uint32_t values[BLOCK_SIZE];
+    bp128_unpack(block, count, values);
+
+    const uint32_t index = std::lower_bound(values, values + count, value) - values;
+    if(index != count) {
+        *actual = values[index];
+        return start + index;
+    }
+
+    if(start + count < length) {
+        *actual = load_u32(block + bp128_block_size(block, count));
+        return start + count;
+    }
+
+    *actual = values[count - 1];
+    return length;
+}
+
+uint32_t bp128_codec_t::append_sorted(uint8_t* in, uint32_t length, uint32_t max, uint32_t value) {
+    uint8_t* block = const_cast<uint8_t*>(bp128_block_at(in, length / BLOCK_SIZE));
+    const uint32_t count = length % BLOCK_SIZE;
+    const uint32_t offset = block - in;
+
+    if(count == 0) {
+        store_u32(block, value);
+        block[4] = 0;
+        return offset + BLOCK_HEADER_SIZE;
+    }
+
+    const uint32_t bits = block[4];
+    const uint32_t delta = value - max;
+
+    if(codec_required_bits(delta) > bits) {
+        // wider deltas: re-encode the last block
+        alignas(16) uint32_t values[BLOCK_SIZE];
+        bp128_unpack(block, count, values);
+        values[count] = value;
+        return offset + bp128_compress_block(values, count + 1, block);
+    }
+
+    uint8_t* packed = block + BLOCK_HEADER_SIZE;
+    const uint32_t curr_size = packed_size(count, bits);
+    const uint32_t new_size = packed_size(count + 1, bits);
+    memset(packed + curr_size, 0, new_size - curr_size);
+
+    if(bits != 0) {
+        bp128_pack(packed, bits, count, delta);
+    }
+
+    return offset + BLOCK_HEADER_SIZE + new_size;
+}
+
+// -- stream_vbyte_codec_t
+
+uint32_t stream_vbyte_codec_t::size_unsorted(const uint32_t* values, uint32_t length, uint32_t min, uint32_t max) {
+    uint32_t size = (length + 3) / 4;
+    for(uint32_t i = 0; i < length; i++) {
+        size += value_size(values[i]);
+    }
+
+    return std::max<uint32_t>(size, 1);
+}
+
+uint32_t stream_vbyte_codec_t::append_size_unsorted(const uint8_t* in, uint32_t length, uint32_t min, uint32_t max,
+                                                    uint32_t value) {
+    const uint8_t* last_group;
+    const uint8_t* end;
+    svb_tail(in, length, last_group, end);
+
+    return (end - in) + (length % 4 == 0 ? 1 : 0) + value_size(value);
+}
+
+uint32_t stream_vbyte_codec_t::compress_unsorted(const uint32_t* values, uint8_t* out, uint32_t length) {
+    uint8_t* p = out;
+
+    for(uint32_t i = 0; i < length; i += 4) {
+        uint8_t* control = p++;
+        *control = 0;
+
+        const uint32_t count = std::min<uint32_t>(4, length - i);
+        for(uint32_t k = 0; k < count; k++) {
+            const uint32_t len = value_size(values[i + k]);
+            *control |= (len - 1) << (2 * k);
+            memcpy(p, &values[i + k], len);
+            p += len;
+        }
+    }
+
+    return p - out;
+}
+
+void stream_vbyte_codec_t::uncompress(const uint8_t* in, uint32_t* out, uint32_t length) {
+    const uint32_t num_groups = length / 4;
+    uint32_t g = 0;
+
+#ifdef HAS_SIMD_CODEC
+    // a group is atleast 5 bytes long, so the 16 byte loads stay within the values when 3 groups follow
+    if(has_ssse3 && num_groups > 3) {
+        in = svb_decode_groups_sse(in, out, num_groups - 3);
+        g = num_groups - 3;
+    }
+#endif
+
+    for(; g < num_groups; g++) {
+        in = svb_decode_group(in, out + g * 4, 4);
+    }
+
+    if(length % 4 != 0) {
+        svb_decode_group(in, out + num_groups * 4, length % 4);
+    }
+}
+
+uint32_t stream_vbyte_codec_t::select(const uint8_t* in, uint32_t length, uint32_t index) {
+    uint32_t values[4];
+    const uint8_t* group = svb_skip_groups(in, index / 4);
+    svb_decode_group(group, values, (index % 4) + 1);
+    return values[index % 4];
+}
+
+uint32_t stream_vbyte_codec_t::linear_search(const uint8_t* in, uint32_t length, uint32_t value) {
+    uint32_t values[4];
+
+    for(uint32_t i = 0; i < length; i += 4) {
+        const uint32_t count = std::min<uint32_t>(4, length - i);
+        in = svb_decode_group(in, values, count);
+
+        for(uint32_t k = 0; k < count; k++) {
+            if(values[k] == value) {
+                return i + k;
+            }
+        }
+    }
+
+    return length;
+}
+
+uint32_t stream_vbyte_codec_t::append_unsorted(uint8_t* in, uint32_t length, uint32_t value) {
+    const uint8_t* last_group;
+    const uint8_t* end;
+    svb_tail(in, length, last_group, end);
+
+    uint8_t* p = in + (end - in);
+    uint8_t* control = in + (last_group - in);
+    const uint32_t k = length % 4;
+
+    if(k == 0) {
+        control = p++;
+        *control = 0;
+    }
+
+    const uint32_t len = value_size(value);
+    *control = (*control & ~(3 << (2 * k))) | ((len - 1) << (2 * k));
+    memcpy(p, &value, len);
+
+    return (p + len) - in;
+}
@@ -1,39 +1,177 @@
 #include "num_tree.h"
-#include "parasort.h"
-#include "timsort.hpp"
+
+namespace {
+    // Unions sorted, de-duplicated ID lists. Dense results are collected in a bitmap over the ID space, while
+    // sparse results are merged pairwise, so that neither needs a sort of the concatenated lists.
+    void union_ids(std::vector<std::vector<uint32_t>>& lists, std::vector<uint32_t>& result) {
+        size_t num_ids = 0;
+        uint32_t max_id = 0;
+
+        for(const auto& list: lists) {
+            num_ids += list.size();
+            if(!list.empty()) {
+                max_id = std::max(max_id, list.back());
+            }
+        }
+
+        if(num_ids == 0) {
+            return;
+        }
+
+        if(lists.size() == 1) {
+            result = std::move(lists[0]);
+            return;
+        }
+
+        if(num_ids >= max_id / 32) {
+            std::vector<uint64_t> words((size_t(max_id) / 64) + 1, 0);
+            for(const auto& list: lists) {
+                for(uint32_t id: list) {
+                    words[id >> 6] |= (uint64_t(1) << (id & 63));
+                }
+            }
+
+            result.reserve(num_ids);
+            for(size_t w = 0; w < words.size(); w++) {
+                uint64_t word = words[w];
+                while(word != 0) {
+                    result.push_back(uint32_t(w * 64 + __builtin_ctzll(word)));
+                    word &= word - 1;
+                }
+            }
+
+            return;
+        }
+
+        while(lists.size() > 1) {
+            std::vector<std::vector<uint32_t>> merged_lists;
+            merged_lists.reserve((lists.size() + 1) / 2);
+
+            for(size_t i = 0; i + 1 < lists.size(); i += 2) {
+                std::vector<uint32_t> merged(lists[i].size() + lists[i+1].size());
+                auto end = std::set_union(lists[i].begin(), lists[i].end(), lists[i+1].begin(), lists[i+1].end(),
+                                          merged.begin());
+                merged.resize(end - merged.begin());
+                merged_lists.push_back(std::move(merged));
+            }
+
+            if(lists.size() % 2 != 0) {
+                merged_lists.push_back(std::move(lists.back()));
+            }
+
+            lists = std::move(merged_lists);
+        }
+
+        result = std::move(lists[0]);
+    }
+}
+
+size_t num_tree_t::bucket_lower_bound(int64_t value) const {
+    return std::lower_bound(buckets.begin(), buckets.end(), value,
+                            [](const bucket_t* bucket, int64_t v) { return bucket->values.back() < v; })
+           - buckets.begin();
+}
+
+void num_tree_t::build_bucket_ids(bucket_t* bucket) {
+    if(bucket->ids != nullptr) {
+        ids_t::destroy_list(bucket->ids);
+    }
+
+    std::vector<uint32_t> bucket_ids;
+    ids_t::merge(bucket->id_lists, bucket_ids);
+
+    // `ids_t` grows from the compact form on its own
+    bucket->ids = SET_COMPACT_IDS(compact_id_list_t::create(1, {bucket_ids[0]}));
+    for(size_t i = 1; i < bucket_ids.size(); i++) {
+        ids_t::upsert(bucket->ids, bucket_ids[i]);
+    }
+}
+
+void num_tree_t::split_bucket(size_t bucket_index) {
+    bucket_t* bucket = buckets[bucket_index];
+    bucket_t* upper = new bucket_t;
+
+    const size_t half = bucket->values.size() / 2;
+    upper->values.assign(bucket->values.begin() + half, bucket->values.end());
+    upper->id_lists.assign(bucket->id_lists.begin() + half, bucket->id_lists.end());
+    bucket->values.resize(half);
+    bucket->id_lists.resize(half);
+
+    build_bucket_ids(bucket);
+    build_bucket_ids(upper);
+
+    buckets.insert(buckets.begin() + bucket_index + 1, upper);
+}
 
 void num_tree_t::insert(int64_t value, uint32_t id) {
-    if (int64map.count(value) == 0) {
-        int64map.emplace(value, SET_COMPACT_IDS(compact_id_list_t::create(1, {id})));
-    } else {
-        auto ids = int64map[value];
-        if (!ids_t::contains(ids, id)) {
-            ids_t::upsert(ids, id);
-            int64map[value] = ids;
+    // values beyond the last bucket go into it
+    const size_t bucket_index = buckets.empty() ? 0 : std::min(bucket_lower_bound(value), buckets.size() - 1);
+    if(buckets.empty()) {
+        buckets.push_back(new bucket_t);
+    }
+
+    bucket_t* bucket = buckets[bucket_index];
+
+    auto value_it = std::lower_bound(bucket->values.begin(), bucket->values.end(), value);
+    const size_t value_index = value_it - bucket->values.begin();
+
+    if(value_it != bucket->values.end() && *value_it == value) {
+        void*& ids = bucket->id_lists[value_index];
+        if(ids_t::contains(ids, id)) {
+            return;
         }
+
+        ids_t::upsert(ids, id);
+    } else {
+        bucket->values.insert(value_it, value);
+        bucket->id_lists.insert(bucket->id_lists.begin() + value_index,
+                                SET_COMPACT_IDS(compact_id_list_t::create(1, {id})));
+        num_values++;
+    }
+
+    if(bucket->ids == nullptr) {
+        bucket->ids = SET_COMPACT_IDS(compact_id_list_t::create(1, {id}));
+    } else if(!ids_t::contains(bucket->ids, id)) {
+        ids_t::upsert(bucket->ids, id);
+    }
+
+    if(bucket->values.size() > BUCKET_MAX_VALUES) {
+        split_bucket(bucket_index);
     }
 }
 
-void num_tree_t::range_inclusive_search(int64_t start, int64_t end, uint32_t** ids, size_t& ids_len) {
-    if(int64map.empty()) {
+void num_tree_t::search_range(int64_t start, int64_t end, uint32_t** ids, size_t& ids_len) const {
+    if(buckets.empty() || start > end) {
         return ;
     }
 
-    auto it_start = int64map.lower_bound(start);  // iter values will be >= start
+    std::vector<std::vector<uint32_t>> id_lists;
 
-    std::vector<uint32_t> consolidated_ids;
-    while(it_start != int64map.end() && it_start->first <= end) {
-        uint32_t* values = ids_t::uncompress(it_start->second);
+    for(size_t b = bucket_lower_bound(start); b < buckets.size(); b++) {
+        bucket_t* bucket = buckets[b];
+        if(bucket->values.front() > end) {
+            break;
+        }
 
-        for(size_t i = 0; i < ids_t::num_ids(it_start->second); i++) {
-            consolidated_ids.push_back(values[i]);
+        if(start <= bucket->values.front() && bucket->values.back() <= end) {
+            id_lists.emplace_back();
+            ids_t::uncompress(bucket->ids, id_lists.back());
+            continue;
         }
 
-        delete [] values;
-        it_start++;
+        auto value_it = std::lower_bound(bucket->values.begin(), bucket->values.end(), start);
+        for(; value_it != bucket->values.end() && *value_it <= end; value_it++) {
+            id_lists.emplace_back();
+            ids_t::uncompress(bucket->id_lists[value_it - bucket->values.begin()], id_lists.back());
+        }
     }
 
-    gfx::timsort(consolidated_ids.begin(), consolidated_ids.end());
+    std::vector<uint32_t> consolidated_ids;
+    union_ids(id_lists, consolidated_ids);
+
+    if(consolidated_ids.empty()) {
+        return ;
+    }
 
     uint32_t *out = nullptr;
     ids_len = ArrayUtils::or_scalar(&consolidated_ids[0], consolidated_ids.size(),
@@ -43,115 +181,146 @@ void num_tree_t::range_inclusive_search(int64_t start, int64_t end, uint32_t** i
     *ids = out;
 }
 
+void num_tree_t::range_inclusive_search(int64_t start, int64_t end, uint32_t** ids, size_t& ids_len) {
+    search_range(start, end, ids, ids_len);
+}
+
 size_t num_tree_t::get(int64_t value, std::vector<uint32_t>& geo_result_ids) {
-    const auto& it = int64map.find(value);
-    if(it == int64map.end()) {
+    void* ids = get_ids(value);
+    if(ids == nullptr) {
         return 0;
     }
 
-    uint32_t* ids = ids_t::uncompress(it->second);
-    for(size_t i = 0; i < ids_t::num_ids(it->second); i++) {
-        geo_result_ids.push_back(ids[i]);
+    ids_t::uncompress(ids, geo_result_ids);
+    return ids_t::num_ids(ids);
+}
+
+void* num_tree_t::get_ids(int64_t value) const {
+    const size_t bucket_index = bucket_lower_bound(value);
+    if(bucket_index == buckets.size()) {
+        return nullptr;
     }
 
-    delete [] ids;
+    const bucket_t* bucket = buckets[bucket_index];
+    auto value_it = std::lower_bound(bucket->values.begin(), bucket->values.end(), value);
+    if(value_it == bucket->values.end() || *value_it != value) {
+        return nullptr;
+    }
 
-    return ids_t::num_ids(it->second);
+    return bucket->id_lists[value_it - bucket->values.begin()];
 }
 
 void num_tree_t::search(NUM_COMPARATOR comparator, int64_t value, uint32_t** ids, size_t& ids_len) {
-    if(int64map.empty()) {
+    if(buckets.empty()) {
         return ;
     }
 
     if(comparator == EQUALS) {
-        const auto& it = int64map.find(value);
-        if(it != int64map.end()) {
+        void* value_ids = get_ids(value);
+        if(value_ids != nullptr) {
             uint32_t *out = nullptr;
-            uint32_t* val_ids = ids_t::uncompress(it->second);
-            ids_len = ArrayUtils::or_scalar(val_ids, ids_t::num_ids(it->second),
+            uint32_t* val_ids = ids_t::uncompress(value_ids);
+            ids_len = ArrayUtils::or_scalar(val_ids, ids_t::num_ids(value_ids),
                                             *ids, ids_len, &out);
             delete[] *ids;
             *ids = out;
             delete[] val_ids;
         }
-    } else if(comparator == GREATER_THAN || comparator == GREATER_THAN_EQUALS) {
-        // iter entries will be >= value, or end() if all entries are before value
-        auto iter_ge_value = int64map.lower_bound(value);
-
-        if(iter_ge_value == int64map.end()) {
-            return ;
+    } else if(comparator == GREATER_THAN_EQUALS) {
+        search_range(value, INT64_MAX, ids, ids_len);
+    } else if(comparator == GREATER_THAN) {
+        if(value != INT64_MAX) {
+            search_range(value + 1, INT64_MAX, ids, ids_len);
         }
-
-        if(comparator == GREATER_THAN && iter_ge_value->first == value) {
-            iter_ge_value++;
+    } else if(comparator == LESS_THAN_EQUALS) {
+        search_range(INT64_MIN, value, ids, ids_len);
+    } else if(comparator == LESS_THAN) {
+        if(value != INT64_MIN) {
+            search_range(INT64_MIN, value - 1, ids, ids_len);
         }
+    }
+}
 
-        std::vector<uint32_t> consolidated_ids;
-        while(iter_ge_value != int64map.end()) {
-            ids_t::uncompress(iter_ge_value->second, consolidated_ids);
-            iter_ge_value++;
+void num_tree_t::walk(bool descending, const std::function<bool(int64_t value, void* ids)>& visit) const {
+    if(descending) {
+        for(auto bucket_it = buckets.rbegin(); bucket_it != buckets.rend(); ++bucket_it) {
+            const bucket_t* bucket = *bucket_it;
+            for(size_t i = bucket->values.size(); i > 0; i--) {
+                if(!visit(bucket->values[i - 1], bucket->id_lists[i - 1])) {
+                    return;
+                }
+            }
         }
 
-        gfx::timsort(consolidated_ids.begin(), consolidated_ids.end());
-        consolidated_ids.erase(unique(consolidated_ids.begin(), consolidated_ids.end()), consolidated_ids.end());
-
-        uint32_t *out = nullptr;
-        ids_len = ArrayUtils::or_scalar(&consolidated_ids[0], consolidated_ids.size(),
-                                        *ids, ids_len, &out);
-
-        delete [] *ids;
-        *ids = out;
+        return;
+    }
 
-    } else if(comparator == LESS_THAN || comparator == LESS_THAN_EQUALS) {
-        // iter entries will be >= value, or end() if all entries are before value
-        auto iter_ge_value = int64map.lower_bound(value);
+    for(const bucket_t* bucket: buckets) {
+        for(size_t i = 0; i < bucket->values.size(); i++) {
+            if(!visit(bucket->values[i], bucket->id_lists[i])) {
+                return;
+            }
+        }
+    }
+}
 
-        std::vector<uint32_t> consolidated_ids;
-        auto it = int64map.begin();
+void num_tree_t::remove(uint64_t value, uint32_t id) {
+    const int64_t key = value;
+    const size_t bucket_index = bucket_lower_bound(key);
+    if(bucket_index == buckets.size()) {
+        return ;
+    }
 
-        while(it != iter_ge_value) {
-            ids_t::uncompress(it->second, consolidated_ids);
-            it++;
-        }
+    bucket_t* bucket = buckets[bucket_index];
+    auto value_it = std::lower_bound(bucket->values.begin(), bucket->values.end(), key);
+    if(value_it == bucket->values.end() || *value_it != key) {
+        return ;
+    }
 
-        // for LESS_THAN_EQUALS, check if last iter entry is equal to value
-        if(it != int64map.end() && comparator == LESS_THAN_EQUALS && it->first == value) {
-            ids_t::uncompress(it->second, consolidated_ids);
-        }
+    const size_t value_index = value_it - bucket->values.begin();
+    void*& ids = bucket->id_lists[value_index];
 
-        gfx::timsort(consolidated_ids.begin(), consolidated_ids.end());
-        consolidated_ids.erase(unique(consolidated_ids.begin(), consolidated_ids.end()), consolidated_ids.end());
+    if(!ids_t::contains(ids, id)) {
+        return ;
+    }
 
-        uint32_t *out = nullptr;
-        ids_len = ArrayUtils::or_scalar(&consolidated_ids[0], consolidated_ids.size(),
-                                        *ids, ids_len, &out);
+    ids_t::erase(ids, id);
 
-        delete [] *ids;
-        *ids = out;
+    if(ids_t::num_ids(ids) == 0) {
+        ids_t::destroy_list(ids);
+        bucket->values.erase(value_it);
+        bucket->id_lists.erase(bucket->id_lists.begin() + value_index);
+        num_values--;
     }
-}
 
-void num_tree_t::remove(uint64_t value, uint32_t id) {
-    if(int64map.count(value) != 0) {
-        void* arr = int64map[value];
-        ids_t::erase(arr, id);
+    if(bucket->values.empty()) {
+        ids_t::destroy_list(bucket->ids);
+        delete bucket;
+        buckets.erase(buckets.begin() + bucket_index);
+        return ;
+    }
 
-        if(ids_t::num_ids(arr) == 0) {
-            ids_t::destroy_list(arr);
-            int64map.erase(value);
-        } else {
-            int64map[value] = arr;
+    // a multi-valued field can hold the document under other values of the bucket as well
+    for(void* value_ids: bucket->id_lists) {
+        if(ids_t::contains(value_ids, id)) {
+            return ;
         }
     }
+
+    ids_t::erase(bucket->ids, id);
 }
 
 size_t num_tree_t::size() {
-    return int64map.size();
+    return num_values;
 }
 
 num_tree_t::~num_tree_t() {
-    for(auto& kv: int64map) {
-        ids_t::destroy_list(kv.second);
+    for(bucket_t* bucket: buckets) {
+        for(void*& ids: bucket->id_lists) {
+            ids_t::destroy_list(ids);
+        }
+
+        ids_t::destroy_list(bucket->ids);
+        delete bucket;
     }
 }
@@ -1,4 +1,5 @@
 #include "or_iterator.h"
+#include "filter_result_iterator.h"
 
 
 bool or_iterator_t::at_end(const std::vector<or_iterator_t>& its) {
@@ -183,7 +184,15 @@ bool or_iterator_t::take_id(result_iter_state_t& istate, uint32_t id, bool& is_e
     }
 
     // decide if this result be matched with filter results
+    if(istate.filter_iterator != nullptr) {
+        return istate.filter_iterator->contains(id);
+    }
+
     if(istate.filter_ids_length != 0) {
+        if(istate.filter_bitmap != nullptr) {
+            return istate.filter_bitmap->contains(id);
+        }
+
         if(istate.filter_ids_index >= istate.filter_ids_length) {
             return false;
         }
@@ -245,7 +245,7 @@ bool compact_posting_list_t::contains_atleast_one(const uint32_t* target_ids, si
 
 /* posting operations */
 
-void posting_t::upsert(void*& obj, uint32_t id, const std::vector<uint32_t>& offsets) {
+void posting_t::upsert(void*& obj, uint32_t id, const std::vector<uint32_t>& offsets, int64_t score) {
     if(IS_COMPACT_POSTING(obj)) {
         compact_posting_list_t* list = (compact_posting_list_t*) RAW_POSTING_PTR(obj);
         int64_t extra_capacity_required = list->upsert(id, offsets);
@@ -285,7 +285,7 @@ void posting_t::upsert(void*& obj, uint32_t id, const std::vector<uint32_t>& off
 
     // either `obj` is already a full list or was converted to a full list above
     posting_list_t* list = (posting_list_t*)(obj);
-    list->upsert(id, offsets);
+    list->upsert(id, offsets, score);
 }
 
 void posting_t::erase(void*& obj, uint32_t id) {
@@ -399,6 +399,56 @@ void posting_t::intersect(const std::vector<void*>& raw_posting_lists, std::vect
     }
 }
 
+void posting_t::block_intersector_t::split_lists(size_t concurrency,
+                                                 std::vector<std::vector<posting_list_t::iterator_t>>& partial_its_vec) {
+    const size_t num_blocks = this->plists[0]->num_blocks();
+    const size_t window_size = (num_blocks + concurrency - 1) / concurrency;  // rounds up
+
+    size_t blocks_traversed = 0;
+    posting_list_t::block_t* start_block = this->plists[0]->get_root();
+    posting_list_t::block_t* curr_block = start_block;
+
+    size_t window_index = 0;
+
+    while(curr_block != nullptr) {
+        blocks_traversed++;
+        if(blocks_traversed % window_size == 0 || blocks_traversed == num_blocks) {
+            // construct partial iterators and intersect within them
+
+            std::vector<posting_list_t::iterator_t>& partial_its = partial_its_vec[window_index];
+            const uint32_t window_first_id = start_block->ids.at(0);
+            const uint32_t window_last_id = curr_block->ids.last();
+
+            for(size_t i = 0; i < this->plists.size(); i++) {
+                posting_list_t::block_t* p_start_block = nullptr;
+                posting_list_t::block_t* p_end_block = nullptr;
+
+                if(i == 0) {
+                    p_start_block = start_block;
+                    p_end_block = curr_block->next;
+                } else {
+                    p_start_block = this->plists[i]->block_of(window_first_id);
+                    if(p_start_block == nullptr) {
+                        // this list ends before the window, so the window can't have any results
+                        partial_its.clear();
+                        break;
+                    }
+
+                    posting_list_t::block_t* last_block = this->plists[i]->block_of(window_last_id);
+                    p_end_block = (last_block == nullptr) ? nullptr : last_block->next;
+                }
+
+                partial_its.push_back(this->plists[i]->new_iterator(p_start_block, p_end_block));
+            }
+
+            start_block = curr_block->next;
+            window_index++;
+        }
+
+        curr_block = curr_block->next;
+    }
+}
+
 void posting_t::to_expanded_plists(const std::vector<void*>& raw_posting_lists, std::vector<posting_list_t*>& plists,
                                    std::vector<posting_list_t*>& expanded_plists) {
     for(size_t i = 0; i < raw_posting_lists.size(); i++) {
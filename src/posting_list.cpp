@@ -1,11 +1,23 @@
 #include "posting_list.h"
+#include "filter_result_iterator.h"
 #include <bitset>
 #include "for.h"
 #include "array_utils.h"
 
 /* block_t operations */
 
-uint32_t posting_list_t::block_t::upsert(const uint32_t id, const std::vector<uint32_t>& positions) {
+uint32_t posting_list_t::block_t::upsert(const uint32_t id, const std::vector<uint32_t>& positions,
+                                         const int64_t score) {
+    if(score > max_score) {
+        max_score = score;
+    }
+
+    // the block does not know whether the field is an array, so we have to be conservative
+    if(!has_verbatim_match && !positions.empty()) {
+        has_verbatim_match = is_verbatim_match(&positions[0], positions.size(), false) ||
+                             is_verbatim_match(&positions[0], positions.size(), true);
+    }
+
     if(id > ids.last() || ids.getLength() == 0) {
         // append to the end
         ids.append(id);
@@ -212,6 +224,11 @@ bool posting_list_t::block_t::contains(uint32_t id) {
     return ids.contains(id);
 }
 
+void posting_list_t::block_t::merge_bounds(const posting_list_t::block_t& other) {
+    max_score = std::max(max_score, other.max_score);
+    has_verbatim_match = has_verbatim_match || other.has_verbatim_match;
+}
+
 /* posting_list_t operations */
 
 posting_list_t::posting_list_t(uint16_t max_block_elements): BLOCK_MAX_ELEMENTS(max_block_elements) {
@@ -231,6 +248,8 @@ posting_list_t::~posting_list_t() {
 
 void posting_list_t::merge_adjacent_blocks(posting_list_t::block_t* block1, posting_list_t::block_t* block2,
                                            size_t num_block2_ids_to_move) {
+    block1->merge_bounds(*block2);
+
     // merge ids
     uint32_t* ids1 = block1->ids.uncompress();
     uint32_t* ids2 = block2->ids.uncompress();
@@ -377,6 +396,8 @@ void posting_list_t::split_block(posting_list_t::block_t* src_block, posting_lis
         return;
     }
 
+    dst_block->merge_bounds(*src_block);
+
     uint32_t* raw_ids = src_block->ids.uncompress();
     size_t ids_first_half_length = (src_block->size() / 2);
     size_t ids_second_half_length = (src_block->size() - ids_first_half_length);
@@ -444,7 +465,7 @@ void posting_list_t::split_block(posting_list_t::block_t* src_block, posting_lis
     delete [] raw_offsets;
 }
 
-void posting_list_t::upsert(const uint32_t id, const std::vector<uint32_t>& offsets) {
+void posting_list_t::upsert(const uint32_t id, const std::vector<uint32_t>& offsets, const int64_t score) {
     // first we will locate the block where `id` should reside
     block_t* upsert_block;
     last_id_t before_upsert_last_id;
@@ -453,39 +474,37 @@ void posting_list_t::upsert(const uint32_t id, const std::vector<uint32_t>& offs
         upsert_block = &root_block;
         before_upsert_last_id = UINT32_MAX;
     } else {
-        const auto it = id_block_map.lower_bound(id);
-        upsert_block = (it == id_block_map.end()) ? id_block_map.rbegin()->second : it->second;
+        const size_t index = std::min(id_block_map.lower_bound(id), id_block_map.size() - 1);
+        upsert_block = id_block_map.block_at(index);
         before_upsert_last_id = upsert_block->ids.last();
     }
 
     // happy path: upsert_block is not full
     if(upsert_block->size() < BLOCK_MAX_ELEMENTS) {
-        uint32_t num_inserted = upsert_block->upsert(id, offsets);
+        uint32_t num_inserted = upsert_block->upsert(id, offsets, score);
         ids_length += num_inserted;
 
         last_id_t after_upsert_last_id = upsert_block->ids.last();
         if(before_upsert_last_id != after_upsert_last_id) {
-            id_block_map.erase(before_upsert_last_id);
-            id_block_map.emplace(after_upsert_last_id, upsert_block);
+            id_block_map.update(before_upsert_last_id, after_upsert_last_id, upsert_block);
         }
     } else {
         block_t* new_block = new block_t;
 
         if(upsert_block->next == nullptr && upsert_block->ids.last() < id) {
             // appending to the end of the last block where the id will reside on a newly block
-            uint32_t num_inserted = new_block->upsert(id, offsets);
+            uint32_t num_inserted = new_block->upsert(id, offsets, score);
             ids_length += num_inserted;
         } else {
             // upsert and then split block
-            uint32_t num_inserted = upsert_block->upsert(id, offsets);
+            uint32_t num_inserted = upsert_block->upsert(id, offsets, score);
             ids_length += num_inserted;
 
             // evenly divide elements between both blocks
             split_block(upsert_block, new_block);
 
             last_id_t after_upsert_last_id = upsert_block->ids.last();
-            id_block_map.erase(before_upsert_last_id);
-            id_block_map.emplace(after_upsert_last_id, upsert_block);
+            id_block_map.update(before_upsert_last_id, after_upsert_last_id, upsert_block);
         }
 
         last_id_t after_new_block_id = new_block->ids.last();
@@ -532,14 +551,14 @@ void posting_list_t::dump() {
 }
 
 void posting_list_t::erase(const uint32_t id) {
-    const auto it = id_block_map.lower_bound(id);
+    const size_t index = id_block_map.lower_bound(id);
 
-    if(it == id_block_map.end()) {
+    if(index == id_block_map.size()) {
         return ;
     }
 
-    block_t* erase_block = it->second;
-    last_id_t before_last_id = it->first;
+    block_t* erase_block = id_block_map.block_at(index);
+    last_id_t before_last_id = id_block_map.last_id_at(index);
     uint32_t num_erased = erase_block->erase(id);
     ids_length -= num_erased;
 
@@ -550,7 +569,7 @@ void posting_list_t::erase(const uint32_t id) {
 
         if(erase_block != &root_block) {
             // since we will be deleting the empty node, set the previous node's next pointer to null
-            std::prev(it)->second->next = nullptr;
+            id_block_map.block_at(index - 1)->next = nullptr;
             delete erase_block;
         } else {
             // The root block cannot be empty if there are other blocks so we will pull some contents from next block
@@ -573,8 +592,7 @@ void posting_list_t::erase(const uint32_t id) {
     if(new_ids_length >= BLOCK_MAX_ELEMENTS/2 || erase_block->next == nullptr) {
         last_id_t after_last_id = erase_block->ids.last();
         if(before_last_id != after_last_id) {
-            id_block_map.erase(before_last_id);
-            id_block_map.emplace(after_last_id, erase_block);
+            id_block_map.update(before_last_id, after_last_id, erase_block);
         }
 
         return ;
@@ -603,8 +621,7 @@ void posting_list_t::erase(const uint32_t id) {
 
     last_id_t after_last_id = erase_block->ids.last();
     if(before_last_id != after_last_id) {
-        id_block_map.erase(before_last_id);
-        id_block_map.emplace(after_last_id, erase_block);
+        id_block_map.update(before_last_id, after_last_id, erase_block);
     }
 }
 
@@ -625,12 +642,12 @@ uint32_t posting_list_t::first_id() {
 }
 
 posting_list_t::block_t* posting_list_t::block_of(uint32_t id) {
-    const auto it = id_block_map.lower_bound(id);
-    if(it == id_block_map.end()) {
+    const size_t index = id_block_map.lower_bound(id);
+    if(index == id_block_map.size()) {
         return nullptr;
     }
 
-    return it->second;
+    return id_block_map.block_at(index);
 }
 
 
@@ -727,30 +744,93 @@ void posting_list_t::intersect(const std::vector<posting_list_t*>& posting_lists
         its.push_back(posting_list->new_iterator());
     }
 
-    size_t num_lists = its.size();
+    std::vector<uint32_t> window_ids;
+    std::vector<uint32_t> scratch;
 
-    switch (num_lists) {
-        case 2:
-            while(!at_end2(its)) {
-                if(equals2(its)) {
-                    //LOG(INFO) << its[0].id();
-                    result_ids.push_back(its[0].id());
-                    advance_all2(its);
-                } else {
-                    advance_non_largest2(its);
-                }
-            }
+    while(!at_end(its)) {
+        const uint32_t window_end = align_block_window(its);
+        if(at_end(its)) {
             break;
-        default:
-            while(!at_end(its)) {
-                if(equals(its)) {
-                    //LOG(INFO) << its[0].id();
-                    result_ids.push_back(its[0].id());
-                    advance_all(its);
-                } else {
-                    advance_non_largest(its);
-                }
+        }
+
+        const size_t num_window_ids = intersect_block_window(its, window_end, window_ids, scratch);
+        result_ids.insert(result_ids.end(), window_ids.begin(), window_ids.begin() + num_window_ids);
+
+        advance_past_window(its, window_end);
+    }
+}
+
+uint32_t posting_list_t::align_block_window(std::vector<posting_list_t::iterator_t>& its) {
+    uint32_t greatest_value = 0;
+
+    for(const auto& it: its) {
+        if(it.id() > greatest_value) {
+            greatest_value = it.id();
+        }
+    }
+
+    // skipping beyond the current block jumps straight to the target block via the block map
+    uint32_t window_end = UINT32_MAX;
+
+    for(auto& it: its) {
+        if(it.id() != greatest_value) {
+            it.skip_to(greatest_value);
+            if(!it.valid()) {
+                return window_end;
             }
+        }
+
+        if(it.last_block_id() < window_end) {
+            window_end = it.last_block_id();
+        }
+    }
+
+    return window_end;
+}
+
+size_t posting_list_t::intersect_block_window(const std::vector<posting_list_t::iterator_t>& its,
+                                              const uint32_t window_end,
+                                              std::vector<uint32_t>& window_ids,
+                                              std::vector<uint32_t>& scratch) {
+    auto window_slice = [window_end](const posting_list_t::iterator_t& it, size_t& slice_len) {
+        const uint32_t* slice_start = it.ids + it.index();
+        const uint32_t* block_end = it.ids + it.block()->size();
+        slice_len = std::upper_bound(slice_start, block_end, window_end) - slice_start;
+        return slice_start;
+    };
+
+    size_t len0 = 0, len1 = 0;
+    const uint32_t* slice0 = window_slice(its[0], len0);
+    const uint32_t* slice1 = window_slice(its[1], len1);
+
+    if(window_ids.size() < std::min(len0, len1)) {
+        window_ids.resize(std::min(len0, len1));
+    }
+
+    size_t num_window_ids = ArrayUtils::intersect(slice0, len0, slice1, len1, window_ids.data());
+
+    for(size_t i = 2; i < its.size() && num_window_ids != 0; i++) {
+        size_t slice_len = 0;
+        const uint32_t* slice = window_slice(its[i], slice_len);
+
+        if(scratch.size() < std::min(num_window_ids, slice_len)) {
+            scratch.resize(std::min(num_window_ids, slice_len));
+        }
+
+        num_window_ids = ArrayUtils::intersect(window_ids.data(), num_window_ids, slice, slice_len, scratch.data());
+        window_ids.swap(scratch);
+    }
+
+    return num_window_ids;
+}
+
+void posting_list_t::advance_past_window(std::vector<posting_list_t::iterator_t>& its, const uint32_t window_end) {
+    for(auto& it: its) {
+        if(it.last_block_id() <= window_end) {
+            it.next_block();
+        } else {
+            it.skip_to(window_end + 1);
+        }
     }
 }
 
@@ -764,7 +844,15 @@ bool posting_list_t::take_id(result_iter_state_t& istate, uint32_t id) {
     }
 
     // decide if this result be matched with filter results
+    if(istate.filter_iterator != nullptr) {
+        return istate.filter_iterator->contains(id);
+    }
+
     if(istate.filter_ids_length != 0) {
+        if(istate.filter_bitmap != nullptr) {
+            return istate.filter_bitmap->contains(id);
+        }
+
         return std::binary_search(istate.filter_ids, istate.filter_ids + istate.filter_ids_length, id);
     }
 
@@ -877,14 +965,19 @@ bool posting_list_t::is_single_token_verbatim_match(const posting_list_t::iterat
                           curr_block->offsets.getLength() :
                           it.offset_index[curr_index + 1];
 
+    return is_verbatim_match(offsets + start_offset, end_offset - start_offset, field_is_array);
+}
+
+bool posting_list_t::is_verbatim_match(const uint32_t* offsets, const uint32_t num_offsets, bool field_is_array) {
     if(field_is_array) {
-       int prev_pos = -1;
+        int prev_pos = -1;
+        uint32_t i = 0;
 
-        while(start_offset < end_offset) {
-            int pos = offsets[start_offset];
-            start_offset++;
+        while(i < num_offsets) {
+            int pos = offsets[i];
+            i++;
 
-            if(pos == prev_pos && pos == 1 && start_offset+1 < end_offset && offsets[start_offset+1] == 0) {
+            if(pos == prev_pos && pos == 1 && i+1 < num_offsets && offsets[i+1] == 0) {
                 return true;
             }
 
@@ -892,12 +985,9 @@ bool posting_list_t::is_single_token_verbatim_match(const posting_list_t::iterat
         }
 
         return false;
-    } else if((end_offset - start_offset) == 2 && offsets[end_offset-1] == 0) {
-        // we've already checked for `offsets[start_offset] == 1` earlier
-        return true;
     }
 
-    return false;
+    return num_offsets == 2 && offsets[0] == 1 && offsets[1] == 0;
 }
 
 bool posting_list_t::at_end(const std::vector<posting_list_t::iterator_t>& its) {
@@ -1009,13 +1099,13 @@ size_t posting_list_t::num_ids() const {
 }
 
 bool posting_list_t::contains(uint32_t id) {
-    const auto it = id_block_map.lower_bound(id);
+    const size_t index = id_block_map.lower_bound(id);
 
-    if(it == id_block_map.end()) {
+    if(index == id_block_map.size()) {
         return false;
     }
 
-    block_t* potential_block = it->second;
+    block_t* potential_block = id_block_map.block_at(index);
     return potential_block->contains(id);
 }
 
@@ -1440,19 +1530,82 @@ size_t posting_list_t::get_last_offset(const posting_list_t::iterator_t& it, boo
     return 0;
 }
 
+/* decode_buffer_t operations */
+
+namespace {
+    constexpr size_t MAX_POOLED_DECODE_BUFFERS = 64;
+
+    struct decode_buffer_pool_t {
+        std::vector<posting_list_t::decode_buffer_t*> buffers;
+
+        ~decode_buffer_pool_t() {
+            for(auto buffer: buffers) {
+                delete buffer;
+            }
+        }
+    };
+
+    thread_local decode_buffer_pool_t decode_buffer_pool;
+
+    template<class codec_t>
+    inline uint32_t* decode_into(const array_base_t<codec_t>& src, std::vector<uint32_t>& dst) {
+        if(dst.size() < src.getLength()) {
+            dst.resize(src.getLength());
+        }
+
+        src.uncompress_into(dst.data());
+        return dst.data();
+    }
+}
+
+posting_list_t::decode_buffer_t* posting_list_t::decode_buffer_t::acquire() {
+    auto& buffers = decode_buffer_pool.buffers;
+    if(buffers.empty()) {
+        return new decode_buffer_t();
+    }
+
+    decode_buffer_t* buffer = buffers.back();
+    buffers.pop_back();
+    return buffer;
+}
+
+void posting_list_t::decode_buffer_t::release(posting_list_t::decode_buffer_t* buffer) {
+    if(buffer == nullptr) {
+        return;
+    }
+
+    auto& buffers = decode_buffer_pool.buffers;
+    if(buffers.size() >= MAX_POOLED_DECODE_BUFFERS) {
+        delete buffer;
+        return;
+    }
+
+    buffers.push_back(buffer);
+}
+
 /* iterator_t operations */
 
-posting_list_t::iterator_t::iterator_t(const std::map<last_id_t, block_t*>* id_block_map,
+posting_list_t::iterator_t::iterator_t(const block_directory_t<block_t>* id_block_map,
                                        posting_list_t::block_t* start, posting_list_t::block_t* end,
                                        bool auto_destroy, uint32_t field_id):
         id_block_map(id_block_map), curr_block(start), curr_index(0), end_block(end),
         auto_destroy(auto_destroy), field_id(field_id) {
 
     if(curr_block != end_block) {
-        ids = curr_block->ids.uncompress();
-        offset_index = curr_block->offset_index.uncompress();
-        offsets = curr_block->offsets.uncompress();
+        load_block();
+    }
+}
+
+void posting_list_t::iterator_t::load_block() {
+    if(!auto_destroy || buffer == nullptr) {
+        // a clone moving off the shared block needs a buffer of its own
+        buffer = decode_buffer_t::acquire();
+        auto_destroy = true;
     }
+
+    ids = decode_into(curr_block->ids, buffer->ids);
+    offset_index = decode_into(curr_block->offset_index, buffer->offset_index);
+    offsets = decode_into(curr_block->offsets, buffer->offsets);
 }
 
 bool posting_list_t::iterator_t::valid() const {
@@ -1465,20 +1618,19 @@ void posting_list_t::iterator_t::next() {
         curr_index = 0;
         curr_block = curr_block->next;
 
-        delete [] ids;
-        delete [] offset_index;
-        delete [] offsets;
-
         ids = offset_index = offsets = nullptr;
 
         if(curr_block != end_block) {
-            ids = curr_block->ids.uncompress();
-            offset_index = curr_block->offset_index.uncompress();
-            offsets = curr_block->offsets.uncompress();
+            load_block();
         }
     }
 }
 
+void posting_list_t::iterator_t::next_block() {
+    curr_index = curr_block->size() - 1;
+    next();
+}
+
 uint32_t posting_list_t::iterator_t::last_block_id() const {
     return ids[curr_block->size() - 1];
 }
@@ -1487,14 +1639,6 @@ uint32_t posting_list_t::iterator_t::id() const {
     return ids[curr_index];
 }
 
-uint32_t posting_list_t::iterator_t::index() const {
-    return curr_index;
-}
-
-posting_list_t::block_t* posting_list_t::iterator_t::block() const {
-    return curr_block;
-}
-
 void posting_list_t::iterator_t::skip_to(uint32_t id) {
     // first look to skip within current block
     if(id <= this->last_block_id()) {
@@ -1505,19 +1649,20 @@ void posting_list_t::iterator_t::skip_to(uint32_t id) {
         return ;
     }
 
-    // identify the block where the id could exist and skip to that
+    // identify the block where the id could exist and skip to that, without going past the end block
+    block_t* const range_end_block = end_block;
     reset_cache();
 
-    const auto it = id_block_map->lower_bound(id);
-    if(it == id_block_map->end()) {
+    const size_t index = id_block_map->lower_bound(id);
+    if(index == id_block_map->size() ||
+       (range_end_block != nullptr && id_block_map->last_id_at(index) >= range_end_block->ids.last())) {
         return;
     }
 
-    curr_block = it->second;
+    curr_block = id_block_map->block_at(index);
+    end_block = range_end_block;
     curr_index = 0;
-    ids = curr_block->ids.uncompress();
-    offset_index = curr_block->offset_index.uncompress();
-    offsets = curr_block->offsets.uncompress();
+    load_block();
 
     while(curr_index < curr_block->size() && this->id() < id) {
         curr_index++;
@@ -1530,15 +1675,12 @@ void posting_list_t::iterator_t::skip_to(uint32_t id) {
 
 posting_list_t::iterator_t::~iterator_t() {
     if(auto_destroy) {
-        reset_cache();
+        decode_buffer_t::release(buffer);
     }
 }
 
 void posting_list_t::iterator_t::reset_cache() {
-    delete [] ids;
-    delete [] offsets;
-    delete [] offset_index;
-
+    // decode buffer is retained for reuse
     ids = offset_index = offsets = nullptr;
     curr_index = 0;
     curr_block = end_block = nullptr;
@@ -1552,9 +1694,11 @@ posting_list_t::iterator_t::iterator_t(iterator_t&& rhs) noexcept {
     ids = rhs.ids;
     offset_index = rhs.offset_index;
     offsets = rhs.offsets;
+    buffer = rhs.buffer;
     auto_destroy = rhs.auto_destroy;
     field_id = rhs.field_id;
 
+    rhs.buffer = nullptr;
     rhs.id_block_map = nullptr;
     rhs.curr_block = nullptr;
     rhs.end_block = nullptr;
@@ -1564,6 +1708,10 @@ posting_list_t::iterator_t::iterator_t(iterator_t&& rhs) noexcept {
 }
 
 posting_list_t::iterator_t& posting_list_t::iterator_t::operator=(posting_list_t::iterator_t&& rhs) noexcept {
+    if(auto_destroy && buffer != rhs.buffer) {
+        decode_buffer_t::release(buffer);
+    }
+
     id_block_map = rhs.id_block_map;
     curr_block = rhs.curr_block;
     curr_index = rhs.curr_index;
@@ -1571,9 +1719,11 @@ posting_list_t::iterator_t& posting_list_t::iterator_t::operator=(posting_list_t
     ids = rhs.ids;
     offset_index = rhs.offset_index;
     offsets = rhs.offsets;
+    buffer = rhs.buffer;
     auto_destroy = rhs.auto_destroy;
     field_id = rhs.field_id;
 
+    rhs.buffer = nullptr;
     rhs.id_block_map = nullptr;
     rhs.curr_block = nullptr;
     rhs.end_block = nullptr;
@@ -1597,6 +1747,7 @@ posting_list_t::iterator_t posting_list_t::iterator_t::clone() const {
     it.ids = ids;
     it.offsets = offsets;
     it.offset_index = offset_index;
+    it.buffer = buffer;
     it.auto_destroy = false;
     it.field_id = field_id;
     return it;
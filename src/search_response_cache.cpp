@@ -0,0 +1,156 @@
+#include "search_response_cache.h"
+
+static int64_t get_steady_clock_s() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool SearchResponseCache::is_stale(const std::vector<collection_version_t>& read_versions,
+                                   const cached_res_t& res) const {
+    const uint64_t seconds_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::high_resolution_clock::now() - res.created_at).count();
+
+    if(seconds_elapsed >= res.ttl) {
+        return true;
+    }
+
+    std::shared_lock lock(versions_mutex);
+
+    for(const auto& read_version: read_versions) {
+        const auto version_it = collection_versions.find(read_version.collection_name);
+        const uint64_t version = (version_it == collection_versions.end()) ? 0 : version_it->second;
+        if(version != read_version.version) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void SearchResponseCache::set_capacity(size_t capacity_bytes) {
+    for(auto& shard: shards) {
+        shard.set_capacity(capacity_bytes / NUM_SHARDS);
+    }
+}
+
+uint64_t SearchResponseCache::get_collection_version(const std::string& collection_name) const {
+    std::shared_lock lock(versions_mutex);
+    const auto version_it = collection_versions.find(collection_name);
+    return (version_it == collection_versions.end()) ? 0 : version_it->second;
+}
+
+void SearchResponseCache::purge_tombstones() {
+    const int64_t now_s = get_steady_clock_s();
+
+    while(!tombstones.empty() && now_s - tombstones.front().dropped_at_s >= TOMBSTONE_TTL_S) {
+        const tombstone_t& tombstone = tombstones.front();
+
+        // unless the collection was created again since
+        const auto version_it = collection_versions.find(tombstone.collection_name);
+        if(version_it != collection_versions.end() && version_it->second == tombstone.version) {
+            collection_versions.erase(version_it);
+        }
+
+        tombstones.pop_front();
+    }
+}
+
+void SearchResponseCache::invalidate(const std::string& collection_name) {
+    // entries of older versions are dropped when they are next looked up or evicted
+    std::unique_lock lock(versions_mutex);
+    collection_versions[collection_name] = ++last_version;
+    purge_tombstones();
+}
+
+void SearchResponseCache::erase(const std::string& collection_name) {
+    std::unique_lock lock(versions_mutex);
+
+    // the tombstone is a version of its own, which responses that read the collection before the drop don't match;
+    // once it's purged, the collection reads as version 0, which no collection that existed has
+    const uint64_t version = ++last_version;
+    collection_versions[collection_name] = version;
+    tombstones.push_back(tombstone_t{collection_name, version, get_steady_clock_s()});
+
+    purge_tombstones();
+}
+
+size_t SearchResponseCache::num_collection_versions() const {
+    std::shared_lock lock(versions_mutex);
+    return collection_versions.size();
+}
+
+std::shared_ptr<const cached_res_t> SearchResponseCache::get(uint64_t key) {
+    bool stale = false;
+
+    auto res = get_shard(key).get_if(key, [this, &stale](const std::vector<collection_version_t>& read_versions,
+                                                         const cached_res_t& cached_res) {
+        stale = is_stale(read_versions, cached_res);
+        return !stale;
+    });
+
+    if(res == nullptr) {
+        num_misses++;
+        num_stale_drops += stale;
+        return nullptr;
+    }
+
+    num_hits++;
+    return res;
+}
+
+void SearchResponseCache::put(uint64_t key, const cached_res_t& res, std::vector<collection_version_t> read_versions) {
+    shard_t& shard = get_shard(key);
+
+    size_t entry_size = shard_t::ENTRY_OVERHEAD + sizeof(cached_res_t) +
+                        res.content_type_header.size() + res.body.size();
+    for(const auto& read_version: read_versions) {
+        entry_size += sizeof(collection_version_t) + read_version.collection_name.size();
+    }
+
+    if(entry_size > shard.get_capacity()) {
+        return;
+    }
+
+    // a response that read a collection which changed during its search would be stale from the start
+    if(is_stale(read_versions, res)) {
+        return;
+    }
+
+    shard.put(key, std::move(read_versions), std::make_shared<const cached_res_t>(res), entry_size);
+}
+
+void SearchResponseCache::clear() {
+    for(auto& shard: shards) {
+        shard.clear();
+    }
+}
+
+uint64_t SearchResponseCache::get_num_evictions() const {
+    uint64_t num_evictions = 0;
+
+    for(const auto& shard: shards) {
+        num_evictions += shard.get_num_evictions();
+    }
+
+    return num_evictions;
+}
+
+size_t SearchResponseCache::size_bytes() {
+    size_t size = 0;
+
+    for(auto& shard: shards) {
+        size += shard.size_bytes();
+    }
+
+    return size;
+}
+
+size_t SearchResponseCache::num_entries() {
+    size_t num_entries = 0;
+
+    for(auto& shard: shards) {
+        num_entries += shard.num_entries();
+    }
+
+    return num_entries;
+}
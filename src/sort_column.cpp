@@ -0,0 +1,51 @@
+#include "sort_column.h"
+
+sort_column_t::~sort_column_t() {
+    for(page_t* page: pages) {
+        delete page;
+    }
+}
+
+void sort_column_t::emplace(uint32_t seq_id, int64_t value) {
+    const size_t page_index = seq_id >> PAGE_BITS;
+    const uint32_t offset = seq_id & (PAGE_SIZE - 1);
+
+    if(page_index >= pages.size()) {
+        pages.resize(page_index + 1, nullptr);
+    }
+
+    if(pages[page_index] == nullptr) {
+        pages[page_index] = new page_t;
+    }
+
+    page_t* page = pages[page_index];
+    if(page->contains(offset)) {
+        return;
+    }
+
+    // documents are mostly indexed in ID order, which makes this an append
+    page->values.insert(page->values.begin() + page->rank(offset), value);
+    page->set(offset);
+
+    num_values++;
+}
+
+void sort_column_t::erase(uint32_t seq_id) {
+    const size_t page_index = seq_id >> PAGE_BITS;
+    const uint32_t offset = seq_id & (PAGE_SIZE - 1);
+
+    if(page_index >= pages.size() || pages[page_index] == nullptr || !pages[page_index]->contains(offset)) {
+        return;
+    }
+
+    page_t* page = pages[page_index];
+    page->values.erase(page->values.begin() + page->rank(offset));
+    page->unset(offset);
+
+    num_values--;
+
+    if(page->values.empty()) {
+        delete page;
+        pages[page_index] = nullptr;
+    }
+}
@@ -6,10 +6,10 @@ void sorted_array::load(const uint32_t *sorted_array, const uint32_t array_lengt
     min = array_length != 0 ? sorted_array[0] : 0;
     max = array_length > 1 ? sorted_array[array_length-1] : min;
 
-    uint32_t size_required = (uint32_t) (sorted_append_size_required(max, array_length) * FOR_GROWTH_FACTOR);
+    uint32_t size_required = (uint32_t) (codec::size_sorted(sorted_array, array_length) * FOR_GROWTH_FACTOR);
     uint8_t *out = (uint8_t *) malloc(size_required * sizeof *out);
     memset(out, 0, size_required);
-    uint32_t actual_size = for_compress_sorted(sorted_array, out, array_length);
+    uint32_t actual_size = codec::compress_sorted(sorted_array, out, array_length);
 
     free(in);
     in = nullptr;
@@ -27,7 +27,7 @@ size_t sorted_array::append(uint32_t value) {
 
         // find the index of the element which is >= to `value`
         uint32_t found_val;
-        uint32_t gte_index = for_lower_bound_search(in, length, value, &found_val);
+        uint32_t gte_index = codec::lower_bound(in, length, value, &found_val);
 
         for(size_t j=length; j>gte_index; j--) {
             arr[j] = arr[j-1];
@@ -40,7 +40,7 @@ size_t sorted_array::append(uint32_t value) {
 
         return gte_index;
     } else {
-        uint32_t size_required = sorted_append_size_required(value, length+1);
+        uint32_t size_required = codec::append_size_sorted(in, length, min, max, value);
         size_t min_expected_size = size_required + FOR_ELE_SIZE;
 
         if(size_bytes < min_expected_size) {
@@ -56,7 +56,7 @@ size_t sorted_array::append(uint32_t value) {
             //LOG(INFO) << "new_size: " << new_size;
         }
 
-        uint32_t new_length_bytes = for_append_sorted(in, length, value);
+        uint32_t new_length_bytes = codec::append_sorted(in, length, max, value);
         if(new_length_bytes == 0) return false;
 
         length_bytes = new_length_bytes;
@@ -86,7 +86,7 @@ bool sorted_array::insert(size_t index, uint32_t value) {
 }
 
 uint32_t sorted_array::at(uint32_t index) {
-    return for_select(in, index);
+    return codec::select(in, length, index);
 }
 
 bool sorted_array::contains(uint32_t value) {
@@ -95,7 +95,7 @@ bool sorted_array::contains(uint32_t value) {
     }
 
     uint32_t actual;
-    for_lower_bound_search(in, length, value, &actual);
+    codec::lower_bound(in, length, value, &actual);
     return actual == value;
 }
 
@@ -105,7 +105,7 @@ uint32_t sorted_array::indexOf(uint32_t value) {
     }
 
     uint32_t actual;
-    uint32_t index = for_lower_bound_search(in, length, value, &actual);
+    uint32_t index = codec::lower_bound(in, length, value, &actual);
 
     if(actual == value) {
         return index;
@@ -115,15 +115,14 @@ uint32_t sorted_array::indexOf(uint32_t value) {
 }
 
 // returns the first element in the sequence which does not compare less than |value|.
-uint32_t sorted_array::lower_bound_search_bits(const uint8_t *in, uint32_t imin, uint32_t imax, uint32_t base,
-                                               uint32_t bits, uint32_t value, uint32_t *actual) {
+uint32_t sorted_array::lower_bound_search_compressed(uint32_t imin, uint32_t imax, uint32_t value, uint32_t *actual) {
     uint32_t imid;
     uint32_t v;
 
     while (imin + 1 < imax) {
         imid = imin + ((imax - imin) / 2);
 
-        v = for_select_bits(in, base, bits, imid);
+        v = codec::select(in, length, imid);
         if (v >= value) {
             imax = imid;
         }
@@ -132,13 +131,13 @@ uint32_t sorted_array::lower_bound_search_bits(const uint8_t *in, uint32_t imin,
         }
     }
 
-    v = for_select_bits(in, base, bits, imin);
+    v = codec::select(in, length, imin);
     if (v >= value) {
         *actual = v;
         return imin;
     }
 
-    v = for_select_bits(in, base, bits, imax);
+    v = codec::select(in, length, imax);
     *actual = v;
     return imax;
 }
@@ -175,36 +174,13 @@ uint32_t sorted_array::lower_bound_search(const uint32_t *in, uint32_t imin, uin
 
 
 void sorted_array::binary_search_indices(const uint32_t *values, int low_vindex, int high_vindex,
-                                         int low_index, int high_index, uint32_t base, uint32_t bits,
-                                         uint32_t *indices) {
+                                         int low_index, int high_index, uint32_t *indices) {
     uint32_t actual_value =  0;
 
     if(high_vindex >= low_vindex && high_index >= low_index) {
         size_t pivot_vindex = (low_vindex + high_vindex) / 2;
 
-        uint32_t in_index = lower_bound_search_bits(in+METADATA_OVERHEAD, low_index, high_index, base, bits,
-                                                    values[pivot_vindex], &actual_value);
-        if(actual_value == values[pivot_vindex]) {
-            indices[pivot_vindex] = in_index;
-        } else {
-            indices[pivot_vindex] = length;
-        }
-
-        binary_search_indices(values, low_vindex, pivot_vindex-1, low_index, in_index, base, bits, indices);
-        binary_search_indices(values, pivot_vindex+1, high_vindex, in_index, high_index, base, bits, indices);
-    }
-}
-
-void sorted_array::binary_search_indices(const uint32_t *values, int low_vindex, int high_vindex, int low_index,
-                                         int high_index, uint32_t *indices) {
-
-    uint32_t actual_value =  0;
-
-    if(high_vindex >= low_vindex && high_index >= low_index) {
-        size_t pivot_vindex = (low_vindex + high_vindex) / 2;
-
-        uint32_t in_index = lower_bound_search(values, low_index, high_index,
-                                               values[pivot_vindex], &actual_value);
+        uint32_t in_index = lower_bound_search_compressed(low_index, high_index, values[pivot_vindex], &actual_value);
         if(actual_value == values[pivot_vindex]) {
             indices[pivot_vindex] = in_index;
         } else {
@@ -221,9 +197,6 @@ void sorted_array::indexOf(const uint32_t *values, const size_t values_len, uint
         return ;
     }
 
-    uint32_t base = *(uint32_t *)(in + 0);
-    uint32_t bits = *(in + 4);
-
     uint32_t low_index, high_index;
     uint32_t actual_value = 0;
 
@@ -231,13 +204,13 @@ void sorted_array::indexOf(const uint32_t *values, const size_t values_len, uint
     int head = -1;
     do {
         head++;
-        low_index = lower_bound_search_bits(in+METADATA_OVERHEAD, 0, length-1, base, bits, values[head], &actual_value);
+        low_index = lower_bound_search_compressed(0, length-1, values[head], &actual_value);
     } while(head < int(values_len - 1) && actual_value > values[head]);
 
     int tail = values_len;
     do {
         tail--;
-        high_index = lower_bound_search_bits(in+METADATA_OVERHEAD, 0, length-1, base, bits, values[tail], &actual_value);
+        high_index = lower_bound_search_compressed(0, length-1, values[tail], &actual_value);
     } while(tail > 0 && actual_value < values[tail]);
 
     for(int i = 0; i < head; i++) {
@@ -249,7 +222,7 @@ void sorted_array::indexOf(const uint32_t *values, const size_t values_len, uint
     }
 
     // recursively search within the bounds for all values
-    binary_search_indices(values, head, tail, low_index, high_index, base, bits, indices);
+    binary_search_indices(values, head, tail, low_index, high_index, indices);
 }
 
 void sorted_array::remove_value(uint32_t value) {
@@ -260,7 +233,7 @@ void sorted_array::remove_value(uint32_t value) {
     // A lower bound search returns the first element in the sequence that is >= `value`
     // So, `found_val` will be either equal or greater than `value`
     uint32_t found_val;
-    uint32_t found_index = for_lower_bound_search(in, length, value, &found_val);
+    uint32_t found_index = codec::lower_bound(in, length, value, &found_val);
 
     if(found_val != value) {
         return ;
@@ -312,24 +285,21 @@ size_t sorted_array::numFoundOf(const uint32_t *values, const size_t values_len)
     uint32_t actual_value = 0;
 
     if(length > values_len) {
-        uint32_t base = *(uint32_t *)(in + 0);
-        uint32_t bits = *(in + 4);
-
         // identify the upper and lower bounds of the search space
         int head = -1;
         do {
             head++;
-            low_index = lower_bound_search_bits(in+METADATA_OVERHEAD, 0, length-1, base, bits, values[head], &actual_value);
+            low_index = lower_bound_search_compressed(0, length-1, values[head], &actual_value);
         } while(head < int(values_len - 1) && actual_value > values[head]);
 
         int tail = values_len;
         do {
             tail--;
-            high_index = lower_bound_search_bits(in+METADATA_OVERHEAD, 0, length-1, base, bits, values[tail], &actual_value);
+            high_index = lower_bound_search_compressed(0, length-1, values[tail], &actual_value);
         } while(tail > 0 && actual_value < values[tail]);
 
         // recursively search within the bounds for all values
-        binary_count_indices(values, head, tail, low_index, high_index, base, bits, num_found);
+        binary_count_indices(values, head, tail, low_index, high_index, num_found);
     } else {
         // identify the upper and lower bounds of the search space
         uint32_t* src = uncompress(length);
@@ -356,15 +326,14 @@ size_t sorted_array::numFoundOf(const uint32_t *values, const size_t values_len)
 }
 
 void sorted_array::binary_count_indices(const uint32_t *values, int low_vindex, int high_vindex, int low_index,
-                                        int high_index, uint32_t base, uint32_t bits, size_t& num_found) {
+                                        int high_index, size_t& num_found) {
 
     uint32_t actual_value =  0;
 
     if(high_vindex >= low_vindex && high_index >= low_index) {
         int pivot_vindex = (low_vindex + high_vindex) / 2;
 
-        uint32_t in_index = lower_bound_search_bits(in+METADATA_OVERHEAD, low_index, high_index, base, bits,
-                                                    values[pivot_vindex], &actual_value);
+        uint32_t in_index = lower_bound_search_compressed(low_index, high_index, values[pivot_vindex], &actual_value);
 
         //LOG(INFO) << "pivot_vindex: " << pivot_vindex << ", values[pivot_vindex]: " << values[pivot_vindex];
         if(actual_value == values[pivot_vindex]) {
@@ -372,8 +341,8 @@ void sorted_array::binary_count_indices(const uint32_t *values, int low_vindex,
             num_found++;
         }
 
-        binary_count_indices(values, low_vindex, pivot_vindex-1, low_index, in_index, base, bits, num_found);
-        binary_count_indices(values, pivot_vindex+1, high_vindex, in_index, high_index, base, bits, num_found);
+        binary_count_indices(values, low_vindex, pivot_vindex-1, low_index, in_index, num_found);
+        binary_count_indices(values, pivot_vindex+1, high_vindex, in_index, high_index, num_found);
     }
 }
 
@@ -19,6 +19,8 @@
 #include "typesense_server_utils.h"
 #include "file_utils.h"
 #include "threadpool.h"
+#include "document_cache.h"
+#include "search_response_cache.h"
 #include "jemalloc.h"
 
 #include "stackprinter.h"
@@ -106,6 +108,9 @@ void init_cmdline_options(cmdline::parser & options, int argc, char **argv) {
     options.add<bool>("skip-writes", '\0', "Skip all writes except config changes. Default: false.", false, false);
 
     options.add<int>("log-slow-searches-time-ms", '\0', "When >= 0, searches that take longer than this duration are logged.", false, 30*1000);
+    options.add<size_t>("document-cache-size", '\0', "Size in bytes of the stored JSON of the documents cached for hydrating search results. Default: 0 (disabled).", false, 0);
+    options.add<size_t>("search-cache-size", '\0', "Size in bytes of the response bodies of the searches cached with `use_cache`, held in 16 equal parts: larger responses than a part are not cached. Default: 67108864 (64 MB).", false, 64 * 1024 * 1024);
+    options.add<size_t>("filter-cache-size", '\0', "Size in bytes of the IDs matched by `filter_by` clauses that each collection caches. Default: 33554432 (32 MB).", false, 32 * 1024 * 1024);
 
     // DEPRECATED
     options.add<std::string>("listen-address", 'h', "[DEPRECATED: use `api-address`] Address to which Typesense API service binds.", false, "0.0.0.0");
@@ -444,6 +449,10 @@ int run_server(const Config & config, const std::string & version, void (*master
     BatchedIndexer* batch_indexer = new BatchedIndexer(server, &store, &meta_store, num_threads,
                                                        config, config.get_skip_writes());
 
+    DocumentCache::get_instance().set_capacity(config.get_document_cache_size());
+    SearchResponseCache::get_instance().set_capacity(config.get_search_cache_size());
+    Index::set_filter_result_cache_size(config.get_filter_cache_size());
+
     CollectionManager & collectionManager = CollectionManager::get_instance();
     collectionManager.init(&store, &app_thread_pool, config.get_max_memory_ratio(),
                            config.get_api_key(), quit_raft_service, batch_indexer);
@@ -0,0 +1,17 @@
+#include "typo_candidate_cache.h"
+
+std::string typo_candidate_cache_t::get_key(const std::string& field_name, const std::string& token,
+                                            uint32_t cost, bool prefix, token_ordering token_order) {
+    std::string key;
+    key.reserve(field_name.size() + token.size() + 4);
+
+    key += field_name;
+    key += '\0';
+    key += token;
+    key += '\0';
+    key += char(cost);
+    key += char(prefix);
+    key += char(token_order);
+
+    return key;
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include "array_utils.h"
 #include "logger.h"
+#include <random>
+#include <set>
+#include <algorithm>
 
 TEST(SortedArrayTest, AndScalar) {
     const size_t size1 = 9;
@@ -172,4 +175,83 @@ TEST(SortedArrayTest, FilterArray) {
     delete[] arr2;
     delete[] arr1;
     delete[] results;
-}
\ No newline at end of file
+}
+
+TEST(SortedArrayTest, IntersectionKernelsMatchScalar) {
+    std::mt19937 gen(137723);
+
+    for(size_t trial = 0; trial < 50; trial++) {
+        std::set<uint32_t> set1, set2;
+        const size_t range = 100 + (gen() % 5000);
+        const size_t size1 = gen() % 1000;
+        const size_t size2 = (trial % 5 == 0) ? (gen() % 20) : (gen() % 1000);
+
+        for(size_t i = 0; i < size1; i++) {
+            set1.insert(gen() % range);
+        }
+
+        for(size_t i = 0; i < size2; i++) {
+            set2.insert(gen() % range);
+        }
+
+        std::vector<uint32_t> vec1(set1.begin(), set1.end());
+        std::vector<uint32_t> vec2(set2.begin(), set2.end());
+
+        std::vector<uint32_t> expected;
+        std::set_intersection(vec1.begin(), vec1.end(), vec2.begin(), vec2.end(), std::back_inserter(expected));
+
+        const size_t out_len = std::max<size_t>(1, std::min(vec1.size(), vec2.size()));
+
+        std::vector<uint32_t> out(out_len);
+        size_t num_found = ArrayUtils::intersect_scalar(vec1.data(), vec1.size(), vec2.data(), vec2.size(), out.data());
+        ASSERT_EQ(expected, std::vector<uint32_t>(out.begin(), out.begin() + num_found));
+
+        if(!vec1.empty() && !vec2.empty()) {
+            const auto& small = (vec1.size() < vec2.size()) ? vec1 : vec2;
+            const auto& large = (vec1.size() < vec2.size()) ? vec2 : vec1;
+            out.assign(out_len, 0);
+            num_found = ArrayUtils::intersect_galloping(small.data(), small.size(), large.data(), large.size(),
+                                                        out.data());
+            ASSERT_EQ(expected, std::vector<uint32_t>(out.begin(), out.begin() + num_found));
+        }
+
+        if(ArrayUtils::has_sse_support()) {
+            out.assign(out_len, 0);
+            num_found = ArrayUtils::intersect_sse(vec1.data(), vec1.size(), vec2.data(), vec2.size(), out.data());
+            ASSERT_EQ(expected, std::vector<uint32_t>(out.begin(), out.begin() + num_found));
+        }
+
+        if(ArrayUtils::has_avx2_support()) {
+            out.assign(out_len, 0);
+            num_found = ArrayUtils::intersect_avx2(vec1.data(), vec1.size(), vec2.data(), vec2.size(), out.data());
+            ASSERT_EQ(expected, std::vector<uint32_t>(out.begin(), out.begin() + num_found));
+        }
+
+        out.assign(out_len, 0);
+        num_found = ArrayUtils::intersect(vec1.data(), vec1.size(), vec2.data(), vec2.size(), out.data());
+        ASSERT_EQ(expected, std::vector<uint32_t>(out.begin(), out.begin() + num_found));
+    }
+}
+
+TEST(SortedArrayTest, IntersectionKernelsDoNotWritePastOutput) {
+    // the final match is found when only one slot is left in the output, so a full-width store would overflow
+    std::vector<uint32_t> A = {1, 2, 3, 4, 100, 101, 102, 103, 104, 105, 106, 107};
+    std::vector<uint32_t> B = {1, 2, 3, 100, 101, 102, 103, 104};
+
+    // guard values after the output buffer must remain untouched
+    std::vector<uint32_t> out(B.size() + 8, UINT32_MAX);
+
+    if(ArrayUtils::has_sse_support()) {
+        ASSERT_EQ(8, ArrayUtils::intersect_sse(A.data(), A.size(), B.data(), B.size(), out.data()));
+        for(size_t i = B.size(); i < out.size(); i++) {
+            ASSERT_EQ(UINT32_MAX, out[i]);
+        }
+    }
+
+    if(ArrayUtils::has_avx2_support()) {
+        ASSERT_EQ(8, ArrayUtils::intersect_avx2(A.data(), A.size(), B.data(), B.size(), out.data()));
+        for(size_t i = B.size(); i < out.size(); i++) {
+            ASSERT_EQ(UINT32_MAX, out[i]);
+        }
+    }
+}
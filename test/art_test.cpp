@@ -864,6 +864,153 @@ TEST(ArtTest, test_art_fuzzy_search_unicode_chars) {
     ASSERT_TRUE(res == 0);
 }
 
+TEST(ArtTest, test_art_fuzzy_search_long_terms) {
+    art_tree t;
+    int res = art_tree_init(&t);
+    ASSERT_TRUE(res == 0);
+
+    // terms of up to 64 characters and longer ones are matched differently
+    std::vector<std::string> keys;
+    for(size_t key_len: {62, 63, 64, 65, 80}) {
+        std::string key;
+        for(size_t i = 0; i < key_len; i++) {
+            key += char('a' + (i * 7 + key_len) % 26);
+        }
+
+        keys.push_back(key);
+        art_document doc = get_document((uint32_t) key_len);
+        ASSERT_TRUE(NULL == art_insert(&t, (unsigned char*)key.c_str(), key.size()+1, &doc));
+    }
+
+    for(const std::string& key: keys) {
+        std::vector<art_leaf*> leaves;
+        art_fuzzy_search(&t, (const unsigned char *) key.c_str(), key.size() + 1, 0, 0, 10, FREQUENCY, false, nullptr, 0, leaves);
+        ASSERT_EQ(1, leaves.size());
+        ASSERT_EQ(key.size() + 1, leaves[0]->key_len);
+
+        // transposition near the end of the term
+        std::string typo = key;
+        std::swap(typo[key.size() - 3], typo[key.size() - 2]);
+
+        leaves.clear();
+        art_fuzzy_search(&t, (const unsigned char *) typo.c_str(), typo.size() + 1, 1, 1, 10, FREQUENCY, false, nullptr, 0, leaves);
+        ASSERT_EQ(1, leaves.size());
+        ASSERT_EQ(key.size() + 1, leaves[0]->key_len);
+
+        // substitution and deletion, as a prefix
+        typo = key.substr(0, key.size() - 1);
+        typo[key.size() - 10] = '0';
+        typo.erase(5, 1);
+
+        leaves.clear();
+        art_fuzzy_search(&t, (const unsigned char *) typo.c_str(), typo.size(), 0, 1, 10, FREQUENCY, true, nullptr, 0, leaves);
+        ASSERT_EQ(0, leaves.size());
+
+        leaves.clear();
+        art_fuzzy_search(&t, (const unsigned char *) typo.c_str(), typo.size(), 2, 2, 10, FREQUENCY, true, nullptr, 0, leaves);
+        ASSERT_FALSE(leaves.empty());
+        ASSERT_EQ(key.size() + 1, leaves[0]->key_len);
+    }
+
+    res = art_tree_destroy(&t);
+    ASSERT_TRUE(res == 0);
+}
+
+TEST(ArtTest, test_art_fuzzy_search_top_leaves) {
+    art_tree t;
+    int res = art_tree_init(&t);
+    ASSERT_TRUE(res == 0);
+
+    // keys share prefixes of varying lengths, so that leaves sit below nodes of every depth
+    uint32_t seq_id = 0;
+    for(size_t i = 0; i < 3000; i++) {
+        std::string key = "p";
+        for(size_t n = (i * 2654435761) % 100000; n != 0; n /= 7) {
+            key += char('a' + n % 7);
+        }
+
+        const size_t num_docs = 1 + (i * 31) % 17;
+        for(size_t j = 0; j < num_docs; j++) {
+            art_document doc(seq_id++, (i * 7919) % 100003, {0});
+            art_insert(&t, (unsigned char*)key.c_str(), key.size()+1, &doc);
+        }
+    }
+
+    for(token_ordering token_order: {FREQUENCY, MAX_SCORE}) {
+        for(const std::string prefix: {"p", "pa", "pbc"}) {
+            std::vector<art_leaf*> all_leaves;
+            art_fuzzy_search(&t, (const unsigned char *) prefix.c_str(), prefix.size(), 0, 1, 100000, token_order,
+                             true, nullptr, 0, all_leaves);
+            ASSERT_GT(all_leaves.size(), 20);
+
+            // the best leaves are found without enumerating all the others
+            std::vector<art_leaf*> leaves;
+            art_fuzzy_search(&t, (const unsigned char *) prefix.c_str(), prefix.size(), 0, 1, 20, token_order,
+                             true, nullptr, 0, leaves);
+            ASSERT_EQ(20, leaves.size());
+
+            for(size_t i = 0; i < leaves.size(); i++) {
+                if(token_order == FREQUENCY) {
+                    ASSERT_EQ(posting_t::num_ids(all_leaves[i]->values), posting_t::num_ids(leaves[i]->values));
+                } else {
+                    ASSERT_EQ(all_leaves[i]->max_score, leaves[i]->max_score);
+                }
+            }
+        }
+    }
+
+    res = art_tree_destroy(&t);
+    ASSERT_TRUE(res == 0);
+}
+
+TEST(ArtTest, DISABLED_BenchmarkFuzzySearchShortPrefixes) {
+    art_tree t;
+    int res = art_tree_init(&t);
+    ASSERT_TRUE(res == 0);
+
+    std::vector<std::string> words;
+    char buf[512];
+    FILE *f = fopen(words_file_path, "r");
+
+    uintptr_t line = 1;
+    while (fgets(buf, sizeof buf, f)) {
+        size_t len = strlen(buf);
+        buf[len-1] = '\0';
+        words.emplace_back(buf);
+        art_document doc = get_document((uint32_t) line);
+        art_insert(&t, (unsigned char*)buf, len, &doc);
+        line++;
+    }
+
+    fclose(f);
+
+    // autocomplete: 1-4 character prefixes of words, at 2 typos
+    std::vector<std::string> prefixes;
+    for(size_t i = 0; i < 2000; i++) {
+        const std::string& word = words[(i * 7919) % words.size()];
+        prefixes.push_back(word.substr(0, 1 + (i % 4)));
+    }
+
+    size_t num_leaves = 0;
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    for(const std::string& prefix: prefixes) {
+        std::vector<art_leaf*> leaves;
+        art_fuzzy_search(&t, (const unsigned char *) prefix.c_str(), prefix.size(), 0, 2, 10, MAX_SCORE, true,
+                         nullptr, 0, leaves);
+        num_leaves += leaves.size();
+    }
+
+    long long int timeMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+                                std::chrono::high_resolution_clock::now() - begin).count();
+
+    LOG(INFO) << "Time taken for " << prefixes.size() << " prefix searches: " << timeMicros << "us, "
+              << "leaves: " << num_leaves;
+
+    res = art_tree_destroy(&t);
+    ASSERT_TRUE(res == 0);
+}
+
 TEST(ArtTest, test_art_search_sku_like_tokens) {
     art_tree t;
     int res = art_tree_init(&t);
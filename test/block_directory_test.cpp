@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include "block_directory.h"
+
+TEST(BlockDirectoryTest, LookupsMatchOrderedMap) {
+    std::mt19937 gen(7331);
+    std::vector<int> blocks(2000);
+
+    block_directory_t<int> directory;
+    std::map<last_id_t, int*> expected;
+
+    for(size_t i = 0; i < blocks.size(); i++) {
+        last_id_t last_id = gen() % 100000;
+        directory.emplace(last_id, &blocks[i]);
+        expected.emplace(last_id, &blocks[i]);
+
+        if(i % 3 == 0) {
+            last_id_t erase_id = gen() % 100000;
+            directory.erase(erase_id);
+            expected.erase(erase_id);
+        }
+    }
+
+    ASSERT_EQ(expected.size(), directory.size());
+
+    size_t index = 0;
+    for(const auto& kv: expected) {
+        ASSERT_EQ(kv.first, directory.last_id_at(index));
+        ASSERT_EQ(kv.second, directory.block_at(index));
+        index++;
+    }
+
+    for(last_id_t id = 0; id < 100010; id += 7) {
+        auto it = expected.lower_bound(id);
+        size_t expected_index = std::distance(expected.begin(), it);
+        ASSERT_EQ(expected_index, directory.lower_bound(id));
+
+        auto found_it = expected.find(id);
+        size_t expected_found_index = (found_it == expected.end()) ? expected.size() :
+                                      std::distance(expected.begin(), found_it);
+        ASSERT_EQ(expected_found_index, directory.find(id));
+    }
+}
+
+TEST(BlockDirectoryTest, UpdateRekeysInPlace) {
+    int a, b, c;
+    block_directory_t<int> directory;
+
+    ASSERT_TRUE(directory.empty());
+    ASSERT_EQ(0, directory.lower_bound(10));
+
+    // absent key is added
+    directory.update(UINT32_MAX, 10, &a);
+    directory.emplace(20, &b);
+    directory.emplace(30, &c);
+    directory.emplace(20, &a);
+
+    ASSERT_EQ(3, directory.size());
+    ASSERT_EQ(&b, directory.block_at(1));
+
+    directory.update(20, 25, &b);
+    ASSERT_EQ(25, directory.last_id_at(1));
+    ASSERT_EQ(1, directory.lower_bound(21));
+    ASSERT_EQ(2, directory.lower_bound(26));
+    ASSERT_EQ(3, directory.lower_bound(31));
+    ASSERT_EQ(3, directory.find(20));
+
+    directory.erase(10);
+    ASSERT_EQ(&b, directory.block_at(0));
+    ASSERT_EQ(0, directory.lower_bound(0));
+}
@@ -905,6 +905,35 @@ TEST_F(CollectionFacetingTest, FacetValuesShouldBeNormalized) {
     collectionManager.drop_collection("coll1");
 }
 
+TEST_F(CollectionFacetingTest, FacetValuesSharingAHashFollowRemovals) {
+    std::vector<field> fields = {field("brand", field_types::STRING, true),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    std::vector<std::string> brands = {"BUQU", "bu-qu"};
+
+    for(size_t i=0; i<brands.size(); i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["brand"] = brands[i];
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    auto results = coll1->search("*", {}, "", {"brand"}, {}, {2}, 10, 1, FREQUENCY, {true}, 1).get();
+    ASSERT_EQ(1, results["facet_counts"][0]["counts"].size());
+    ASSERT_EQ("bu-qu", results["facet_counts"][0]["counts"][0]["value"].get<std::string>());
+
+    // no remaining document has the value written this way
+    ASSERT_TRUE(coll1->remove("1").ok());
+
+    results = coll1->search("*", {}, "", {"brand"}, {}, {2}, 10, 1, FREQUENCY, {true}, 1).get();
+    ASSERT_EQ(1, results["facet_counts"][0]["counts"].size());
+    ASSERT_EQ(1, results["facet_counts"][0]["counts"][0]["count"].get<size_t>());
+    ASSERT_EQ("BUQU", results["facet_counts"][0]["counts"][0]["value"].get<std::string>());
+
+    collectionManager.drop_collection("coll1");
+}
+
 TEST_F(CollectionFacetingTest, FacetArrayValuesShouldBeNormalized) {
     std::vector<field> fields = {field("brands", field_types::STRING_ARRAY, true),};
 
@@ -1012,3 +1041,169 @@ TEST_F(CollectionFacetingTest, FacetOnArrayFieldWithSpecialChars) {
         }
     }
 }
+
+TEST_F(CollectionFacetingTest, TopFacetValuesOfHighCardinalityField) {
+    std::vector<field> fields = {
+        field("sku", field_types::STRING, true),
+        field("points", field_types::INT32, false),
+    };
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    // enough distinct values for the facet merge to be partitioned
+    const size_t num_values = 35000;
+    std::vector<std::string> json_lines;
+
+    auto add_doc = [&](size_t value_index) {
+        nlohmann::json doc;
+        doc["sku"] = "sku" + std::to_string(value_index);
+        doc["points"] = int32_t(json_lines.size());
+        json_lines.push_back(doc.dump());
+    };
+
+    for(size_t i = 0; i < num_values; i++) {
+        add_doc(i);
+    }
+
+    for(size_t i = 0; i < num_values; i += 7) {
+        add_doc(i);
+    }
+
+    for(size_t i: {70, 21000, 34993}) {
+        add_doc(i);
+    }
+
+    nlohmann::json document;
+    auto import_res = coll1->add_many(json_lines, document);
+    ASSERT_TRUE(import_res["success"].get<bool>());
+
+    auto results = coll1->search("*", {}, "", {"sku"}, {}, {0}, 10, 1, FREQUENCY, {true}, 10,
+                                 spp::sparse_hash_set<std::string>(), spp::sparse_hash_set<std::string>(), 3).get();
+
+    ASSERT_EQ(json_lines.size(), results["found"].get<size_t>());
+    ASSERT_EQ(3, results["facet_counts"][0]["counts"].size());
+
+    std::set<std::string> top_values;
+    for(const auto& facet_count: results["facet_counts"][0]["counts"]) {
+        ASSERT_EQ(3, facet_count["count"].get<size_t>());
+        top_values.insert(facet_count["value"].get<std::string>());
+    }
+
+    ASSERT_EQ((std::set<std::string>{"sku70", "sku21000", "sku34993"}), top_values);
+    ASSERT_EQ(num_values, results["facet_counts"][0]["stats"]["total_values"].get<size_t>());
+
+    results = coll1->search("*", {}, "", {"sku"}, {}, {0}, 10, 1, FREQUENCY, {true}, 10,
+                            spp::sparse_hash_set<std::string>(), spp::sparse_hash_set<std::string>(), 10).get();
+
+    ASSERT_EQ(10, results["facet_counts"][0]["counts"].size());
+    for(size_t i = 3; i < 10; i++) {
+        ASSERT_EQ(2, results["facet_counts"][0]["counts"][i]["count"].get<size_t>());
+    }
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionFacetingTest, SampledFacetCounts) {
+    std::vector<field> fields = {
+        field("category", field_types::STRING, true),
+        field("points", field_types::INT32, false),
+    };
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    std::vector<std::string> json_lines;
+    for(size_t i = 0; i < 10000; i++) {
+        nlohmann::json doc;
+        doc["category"] = "category" + std::to_string(i % 5);
+        doc["points"] = int32_t(i);
+        json_lines.push_back(doc.dump());
+    }
+
+    nlohmann::json document;
+    ASSERT_TRUE(coll1->add_many(json_lines, document)["success"].get<bool>());
+
+    auto search_sampled = [&](size_t facet_sample_percent, size_t facet_sample_threshold) {
+        return coll1->search("*", {}, "", {"category"}, {}, {0}, 10, 1, FREQUENCY, {true}, 10,
+                             spp::sparse_hash_set<std::string>(),
+                             spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 20, {}, {}, {}, 0,
+                             "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7, fallback,
+                             4, {off}, INT16_MAX, INT16_MAX, 2, 2, false, "", true, 0, max_score,
+                             facet_sample_percent, facet_sample_threshold);
+    };
+
+    // counts over a sample are scaled up to estimates
+    auto results = search_sampled(25, 1000).get();
+
+    ASSERT_EQ(10000, results["found"].get<size_t>());
+    ASSERT_EQ(5, results["facet_counts"][0]["counts"].size());
+    ASSERT_TRUE(results["facet_counts"][0]["sampled"].get<bool>());
+
+    for(const auto& facet_count: results["facet_counts"][0]["counts"]) {
+        ASSERT_NEAR(2000, facet_count["count"].get<size_t>(), 400);
+    }
+
+    // below the threshold, counts are exact
+    results = search_sampled(10, 20000).get();
+
+    ASSERT_EQ(0, results["facet_counts"][0].count("sampled"));
+    for(const auto& facet_count: results["facet_counts"][0]["counts"]) {
+        ASSERT_EQ(2000, facet_count["count"].get<size_t>());
+    }
+
+    auto res_op = search_sampled(0, 1000);
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Value of `facet_sample_percent` must be between 1 and 100.", res_op.error());
+
+    res_op = search_sampled(101, 1000);
+    ASSERT_FALSE(res_op.ok());
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionFacetingTest, GroupedFacetCountsAreExactUnlessApproximate) {
+    std::vector<field> fields = {
+        field("category", field_types::STRING, true),
+        field("group", field_types::INT32, true),
+    };
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    std::vector<std::string> json_lines;
+    for(size_t i = 0; i < 6000; i++) {
+        nlohmann::json doc;
+        doc["category"] = "category" + std::to_string(i % 2);
+        doc["group"] = int32_t(i / 2);
+        json_lines.push_back(doc.dump());
+    }
+
+    nlohmann::json document;
+    ASSERT_TRUE(coll1->add_many(json_lines, document)["success"].get<bool>());
+
+    auto search_grouped = [&](bool facet_approximate_group_counts) {
+        return coll1->search("*", {}, "", {"category"}, {}, {0}, 10, 1, FREQUENCY, {true}, 10,
+                             spp::sparse_hash_set<std::string>(),
+                             spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 20, {}, {}, {"group"}, 1,
+                             "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7, fallback,
+                             4, {off}, INT16_MAX, INT16_MAX, 2, 2, false, "", true, 0, max_score,
+                             100, 0, facet_approximate_group_counts).get();
+    };
+
+    auto results = search_grouped(false);
+    ASSERT_EQ(2, results["facet_counts"][0]["counts"].size());
+    ASSERT_EQ(0, results["facet_counts"][0].count("group_counts_approximate"));
+
+    for(const auto& facet_count: results["facet_counts"][0]["counts"]) {
+        ASSERT_EQ(3000, facet_count["count"].get<size_t>());
+    }
+
+    // groups are counted in bounded memory, and the counts are flagged as estimates
+    results = search_grouped(true);
+    ASSERT_EQ(2, results["facet_counts"][0]["counts"].size());
+    ASSERT_TRUE(results["facet_counts"][0]["group_counts_approximate"].get<bool>());
+
+    for(const auto& facet_count: results["facet_counts"][0]["counts"]) {
+        ASSERT_NEAR(3000, facet_count["count"].get<size_t>(), 3000 * 0.08);
+    }
+
+    collectionManager.drop_collection("coll1");
+}
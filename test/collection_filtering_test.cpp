@@ -2453,3 +2453,151 @@ TEST_F(CollectionFilteringTest, FilteringAfterUpsertOnArrayWithSymbolsToIndex) {
 
     collectionManager.drop_collection("coll1");
 }
+
+TEST_F(CollectionFilteringTest, BroadFiltersWithSelectiveTextQuery) {
+    // filters much broader than the text query are probed lazily instead of being materialized
+    std::vector<field> fields = {field("name", field_types::STRING, false),
+                                 field("tag", field_types::STRING, false),
+                                 field("category_ids", field_types::INT32_ARRAY, false),
+                                 field("points", field_types::INT32, false)};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    for(size_t i = 0; i < 1000; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["name"] = (i == 5 || i == 500 || i == 999) ? "apple pie" : "banana bread";
+        doc["tag"] = "common tag";
+        doc["category_ids"] = {1, (i % 2 == 0) ? 2 : 3};
+        doc["points"] = i;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    auto results = coll1->search("apple", {"name"}, "category_ids: 1", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(3, results["found"].get<size_t>());
+    ASSERT_EQ("999", results["hits"][0]["document"]["id"].get<std::string>());
+    ASSERT_EQ("500", results["hits"][1]["document"]["id"].get<std::string>());
+    ASSERT_EQ("5", results["hits"][2]["document"]["id"].get<std::string>());
+
+    results = coll1->search("apple", {"name"}, "category_ids: 1 && category_ids: 3", {}, {}, {0}, 10, 1,
+                            FREQUENCY, {false}).get();
+    ASSERT_EQ(2, results["found"].get<size_t>());
+    ASSERT_EQ("999", results["hits"][0]["document"]["id"].get<std::string>());
+    ASSERT_EQ("5", results["hits"][1]["document"]["id"].get<std::string>());
+
+    results = coll1->search("apple", {"name"}, "category_ids: 7 || tag: common", {}, {}, {0}, 10, 1,
+                            FREQUENCY, {false}).get();
+    ASSERT_EQ(3, results["found"].get<size_t>());
+
+    results = coll1->search("apple", {"name"}, "category_ids: 2 && tag: missing", {}, {}, {0}, 10, 1,
+                            FREQUENCY, {false}).get();
+    ASSERT_EQ(0, results["found"].get<size_t>());
+
+    // prefix candidates are matched against the filter too
+    results = coll1->search("appl", {"name"}, "category_ids: [2, 3] && id: [5, 6, 7]", {}, {}, {0}, 10, 1,
+                            FREQUENCY, {true}).get();
+    ASSERT_EQ(1, results["found"].get<size_t>());
+    ASSERT_EQ("5", results["hits"][0]["document"]["id"].get<std::string>());
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionFilteringTest, FilterResultsFollowWrites) {
+    std::vector<field> fields = {field("name", field_types::STRING, false),
+                                 field("brand", field_types::STRING, false, true),
+                                 field("in_stock", field_types::BOOL, false, true),
+                                 field("points", field_types::INT32, false)};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    // every subtree is cached, however cheap
+    Index::set_filter_result_cache_min_cost_us(0);
+
+    for(size_t i = 0; i < 10; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["name"] = "shoe " + std::to_string(i);
+        doc["brand"] = (i % 2 == 0) ? "Nike" : "Puma";
+        doc["in_stock"] = (i < 5);
+        doc["points"] = i;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    const std::string filter_query = "brand: Nike && points: >2";
+
+    // the second search is served from the cached results of the filter
+    for(size_t i = 0; i < 2; i++) {
+        auto results = coll1->search("*", {}, filter_query, {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+        ASSERT_EQ(3, results["found"].get<size_t>());
+    }
+
+    // commuted operands share the results
+    auto results = coll1->search("*", {}, "points: >2 && brand: Nike", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(3, results["found"].get<size_t>());
+
+    // a clause added to a cached expression reuses it, and writes to the field of the clause alone are seen
+    const std::string in_stock_filter_query = "brand: Nike && points: >2 && in_stock: true";
+    results = coll1->search("*", {}, in_stock_filter_query, {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(1, results["found"].get<size_t>());
+
+    ASSERT_TRUE(coll1->add(R"({"id": "6", "in_stock": true})", UPDATE).ok());
+    results = coll1->search("*", {}, in_stock_filter_query, {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(2, results["found"].get<size_t>());
+
+    ASSERT_TRUE(coll1->add(R"({"id": "6", "in_stock": false})", UPDATE).ok());
+    results = coll1->search("*", {}, in_stock_filter_query, {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(1, results["found"].get<size_t>());
+
+    // writes to a field of the filter are seen
+    ASSERT_TRUE(coll1->add(R"({"id": "1", "brand": "Nike"})", UPDATE).ok());
+    results = coll1->search("*", {}, filter_query, {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(3, results["found"].get<size_t>());
+
+    ASSERT_TRUE(coll1->add(R"({"id": "3", "brand": "Nike"})", UPDATE).ok());
+    results = coll1->search("*", {}, filter_query, {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(4, results["found"].get<size_t>());
+
+    ASSERT_TRUE(coll1->add(R"({"id": "4", "points": 1})", UPDATE).ok());
+    results = coll1->search("*", {}, filter_query, {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(3, results["found"].get<size_t>());
+
+    // and so are documents that are added or removed
+    results = coll1->search("*", {}, "in_stock: != true", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(5, results["found"].get<size_t>());
+
+    // without a value for the field
+    ASSERT_TRUE(coll1->add(R"({"id": "10", "name": "shoe 10", "points": 10})").ok());
+    results = coll1->search("*", {}, "in_stock: != true", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(6, results["found"].get<size_t>());
+
+    ASSERT_TRUE(coll1->remove("8").ok());
+    results = coll1->search("*", {}, filter_query, {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(2, results["found"].get<size_t>());
+
+    results = coll1->search("*", {}, "in_stock: != true", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(5, results["found"].get<size_t>());
+
+    // string filters of several values, which share one comparator
+    for(const auto& brand_filter: {"brand: [Nike, Puma]", "brand: [Puma, Nike]"}) {
+        for(size_t i = 0; i < 2; i++) {
+            results = coll1->search("*", {}, brand_filter, {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+            ASSERT_EQ(9, results["found"].get<size_t>());
+        }
+    }
+
+    results = coll1->search("*", {}, "brand: [Puma]", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(3, results["found"].get<size_t>());
+
+    results = coll1->search("*", {}, "brand:= [Puma, Nike]", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(9, results["found"].get<size_t>());
+
+    ASSERT_TRUE(coll1->add(R"({"id": "9", "brand": "Nike"})", UPDATE).ok());
+    results = coll1->search("*", {}, "brand: [Nike, Puma]", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(9, results["found"].get<size_t>());
+
+    results = coll1->search("*", {}, "brand: [Puma]", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(2, results["found"].get<size_t>());
+
+    Index::set_filter_result_cache_min_cost_us(Index::FILTER_RESULT_CACHE_MIN_COST_US);
+    collectionManager.drop_collection("coll1");
+}
@@ -536,3 +536,73 @@ TEST_F(CollectionGroupingTest, UseHighestValueInGroupForOrdering) {
     ASSERT_STREQ("249", res["grouped_hits"][0]["group_key"][0].get<std::string>().c_str());
     ASSERT_EQ(2, res["grouped_hits"][0]["hits"].size());
 }
+
+TEST_F(CollectionGroupingTest, GroupKeysFollowDocumentChanges) {
+    auto search_grouped = [&]() {
+        return coll_group->search("*", {}, "", {}, {}, {0}, 50, 1, FREQUENCY,
+                                  {false}, Index::DROP_TOKENS_THRESHOLD,
+                                  spp::sparse_hash_set<std::string>(),
+                                  spp::sparse_hash_set<std::string>(), 10, "", 30, 5,
+                                  "", 10,
+                                  {}, {}, {"size"}, 10).get();
+    };
+
+    // sizes 10, 11 and 12
+    auto res = search_grouped();
+    ASSERT_EQ(3, res["found"].get<size_t>());
+
+    // group keys of documents indexed after the first grouped search
+    ASSERT_TRUE(coll_group->add(R"({"id": "12", "title": "Omega Linen Shirt", "brand": "Omega", "size": 13,
+                                    "colors": ["white"], "rating": 4.9})").ok());
+
+    res = search_grouped();
+    ASSERT_EQ(4, res["found"].get<size_t>());
+    ASSERT_EQ(13, res["grouped_hits"][0]["group_key"][0].get<size_t>());
+    ASSERT_EQ(1, res["grouped_hits"][0]["hits"].size());
+
+    // updated and removed documents
+    ASSERT_TRUE(coll_group->add(R"({"id": "5", "size": 13})", UPDATE).ok());
+
+    res = search_grouped();
+    ASSERT_EQ(4, res["found"].get<size_t>());
+    ASSERT_EQ(13, res["grouped_hits"][0]["group_key"][0].get<size_t>());
+    ASSERT_EQ(2, res["grouped_hits"][0]["hits"].size());
+    ASSERT_STREQ("5", res["grouped_hits"][0]["hits"][1]["document"]["id"].get<std::string>().c_str());
+
+    ASSERT_TRUE(coll_group->remove("1").ok());
+
+    res = search_grouped();
+    ASSERT_EQ(3, res["found"].get<size_t>());
+
+    for(const auto& grouped_hit: res["grouped_hits"]) {
+        ASSERT_NE(11, grouped_hit["group_key"][0].get<size_t>());
+    }
+}
+
+TEST_F(CollectionGroupingTest, GroupKeysOfMoreSetsOfFieldsThanColumns) {
+    const std::vector<std::vector<std::string>> group_by_field_sets = {
+        {"brand"}, {"size"}, {"colors"}, {"rating"}, {"brand", "size"}, {"size", "colors"}
+    };
+
+    auto search_grouped = [&](const std::vector<std::string>& group_by_fields) {
+        return coll_group->search("*", {}, "", {}, {}, {0}, 50, 1, FREQUENCY,
+                                  {false}, Index::DROP_TOKENS_THRESHOLD,
+                                  spp::sparse_hash_set<std::string>(),
+                                  spp::sparse_hash_set<std::string>(), 10, "", 30, 5,
+                                  "", 10,
+                                  {}, {}, group_by_fields, 10).get();
+    };
+
+    std::vector<size_t> found;
+
+    for(const auto& group_by_fields: group_by_field_sets) {
+        found.push_back(search_grouped(group_by_fields)["found"].get<size_t>());
+    }
+
+    // keys read from the columns that were built meanwhile, and computed for the sets left without one
+    for(size_t round = 0; round < 3; round++) {
+        for(size_t i = 0; i < group_by_field_sets.size(); i++) {
+            ASSERT_EQ(found[i], search_grouped(group_by_field_sets[i])["found"].get<size_t>());
+        }
+    }
+}
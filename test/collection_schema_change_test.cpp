@@ -1446,3 +1446,75 @@ TEST_F(CollectionSchemaChangeTest, GeoFieldSchemaAddition) {
     ASSERT_TRUE(res_op.ok());
     ASSERT_EQ(2, res_op.get()["found"].get<size_t>());
 }
+
+TEST_F(CollectionSchemaChangeTest, SearchPlansFollowSchemaChanges) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "points", "type": "int32", "sort": true}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    nlohmann::json doc;
+    doc["id"] = "0";
+    doc["title"] = "Title 1";
+    doc["points"] = 100;
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    std::vector<sort_by> sort_fields = { sort_by("points", "DESC") };
+
+    // parsed once, and then served from the plan caches
+    for(size_t i = 0; i < 2; i++) {
+        auto res_op = coll1->search("*", {}, "points: >10", {}, sort_fields, {0}, 3, 1, FREQUENCY, {true});
+        ASSERT_TRUE(res_op.ok());
+        ASSERT_EQ(1, res_op.get()["found"].get<size_t>());
+    }
+
+    // `id` filters resolve to the documents that exist at the time of the search
+    auto res_op = coll1->search("*", {}, "id: 1", {}, {}, {0}, 3, 1, FREQUENCY, {true});
+    ASSERT_TRUE(res_op.ok());
+    ASSERT_EQ(0, res_op.get()["found"].get<size_t>());
+
+    doc["id"] = "1";
+    doc["title"] = "Title 2";
+    doc["points"] = 200;
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    res_op = coll1->search("*", {}, "id: 1", {}, {}, {0}, 3, 1, FREQUENCY, {true});
+    ASSERT_TRUE(res_op.ok());
+    ASSERT_EQ(1, res_op.get()["found"].get<size_t>());
+
+    auto schema_changes = R"({
+        "fields": [
+            {"name": "points", "drop": true}
+        ]
+    })"_json;
+
+    auto alter_op = coll1->alter(schema_changes);
+    ASSERT_TRUE(alter_op.ok());
+
+    res_op = coll1->search("*", {}, "points: >10", {}, {}, {0}, 3, 1, FREQUENCY, {true});
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Could not find a filter field named `points` in the schema.", res_op.error());
+
+    res_op = coll1->search("*", {}, "", {}, sort_fields, {0}, 3, 1, FREQUENCY, {true});
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Could not find a field named `points` in the schema for sorting.", res_op.error());
+
+    // re-added with another type
+    schema_changes = R"({
+        "fields": [
+            {"name": "points", "type": "int64"}
+        ]
+    })"_json;
+
+    alter_op = coll1->alter(schema_changes);
+    ASSERT_TRUE(alter_op.ok());
+
+    res_op = coll1->search("*", {}, "points: 200", {}, {}, {0}, 3, 1, FREQUENCY, {true});
+    ASSERT_TRUE(res_op.ok());
+    ASSERT_EQ(1, res_op.get()["found"].get<size_t>());
+}
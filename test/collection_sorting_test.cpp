@@ -2176,3 +2176,188 @@ TEST_F(CollectionSortingTest, OptionalFilteringViaSortingSecondThirdParams) {
         ASSERT_EQ(expected_ids[i], results["hits"][i]["document"]["id"].get<std::string>());
     }
 }
+
+TEST_F(CollectionSortingTest, WildcardSortedOnNumericalFieldInValueOrder) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("points", field_types::INT32, false),
+                                 field("price", field_types::FLOAT, false, true),};
+
+    Collection* coll1 = collectionManager.get_collection("coll1").get();
+    if(coll1 == nullptr) {
+        coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+    }
+
+    // only every 30th document has a price
+    std::vector<std::pair<int32_t, float>> doc_values;
+
+    for(size_t i = 0; i < 3000; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "Title " + std::to_string(i);
+        doc["points"] = int32_t((i * 7919) % 100);
+
+        float price = -1;
+        if(i % 30 == 0) {
+            price = float((i * 31) % 97) + 0.5f;
+            doc["price"] = price;
+        }
+
+        doc_values.emplace_back(doc["points"].get<int32_t>(), price);
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    // ties are ordered by descending seq_id, and documents without a value are last
+    auto expected_ids = [&](const std::function<bool(size_t)>& filter, bool on_price, bool asc) {
+        std::vector<size_t> ids;
+        for(size_t i = 0; i < doc_values.size(); i++) {
+            if(filter(i)) {
+                ids.push_back(i);
+            }
+        }
+
+        std::sort(ids.begin(), ids.end(), [&](size_t a, size_t b) {
+            float a_value = on_price ? doc_values[a].second : doc_values[a].first;
+            float b_value = on_price ? doc_values[b].second : doc_values[b].first;
+
+            if(on_price && (a_value < 0 || b_value < 0)) {
+                return (a_value < 0) != (b_value < 0) ? (b_value < 0) : (a > b);
+            }
+
+            if(a_value != b_value) {
+                return asc ? (a_value < b_value) : (a_value > b_value);
+            }
+
+            return a > b;
+        });
+
+        return ids;
+    };
+
+    auto assert_hits = [&](const nlohmann::json& res, const std::vector<size_t>& ids, size_t start) {
+        for(size_t i = 0; i < res["hits"].size(); i++) {
+            ASSERT_EQ(std::to_string(ids[start + i]), res["hits"][i]["document"]["id"].get<std::string>());
+        }
+    };
+
+    std::vector<sort_by> sort_points_asc = {sort_by("points", "ASC")};
+    auto res = coll1->search("*", {}, "", {}, sort_points_asc, {0}, 10, 3, FREQUENCY, {false}).get();
+
+    ASSERT_EQ(3000, res["found"].get<size_t>());
+    ASSERT_EQ(10, res["hits"].size());
+    assert_hits(res, expected_ids([](size_t) { return true; }, false, true), 20);
+
+    std::vector<sort_by> sort_points_desc = {sort_by("points", "DESC")};
+    res = coll1->search("*", {}, "points:>=5", {}, sort_points_desc, {0}, 20, 1, FREQUENCY, {false}).get();
+
+    auto filtered_ids = expected_ids([&](size_t i) { return doc_values[i].first >= 5; }, false, false);
+    ASSERT_EQ(filtered_ids.size(), res["found"].get<size_t>());
+    ASSERT_EQ(20, res["hits"].size());
+    assert_hits(res, filtered_ids, 0);
+
+    // the walk runs out of values before filling a page
+    std::vector<sort_by> sort_price_desc = {sort_by("price", "DESC")};
+    auto price_ids = expected_ids([](size_t) { return true; }, true, false);
+
+    for(size_t page: {10, 11}) {
+        res = coll1->search("*", {}, "", {}, sort_price_desc, {0}, 10, page, FREQUENCY, {false}).get();
+        ASSERT_EQ(3000, res["found"].get<size_t>());
+        ASSERT_EQ(10, res["hits"].size());
+        assert_hits(res, price_ids, (page - 1) * 10);
+    }
+
+    ASSERT_EQ("2999", res["hits"][0]["document"]["id"].get<std::string>());
+}
+
+TEST_F(CollectionSortingTest, WildcardSortedInValueOrderWithCuration) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("points", field_types::INT32, false),};
+
+    Collection* coll1 = collectionManager.get_collection("coll1").get();
+    if(coll1 == nullptr) {
+        coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+    }
+
+    std::vector<int32_t> doc_points;
+
+    for(size_t i = 0; i < 3000; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "Title " + std::to_string(i);
+        doc["points"] = int32_t((i * 7919) % 100);
+
+        doc_points.push_back(doc["points"].get<int32_t>());
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    // ties are ordered by descending seq_id
+    std::vector<size_t> filtered_ids;
+    for(size_t i = doc_points.size(); i > 0; i--) {
+        if(doc_points[i - 1] >= 5) {
+            filtered_ids.push_back(i - 1);
+        }
+    }
+
+    std::stable_sort(filtered_ids.begin(), filtered_ids.end(), [&](size_t a, size_t b) {
+        return doc_points[a] > doc_points[b];
+    });
+
+    // the two best hits are hidden and the third is pinned on top
+    const std::string hidden_hits = std::to_string(filtered_ids[0]) + "," + std::to_string(filtered_ids[1]);
+    const std::string pinned_hits = std::to_string(filtered_ids[2]) + ":1";
+
+    std::vector<sort_by> sort_points_desc = {sort_by("points", "DESC")};
+    auto res = coll1->search("*", {}, "points:>=5", {}, sort_points_desc, {0}, 20, 1, FREQUENCY, {false},
+                             Index::DROP_TOKENS_THRESHOLD, spp::sparse_hash_set<std::string>(),
+                             spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", Index::TYPO_TOKENS_THRESHOLD,
+                             pinned_hits, hidden_hits).get();
+
+    ASSERT_EQ(filtered_ids.size() - 2, res["found"].get<size_t>());
+    ASSERT_EQ(20, res["hits"].size());
+    ASSERT_EQ(std::to_string(filtered_ids[2]), res["hits"][0]["document"]["id"].get<std::string>());
+
+    for(size_t i = 1; i < res["hits"].size(); i++) {
+        ASSERT_EQ(std::to_string(filtered_ids[i + 2]), res["hits"][i]["document"]["id"].get<std::string>());
+    }
+}
+
+TEST_F(CollectionSortingTest, UpdatedPointsBeatStaleBlockBounds) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("points", field_types::INT32, false),};
+
+    Collection* coll1 = collectionManager.get_collection("coll1").get();
+    if(coll1 == nullptr) {
+        coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+    }
+
+    // the best hits are indexed first, so the blocks of the last documents can't beat the topster's minimum
+    for(size_t i = 0; i < 1000; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "Title " + std::to_string(i);
+        doc["points"] = int32_t(1000 - i);
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    // an update of the points alone leaves the postings of the title, and so its block bound, untouched
+    nlohmann::json doc;
+    doc["id"] = "999";
+    doc["points"] = 5000;
+    ASSERT_TRUE(coll1->add(doc.dump(), UPDATE, "999").ok());
+
+    std::vector<sort_by> sort_points_desc = {sort_by("points", "DESC")};
+    auto res = coll1->search("title", {"title"}, "", {}, sort_points_desc, {0}, 10, 1, FREQUENCY, {false}).get();
+
+    ASSERT_EQ(1000, res["found"].get<size_t>());
+    ASSERT_EQ("999", res["hits"][0]["document"]["id"].get<std::string>());
+    ASSERT_EQ("0", res["hits"][1]["document"]["id"].get<std::string>());
+
+    // and so is a later update that lowers them again
+    doc["points"] = 0;
+    ASSERT_TRUE(coll1->add(doc.dump(), UPDATE, "999").ok());
+
+    res = coll1->search("title", {"title"}, "", {}, sort_points_desc, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(1000, res["found"].get<size_t>());
+    ASSERT_EQ("0", res["hits"][0]["document"]["id"].get<std::string>());
+
+    collectionManager.drop_collection("coll1");
+}
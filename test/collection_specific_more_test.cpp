@@ -1811,3 +1811,41 @@ TEST_F(CollectionSpecificMoreTest, CrossFieldTypoAndPrefixWithWeights) {
                         "<mark>", "</mark>", {2, 3}).get();
     ASSERT_EQ(1, res["hits"].size());
 }
+
+TEST_F(CollectionSpecificMoreTest, PrefixCandidatesFillUpAcrossFields) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("description", field_types::STRING, false),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    // the more frequent tokens of the description are already candidates from the title
+    std::vector<std::pair<std::string, std::string>> title_descriptions = {
+        {"cab", "cab"}, {"cad", "cad"}, {"x", "cam"}, {"x", "can"}, {"x", "cap"}
+    };
+
+    size_t seq_id = 0;
+    for(size_t i = 0; i < title_descriptions.size(); i++) {
+        for(size_t j = 0; j < 6 - i; j++) {
+            nlohmann::json doc;
+            doc["id"] = std::to_string(seq_id++);
+            doc["title"] = title_descriptions[i].first;
+            doc["description"] = title_descriptions[i].second;
+            ASSERT_TRUE(coll1->add(doc.dump()).ok());
+        }
+    }
+
+    // the description is asked only for the leaves that fill the 4 candidates up, apart from those of the title
+    auto res = coll1->search("ca", {"title", "description"}, "", {}, {}, {0}, 20, 1, FREQUENCY, {true}, 0,
+                             spp::sparse_hash_set<std::string>(),
+                             spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 1, {}, {}, {}, 0,
+                             "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7,
+                             fallback, 4).get();
+
+    ASSERT_EQ(6 + 5 + 4 + 3, res["found"].get<size_t>());
+
+    for(const auto& hit: res["hits"]) {
+        ASSERT_NE("cap", hit["document"]["description"].get<std::string>());
+    }
+
+    collectionManager.drop_collection("coll1");
+}
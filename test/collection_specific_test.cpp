@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <collection_manager.h>
 #include "collection.h"
+#include "document_cache.h"
 
 class CollectionSpecificTest : public ::testing::Test {
 protected:
@@ -2918,3 +2919,98 @@ TEST_F(CollectionSpecificTest, DontHighlightPunctuation) {
     collectionManager.drop_collection("coll1");
 }
 
+
+TEST_F(CollectionSpecificTest, HitsHydratedFromDocumentCache) {
+    DocumentCache::get_instance().set_capacity(1024 * 1024);
+
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("points", field_types::INT32, false),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    for(size_t i = 0; i < 5; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "Shirt " + std::to_string(i);
+        doc["points"] = i;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    auto results = coll1->search("shirt", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(5, results["hits"].size());
+    ASSERT_EQ(5, DocumentCache::get_instance().num_documents());
+
+    // hits of the same page are in ranking order, whether cached or not
+    results = coll1->search("shirt", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(5, results["hits"].size());
+    for(size_t i = 0; i < 5; i++) {
+        ASSERT_EQ(std::to_string(4 - i), results["hits"][i]["document"]["id"].get<std::string>());
+        ASSERT_EQ("Shirt " + std::to_string(4 - i), results["hits"][i]["document"]["title"].get<std::string>());
+    }
+
+    // updates are never served from a stale copy
+    ASSERT_TRUE(coll1->add(R"({"id": "3", "title": "Shirt updated"})", UPDATE).ok());
+    ASSERT_TRUE(coll1->remove("4").ok());
+
+    results = coll1->search("shirt", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(4, results["hits"].size());
+    ASSERT_EQ("3", results["hits"][0]["document"]["id"].get<std::string>());
+    ASSERT_EQ("Shirt updated", results["hits"][0]["document"]["title"].get<std::string>());
+
+    DocumentCache::get_instance().clear();
+    DocumentCache::get_instance().set_capacity(0);
+}
+
+TEST_F(CollectionSpecificTest, TypoCandidatesFollowIndexChanges) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("points", field_types::INT32, false),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    nlohmann::json doc;
+    doc["id"] = "0";
+    doc["title"] = "Typesense search";
+    doc["points"] = 1;
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    doc["id"] = "1";
+    doc["title"] = "Typical usage";
+    doc["points"] = 2;
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    auto results = coll1->search("typ", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(2, results["hits"].size());
+
+    // candidates found before are filtered for the query
+    results = coll1->search("typ", {"title"}, "points: 1", {}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(1, results["hits"].size());
+    ASSERT_EQ("0", results["hits"][0]["document"]["id"].get<std::string>());
+
+    results = coll1->search("typesens", {"title"}, "", {}, {}, {1}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(1, results["hits"].size());
+
+    // new tokens are found once indexed
+    doc["id"] = "2";
+    doc["title"] = "Typhoon warning";
+    doc["points"] = 3;
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    results = coll1->search("typ", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(3, results["hits"].size());
+    ASSERT_EQ("2", results["hits"][0]["document"]["id"].get<std::string>());
+
+    // and no longer found once removed
+    ASSERT_TRUE(coll1->remove("0").ok());
+
+    results = coll1->search("typ", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(2, results["hits"].size());
+
+    results = coll1->search("typesens", {"title"}, "", {}, {}, {1}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(0, results["hits"].size());
+
+    ASSERT_TRUE(coll1->add(R"({"id": "1", "title": "Typesense usage"})", UPDATE).ok());
+
+    results = coll1->search("typesens", {"title"}, "", {}, {}, {1}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(1, results["hits"].size());
+    ASSERT_EQ("1", results["hits"][0]["document"]["id"].get<std::string>());
+}
@@ -368,6 +368,65 @@ TEST_F(CollectionVectorTest, VecSearchWithFiltering) {
     ASSERT_EQ(1, results["hits"].size());
 }
 
+TEST_F(CollectionVectorTest, VecSearchWithFilteringAndCuration) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "points", "type": "int32"},
+            {"name": "vec", "type": "float[]", "num_dim": 4}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    std::mt19937 rng;
+    rng.seed(47);
+    std::uniform_real_distribution<> distrib;
+
+    size_t num_docs = 20;
+
+    for (size_t i = 0; i < num_docs; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = std::to_string(i) + " title";
+        doc["points"] = i;
+
+        std::vector<float> values;
+        for(size_t j = 0; j < 4; j++) {
+            values.push_back(distrib(rng));
+        }
+
+        doc["vec"] = values;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    // hidden and pinned hits must neither leak into nor repeat in the nearest neighbors, both with HNSW and flat search
+    for(const std::string flat_search_cutoff: {"0", "1000"}) {
+        auto results = coll1->search("*", {}, "points:<10", {}, {}, {0}, 20, 1, FREQUENCY, {true},
+                                     Index::DROP_TOKENS_THRESHOLD,
+                                     spp::sparse_hash_set<std::string>(),
+                                     spp::sparse_hash_set<std::string>(), 10, "", 30, 5,
+                                     "", 10, "5:1", "3", {}, 0,
+                                     "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7,
+                                     fallback,
+                                     4, {off}, 32767, 32767, 2,
+                                     false, true, "vec:([0.96826, 0.94, 0.39557, 0.306488], flat_search_cutoff: " +
+                                                  flat_search_cutoff + ")").get();
+
+        ASSERT_EQ(9, results["found"].get<size_t>());
+        ASSERT_EQ(9, results["hits"].size());
+        ASSERT_EQ("5", results["hits"][0]["document"]["id"].get<std::string>());
+
+        for(size_t i = 1; i < results["hits"].size(); i++) {
+            const auto& id = results["hits"][i]["document"]["id"].get<std::string>();
+            ASSERT_NE("3", id);
+            ASSERT_NE("5", id);
+            ASSERT_LT(std::stoi(id), 10);
+        }
+    }
+}
+
 TEST_F(CollectionVectorTest, VecSearchWithFilteringWithMissingVectorValues) {
     nlohmann::json schema = R"({
         "name": "coll1",
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <random>
+#include "distinct_counter.h"
+
+TEST(DistinctCounterTest, ExactWhileSmall) {
+    distinct_counter_t counter(true);
+    ASSERT_EQ(0, counter.count());
+
+    for(uint64_t id = 0; id < distinct_counter_t::MAX_EXACT_IDS; id++) {
+        counter.add(id * 7919);
+        counter.add(id * 7919);
+    }
+
+    ASSERT_TRUE(counter.is_exact());
+    ASSERT_EQ(distinct_counter_t::MAX_EXACT_IDS, counter.count());
+
+    distinct_counter_t other;
+    other.add(1);
+    other.add(7919);
+
+    counter.merge(other);
+    ASSERT_FALSE(counter.is_exact());
+
+    distinct_counter_t small;
+    small.add(5);
+    small.add(10);
+    small.merge(other);
+    ASSERT_TRUE(small.is_exact());
+    ASSERT_EQ(4, small.count());
+}
+
+TEST(DistinctCounterTest, EstimatesLargeCardinalities) {
+    std::mt19937_64 gen(42);
+
+    for(size_t num_ids: {300, 1000, 5000, 100000, 1000000}) {
+        distinct_counter_t counter(true);
+
+        for(size_t i = 0; i < num_ids; i++) {
+            uint64_t id = gen();
+            counter.add(id);
+
+            // repeated IDs are not counted again
+            if(i % 3 == 0) {
+                counter.add(id);
+            }
+        }
+
+        ASSERT_FALSE(counter.is_exact());
+        ASSERT_NEAR(num_ids, counter.count(), num_ids * 0.08);
+    }
+
+    // sequential IDs, counted in parts that are merged
+    std::vector<distinct_counter_t> parts(4, distinct_counter_t(true));
+    for(uint64_t id = 0; id < 200000; id++) {
+        parts[id % 4].add(id);
+        parts[(id + 1) % 4].add(id);
+    }
+
+    distinct_counter_t merged;
+    for(const auto& part: parts) {
+        merged.merge(part);
+    }
+
+    ASSERT_NEAR(200000, merged.count(), 200000 * 0.08);
+}
+
+TEST(DistinctCounterTest, ExactUnlessApproximate) {
+    distinct_counter_t counter;
+    distinct_counter_t other;
+
+    for(uint64_t id = 0; id < 100000; id++) {
+        counter.add(id * 7919);
+        other.add(id * 7919 + (id % 2));
+    }
+
+    ASSERT_TRUE(counter.is_exact());
+    ASSERT_EQ(100000, counter.count());
+
+    counter.merge(other);
+    ASSERT_TRUE(counter.is_exact());
+    ASSERT_EQ(150000, counter.count());
+
+    // merging an approximate counter makes the merged one approximate
+    distinct_counter_t approximate(true);
+    approximate.add(1);
+    counter.merge(approximate);
+    ASSERT_FALSE(counter.is_exact());
+    ASSERT_NEAR(150001, counter.count(), 150001 * 0.08);
+}
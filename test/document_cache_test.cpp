@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "document_cache.h"
+
+class DocumentCacheTest : public ::testing::Test {
+protected:
+    DocumentCache& cache = DocumentCache::get_instance();
+
+    virtual void SetUp() {
+        cache.clear();
+        cache.set_capacity(100);
+    }
+
+    virtual void TearDown() {
+        cache.clear();
+        cache.set_capacity(0);
+    }
+};
+
+TEST_F(DocumentCacheTest, EvictsLeastRecentlyUsed) {
+    nlohmann::json document;
+
+    for(uint32_t seq_id = 0; seq_id < 4; seq_id++) {
+        cache.put(DocumentCache::get_key(1, seq_id), {{"id", std::to_string(seq_id)}}, 30, cache.get_write_epoch());
+    }
+
+    // the first document was evicted to fit the last one
+    ASSERT_EQ(3, cache.num_documents());
+    ASSERT_EQ(90, cache.size_bytes());
+    ASSERT_FALSE(cache.get(DocumentCache::get_key(1, 0), document));
+
+    ASSERT_TRUE(cache.get(DocumentCache::get_key(1, 1), document));
+    ASSERT_EQ("1", document["id"].get<std::string>());
+
+    // other collections have their own keys
+    ASSERT_FALSE(cache.get(DocumentCache::get_key(2, 1), document));
+
+    // the document just read is kept over the ones that were not
+    cache.put(DocumentCache::get_key(1, 4), {{"id", "4"}}, 30, cache.get_write_epoch());
+    ASSERT_TRUE(cache.get(DocumentCache::get_key(1, 1), document));
+    ASSERT_FALSE(cache.get(DocumentCache::get_key(1, 2), document));
+
+    // documents larger than the cache are not cached
+    cache.put(DocumentCache::get_key(1, 5), {{"id", "5"}}, 101, cache.get_write_epoch());
+    ASSERT_FALSE(cache.get(DocumentCache::get_key(1, 5), document));
+    ASSERT_EQ(3, cache.num_documents());
+
+    cache.set_capacity(50);
+    ASSERT_EQ(1, cache.num_documents());
+    ASSERT_TRUE(cache.get(DocumentCache::get_key(1, 1), document));
+}
+
+TEST_F(DocumentCacheTest, InvalidatedDocumentsAreNotCachedAgain) {
+    nlohmann::json document;
+
+    cache.put(DocumentCache::get_key(1, 0), {{"title", "old"}}, 10, cache.get_write_epoch());
+    cache.invalidate(DocumentCache::get_key(1, 0));
+    ASSERT_FALSE(cache.get(DocumentCache::get_key(1, 0), document));
+
+    // a copy read before a write is stale
+    const uint64_t read_epoch = cache.get_write_epoch();
+    cache.invalidate(DocumentCache::get_key(1, 0));
+    cache.put(DocumentCache::get_key(1, 0), {{"title", "old"}}, 10, read_epoch);
+    ASSERT_FALSE(cache.get(DocumentCache::get_key(1, 0), document));
+
+    cache.put(DocumentCache::get_key(1, 0), {{"title", "new"}}, 10, cache.get_write_epoch());
+    ASSERT_TRUE(cache.get(DocumentCache::get_key(1, 0), document));
+    ASSERT_EQ("new", document["title"].get<std::string>());
+
+    // a disabled cache holds nothing
+    cache.set_capacity(0);
+    ASSERT_FALSE(cache.enabled());
+    ASSERT_EQ(0, cache.num_documents());
+}
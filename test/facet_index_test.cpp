@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <map>
+#include "facet_index.h"
+
+namespace {
+    std::vector<uint64_t> get_hashes(const facet_index_t& index, uint32_t seq_id) {
+        const uint32_t* ordinals = nullptr;
+        const uint32_t num_ordinals = index.get(seq_id, ordinals);
+
+        std::vector<uint64_t> hashes;
+        for(size_t i = 0; i < num_ordinals; i++) {
+            hashes.push_back(index.get_hash(ordinals[i]));
+        }
+
+        return hashes;
+    }
+
+    std::vector<std::string> get_values(const facet_index_t& index, uint32_t seq_id) {
+        const uint32_t* ordinals = nullptr;
+        const uint32_t num_ordinals = index.get(seq_id, ordinals);
+
+        std::vector<std::string> values;
+        for(size_t i = 0; i < num_ordinals; i++) {
+            values.push_back(index.get_value(ordinals[i], seq_id, i));
+        }
+
+        return values;
+    }
+
+    std::vector<std::string> to_values(const std::vector<uint64_t>& hashes) {
+        std::vector<std::string> values;
+        for(uint64_t hash: hashes) {
+            values.push_back("value " + std::to_string(hash));
+        }
+
+        return values;
+    }
+}
+
+TEST(FacetIndexTest, InsertGetAndErase) {
+    facet_index_t index;
+    std::map<uint32_t, std::vector<uint64_t>> expected;
+    std::mt19937 gen(200);
+
+    // clustered and scattered IDs, with arrays of repeated values and empty arrays
+    for(uint32_t id = 0; id < 6000; id++) {
+        std::vector<uint64_t> hashes;
+        for(size_t i = 0, n = gen() % 4; i < n; i++) {
+            hashes.push_back(1000 + gen() % 50);
+        }
+
+        index.insert(id, hashes, to_values(hashes));
+        expected.emplace(id, hashes);
+    }
+
+    for(size_t i = 0; i < 500; i++) {
+        uint32_t id = gen() % 10000000;
+        index.insert(id, {id}, to_values({id}));
+        expected.emplace(id, std::vector<uint64_t>{id});
+    }
+
+    ASSERT_EQ(expected.size(), index.size());
+
+    // existing values are not overwritten
+    index.insert(10, {1, 2, 3}, to_values({1, 2, 3}));
+    ASSERT_EQ(expected[10], get_hashes(index, 10));
+
+    for(const auto& kv: expected) {
+        ASSERT_TRUE(index.contains(kv.first));
+        ASSERT_EQ(kv.second, get_hashes(index, kv.first));
+        ASSERT_EQ(to_values(kv.second), get_values(index, kv.first));
+    }
+
+    ASSERT_FALSE(index.contains(20000000));
+    ASSERT_TRUE(get_hashes(index, UINT32_MAX).empty());
+
+    // ordinals are dense
+    ASSERT_EQ(index.num_values(), index.num_ordinals());
+
+    uint32_t ordinal = 0;
+    ASSERT_TRUE(index.get_ordinal(1000, ordinal));
+    ASSERT_EQ(1000, index.get_hash(ordinal));
+    ASSERT_EQ("value 1000", index.get_value(ordinal, 0, 0));
+    ASSERT_FALSE(index.get_ordinal(999, ordinal));
+
+    // erase half of the documents, out of ID order
+    std::vector<uint32_t> ids;
+    for(const auto& kv: expected) {
+        ids.push_back(kv.first);
+    }
+
+    std::shuffle(ids.begin(), ids.end(), gen);
+    ids.resize(ids.size() / 2);
+
+    for(uint32_t id: ids) {
+        index.erase(id);
+        expected.erase(id);
+    }
+
+    index.erase(20000000);
+    ASSERT_EQ(expected.size(), index.size());
+
+    for(const auto& kv: expected) {
+        ASSERT_EQ(kv.second, get_hashes(index, kv.first));
+        ASSERT_EQ(to_values(kv.second), get_values(index, kv.first));
+    }
+
+    for(uint32_t id: ids) {
+        ASSERT_FALSE(index.contains(id));
+    }
+
+    // ordinals of values no longer held are released and reused
+    std::map<uint64_t, size_t> value_counts;
+    for(const auto& kv: expected) {
+        for(uint64_t hash: kv.second) {
+            value_counts[hash]++;
+        }
+    }
+
+    ASSERT_EQ(value_counts.size(), index.num_values());
+
+    const size_t num_ordinals = index.num_ordinals();
+    index.insert(20000000, {77777}, {"new value"});
+    ASSERT_EQ(num_ordinals, index.num_ordinals());
+    ASSERT_EQ(std::vector<uint64_t>{77777}, get_hashes(index, 20000000));
+    ASSERT_EQ(std::vector<std::string>{"new value"}, get_values(index, 20000000));
+
+    // values sharing a hash are rendered as their documents have them
+    index.insert(20000001, {77777}, {"New Value"});
+    index.insert(20000002, {77777}, {"New Value"});
+    ASSERT_EQ(std::vector<std::string>{"new value"}, get_values(index, 20000000));
+    ASSERT_EQ(std::vector<std::string>{"New Value"}, get_values(index, 20000001));
+
+    ASSERT_TRUE(index.get_ordinal(77777, ordinal));
+    ASSERT_EQ("New Value", index.get_value(ordinal, 0, 0));
+
+    // a variant is forgotten along with the last document holding it
+    index.erase(20000001);
+    index.erase(20000002);
+    ASSERT_EQ("new value", index.get_value(ordinal, 0, 0));
+
+    index.insert(20000001, {77777}, {"NEW VALUE"});
+    ASSERT_EQ(std::vector<std::string>{"NEW VALUE"}, get_values(index, 20000001));
+    ASSERT_EQ(std::vector<std::string>{"new value"}, get_values(index, 20000000));
+    index.erase(20000001);
+
+    // re-inserting an erased document
+    index.erase(20000000);
+    index.insert(20000000, {5, 6}, to_values({5, 6}));
+    ASSERT_EQ((std::vector<uint64_t>{5, 6}), get_hashes(index, 20000000));
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include "filter_result_cache.h"
+
+static std::shared_ptr<const id_bitmap_t> make_ids(uint32_t num_ids, uint32_t step) {
+    std::vector<uint32_t> ids;
+    for(uint32_t i = 0; i < num_ids; i++) {
+        ids.push_back(i * step);
+    }
+
+    return std::make_shared<const id_bitmap_t>(ids.data(), ids.size());
+}
+
+TEST(FilterResultCacheTest, EntriesAreChargedForTheirIDs) {
+    // sparse IDs are held in arrays and dense ones in bitmaps
+    const size_t sparse_size = make_ids(1000, 50)->size_bytes();
+    const size_t dense_size = make_ids(60000, 1)->size_bytes();
+    ASSERT_GT(dense_size, 8 * 1024);
+    ASSERT_LT(sparse_size, dense_size);
+
+    filter_result_cache_t cache(3 * dense_size);
+
+    cache.put("a", {1}, make_ids(60000, 1));
+    cache.put("b", {1}, make_ids(60000, 1));
+    cache.put("c", {1}, make_ids(60000, 1));
+    ASSERT_EQ(2, cache.num_entries());
+
+    cache.put("d", {1}, make_ids(1000, 50));
+    ASSERT_EQ(3, cache.num_entries());
+
+    auto cached_ids = cache.get("d", {1});
+    ASSERT_NE(nullptr, cached_ids);
+    ASSERT_EQ(1000, cached_ids->cardinality());
+    ASSERT_TRUE(cached_ids->contains(49950));
+
+    // results larger than the cache are not held
+    cache.put("e", {1}, make_ids(60000 * 4, 1));
+    ASSERT_EQ(nullptr, cache.get("e", {1}));
+}
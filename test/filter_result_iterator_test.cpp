@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <algorithm>
+#include "filter_result_iterator.h"
+
+namespace {
+    std::vector<uint32_t> random_ids(std::mt19937& gen, size_t count, uint32_t max_id) {
+        std::uniform_int_distribution<uint32_t> dist(0, max_id);
+        std::set<uint32_t> ids;
+        while(ids.size() < count) {
+            ids.insert(dist(gen));
+        }
+        return std::vector<uint32_t>(ids.begin(), ids.end());
+    }
+
+    void* make_posting(const std::vector<uint32_t>& ids) {
+        uint32_t offset_index = 0, offset = 0;
+        void* obj = SET_COMPACT_POSTING(compact_posting_list_t::create(1, &ids[0], &offset_index, 1, &offset));
+        for(size_t i = 1; i < ids.size(); i++) {
+            posting_t::upsert(obj, ids[i], {0});
+        }
+        return obj;
+    }
+
+    void* make_id_list(const std::vector<uint32_t>& ids) {
+        void* obj = SET_COMPACT_IDS(compact_id_list_t::create(1, {ids[0]}));
+        for(size_t i = 1; i < ids.size(); i++) {
+            ids_t::upsert(obj, ids[i]);
+        }
+        return obj;
+    }
+
+    std::vector<uint32_t> to_vector(filter_result_iterator_t& it) {
+        std::vector<uint32_t> ids;
+        for(it.reset(); it.valid(); it.next()) {
+            ids.push_back(it.id());
+        }
+        return ids;
+    }
+}
+
+TEST(FilterResultIteratorTest, LeavesAndNodes) {
+    std::mt19937 gen(9281);
+
+    auto a_ids = random_ids(gen, 5000, 50000);
+    auto b_ids = random_ids(gen, 20000, 50000);
+    auto c_ids = random_ids(gen, 15, 50000);
+    auto d_ids = random_ids(gen, 3000, 50000);
+
+    void* a_posting = make_posting(a_ids);
+    void* c_posting = make_posting(c_ids);
+    void* b_id_list = make_id_list(b_ids);
+
+    ASSERT_FALSE(IS_COMPACT_POSTING(a_posting));
+    ASSERT_TRUE(IS_COMPACT_POSTING(c_posting));
+    ASSERT_FALSE(IS_COMPACT_IDS(b_id_list));
+
+    auto a_leaf = filter_result_iterator_t::posting_leaf(a_posting);
+    ASSERT_EQ(filter_result_iterator_t::POSTING_LEAF, a_leaf.get_type());
+    ASSERT_EQ(a_ids, to_vector(a_leaf));
+
+    auto c_leaf = filter_result_iterator_t::posting_leaf(c_posting);
+    ASSERT_EQ(filter_result_iterator_t::IDS_LEAF, c_leaf.get_type());
+    ASSERT_EQ(c_ids, to_vector(c_leaf));
+
+    // (a AND b) OR c OR d
+    std::vector<filter_result_iterator_t> and_children;
+    and_children.push_back(filter_result_iterator_t::posting_leaf(a_posting));
+    and_children.push_back(filter_result_iterator_t::id_list_leaf(b_id_list));
+
+    std::vector<filter_result_iterator_t> or_children;
+    or_children.push_back(filter_result_iterator_t::and_node(std::move(and_children)));
+    or_children.push_back(filter_result_iterator_t::posting_leaf(c_posting));
+    or_children.push_back(filter_result_iterator_t::ids_leaf(std::vector<uint32_t>(d_ids)));
+
+    auto root = filter_result_iterator_t::or_node(std::move(or_children));
+
+    std::vector<uint32_t> a_and_b, expected;
+    std::set_intersection(a_ids.begin(), a_ids.end(), b_ids.begin(), b_ids.end(), std::back_inserter(a_and_b));
+    std::set<uint32_t> expected_set(a_and_b.begin(), a_and_b.end());
+    expected_set.insert(c_ids.begin(), c_ids.end());
+    expected_set.insert(d_ids.begin(), d_ids.end());
+    expected.assign(expected_set.begin(), expected_set.end());
+
+    ASSERT_EQ(expected, to_vector(root));
+    ASSERT_EQ(std::min(a_ids.size(), b_ids.size()) + c_ids.size() + d_ids.size(), root.approx_cardinality());
+
+    // probes in random order
+    root.reset();
+    std::uniform_int_distribution<uint32_t> dist(0, 50001);
+    for(size_t i = 0; i < 2000; i++) {
+        uint32_t id = dist(gen);
+        ASSERT_EQ(expected_set.count(id) != 0, root.contains(id));
+    }
+
+    // ascending probes after a skip
+    root.reset();
+    root.skip_to(25000);
+    ASSERT_EQ(*std::lower_bound(expected.begin(), expected.end(), 25000), root.id());
+    for(uint32_t id = 25000; id < 26000; id++) {
+        ASSERT_EQ(expected_set.count(id) != 0, root.contains(id));
+    }
+
+    // smaller probes are looked up without rewinding the iterator
+    const uint32_t position = root.id();
+    for(uint32_t id = 0; id < 1000; id++) {
+        ASSERT_EQ(expected_set.count(id) != 0, root.contains(id));
+    }
+    ASSERT_EQ(position, root.id());
+
+    // a posting list whose only matching document is before the position of the iterator
+    std::set<uint32_t> before_set = {expected[0]};
+    for(uint32_t id = 0; id < 20000 && before_set.size() < 500; id++) {
+        if(expected_set.count(id) == 0) {
+            before_set.insert(id);
+        }
+    }
+
+    void* before_posting = make_posting(std::vector<uint32_t>(before_set.begin(), before_set.end()));
+    ASSERT_FALSE(IS_COMPACT_POSTING(before_posting));
+    ASSERT_TRUE(root.contains_atleast_one(before_posting));
+    ASSERT_EQ(position, root.id());
+
+    // posting lists with and without any matching document
+    ASSERT_TRUE(root.contains_atleast_one(a_posting));
+    ASSERT_TRUE(root.contains_atleast_one(c_posting));
+
+    auto outside_ids = random_ids(gen, 500, 1000);
+    for(auto& id: outside_ids) {
+        id += 60000;
+    }
+
+    void* outside_posting = make_posting(outside_ids);
+    ASSERT_FALSE(root.contains_atleast_one(outside_posting));
+    ASSERT_TRUE(root.contains(expected[0]));
+
+    posting_t::destroy_list(a_posting);
+    posting_t::destroy_list(c_posting);
+    posting_t::destroy_list(outside_posting);
+    posting_t::destroy_list(before_posting);
+    ids_t::destroy_list(b_id_list);
+}
+
+TEST(FilterResultIteratorTest, EmptyNodes) {
+    auto empty_leaf = filter_result_iterator_t::ids_leaf({});
+    ASSERT_FALSE(empty_leaf.valid());
+    ASSERT_FALSE(empty_leaf.contains(0));
+
+    std::vector<filter_result_iterator_t> children;
+    children.push_back(filter_result_iterator_t::ids_leaf({1, 5, 9}));
+    children.push_back(filter_result_iterator_t::ids_leaf({2, 6, 10}));
+
+    auto disjoint = filter_result_iterator_t::and_node(std::move(children));
+    ASSERT_FALSE(disjoint.valid());
+    ASSERT_FALSE(disjoint.contains(5));
+
+    auto no_children = filter_result_iterator_t::or_node({});
+    ASSERT_FALSE(no_children.valid());
+    ASSERT_EQ(0, no_children.approx_cardinality());
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <algorithm>
+#include "id_bitmap.h"
+
+namespace {
+    std::vector<uint32_t> random_ids(std::mt19937& gen, size_t count, uint32_t max_id) {
+        std::uniform_int_distribution<uint32_t> dist(0, max_id);
+        std::set<uint32_t> ids;
+        while(ids.size() < count) {
+            ids.insert(dist(gen));
+        }
+        return std::vector<uint32_t>(ids.begin(), ids.end());
+    }
+
+    std::vector<uint32_t> to_vector(const id_bitmap_t& bitmap) {
+        std::vector<uint32_t> ids(bitmap.cardinality());
+        bitmap.uncompress(ids.data());
+        return ids;
+    }
+}
+
+TEST(IdBitmapTest, AddAndContains) {
+    id_bitmap_t bitmap;
+    ASSERT_TRUE(bitmap.empty());
+
+    bitmap.add(10);
+    bitmap.add(5);
+    bitmap.add(70000);
+    bitmap.add(10);
+    bitmap.add(3);
+
+    ASSERT_EQ(4, bitmap.cardinality());
+    ASSERT_EQ(2, bitmap.num_containers());
+
+    ASSERT_TRUE(bitmap.contains(3));
+    ASSERT_TRUE(bitmap.contains(5));
+    ASSERT_TRUE(bitmap.contains(10));
+    ASSERT_TRUE(bitmap.contains(70000));
+    ASSERT_FALSE(bitmap.contains(4));
+    ASSERT_FALSE(bitmap.contains(70001));
+    ASSERT_FALSE(bitmap.contains(200000));
+
+    std::vector<uint32_t> expected = {3, 5, 10, 70000};
+    ASSERT_EQ(expected, to_vector(bitmap));
+}
+
+TEST(IdBitmapTest, ContainerFormDependsOnCardinality) {
+    std::vector<uint32_t> ids;
+    for(uint32_t i = 0; i < id_bitmap_t::ARRAY_CONTAINER_MAX; i++) {
+        ids.push_back(i * 2);
+    }
+
+    id_bitmap_t sparse(ids.data(), ids.size());
+    ASSERT_EQ(1, sparse.num_containers());
+    ASSERT_FALSE(sparse.get_containers()[0].is_bitmap());
+
+    ids.push_back(ids.back() + 1);
+    id_bitmap_t dense(ids.data(), ids.size());
+    ASSERT_TRUE(dense.get_containers()[0].is_bitmap());
+    ASSERT_EQ(ids, to_vector(dense));
+
+    // appending past the threshold converts the container
+    sparse.add(ids.back());
+    ASSERT_TRUE(sparse.get_containers()[0].is_bitmap());
+    ASSERT_EQ(ids, to_vector(sparse));
+
+    // excluding most of the values turns the container back into an array
+    id_bitmap_t filter(ids.data() + 10, ids.size() - 10);
+    id_bitmap_t result;
+    id_bitmap_t::exclude(dense, filter, result);
+    ASSERT_EQ(10, result.cardinality());
+    ASSERT_FALSE(result.get_containers()[0].is_bitmap());
+    ASSERT_EQ(std::vector<uint32_t>(ids.begin(), ids.begin() + 10), to_vector(result));
+}
+
+TEST(IdBitmapTest, SetOperationsMatchSortedArrays) {
+    std::mt19937 gen(137723);
+
+    // mix of sparse and dense chunks
+    const std::vector<std::pair<size_t, uint32_t>> shapes = {
+        {100, 1000000}, {5000, 70000}, {60000, 200000}, {20000, 20000}, {0, 100}
+    };
+
+    for(const auto& shape_a: shapes) {
+        for(const auto& shape_b: shapes) {
+            auto a_ids = random_ids(gen, shape_a.first, shape_a.second);
+            auto b_ids = random_ids(gen, shape_b.first, shape_b.second);
+
+            id_bitmap_t a(a_ids.data(), a_ids.size());
+            id_bitmap_t b(b_ids.data(), b_ids.size());
+
+            std::vector<uint32_t> expected;
+            id_bitmap_t result;
+
+            std::set_intersection(a_ids.begin(), a_ids.end(), b_ids.begin(), b_ids.end(),
+                                  std::back_inserter(expected));
+            id_bitmap_t::intersect(a, b, result);
+            ASSERT_EQ(expected.size(), result.cardinality());
+            ASSERT_EQ(expected, to_vector(result));
+
+            expected.clear();
+            std::set_union(a_ids.begin(), a_ids.end(), b_ids.begin(), b_ids.end(), std::back_inserter(expected));
+            id_bitmap_t::merge(a, b, result);
+            ASSERT_EQ(expected.size(), result.cardinality());
+            ASSERT_EQ(expected, to_vector(result));
+
+            expected.clear();
+            std::set_difference(a_ids.begin(), a_ids.end(), b_ids.begin(), b_ids.end(),
+                                std::back_inserter(expected));
+            id_bitmap_t::exclude(a, b, result);
+            ASSERT_EQ(expected.size(), result.cardinality());
+            ASSERT_EQ(expected, to_vector(result));
+        }
+    }
+}
+
+TEST(IdBitmapTest, IterationAndSelect) {
+    std::mt19937 gen(42);
+    auto ids = random_ids(gen, 30000, 300000);
+    id_bitmap_t bitmap(ids.data(), ids.size());
+
+    size_t i = 0;
+    for(auto it = bitmap.new_iterator(); it.valid(); it.next()) {
+        ASSERT_EQ(ids[i++], it.id());
+    }
+    ASSERT_EQ(ids.size(), i);
+
+    for(size_t rank = 0; rank < ids.size(); rank += 997) {
+        ASSERT_EQ(ids[rank], bitmap.select(rank));
+    }
+
+    auto it = bitmap.new_iterator();
+    for(uint32_t target: {0u, 5000u, 65535u, 65536u, 150001u, 299999u}) {
+        it.skip_to(target);
+        auto expected = std::lower_bound(ids.begin(), ids.end(), target);
+        if(expected == ids.end()) {
+            ASSERT_FALSE(it.valid());
+        } else {
+            ASSERT_TRUE(it.valid());
+            ASSERT_EQ(*expected, it.id());
+        }
+    }
+
+    it.skip_to(400000);
+    ASSERT_FALSE(it.valid());
+}
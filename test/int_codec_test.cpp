@@ -0,0 +1,269 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <fstream>
+#include <chrono>
+#include <unordered_map>
+#include <sstream>
+#include "int_codec.h"
+#include "json.hpp"
+#include "logger.h"
+
+namespace {
+    template<class codec_t>
+    void assert_sorted_codec(const std::vector<uint32_t>& values) {
+        const uint32_t length = values.size();
+
+        std::vector<uint8_t> buf(codec_t::size_sorted(values.data(), length) + 16);
+        codec_t::compress_sorted(values.data(), buf.data(), length);
+
+        std::vector<uint32_t> decoded(length);
+        codec_t::uncompress(buf.data(), decoded.data(), length);
+        ASSERT_EQ(values, decoded);
+
+        for(uint32_t i = 0; i < length; i += 7) {
+            ASSERT_EQ(values[i], codec_t::select(buf.data(), length, i));
+
+            uint32_t actual = 0;
+            ASSERT_EQ(i, codec_t::lower_bound(buf.data(), length, values[i], &actual));
+            ASSERT_EQ(values[i], actual);
+
+            if(i != 0 && values[i] - values[i-1] > 1) {
+                ASSERT_EQ(i, codec_t::lower_bound(buf.data(), length, values[i] - 1, &actual));
+                ASSERT_EQ(values[i], actual);
+            }
+        }
+
+        // appends, growing the buffer as the codec asks for
+        std::vector<uint8_t> appended(METADATA_OVERHEAD + 8, 0);
+        uint32_t min = UINT32_MAX, max = 0;
+
+        for(uint32_t i = 0; i < length; i++) {
+            uint32_t size = codec_t::append_size_sorted(appended.data(), i, min, max, values[i]);
+            if(appended.size() < size + 16) {
+                appended.resize(size + 16);
+            }
+
+            ASSERT_NE(0, codec_t::append_sorted(appended.data(), i, max, values[i]));
+            min = std::min(min, values[i]);
+            max = std::max(max, values[i]);
+        }
+
+        std::fill(decoded.begin(), decoded.end(), 0);
+        codec_t::uncompress(appended.data(), decoded.data(), length);
+        ASSERT_EQ(values, decoded);
+    }
+
+    template<class codec_t>
+    void assert_unsorted_codec(const std::vector<uint32_t>& values) {
+        const uint32_t length = values.size();
+        uint32_t min = UINT32_MAX, max = 0;
+        for(auto v: values) {
+            min = std::min(min, v);
+            max = std::max(max, v);
+        }
+
+        std::vector<uint8_t> buf(codec_t::size_unsorted(values.data(), length, min, max) + 16);
+        codec_t::compress_unsorted(values.data(), buf.data(), length);
+
+        std::vector<uint32_t> decoded(length);
+        codec_t::uncompress(buf.data(), decoded.data(), length);
+        ASSERT_EQ(values, decoded);
+
+        for(uint32_t i = 0; i < length; i += 7) {
+            ASSERT_EQ(values[i], codec_t::select(buf.data(), length, i));
+            uint32_t index = codec_t::linear_search(buf.data(), length, values[i]);
+            ASSERT_EQ(values[i], values[index]);
+        }
+
+        std::vector<uint8_t> appended(METADATA_OVERHEAD + 8, 0);
+        min = UINT32_MAX, max = 0;
+
+        for(uint32_t i = 0; i < length; i++) {
+            uint32_t size = codec_t::append_size_unsorted(appended.data(), i, min, max, values[i]);
+            if(appended.size() < size + 16) {
+                appended.resize(size + 16);
+            }
+
+            ASSERT_NE(0, codec_t::append_unsorted(appended.data(), i, values[i]));
+            min = std::min(min, values[i]);
+            max = std::max(max, values[i]);
+        }
+
+        std::fill(decoded.begin(), decoded.end(), 0);
+        codec_t::uncompress(appended.data(), decoded.data(), length);
+        ASSERT_EQ(values, decoded);
+    }
+
+    std::vector<uint32_t> sorted_values(std::mt19937& gen, size_t count, uint32_t max_value) {
+        std::uniform_int_distribution<uint32_t> dist(0, max_value);
+        std::set<uint32_t> values;
+        while(values.size() < count) {
+            values.insert(dist(gen));
+        }
+        return std::vector<uint32_t>(values.begin(), values.end());
+    }
+}
+
+TEST(IntCodecTest, SortedCodecs) {
+    std::mt19937 gen(1337);
+
+    for(size_t count: {1, 2, 3, 4, 5, 127, 128, 129, 255, 256, 1000}) {
+        // dense, sparse and full width deltas
+        for(uint32_t max_value: {uint32_t(count * 2), uint32_t(count * 1000), UINT32_MAX}) {
+            auto values = sorted_values(gen, count, max_value);
+            assert_sorted_codec<for_codec_t>(values);
+            assert_sorted_codec<bp128_codec_t>(values);
+        }
+    }
+
+    // deltas that widen within a block
+    std::vector<uint32_t> widening;
+    for(uint32_t i = 0; i < 300; i++) {
+        widening.push_back(i * i * i);
+    }
+    assert_sorted_codec<bp128_codec_t>(widening);
+
+    // past the last value
+    auto values = sorted_values(gen, 200, 5000);
+    std::vector<uint8_t> buf(bp128_codec_t::size_sorted(values.data(), values.size()));
+    bp128_codec_t::compress_sorted(values.data(), buf.data(), values.size());
+
+    uint32_t actual = 0;
+    ASSERT_EQ(values.size(), bp128_codec_t::lower_bound(buf.data(), values.size(), values.back() + 1, &actual));
+    ASSERT_EQ(values.back(), actual);
+}
+
+TEST(IntCodecTest, UnsortedCodecs) {
+    std::mt19937 gen(7331);
+
+    for(size_t count: {1, 2, 3, 4, 5, 15, 16, 17, 100, 1001}) {
+        for(uint32_t max_value: {uint32_t(200), uint32_t(70000), UINT32_MAX}) {
+            std::uniform_int_distribution<uint32_t> dist(0, max_value);
+            std::vector<uint32_t> values;
+            for(size_t i = 0; i < count; i++) {
+                values.push_back(dist(gen));
+            }
+
+            assert_unsorted_codec<for_codec_t>(values);
+            assert_unsorted_codec<stream_vbyte_codec_t>(values);
+        }
+    }
+}
+
+namespace {
+    template<class codec_t>
+    void benchmark_sorted(const std::string& name, const std::vector<std::vector<uint32_t>>& lists, size_t rounds) {
+        std::vector<std::vector<uint8_t>> encoded;
+        size_t num_values = 0, num_bytes = 0, max_length = 0;
+
+        for(const auto& list: lists) {
+            encoded.emplace_back(codec_t::size_sorted(list.data(), list.size()) + 16);
+            num_bytes += codec_t::compress_sorted(list.data(), encoded.back().data(), list.size());
+            num_values += list.size();
+            max_length = std::max(max_length, list.size());
+        }
+
+        std::vector<uint32_t> out(max_length + 4);
+        auto begin = std::chrono::high_resolution_clock::now();
+
+        for(size_t r = 0; r < rounds; r++) {
+            for(size_t i = 0; i < lists.size(); i++) {
+                codec_t::uncompress(encoded[i].data(), out.data(), lists[i].size());
+            }
+        }
+
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - begin).count();
+
+        LOG(INFO) << name << ": " << (double(num_bytes) / num_values) << " bytes per value, "
+                  << (double(num_values) * rounds / std::max<long long>(micros, 1)) << " million values decoded/s";
+    }
+
+    template<class codec_t>
+    void benchmark_unsorted(const std::string& name, const std::vector<std::vector<uint32_t>>& lists, size_t rounds) {
+        std::vector<std::vector<uint8_t>> encoded;
+        size_t num_values = 0, num_bytes = 0, max_length = 0;
+
+        for(const auto& list: lists) {
+            uint32_t min = *std::min_element(list.begin(), list.end());
+            uint32_t max = *std::max_element(list.begin(), list.end());
+            encoded.emplace_back(codec_t::size_unsorted(list.data(), list.size(), min, max) + 16);
+            num_bytes += codec_t::compress_unsorted(list.data(), encoded.back().data(), list.size());
+            num_values += list.size();
+            max_length = std::max(max_length, list.size());
+        }
+
+        std::vector<uint32_t> out(max_length + 4);
+        auto begin = std::chrono::high_resolution_clock::now();
+
+        for(size_t r = 0; r < rounds; r++) {
+            for(size_t i = 0; i < lists.size(); i++) {
+                codec_t::uncompress(encoded[i].data(), out.data(), lists[i].size());
+            }
+        }
+
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - begin).count();
+
+        LOG(INFO) << name << ": " << (double(num_bytes) / num_values) << " bytes per value, "
+                  << (double(num_values) * rounds / std::max<long long>(micros, 1)) << " million values decoded/s";
+    }
+}
+
+TEST(IntCodecTest, DISABLED_Benchmark) {
+    // postings of the title words of the test documents, replicated into a larger corpus
+    const size_t NUM_COPIES = 5000;
+    const size_t BLOCK_SIZE = 256;
+
+    std::vector<std::string> titles;
+    std::ifstream infile(std::string(ROOT_DIR)+"test/documents.jsonl");
+    std::string json_line;
+    while(std::getline(infile, json_line)) {
+        titles.push_back(nlohmann::json::parse(json_line)["title"].get<std::string>());
+    }
+
+    std::unordered_map<std::string, std::vector<uint32_t>> token_ids;
+    std::unordered_map<std::string, std::vector<uint32_t>> token_offsets;
+    std::mt19937 gen(42);
+
+    uint32_t seq_id = 0;
+    for(size_t copy = 0; copy < NUM_COPIES; copy++) {
+        for(const auto& title: titles) {
+            seq_id += 1 + (gen() % 4);
+            std::istringstream stream(title);
+            std::string token;
+            uint32_t position = 0;
+
+            while(stream >> token) {
+                auto& ids = token_ids[token];
+                if(ids.empty() || ids.back() != seq_id) {
+                    ids.push_back(seq_id);
+                }
+                token_offsets[token].push_back(position++);
+            }
+        }
+    }
+
+    // split into the blocks of a posting list
+    std::vector<std::vector<uint32_t>> id_blocks, offset_blocks;
+    for(const auto& kv: token_ids) {
+        for(size_t i = 0; i < kv.second.size(); i += BLOCK_SIZE) {
+            size_t end = std::min(kv.second.size(), i + BLOCK_SIZE);
+            id_blocks.emplace_back(kv.second.begin() + i, kv.second.begin() + end);
+        }
+
+        const auto& offsets = token_offsets[kv.first];
+        for(size_t i = 0; i < offsets.size(); i += BLOCK_SIZE) {
+            size_t end = std::min(offsets.size(), i + BLOCK_SIZE);
+            offset_blocks.emplace_back(offsets.begin() + i, offsets.begin() + end);
+        }
+    }
+
+    LOG(INFO) << "Tokens: " << token_ids.size() << ", id blocks: " << id_blocks.size();
+
+    benchmark_sorted<for_codec_t>("ids, frame of reference", id_blocks, 100);
+    benchmark_sorted<bp128_codec_t>("ids, bp128", id_blocks, 100);
+    benchmark_unsorted<for_codec_t>("offsets, frame of reference", offset_blocks, 100);
+    benchmark_unsorted<stream_vbyte_codec_t>("offsets, stream vbyte", offset_blocks, 100);
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include <art.h>
 #include "num_tree.h"
+#include <random>
+#include <map>
+#include <set>
 
 TEST(NumTreeTest, Searches) {
     num_tree_t tree;
@@ -72,3 +75,124 @@ TEST(NumTreeTest, EraseFullList) {
     tree.search(NUM_COMPARATOR::EQUALS, 0, &ids, ids_len);
     ASSERT_EQ(nullptr, ids);
 }
+
+TEST(NumTreeTest, RangeSearchesAcrossBuckets) {
+    num_tree_t tree;
+    std::map<int64_t, std::set<uint32_t>> expected;
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int64_t> value_dist(-5000, 5000);
+
+    // multi-valued documents, with enough distinct values to need many buckets
+    for(uint32_t id = 0; id < 3000; id++) {
+        for(size_t i = 0; i < 3; i++) {
+            int64_t value = value_dist(gen);
+            tree.insert(value, id);
+            expected[value].insert(id);
+        }
+    }
+
+    // erase some of the documents from some of their values
+    for(uint32_t id = 0; id < 3000; id += 7) {
+        for(auto& kv: expected) {
+            if(kv.second.count(id) != 0 && (kv.first % 2 == 0)) {
+                tree.remove(kv.first, id);
+                kv.second.erase(id);
+            }
+        }
+    }
+
+    for(auto it = expected.begin(); it != expected.end();) {
+        it = it->second.empty() ? expected.erase(it) : std::next(it);
+    }
+
+    ASSERT_EQ(expected.size(), tree.size());
+
+    auto expected_ids = [&](int64_t start, int64_t end) {
+        std::set<uint32_t> ids;
+        for(auto it = expected.lower_bound(start); it != expected.end() && it->first <= end; it++) {
+            ids.insert(it->second.begin(), it->second.end());
+        }
+        return std::vector<uint32_t>(ids.begin(), ids.end());
+    };
+
+    std::vector<std::pair<int64_t, int64_t>> ranges = {
+        {-5000, 5000}, {-10, 10}, {0, 0}, {-4999, -4000}, {100, 2500}, {4990, 6000}, {6000, 7000}, {10, 5}
+    };
+
+    for(const auto& range: ranges) {
+        uint32_t* ids = nullptr;
+        size_t ids_len = 0;
+        tree.range_inclusive_search(range.first, range.second, &ids, ids_len);
+        ASSERT_EQ(expected_ids(range.first, range.second), std::vector<uint32_t>(ids, ids + ids_len));
+        delete [] ids;
+    }
+
+    uint32_t* ids = nullptr;
+    size_t ids_len = 0;
+
+    tree.search(NUM_COMPARATOR::GREATER_THAN, 1000, &ids, ids_len);
+    ASSERT_EQ(expected_ids(1001, INT64_MAX), std::vector<uint32_t>(ids, ids + ids_len));
+    delete [] ids;
+    ids = nullptr;
+    ids_len = 0;
+
+    tree.search(NUM_COMPARATOR::LESS_THAN, -1000, &ids, ids_len);
+    ASSERT_EQ(expected_ids(INT64_MIN, -1001), std::vector<uint32_t>(ids, ids + ids_len));
+    delete [] ids;
+    ids = nullptr;
+    ids_len = 0;
+
+    // results are OR-ed into the given IDs
+    tree.range_inclusive_search(-10, -5, &ids, ids_len);
+    tree.range_inclusive_search(5, 10, &ids, ids_len);
+    auto low_ids = expected_ids(-10, -5), high_ids = expected_ids(5, 10);
+    std::set<uint32_t> both(low_ids.begin(), low_ids.end());
+    both.insert(high_ids.begin(), high_ids.end());
+    ASSERT_EQ(std::vector<uint32_t>(both.begin(), both.end()), std::vector<uint32_t>(ids, ids + ids_len));
+    delete [] ids;
+
+    for(const auto& kv: expected) {
+        void* value_ids = tree.get_ids(kv.first);
+        ASSERT_NE(nullptr, value_ids);
+        ASSERT_EQ(kv.second.size(), ids_t::num_ids(value_ids));
+    }
+}
+
+TEST(NumTreeTest, WalkInValueOrder) {
+    num_tree_t tree;
+    std::map<int64_t, std::vector<uint32_t>> expected;
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int64_t> value_dist(-2000, 2000);
+
+    for(uint32_t id = 0; id < 3000; id++) {
+        int64_t value = value_dist(gen);
+        tree.insert(value, id);
+        expected[value].push_back(id);
+    }
+
+    std::vector<std::pair<int64_t, std::vector<uint32_t>>> walked;
+    tree.walk(false, [&](int64_t value, void* ids) {
+        std::vector<uint32_t> value_ids;
+        ids_t::uncompress(ids, value_ids);
+        walked.emplace_back(value, value_ids);
+        return true;
+    });
+
+    using value_ids_t = std::vector<std::pair<int64_t, std::vector<uint32_t>>>;
+    ASSERT_EQ(value_ids_t(expected.begin(), expected.end()), walked);
+
+    // stops when asked to
+    std::vector<int64_t> walked_values;
+    tree.walk(true, [&](int64_t value, void* ids) {
+        walked_values.push_back(value);
+        return walked_values.size() < 300;
+    });
+
+    ASSERT_EQ(300, walked_values.size());
+
+    auto expected_it = expected.rbegin();
+    for(int64_t value: walked_values) {
+        ASSERT_EQ(expected_it->first, value);
+        expected_it++;
+    }
+}
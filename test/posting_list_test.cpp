@@ -3,6 +3,8 @@
 #include "array_utils.h"
 #include <chrono>
 #include <vector>
+#include <random>
+#include <set>
 
 class PostingListTest : public ::testing::Test {
 protected:
@@ -1540,3 +1542,218 @@ TEST_F(PostingListTest, DISABLED_BenchmarkIntersection) {
     LOG(INFO) << "Sorted array result len: " << abc_len;
     LOG(INFO) << "Time taken for sorted array intersection: " << timeMicros;
 }
+
+TEST_F(PostingListTest, BlockIntersectionOfManyLists) {
+    std::mt19937 gen(52731);
+    std::vector<uint32_t> offsets = {0, 1, 3};
+
+    for(size_t num_lists = 2; num_lists <= 5; num_lists++) {
+        std::vector<std::set<uint32_t>> id_sets(num_lists);
+        std::vector<posting_list_t*> plists;
+
+        for(size_t i = 0; i < num_lists; i++) {
+            // skewed list sizes exercise both the SIMD and the galloping paths
+            const size_t num_ids = (i == 0) ? 200 : 2000 * i;
+            while(id_sets[i].size() < num_ids) {
+                id_sets[i].insert(gen() % 20000);
+            }
+
+            posting_list_t* pl = new posting_list_t(i % 2 == 0 ? 4 : 256);
+            for(auto id: id_sets[i]) {
+                pl->upsert(id, offsets);
+            }
+
+            plists.push_back(pl);
+        }
+
+        std::vector<uint32_t> expected(id_sets[0].begin(), id_sets[0].end());
+        for(size_t i = 1; i < num_lists; i++) {
+            std::vector<uint32_t> next;
+            std::set_intersection(expected.begin(), expected.end(), id_sets[i].begin(), id_sets[i].end(),
+                                  std::back_inserter(next));
+            expected = next;
+        }
+
+        std::vector<uint32_t> result_ids;
+        posting_list_t::intersect(plists, result_ids);
+        ASSERT_EQ(expected, result_ids);
+
+        std::vector<void*> raw_posting_lists(plists.begin(), plists.end());
+        result_iter_state_t iter_state;
+        std::vector<uint32_t> block_result_ids;
+
+        posting_t::block_intersector_t(raw_posting_lists, iter_state)
+        .intersect([&](auto seq_id, auto& its) {
+            for(const auto& it: its) {
+                ASSERT_EQ(seq_id, it.id());
+            }
+            block_result_ids.push_back(seq_id);
+        });
+
+        ASSERT_EQ(expected, block_result_ids);
+
+        for(auto pl: plists) {
+            delete pl;
+        }
+    }
+}
+
+TEST_F(PostingListTest, ParallelBlockIntersection) {
+    std::mt19937 gen(1107);
+    std::vector<uint32_t> offsets = {0, 1, 3};
+
+    std::vector<std::set<uint32_t>> id_sets(3);
+    std::vector<posting_list_t*> plists;
+
+    for(size_t i = 0; i < id_sets.size(); i++) {
+        while(id_sets[i].size() < 3000 * (i + 1)) {
+            id_sets[i].insert(gen() % 30000);
+        }
+
+        posting_list_t* pl = new posting_list_t(i == 1 ? 16 : 64);
+        for(auto id: id_sets[i]) {
+            pl->upsert(id, offsets);
+        }
+
+        plists.push_back(pl);
+    }
+
+    std::vector<uint32_t> expected;
+    posting_list_t::intersect(plists, expected);
+
+    std::vector<void*> raw_posting_lists(plists.begin(), plists.end());
+
+    for(size_t concurrency: {1, 3, 4, 16}) {
+        result_iter_state_t iter_state;
+        std::vector<std::vector<uint32_t>> range_ids(concurrency);
+
+        posting_t::block_intersector_t(raw_posting_lists, iter_state, pool)
+        .intersect([&](auto seq_id, auto& its, size_t range_index) {
+            for(const auto& it: its) {
+                ASSERT_EQ(seq_id, it.id());
+            }
+            range_ids[range_index].push_back(seq_id);
+        }, concurrency);
+
+        // ranges are disjoint and ordered
+        std::vector<uint32_t> result_ids;
+        for(const auto& ids: range_ids) {
+            result_ids.insert(result_ids.end(), ids.begin(), ids.end());
+        }
+
+        ASSERT_EQ(expected, result_ids);
+    }
+
+    // iterators restricted to a range of blocks don't skip past it
+    auto start_block = plists[0]->get_root()->next;
+    auto end_block = start_block->next->next;
+    auto it = plists[0]->new_iterator(start_block, end_block);
+    it.skip_to(start_block->next->ids.at(1));
+    ASSERT_TRUE(it.valid());
+    ASSERT_EQ(start_block->next->ids.at(1), it.id());
+    it.skip_to(end_block->ids.at(0));
+    ASSERT_FALSE(it.valid());
+
+    for(auto pl: plists) {
+        delete pl;
+    }
+}
+
+TEST_F(PostingListTest, BlockScoreBounds) {
+    std::vector<uint32_t> offsets = {0, 1, 3};
+    std::vector<uint32_t> verbatim_offsets = {1, 0};
+
+    posting_list_t pl(4);
+
+    for(size_t i = 0; i < 12; i++) {
+        pl.upsert(i, offsets, i * 10);
+    }
+
+    // [0..3], [4..7], [8..11]
+    ASSERT_EQ(3, pl.num_blocks());
+    ASSERT_EQ(30, pl.get_root()->max_score);
+    ASSERT_EQ(70, pl.block_of(5)->max_score);
+    ASSERT_EQ(110, pl.block_of(11)->max_score);
+    ASSERT_FALSE(pl.block_of(11)->has_verbatim_match);
+
+    // updating a document only widens the bounds
+    pl.upsert(9, verbatim_offsets, 500);
+    pl.upsert(9, offsets, 5);
+    ASSERT_EQ(500, pl.block_of(9)->max_score);
+    ASSERT_TRUE(pl.block_of(9)->has_verbatim_match);
+
+    // split: both halves retain the bounds of the block that was split
+    pl.upsert(2, offsets, 2);
+    pl.upsert(13, offsets, 1);
+    pl.upsert(1, offsets, 1);
+
+    for(auto it = pl.new_iterator(); it.valid(); it.next()) {
+        ASSERT_GE(it.block()->max_score, int64_t(it.id() * 10));
+    }
+
+    // without a score, the block can never be skipped
+    pl.upsert(100, offsets);
+    ASSERT_EQ(posting_list_t::UNKNOWN_SCORE, pl.block_of(100)->max_score);
+
+    // merging of blocks on erase widens the surviving block
+    for(uint32_t id: {8, 10, 11, 13, 100}) {
+        pl.erase(id);
+    }
+
+    ASSERT_LE(500, pl.block_of(9)->max_score);
+    ASSERT_TRUE(pl.block_of(9)->has_verbatim_match);
+
+    // array offsets: [pos, pos, array_index, last_token_marker]
+    std::vector<uint32_t> array_verbatim_offsets = {1, 1, 0, 0};
+    ASSERT_TRUE(posting_list_t::is_verbatim_match(&array_verbatim_offsets[0], array_verbatim_offsets.size(), true));
+    ASSERT_FALSE(posting_list_t::is_verbatim_match(&offsets[0], offsets.size(), false));
+    ASSERT_TRUE(posting_list_t::is_verbatim_match(&verbatim_offsets[0], verbatim_offsets.size(), false));
+}
+
+TEST_F(PostingListTest, IteratorReusesDecodeBuffers) {
+    std::vector<uint32_t> offsets = {0, 1, 3};
+    posting_list_t pl(4);
+
+    for(size_t i = 0; i < 40; i++) {
+        pl.upsert(i, offsets);
+    }
+
+    const uint32_t* first_ids = nullptr;
+
+    {
+        auto it = pl.new_iterator();
+        first_ids = it.ids;
+
+        size_t num_ids = 0;
+        while(it.valid()) {
+            // all blocks have the same size, so they are decoded into the same memory
+            ASSERT_EQ(first_ids, it.ids);
+            ASSERT_EQ(num_ids, it.id());
+
+            if(it.index() == 1) {
+                // a clone that moves off the shared block must not disturb the original
+                auto clone = it.clone();
+                clone.next_block();
+                if(clone.valid()) {
+                    ASSERT_NE(it.ids, clone.ids);
+                    ASSERT_EQ(it.last_block_id() + 1, clone.id());
+                }
+                ASSERT_EQ(num_ids, it.id());
+            }
+
+            num_ids++;
+            it.next();
+        }
+
+        ASSERT_EQ(40, num_ids);
+    }
+
+    // buffer of a destroyed iterator is recycled by the next one on the same thread
+    auto it = pl.new_iterator();
+    ASSERT_EQ(first_ids, it.ids);
+
+    it.skip_to(21);
+    ASSERT_TRUE(it.valid());
+    ASSERT_EQ(21, it.id());
+    ASSERT_EQ(first_ids, it.ids);
+}
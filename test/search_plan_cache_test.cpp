@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include "search_plan_cache.h"
+
+TEST(SearchPlanCacheTest, SortPlansOwnTheirEvalFilterTrees) {
+    search_plan_cache_t<sort_plan_t> cache(4096);
+
+    auto sort_plan = std::make_shared<sort_plan_t>();
+    sort_plan->sort_fields_std.emplace_back("points", "DESC");
+    sort_plan->sort_fields_std.emplace_back(sort_field_const::eval, "DESC");
+    sort_plan->sort_fields_std.back().eval.filter_tree_root = new filter_node_t(filter{"brand", {"Nike"}, {EQUALS}});
+
+    cache.put("sort", 0, sort_plan);
+    sort_plan.reset();
+
+    auto cached_plan = cache.get("sort", 0);
+    ASSERT_NE(nullptr, cached_plan);
+    ASSERT_EQ(nullptr, cached_plan->sort_fields_std[0].eval.filter_tree_root);
+    ASSERT_EQ("brand", cached_plan->sort_fields_std[1].eval.filter_tree_root->filter_exp.field_name);
+
+    // dropped for a newer schema, while still held by the search
+    ASSERT_EQ(nullptr, cache.get("sort", 1));
+    ASSERT_EQ(0, cache.num_entries());
+    ASSERT_EQ("brand", cached_plan->sort_fields_std[1].eval.filter_tree_root->filter_exp.field_name);
+}
+
+TEST(SearchPlanCacheTest, PlansAreChargedByTheLengthOfTheirClauses) {
+    search_plan_cache_t<std::string> cache(4096);
+
+    cache.put("a: 1", 0, std::make_shared<const std::string>("plan"));
+    const size_t short_plan_size = cache.size_bytes();
+
+    cache.put(std::string(40, 'a'), 0, std::make_shared<const std::string>("plan"));
+    ASSERT_GT(cache.size_bytes() - short_plan_size, short_plan_size);
+
+    // a clause too long to hold
+    cache.put(std::string(4096, 'a'), 0, std::make_shared<const std::string>("plan"));
+    ASSERT_EQ(2, cache.num_entries());
+}
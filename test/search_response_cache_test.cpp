@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "search_response_cache.h"
+
+class SearchResponseCacheTest : public ::testing::Test {
+protected:
+    SearchResponseCache& cache = SearchResponseCache::get_instance();
+
+    virtual void SetUp() {
+        cache.set_capacity(16 * 64 * 1024);
+        cache.clear();
+    }
+
+    virtual void TearDown() {
+        cache.clear();
+        cache.set_capacity(0);
+    }
+
+    cached_res_t make_res(uint64_t key, size_t body_size, uint32_t ttl = 60) {
+        cached_res_t res;
+        res.load(200, "application/json; charset=utf-8", std::string(body_size, 'x'),
+                 std::chrono::high_resolution_clock::now(), ttl, key);
+        return res;
+    }
+
+    std::vector<SearchResponseCache::collection_version_t> read_versions(const std::vector<std::string>& names) {
+        std::vector<SearchResponseCache::collection_version_t> versions;
+        for(const auto& name: names) {
+            versions.push_back({name, cache.get_collection_version(name)});
+        }
+        return versions;
+    }
+};
+
+TEST_F(SearchResponseCacheTest, EntriesAreDroppedWhenTheirCollectionsChange) {
+    const uint64_t hits = cache.get_num_hits();
+    const uint64_t misses = cache.get_num_misses();
+    const uint64_t evictions = cache.get_num_evictions();
+    const uint64_t stale_drops = cache.get_num_stale_drops();
+
+    cache.put(1, make_res(1, 100), read_versions({"products"}));
+    cache.put(2, make_res(2, 100), read_versions({"products", "brands"}));
+    cache.put(3, make_res(3, 100), read_versions({"brands"}));
+
+    auto res = cache.get(1);
+    ASSERT_NE(nullptr, res);
+    ASSERT_EQ(200, res->status_code);
+    ASSERT_EQ(100, res->body.size());
+    ASSERT_EQ(hits + 1, cache.get_num_hits());
+
+    cache.invalidate("brands");
+
+    ASSERT_NE(nullptr, cache.get(1));
+    ASSERT_EQ(nullptr, cache.get(2));
+    ASSERT_EQ(nullptr, cache.get(3));
+    ASSERT_EQ(nullptr, cache.get(4));
+    ASSERT_EQ(misses + 3, cache.get_num_misses());
+    ASSERT_EQ(stale_drops + 2, cache.get_num_stale_drops());
+    ASSERT_EQ(evictions, cache.get_num_evictions());
+    ASSERT_EQ(1, cache.num_entries());
+
+    // read before the change, so the response could already be stale
+    auto versions = read_versions({"products"});
+    cache.invalidate("products");
+    cache.put(5, make_res(5, 100), versions);
+    ASSERT_EQ(nullptr, cache.get(5));
+
+    // responses handed out earlier outlive their entries
+    ASSERT_EQ(100, res->body.size());
+}
+
+TEST_F(SearchResponseCacheTest, EntriesAreDroppedOnceTheirTTLLapses) {
+    cache.put(1, make_res(1, 100, 0), read_versions({"products"}));
+    ASSERT_EQ(nullptr, cache.get(1));
+    ASSERT_EQ(0, cache.num_entries());
+}
+
+TEST_F(SearchResponseCacheTest, DroppedCollectionsLeaveATombstone) {
+    cache.invalidate("orders");
+    const size_t num_versions = cache.num_collection_versions();
+
+    auto versions = read_versions({"orders"});
+    cache.put(1, make_res(1, 100), versions);
+    ASSERT_NE(nullptr, cache.get(1));
+
+    cache.erase("orders");
+    ASSERT_EQ(nullptr, cache.get(1));
+
+    // searches that read the collection before it was dropped, and put after it was created again
+    cache.put(2, make_res(2, 100), versions);
+    ASSERT_EQ(nullptr, cache.get(2));
+
+    cache.invalidate("orders");
+    cache.put(3, make_res(3, 100), versions);
+    ASSERT_EQ(nullptr, cache.get(3));
+
+    cache.put(4, make_res(4, 100), read_versions({"orders"}));
+    ASSERT_NE(nullptr, cache.get(4));
+
+    // the tombstone took the place of the version
+    ASSERT_EQ(num_versions, cache.num_collection_versions());
+}
+
+TEST_F(SearchResponseCacheTest, ShardsEvictLeastRecentlyUsed) {
+    const uint64_t evictions = cache.get_num_evictions();
+
+    // keys of the same shard, each of which holds up to 64 KB
+    cache.put(16, make_res(16, 30 * 1024), {});
+    cache.put(32, make_res(32, 30 * 1024), {});
+    ASSERT_NE(nullptr, cache.get(16));
+
+    // other shards are left be
+    cache.put(17, make_res(17, 30 * 1024), {});
+
+    cache.put(48, make_res(48, 30 * 1024), {});
+    ASSERT_EQ(evictions + 1, cache.get_num_evictions());
+    ASSERT_EQ(3, cache.num_entries());
+    ASSERT_LE(cache.size_bytes(), 16 * 64 * 1024);
+
+    ASSERT_NE(nullptr, cache.get(16));
+    ASSERT_EQ(nullptr, cache.get(32));
+    ASSERT_NE(nullptr, cache.get(48));
+    ASSERT_NE(nullptr, cache.get(17));
+
+    // responses larger than a shard are not held
+    cache.put(64, make_res(64, 65 * 1024), {});
+    ASSERT_EQ(nullptr, cache.get(64));
+    ASSERT_EQ(3, cache.num_entries());
+
+    cache.set_capacity(0);
+    ASSERT_FALSE(cache.enabled());
+    ASSERT_EQ(0, cache.num_entries());
+    ASSERT_EQ(0, cache.size_bytes());
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <map>
+#include "sort_column.h"
+
+TEST(SortColumnTest, EmplaceGetAndErase) {
+    sort_column_t column;
+    std::map<uint32_t, int64_t> expected;
+    std::mt19937 gen(100);
+
+    // clustered and scattered IDs
+    for(uint32_t id = 0; id < 5000; id++) {
+        int64_t value = int64_t(gen()) - INT32_MAX;
+        column.emplace(id, value);
+        expected.emplace(id, value);
+    }
+
+    for(size_t i = 0; i < 500; i++) {
+        uint32_t id = gen() % 10000000;
+        column.emplace(id, -int64_t(id));
+        expected.emplace(id, -int64_t(id));
+    }
+
+    ASSERT_EQ(expected.size(), column.size());
+
+    // existing values are not overwritten
+    column.emplace(10, 12345);
+    ASSERT_EQ(expected[10], column.at(10));
+
+    for(const auto& kv: expected) {
+        int64_t value = 0;
+        ASSERT_TRUE(column.get(kv.first, value));
+        ASSERT_EQ(kv.second, value);
+        ASSERT_TRUE(column.contains(kv.first));
+    }
+
+    int64_t value = 0;
+    ASSERT_FALSE(column.get(5000, value));
+    ASSERT_FALSE(column.get(UINT32_MAX, value));
+    ASSERT_FALSE(column.contains(20000000));
+
+    // emptying a page releases it, and it can be written again
+    for(uint32_t id = 0; id < sort_column_t::PAGE_SIZE; id++) {
+        column.erase(id);
+        expected.erase(id);
+    }
+
+    column.erase(0);
+    ASSERT_EQ(expected.size(), column.size());
+    ASSERT_FALSE(column.contains(0));
+    ASSERT_FALSE(column.get(1, value));
+
+    column.emplace(1, INT64_MIN);
+    ASSERT_TRUE(column.get(1, value));
+    ASSERT_EQ(INT64_MIN, value);
+    ASSERT_FALSE(column.contains(0));
+}
@@ -223,16 +223,36 @@ TEST(TopsterTest, DistinctIntValues) {
 
         if(distinct_ids[i] == 1) {
             EXPECT_EQ(12, (int) dist_topster.getKV(i)->scores[dist_topster.getKV(i)->match_score_index]);
-            EXPECT_EQ(2, dist_topster.group_kv_map[dist_topster.getDistinctKeyAt(i)]->size);
-            EXPECT_EQ(12, dist_topster.group_kv_map[dist_topster.getDistinctKeyAt(i)]->getKV(0)->scores[0]);
-            EXPECT_EQ(11, dist_topster.group_kv_map[dist_topster.getDistinctKeyAt(i)]->getKV(1)->scores[0]);
         }
 
         if(distinct_ids[i] == 5) {
             EXPECT_EQ(9, (int) dist_topster.getKV(i)->scores[dist_topster.getKV(i)->match_score_index]);
-            EXPECT_EQ(2, dist_topster.group_kv_map[dist_topster.getDistinctKeyAt(i)]->size);
-            EXPECT_EQ(10, dist_topster.group_kv_map[dist_topster.getDistinctKeyAt(i)]->getKV(0)->scores[0]);
-            EXPECT_EQ(9, dist_topster.group_kv_map[dist_topster.getDistinctKeyAt(i)]->getKV(1)->scores[0]);
         }
     }
+
+    ASSERT_EQ(10, dist_topster.num_groups);
+
+    uint32_t group;
+    ASSERT_TRUE(dist_topster.find_group(1, group));
+    EXPECT_EQ(2, dist_topster.getGroupSize(group));
+    EXPECT_EQ(12, dist_topster.getGroupKV(group, 0)->scores[0]);
+    EXPECT_EQ(11, dist_topster.getGroupKV(group, 1)->scores[0]);
+
+    // only the top 2 of the 3 KVs of the group are kept
+    ASSERT_TRUE(dist_topster.find_group(5, group));
+    EXPECT_EQ(2, dist_topster.getGroupSize(group));
+    EXPECT_EQ(10, dist_topster.getGroupKV(group, 0)->scores[0]);
+    EXPECT_EQ(9, dist_topster.getGroupKV(group, 1)->scores[0]);
+
+    // a KV added again replaces its older self within the group
+    int64_t scores[3] = {13, 20, 30};
+    KV kv(0, 101, 1, 0, scores);
+    dist_topster.add(&kv);
+
+    ASSERT_TRUE(dist_topster.find_group(1, group));
+    EXPECT_EQ(2, dist_topster.getGroupSize(group));
+    EXPECT_EQ(13, dist_topster.getGroupKV(group, 0)->scores[0]);
+    EXPECT_EQ(11, dist_topster.getGroupKV(group, 1)->scores[0]);
+
+    ASSERT_FALSE(dist_topster.find_group(11, group));
 }
\ No newline at end of file
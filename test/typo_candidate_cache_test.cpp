@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include "typo_candidate_cache.h"
+
+class TypoCandidateCacheTest : public ::testing::Test {
+protected:
+    art_tree tree;
+    std::vector<art_leaf*> leaves;
+
+    virtual void SetUp() {
+        art_tree_init(&tree);
+
+        for(const char* key: {"apple", "apply", "ample"}) {
+            art_document document(1, 1, {0});
+            art_insert(&tree, (const unsigned char*) key, strlen(key) + 1, &document);
+            leaves.push_back((art_leaf*) art_search(&tree, (const unsigned char*) key, strlen(key) + 1));
+        }
+    }
+
+    virtual void TearDown() {
+        art_tree_destroy(&tree);
+    }
+
+    std::shared_ptr<const typo_candidates_t> make_leaves(size_t num_leaves) {
+        auto candidates = std::make_shared<typo_candidates_t>();
+        candidates->leaves.assign(leaves.begin(), leaves.begin() + num_leaves);
+        return candidates;
+    }
+};
+
+TEST_F(TypoCandidateCacheTest, KeysDifferInEveryPart) {
+    typo_candidate_cache_t cache(4096);
+
+    const std::string key = typo_candidate_cache_t::get_key("title", "appl", 1, true, MAX_SCORE);
+    cache.put(key, 3, make_leaves(3));
+
+    auto cached_leaves = cache.get(key, 3);
+    ASSERT_NE(nullptr, cached_leaves);
+    ASSERT_EQ(3, cached_leaves->leaves.size());
+    ASSERT_STREQ("apple", (const char*) cached_leaves->leaves[0]->key);
+
+    ASSERT_EQ(nullptr, cache.get(typo_candidate_cache_t::get_key("title", "appl", 2, true, MAX_SCORE), 3));
+    ASSERT_EQ(nullptr, cache.get(typo_candidate_cache_t::get_key("title", "appl", 1, false, MAX_SCORE), 3));
+    ASSERT_EQ(nullptr, cache.get(typo_candidate_cache_t::get_key("title", "appl", 1, true, FREQUENCY), 3));
+    ASSERT_EQ(nullptr, cache.get(typo_candidate_cache_t::get_key("name", "appl", 1, true, MAX_SCORE), 3));
+
+    // entries are charged for their leaves
+    const size_t entry_size = cache.size_bytes();
+    cache.put(typo_candidate_cache_t::get_key("title", "appl", 2, true, MAX_SCORE), 3, make_leaves(1));
+    ASSERT_EQ(2 * sizeof(art_leaf*), entry_size - (cache.size_bytes() - entry_size));
+}
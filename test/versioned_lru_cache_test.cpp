@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "versioned_lru_cache.h"
+
+typedef versioned_lru_cache_t<std::string, std::string, uint64_t> string_cache_t;
+
+static std::shared_ptr<const std::string> make_value(const std::string& value) {
+    return std::make_shared<const std::string>(value);
+}
+
+TEST(VersionedLRUCacheTest, EntriesOfOtherVersionsAreDropped) {
+    string_cache_t cache(1024);
+
+    cache.put("points: >10", 3, make_value("plan"), 100);
+
+    auto value = cache.get("points: >10", 3);
+    ASSERT_NE(nullptr, value);
+    ASSERT_EQ("plan", *value);
+    ASSERT_EQ(nullptr, cache.get("points: >20", 3));
+
+    // what was derived from changed since
+    ASSERT_EQ(nullptr, cache.get("points: >10", 4));
+    ASSERT_EQ(0, cache.num_entries());
+    ASSERT_EQ(0, cache.size_bytes());
+    ASSERT_EQ(nullptr, cache.get("points: >10", 3));
+    ASSERT_EQ(0, cache.get_num_evictions());
+
+    // values handed out earlier outlive their entries
+    ASSERT_EQ("plan", *value);
+
+    cache.put("a", 1, make_value("a"), 100);
+    ASSERT_EQ(nullptr, cache.get_if("a", [](uint64_t version, const std::string& value) { return value != "a"; }));
+    ASSERT_EQ(0, cache.num_entries());
+}
+
+TEST(VersionedLRUCacheTest, EvictsLeastRecentlyUsed) {
+    string_cache_t cache(300);
+
+    cache.put("a", 0, make_value("a"), 100);
+    cache.put("b", 0, make_value("b"), 100);
+    cache.put("c", 0, make_value("c"), 100);
+    ASSERT_NE(nullptr, cache.get("a", 0));
+
+    cache.put("d", 0, make_value("d"), 150);
+    ASSERT_EQ(2, cache.get_num_evictions());
+    ASSERT_EQ(2, cache.num_entries());
+    ASSERT_EQ(250, cache.size_bytes());
+
+    ASSERT_NE(nullptr, cache.get("a", 0));
+    ASSERT_EQ(nullptr, cache.get("b", 0));
+    ASSERT_EQ(nullptr, cache.get("c", 0));
+    ASSERT_NE(nullptr, cache.get("d", 0));
+
+    // replaced in place
+    cache.put("d", 0, make_value("e"), 50);
+    ASSERT_EQ("e", *cache.get("d", 0));
+    ASSERT_EQ(150, cache.size_bytes());
+
+    // entries larger than the cache are not held
+    cache.put("f", 0, make_value("f"), 301);
+    ASSERT_EQ(nullptr, cache.get("f", 0));
+    ASSERT_EQ(2, cache.num_entries());
+
+    cache.erase("a");
+    ASSERT_EQ(nullptr, cache.get("a", 0));
+    ASSERT_EQ(50, cache.size_bytes());
+
+    cache.put("a", 0, make_value("a"), 100);
+    cache.set_capacity(100);
+    ASSERT_EQ(1, cache.num_entries());
+    ASSERT_NE(nullptr, cache.get("a", 0));
+
+    cache.set_capacity(0);
+    ASSERT_FALSE(cache.enabled());
+    ASSERT_EQ(0, cache.num_entries());
+    ASSERT_EQ(0, cache.size_bytes());
+}